@@ -1,6 +1,7 @@
 #pragma once
 
 #include <stdbool.h>
+#include <stddef.h>
 #include "esp_err.h"
 
 #ifdef __cplusplus
@@ -108,6 +109,33 @@ esp_err_t sd_db_delete(const char *key);
  */
 bool sd_db_key_exists(const char *key);
 
+/**
+ * @brief Store binary data under a key
+ * Written immediately (no sd_db_save needed), outside the string table,
+ * so it is not limited to the 128-character value size.
+ * @param key Key name (max 8 chars, the SD card file name is "<key>.bin")
+ * @param data Data to store
+ * @param len Data length in bytes
+ * @return ESP_OK on success
+ */
+esp_err_t sd_db_set_blob(const char *key, const void *data, size_t len);
+
+/**
+ * @brief Read binary data stored with sd_db_set_blob
+ * @param key Key name
+ * @param data Buffer to fill
+ * @param len In: buffer size, out: bytes read
+ * @return ESP_OK on success, ESP_ERR_NOT_FOUND if key doesn't exist
+ */
+esp_err_t sd_db_get_blob(const char *key, void *data, size_t *len);
+
+/**
+ * @brief Delete binary data stored with sd_db_set_blob
+ * @param key Key name
+ * @return ESP_OK on success, ESP_ERR_NOT_FOUND if key doesn't exist
+ */
+esp_err_t sd_db_delete_blob(const char *key);
+
 /**
  * @brief Save all pending changes to SD card
  * @return ESP_OK on success
@@ -8,6 +8,8 @@
 #include "nvs_flash.h"
 #include "nvs.h"
 #include "bsp/esp-bsp.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
 
 static const char *TAG = "sd_database";
 
@@ -19,6 +21,8 @@ static const char *TAG = "sd_database";
 
 // NVS namespace
 #define NVS_NAMESPACE   "voxels_db"
+#define NVS_BLOB_NAMESPACE  "voxels_blob"   // Separate: saving the KV store erases its namespace
+#define BLOB_KEY_MAX        8               // SD blobs are "<key>.bin" 8.3 names (no FATFS long names); NVS allows 15
 
 // Storage mode
 typedef enum {
@@ -39,6 +43,12 @@ static sd_db_status_t db_status = SD_DB_NOT_PRESENT;
 static storage_mode_t storage_mode = STORAGE_NONE;
 static bool db_modified = false;
 static nvs_handle_t db_nvs_handle = 0;
+static nvs_handle_t blob_nvs_handle = 0;
+
+// Guards the cache - callers run on the httpd task, HTTP workers and LVGL
+static SemaphoreHandle_t db_mutex = NULL;
+#define DB_LOCK()   do { if (db_mutex) xSemaphoreTakeRecursive(db_mutex, portMAX_DELAY); } while (0)
+#define DB_UNLOCK() do { if (db_mutex) xSemaphoreGiveRecursive(db_mutex); } while (0)
 
 // Forward declarations
 static esp_err_t load_database_sd(void);
@@ -51,6 +61,10 @@ sd_db_status_t sd_db_init(void)
 {
     ESP_LOGI(TAG, "Initializing database...");
     
+    if (db_mutex == NULL) {
+        db_mutex = xSemaphoreCreateRecursiveMutex();
+    }
+    
     // First, try to mount SD card
     esp_err_t ret = bsp_sdcard_mount();
     if (ret == ESP_OK) {
@@ -153,6 +167,10 @@ esp_err_t sd_db_wipe(void)
             nvs_erase_all(db_nvs_handle);
             nvs_commit(db_nvs_handle);
         }
+        if (blob_nvs_handle != 0) {
+            nvs_erase_all(blob_nvs_handle);
+            nvs_commit(blob_nvs_handle);
+        }
     } else {
         // Wipe SD card
         DIR *dir = opendir(BSP_SD_MOUNT_POINT);
@@ -326,11 +344,13 @@ esp_err_t sd_db_set_string(const char *key, const char *value)
         return ESP_ERR_INVALID_STATE;
     }
     
+    DB_LOCK();
     int idx = find_entry(key);
     if (idx >= 0) {
         strncpy(db_cache[idx].value, value, sizeof(db_cache[0].value) - 1);
     } else {
         if (db_entry_count >= MAX_ENTRIES) {
+            DB_UNLOCK();
             ESP_LOGE(TAG, "Database full");
             return ESP_ERR_NO_MEM;
         }
@@ -340,6 +360,7 @@ esp_err_t sd_db_set_string(const char *key, const char *value)
     }
     
     db_modified = true;
+    DB_UNLOCK();
     ESP_LOGD(TAG, "Set %s = %s", key, value);
     return ESP_OK;
 }
@@ -350,13 +371,16 @@ esp_err_t sd_db_get_string(const char *key, char *value, size_t max_len)
         return ESP_ERR_INVALID_STATE;
     }
     
+    DB_LOCK();
     int idx = find_entry(key);
     if (idx < 0) {
+        DB_UNLOCK();
         return ESP_ERR_NOT_FOUND;
     }
     
     strncpy(value, db_cache[idx].value, max_len - 1);
     value[max_len - 1] = '\0';
+    DB_UNLOCK();
     return ESP_OK;
 }
 
@@ -387,8 +411,10 @@ esp_err_t sd_db_delete(const char *key)
         return ESP_ERR_INVALID_STATE;
     }
     
+    DB_LOCK();
     int idx = find_entry(key);
     if (idx < 0) {
+        DB_UNLOCK();
         return ESP_ERR_NOT_FOUND;
     }
     
@@ -397,6 +423,7 @@ esp_err_t sd_db_delete(const char *key)
     }
     db_entry_count--;
     db_modified = true;
+    DB_UNLOCK();
     
     ESP_LOGD(TAG, "Deleted key: %s", key);
     return ESP_OK;
@@ -407,7 +434,130 @@ bool sd_db_key_exists(const char *key)
     if (!sd_db_is_ready() || key == NULL) {
         return false;
     }
-    return find_entry(key) >= 0;
+    DB_LOCK();
+    bool exists = find_entry(key) >= 0;
+    DB_UNLOCK();
+    return exists;
+}
+
+// SD card blobs are stored as one file per key next to the database
+static void blob_file_path(const char *key, char *path, size_t len)
+{
+    snprintf(path, len, "%s/%s.bin", BSP_SD_MOUNT_POINT, key);
+}
+
+static esp_err_t open_blob_nvs(void)
+{
+    if (blob_nvs_handle != 0) {
+        return ESP_OK;
+    }
+    return nvs_open(NVS_BLOB_NAMESPACE, NVS_READWRITE, &blob_nvs_handle);
+}
+
+esp_err_t sd_db_set_blob(const char *key, const void *data, size_t len)
+{
+    if (!sd_db_is_ready() || key == NULL || data == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (strlen(key) > BLOB_KEY_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    esp_err_t ret = ESP_OK;
+    DB_LOCK();
+    if (storage_mode == STORAGE_SD) {
+        char path[64];
+        blob_file_path(key, path, sizeof(path));
+        FILE *f = fopen(path, "wb");
+        if (f == NULL) {
+            ret = ESP_FAIL;
+        } else {
+            if (fwrite(data, 1, len, f) != len) {
+                ret = ESP_FAIL;
+            }
+            fclose(f);
+        }
+    } else {
+        ret = open_blob_nvs();
+        if (ret == ESP_OK) {
+            ret = nvs_set_blob(blob_nvs_handle, key, data, len);
+        }
+        if (ret == ESP_OK) {
+            ret = nvs_commit(blob_nvs_handle);
+        }
+    }
+    DB_UNLOCK();
+    
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to write blob %s: %s", key, esp_err_to_name(ret));
+    }
+    return ret;
+}
+
+esp_err_t sd_db_get_blob(const char *key, void *data, size_t *len)
+{
+    if (!sd_db_is_ready() || key == NULL || data == NULL || len == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (strlen(key) > BLOB_KEY_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    esp_err_t ret = ESP_OK;
+    DB_LOCK();
+    if (storage_mode == STORAGE_SD) {
+        char path[64];
+        blob_file_path(key, path, sizeof(path));
+        FILE *f = fopen(path, "rb");
+        if (f == NULL) {
+            ret = ESP_ERR_NOT_FOUND;
+        } else {
+            *len = fread(data, 1, *len, f);
+            fclose(f);
+        }
+    } else {
+        ret = open_blob_nvs();
+        if (ret == ESP_OK) {
+            ret = nvs_get_blob(blob_nvs_handle, key, data, len);
+            if (ret == ESP_ERR_NVS_NOT_FOUND) {
+                ret = ESP_ERR_NOT_FOUND;
+            }
+        }
+    }
+    DB_UNLOCK();
+    return ret;
+}
+
+esp_err_t sd_db_delete_blob(const char *key)
+{
+    if (!sd_db_is_ready() || key == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (strlen(key) > BLOB_KEY_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    esp_err_t ret = ESP_OK;
+    DB_LOCK();
+    if (storage_mode == STORAGE_SD) {
+        char path[64];
+        blob_file_path(key, path, sizeof(path));
+        if (remove(path) != 0) {
+            ret = ESP_ERR_NOT_FOUND;
+        }
+    } else {
+        ret = open_blob_nvs();
+        if (ret == ESP_OK) {
+            ret = nvs_erase_key(blob_nvs_handle, key);
+            if (ret == ESP_OK) {
+                nvs_commit(blob_nvs_handle);
+            } else if (ret == ESP_ERR_NVS_NOT_FOUND) {
+                ret = ESP_ERR_NOT_FOUND;
+            }
+        }
+    }
+    DB_UNLOCK();
+    return ret;
 }
 
 esp_err_t sd_db_save(void)
@@ -416,13 +566,18 @@ esp_err_t sd_db_save(void)
         return ESP_ERR_INVALID_STATE;
     }
     
+    DB_LOCK();
+    
     if (!db_modified) {
+        DB_UNLOCK();
         ESP_LOGD(TAG, "No changes to save");
         return ESP_OK;
     }
     
     if (storage_mode == STORAGE_NVS) {
-        return save_to_nvs();
+        esp_err_t ret = save_to_nvs();
+        DB_UNLOCK();
+        return ret;
     }
     
     // Save to SD card
@@ -430,6 +585,7 @@ esp_err_t sd_db_save(void)
     
     FILE *f = fopen(DB_FILE_PATH, "w");
     if (f == NULL) {
+        DB_UNLOCK();
         ESP_LOGE(TAG, "Failed to open database file for writing");
         return ESP_FAIL;
     }
@@ -443,6 +599,7 @@ esp_err_t sd_db_save(void)
     
     fclose(f);
     db_modified = false;
+    DB_UNLOCK();
     
     ESP_LOGI(TAG, "Database saved to SD card with %d entries", db_entry_count);
     return ESP_OK;
@@ -462,6 +619,10 @@ esp_err_t sd_db_deinit(void)
         nvs_close(db_nvs_handle);
         db_nvs_handle = 0;
     }
+    if (blob_nvs_handle != 0) {
+        nvs_close(blob_nvs_handle);
+        blob_nvs_handle = 0;
+    }
     
     // Clear cache
     db_entry_count = 0;
@@ -0,0 +1,233 @@
+// fetch_scheduler on a simulated clock, driven like weather_fetch_task:
+// sleep until next_delay or a request, begin, run a fake HTTP fetch with
+// scripted latency and outcome, complete
+#include "fetch_scheduler.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SOFT_TTL        600
+#define HARD_TTL        1800
+#define BACKOFF_MIN     5
+#define BACKOFF_MAX     900
+#define DEVICES         1000
+
+static int failures = 0;
+
+#define CHECK(cond, ...) do {                                   \
+        if (!(cond)) {                                          \
+            failures++;                                         \
+            printf("FAIL %s:%d: ", __FILE__, __LINE__);         \
+            printf(__VA_ARGS__);                                \
+            printf("\n");                                       \
+        }                                                       \
+    } while (0)
+
+static const fetch_policy_t policy = {
+    .soft_ttl = SOFT_TTL,
+    .hard_ttl = HARD_TTL,
+    .backoff_min = BACKOFF_MIN,
+    .backoff_max = BACKOFF_MAX,
+};
+
+// Fake HTTP layer: each call takes 'latency' seconds and succeeds unless
+// the server is down at the time it starts
+typedef struct {
+    int64_t down_from;
+    int64_t down_until;
+    uint32_t latency;
+    int calls;
+    int64_t call_at[256];
+} fake_http_t;
+
+static bool fake_fetch(fake_http_t *http, int64_t *now)
+{
+    if (http->calls < 256) {
+        http->call_at[http->calls] = *now;
+    }
+    http->calls++;
+    bool up = *now < http->down_from || *now >= http->down_until;
+    *now += http->latency;
+    return up;
+}
+
+// Run the fetch loop until 'end'. Requests arrive at the given times
+// (ascending, may be NULL) and wake the loop like a task notification.
+static void run_loop(fetch_scheduler_t *sched, fake_http_t *http, int64_t *now, int64_t end,
+                     const int64_t *requests, int request_count)
+{
+    int next_request = 0;
+    while (*now < end) {
+        while (next_request < request_count && requests[next_request] <= *now) {
+            fetch_scheduler_request(sched, *now);
+            next_request++;
+        }
+
+        if (fetch_scheduler_begin(sched, *now)) {
+            int64_t started = *now;
+            bool ok = fake_fetch(http, now);
+            // Requests that arrive while the fetch runs
+            while (next_request < request_count && requests[next_request] <= *now) {
+                fetch_scheduler_request(sched, requests[next_request] > started ? requests[next_request] : started);
+                next_request++;
+            }
+            fetch_scheduler_complete(sched, *now, ok);
+            continue;
+        }
+
+        uint32_t delay = fetch_scheduler_next_delay(sched, *now);
+        int64_t wake = (delay == UINT32_MAX) ? end : *now + delay;
+        if (next_request < request_count && requests[next_request] < wake) {
+            wake = requests[next_request];
+        }
+        *now = (wake > end) ? end : (wake > *now ? wake : *now + 1);
+    }
+}
+
+static void test_refresh_cycle(void)
+{
+    fetch_scheduler_t sched;
+    fake_http_t http = { .down_from = INT64_MAX, .latency = 2 };
+    int64_t now = 1000;
+    fetch_scheduler_init(&sched, &policy, 1);
+
+    CHECK(fetch_scheduler_data_state(&sched, now) == FETCH_DATA_NONE, "no data yet");
+    CHECK(fetch_scheduler_next_delay(&sched, now) == 0, "first fetch due at once");
+
+    run_loop(&sched, &http, &now, 1000 + 3 * SOFT_TTL + 10, NULL, 0);
+    CHECK(http.calls == 4, "%d fetches in three soft TTLs, expected 4", http.calls);
+    for (int i = 1; i < http.calls && i < 4; i++) {
+        // Due soft_ttl after the previous fetch completed
+        CHECK(http.call_at[i] - http.call_at[i - 1] == SOFT_TTL + http.latency,
+              "fetch %d after %lld s", i, (long long)(http.call_at[i] - http.call_at[i - 1]));
+    }
+
+    // Freshness without refreshes
+    fetch_scheduler_init(&sched, &policy, 1);
+    CHECK(fetch_scheduler_begin(&sched, 0), "begin");
+    CHECK(fetch_scheduler_next_delay(&sched, 0) == UINT32_MAX, "in flight");
+    CHECK(!fetch_scheduler_begin(&sched, 0), "one fetch at a time");
+    fetch_scheduler_complete(&sched, 0, true);
+    CHECK(fetch_scheduler_data_state(&sched, SOFT_TTL - 1) == FETCH_DATA_FRESH, "fresh");
+    CHECK(fetch_scheduler_data_state(&sched, SOFT_TTL) == FETCH_DATA_STALE, "stale");
+    CHECK(fetch_scheduler_data_state(&sched, HARD_TTL) == FETCH_DATA_EXPIRED, "expired");
+    CHECK(fetch_scheduler_next_delay(&sched, 100) == SOFT_TTL - 100, "next refresh");
+}
+
+static void test_backoff(void)
+{
+    fetch_scheduler_t sched;
+    fake_http_t http = { .down_from = 0, .down_until = 20000, .latency = 1 };
+    int64_t now = 0;
+    fetch_scheduler_init(&sched, &policy, 42);
+
+    run_loop(&sched, &http, &now, 20000, NULL, 0);
+
+    // Retry gaps follow min * 2^n with equal jitter, capped at max
+    uint32_t nominal = BACKOFF_MIN;
+    for (int i = 1; i < http.calls && i < 256; i++) {
+        int64_t gap = http.call_at[i] - http.call_at[i - 1] - http.latency;
+        CHECK(gap >= nominal / 2 && gap <= nominal, "retry %d after %lld s, expected %u-%u",
+              i, (long long)gap, nominal / 2, nominal);
+        nominal = (nominal * 2 > BACKOFF_MAX) ? BACKOFF_MAX : nominal * 2;
+    }
+    CHECK(http.calls > 10 && http.calls < 40, "%d attempts in an outage", http.calls);
+    CHECK(fetch_scheduler_data_state(&sched, now) == FETCH_DATA_NONE, "no data while down");
+
+    // The first success after the outage resets the backoff
+    run_loop(&sched, &http, &now, 20000 + BACKOFF_MAX + SOFT_TTL + 10, NULL, 0);
+    int last = http.calls - 1;
+    CHECK(fetch_scheduler_data_state(&sched, now) != FETCH_DATA_NONE, "recovered");
+    CHECK(sched.failures == 0, "backoff reset");
+    CHECK(http.call_at[last] - http.call_at[last - 1] == SOFT_TTL + http.latency, "back on the refresh cycle");
+}
+
+static void test_coalescing(void)
+{
+    fetch_scheduler_t sched;
+    fake_http_t http = { .down_from = INT64_MAX, .latency = 3 };
+    int64_t now = 0;
+    fetch_scheduler_init(&sched, &policy, 7);
+
+    // A burst of requests at boot (UI, web handlers, widgets) and during the fetch
+    int64_t burst[50];
+    for (int i = 0; i < 50; i++) {
+        burst[i] = i / 10;
+    }
+    run_loop(&sched, &http, &now, 100, burst, 50);
+    CHECK(http.calls == 1, "%d fetches for a burst of requests, expected 1", http.calls);
+
+    // Requests while the data is fresh don't fetch
+    int64_t fresh[20];
+    for (int i = 0; i < 20; i++) {
+        fresh[i] = 100 + i * 20;
+    }
+    run_loop(&sched, &http, &now, 500, fresh, 20);
+    CHECK(http.calls == 1, "%d fetches with fresh data, expected 1", http.calls);
+
+    // After an invalidate (location change) the refetch also absorbs the
+    // requests that arrive while it runs
+    fetch_scheduler_init(&sched, &policy, 7);
+    http.calls = 0;
+    now = 0;
+    run_loop(&sched, &http, &now, SOFT_TTL + 100, NULL, 0);
+    int before = http.calls;
+    int64_t after_change[3] = { SOFT_TTL + 101, SOFT_TTL + 101, SOFT_TTL + 102 };
+    fetch_scheduler_invalidate(&sched);
+    run_loop(&sched, &http, &now, SOFT_TTL + 200, after_change, 3);
+    CHECK(http.calls == before + 1, "%d fetches after invalidate + requests, expected %d", http.calls, before + 1);
+
+    // Requests while backing off wait for the retry
+    fetch_scheduler_init(&sched, &policy, 7);
+    fake_http_t down = { .down_from = 0, .down_until = INT64_MAX, .latency = 1 };
+    now = 0;
+    int64_t impatient[30];
+    for (int i = 0; i < 30; i++) {
+        impatient[i] = 2 + i / 10;
+    }
+    run_loop(&sched, &down, &now, 4, impatient, 30);
+    CHECK(down.calls == 1, "%d fetches while backing off, expected 1", down.calls);
+}
+
+// Many devices losing the server at once must not retry in lockstep
+static void test_jitter_spread(void)
+{
+    static int64_t second_retry[DEVICES];
+    int buckets[BACKOFF_MIN * 8 + 1] = { 0 };
+    for (int d = 0; d < DEVICES; d++) {
+        fetch_scheduler_t sched;
+        fetch_scheduler_init(&sched, &policy, 0x1000 + d * 7919);
+        fetch_scheduler_begin(&sched, 0);
+        fetch_scheduler_complete(&sched, 0, false);
+        int64_t at = fetch_scheduler_next_delay(&sched, 0);
+        CHECK(fetch_scheduler_begin(&sched, at), "retry due");
+        fetch_scheduler_complete(&sched, at, false);
+        second_retry[d] = at + fetch_scheduler_next_delay(&sched, at);
+        if (second_retry[d] >= 0 && second_retry[d] < (int64_t)(sizeof(buckets) / sizeof(buckets[0]))) {
+            buckets[second_retry[d]]++;
+        }
+    }
+    int used = 0;
+    int largest = 0;
+    for (size_t i = 0; i < sizeof(buckets) / sizeof(buckets[0]); i++) {
+        used += buckets[i] > 0;
+        largest = buckets[i] > largest ? buckets[i] : largest;
+    }
+    CHECK(used >= 6, "second retries land on %d distinct seconds", used);
+    CHECK(largest < DEVICES / 3, "%d of %d devices retry in the same second", largest, DEVICES);
+}
+
+int main(void)
+{
+    test_refresh_cycle();
+    test_backoff();
+    test_coalescing();
+    test_jitter_spread();
+
+    if (failures) {
+        printf("%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("fetch_scheduler: all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,120 @@
+// Throughput of json_stream on the recorded Open-Meteo responses, fed in
+// chunks the size of the HTTP client's receive buffer. With cJSON
+// available the same documents are also parsed into a tree for comparison.
+#include "json_stream.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#ifdef HAVE_CJSON
+#include "cJSON.h"
+#endif
+
+static const char *fixtures[] = {
+    "forecast_series.json",
+    "forecast_multi.json",
+    "geocoding_90210.json",
+};
+
+static volatile size_t sink;
+
+static void count_cb(const json_stream_value_t *value, void *user_data)
+{
+    (*(size_t *)user_data)++;
+    sink += value->len;
+}
+
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static char *load_fixture(const char *name, size_t *len)
+{
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%s", FIXTURE_DIR, name);
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        perror(path);
+        exit(2);
+    }
+    fseek(f, 0, SEEK_END);
+    *len = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    char *data = malloc(*len + 1);
+    if (fread(data, 1, *len, f) != *len) {
+        perror(path);
+        exit(2);
+    }
+    data[*len] = '\0';
+    fclose(f);
+    return data;
+}
+
+int main(int argc, char **argv)
+{
+    int iterations = 20000;
+    size_t chunk = 512;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--iterations") == 0) {
+            iterations = atoi(argv[i + 1]);
+        } else if (strcmp(argv[i], "--chunk") == 0) {
+            chunk = strtoul(argv[i + 1], NULL, 10);
+        }
+    }
+    if (iterations < 1 || chunk < 1) {
+        fprintf(stderr, "usage: %s [--iterations N] [--chunk BYTES]\n", argv[0]);
+        return 2;
+    }
+
+    printf("%d iterations, %zu byte chunks, json_stream_t is %zu bytes\n\n",
+           iterations, chunk, sizeof(json_stream_t));
+    printf("%-24s %7s %7s %10s %9s %9s\n", "", "bytes", "values", "MB/s", "us/doc", "ns/byte");
+
+    for (size_t f = 0; f < sizeof(fixtures) / sizeof(fixtures[0]); f++) {
+        size_t len;
+        char *data = load_fixture(fixtures[f], &len);
+
+        size_t values = 0;
+        json_stream_t js;
+        json_stream_init(&js, count_cb, &values);
+        double start = now_s();
+        for (int it = 0; it < iterations; it++) {
+            json_stream_reset(&js);
+            for (size_t pos = 0; pos < len; pos += chunk) {
+                size_t n = (len - pos < chunk) ? len - pos : chunk;
+                if (json_stream_feed(&js, data + pos, n) != ESP_OK) {
+                    fprintf(stderr, "%s: parse error\n", fixtures[f]);
+                    return 1;
+                }
+            }
+            if (json_stream_finish(&js) != ESP_OK) {
+                fprintf(stderr, "%s: incomplete\n", fixtures[f]);
+                return 1;
+            }
+        }
+        double elapsed = now_s() - start;
+        double per_doc = elapsed / iterations;
+        printf("%-24s %7zu %7zu %10.1f %9.2f %9.2f\n", fixtures[f], len, values / iterations,
+               len / per_doc / 1e6, per_doc * 1e6, per_doc * 1e9 / len);
+
+#ifdef HAVE_CJSON
+        start = now_s();
+        for (int it = 0; it < iterations; it++) {
+            cJSON *tree = cJSON_Parse(data);
+            if (!tree) {
+                fprintf(stderr, "%s: cJSON parse error\n", fixtures[f]);
+                return 1;
+            }
+            cJSON_Delete(tree);
+        }
+        per_doc = (now_s() - start) / iterations;
+        printf("%-24s %7zu %7s %10.1f %9.2f %9.2f\n", "  cJSON_Parse (tree)", len, "",
+               len / per_doc / 1e6, per_doc * 1e6, per_doc * 1e9 / len);
+#endif
+        free(data);
+    }
+    return 0;
+}
@@ -0,0 +1,283 @@
+// json_stream against recorded Open-Meteo responses fed in small chunks:
+// every split of the input must report the same values as one feed
+#include "json_stream.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_EVENTS      1024
+#define RANDOM_SPLITS   200
+
+typedef struct {
+    char path[JSON_STREAM_PATH_LEN];
+    json_stream_type_t type;
+    char text[JSON_STREAM_TOKEN_LEN];
+    size_t len;
+    int index;
+    int outer_index;
+    bool truncated;
+} event_t;
+
+typedef struct {
+    event_t events[MAX_EVENTS];
+    int count;
+} events_t;
+
+static int failures = 0;
+
+#define CHECK(cond, ...) do {                                   \
+        if (!(cond)) {                                          \
+            failures++;                                         \
+            printf("FAIL %s:%d: ", __FILE__, __LINE__);         \
+            printf(__VA_ARGS__);                                \
+            printf("\n");                                       \
+        }                                                       \
+    } while (0)
+
+static void record_cb(const json_stream_value_t *value, void *user_data)
+{
+    events_t *events = user_data;
+    if (events->count == MAX_EVENTS) {
+        return;
+    }
+    event_t *e = &events->events[events->count++];
+    strcpy(e->path, value->path);
+    memcpy(e->text, value->text, value->len + 1);
+    e->type = value->type;
+    e->len = value->len;
+    e->index = value->index;
+    e->outer_index = value->outer_index;
+    e->truncated = value->truncated;
+}
+
+static char *load_fixture(const char *name, size_t *len)
+{
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%s", FIXTURE_DIR, name);
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        perror(path);
+        exit(2);
+    }
+    fseek(f, 0, SEEK_END);
+    *len = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    char *data = malloc(*len + 1);
+    if (fread(data, 1, *len, f) != *len) {
+        perror(path);
+        exit(2);
+    }
+    data[*len] = '\0';
+    fclose(f);
+    return data;
+}
+
+// Feed data split at the given offsets (ascending, may be NULL)
+static esp_err_t parse_split(const char *data, size_t len, const size_t *splits, int split_count,
+                             events_t *events)
+{
+    json_stream_t js;
+    events->count = 0;
+    json_stream_init(&js, record_cb, events);
+
+    size_t pos = 0;
+    for (int i = 0; i <= split_count; i++) {
+        size_t end = (i < split_count) ? splits[i] : len;
+        if (json_stream_feed(&js, data + pos, end - pos) != ESP_OK) {
+            return ESP_FAIL;
+        }
+        pos = end;
+    }
+    return json_stream_finish(&js);
+}
+
+static esp_err_t parse_chunked(const char *data, size_t len, size_t chunk, events_t *events)
+{
+    static size_t splits[65536];
+    int count = 0;
+    for (size_t pos = chunk; pos < len && count < (int)(sizeof(splits) / sizeof(splits[0])); pos += chunk) {
+        splits[count++] = pos;
+    }
+    return parse_split(data, len, splits, count, events);
+}
+
+static bool same_events(const events_t *a, const events_t *b, const char *what)
+{
+    if (a->count != b->count) {
+        printf("  %s: %d values, expected %d\n", what, b->count, a->count);
+        return false;
+    }
+    for (int i = 0; i < a->count; i++) {
+        const event_t *x = &a->events[i];
+        const event_t *y = &b->events[i];
+        if (strcmp(x->path, y->path) != 0 || x->type != y->type || x->len != y->len ||
+            memcmp(x->text, y->text, x->len) != 0 || x->index != y->index ||
+            x->outer_index != y->outer_index || x->truncated != y->truncated) {
+            printf("  %s: value %d is %s=%s, expected %s=%s\n", what, i, y->path, y->text, x->path, x->text);
+            return false;
+        }
+    }
+    return true;
+}
+
+static const event_t *find(const events_t *events, const char *path, int index)
+{
+    for (int i = 0; i < events->count; i++) {
+        if (strcmp(events->events[i].path, path) == 0 && events->events[i].index == index) {
+            return &events->events[i];
+        }
+    }
+    return NULL;
+}
+
+static int count_path(const events_t *events, const char *path)
+{
+    int n = 0;
+    for (int i = 0; i < events->count; i++) {
+        n += strcmp(events->events[i].path, path) == 0;
+    }
+    return n;
+}
+
+static bool text_is(const event_t *e, json_stream_type_t type, const char *text)
+{
+    return e && e->type == type && strcmp(e->text, text) == 0;
+}
+
+// Whole-buffer parse is the reference; every chunking must match it
+static void check_splits(const char *name, events_t *reference)
+{
+    static events_t split;
+    size_t len;
+    char *data = load_fixture(name, &len);
+
+    CHECK(parse_split(data, len, NULL, 0, reference) == ESP_OK, "%s: one feed failed", name);
+    CHECK(reference->count > 0 && reference->count < MAX_EVENTS, "%s: %d values", name, reference->count);
+
+    const size_t chunks[] = { 1, 2, 3, 4, 7, 16, 61, 512, 1460 };
+    for (size_t i = 0; i < sizeof(chunks) / sizeof(chunks[0]); i++) {
+        char what[64];
+        snprintf(what, sizeof(what), "%s in %zu byte chunks", name, chunks[i]);
+        CHECK(parse_chunked(data, len, chunks[i], &split) == ESP_OK, "%s failed", what);
+        CHECK(same_events(reference, &split, what), "%s differs", what);
+    }
+
+    // Random split points, as a TCP stream might deliver them
+    srand(1234);
+    for (int r = 0; r < RANDOM_SPLITS; r++) {
+        size_t splits[32];
+        int count = 1 + rand() % 31;
+        for (int i = 0; i < count; i++) {
+            splits[i] = (size_t)rand() % len;
+        }
+        for (int i = 1; i < count; i++) {
+            for (int j = i; j > 0 && splits[j - 1] > splits[j]; j--) {
+                size_t t = splits[j];
+                splits[j] = splits[j - 1];
+                splits[j - 1] = t;
+            }
+        }
+        char what[64];
+        snprintf(what, sizeof(what), "%s random split %d", name, r);
+        CHECK(parse_split(data, len, splits, count, &split) == ESP_OK, "%s failed", what);
+        CHECK(same_events(reference, &split, what), "%s differs", what);
+    }
+
+    // No prefix is a complete document
+    for (size_t cut = 0; cut < len; cut += (len > 600) ? 7 : 1) {
+        CHECK(parse_split(data, cut, NULL, 0, &split) == ESP_FAIL, "%s: prefix of %zu bytes accepted", name, cut);
+    }
+
+    free(data);
+}
+
+static void test_forecast_series(void)
+{
+    static events_t ev;
+    check_splits("forecast_series.json", &ev);
+
+    CHECK(text_is(find(&ev, "current.temperature_2m", -1), JSON_STREAM_NUMBER, "21.3"), "current temperature");
+    CHECK(text_is(find(&ev, "current.weather_code", -1), JSON_STREAM_NUMBER, "2"), "current weather code");
+    CHECK(text_is(find(&ev, "current_units.temperature_2m", -1), JSON_STREAM_STRING, "\xc2\xb0" "C"), "raw UTF-8 unit");
+    CHECK(count_path(&ev, "hourly.time[]") == 48, "48 hourly times");
+    CHECK(count_path(&ev, "daily.time[]") == 7, "7 daily times");
+    CHECK(text_is(find(&ev, "hourly.time[]", 0), JSON_STREAM_NUMBER, "1791388800"), "first hour");
+    CHECK(text_is(find(&ev, "hourly.precipitation_probability[]", 47), JSON_STREAM_NULL, "null"), "null hour");
+    CHECK(text_is(find(&ev, "daily.precipitation_probability_max[]", 5), JSON_STREAM_NUMBER, "90"), "daily precip");
+    const event_t *e = find(&ev, "hourly.temperature_2m[]", 47);
+    CHECK(e && e->outer_index == -1, "no outer array");
+}
+
+static void test_forecast_multi(void)
+{
+    static events_t ev;
+    check_splits("forecast_multi.json", &ev);
+
+    CHECK(count_path(&ev, "[].current.temperature_2m") == 3, "three locations");
+    for (int i = 0; i < ev.count; i++) {
+        const event_t *e = &ev.events[i];
+        if (strcmp(e->path, "[].current.temperature_2m") == 0) {
+            static const char *expected[] = { "21.3", "14.8", "9.6" };
+            CHECK(e->outer_index >= 0 && e->outer_index < 3 && strcmp(e->text, expected[e->outer_index]) == 0,
+                  "location %d temperature %s", e->outer_index, e->text);
+            CHECK(e->index == e->outer_index, "index %d", e->index);
+        }
+    }
+}
+
+static void test_geocoding(void)
+{
+    static events_t ev;
+    check_splits("geocoding_90210.json", &ev);
+    CHECK(text_is(find(&ev, "results[].latitude", 0), JSON_STREAM_NUMBER, "34.07362"), "latitude");
+    CHECK(text_is(find(&ev, "results[].longitude", 0), JSON_STREAM_NUMBER, "-118.40036"), "longitude");
+    CHECK(text_is(find(&ev, "results[].timezone", 0), JSON_STREAM_STRING, "America/Los_Angeles"), "timezone");
+    CHECK(text_is(find(&ev, "results[].postcodes[]", 1), JSON_STREAM_STRING, "90210"), "postcode");
+
+    // \u escapes split across chunks decode to UTF-8
+    check_splits("geocoding_zurich.json", &ev);
+    CHECK(text_is(find(&ev, "results[].name", 0), JSON_STREAM_STRING, "Z\xc3\xbcrich"), "escaped name");
+
+    check_splits("geocoding_empty.json", &ev);
+    CHECK(find(&ev, "results[].latitude", 0) == NULL, "no results");
+}
+
+static void test_malformed(void)
+{
+    static events_t ev;
+    const char *bad[] = {
+        "{\"a\":1}x", "{\"a\":}", "{\"a\" 1}", "[1,]x", "{\"a\":tru}", "{\"a\":\"\\x\"}",
+        "{\"a\":\"\\u12g4\"}", "{\"a\":1]", "[[[[[[[[[1]]]]]]]]]", "{\"a\":\"line\nbreak\"}",
+    };
+    for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); i++) {
+        for (size_t chunk = 1; chunk <= 3; chunk++) {
+            CHECK(parse_chunked(bad[i], strlen(bad[i]), chunk, &ev) == ESP_FAIL,
+                  "accepted %s in %zu byte chunks", bad[i], chunk);
+        }
+    }
+
+    // Over-long strings are cut and flagged, not rejected
+    char doc[256];
+    snprintf(doc, sizeof(doc), "{\"s\":\"%0100d\"}", 0);
+    CHECK(parse_chunked(doc, strlen(doc), 5, &ev) == ESP_OK && ev.count == 1, "long string");
+    CHECK(ev.events[0].truncated && ev.events[0].len == JSON_STREAM_TOKEN_LEN - 1, "truncated flag");
+
+    // A bare root number ends with the input, even split mid-number
+    CHECK(parse_chunked("-12.5e3", 7, 2, &ev) == ESP_OK && text_is(&ev.events[0], JSON_STREAM_NUMBER, "-12.5e3"),
+          "bare root number");
+}
+
+int main(void)
+{
+    test_forecast_series();
+    test_forecast_multi();
+    test_geocoding();
+    test_malformed();
+
+    if (failures) {
+        printf("%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("json_stream: all checks passed\n");
+    return 0;
+}
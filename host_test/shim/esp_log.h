@@ -0,0 +1,31 @@
+#pragma once
+
+// Host build of esp_log.h: prints to stderr, filtered by esp_log_level_set()
+#include "esp_err.h"
+
+typedef enum {
+    ESP_LOG_NONE,
+    ESP_LOG_ERROR,
+    ESP_LOG_WARN,
+    ESP_LOG_INFO,
+    ESP_LOG_DEBUG,
+    ESP_LOG_VERBOSE
+} esp_log_level_t;
+
+extern esp_log_level_t esp_shim_log_level;
+
+void esp_log_level_set(const char *tag, esp_log_level_t level);
+void esp_log_write(esp_log_level_t level, const char *tag, const char *format, ...)
+    __attribute__((format(printf, 3, 4)));
+
+#define ESP_SHIM_LOG(level, letter, tag, format, ...) do {                      \
+        if (esp_shim_log_level >= (level)) {                                    \
+            esp_log_write(level, tag, letter " (%s) " format "\n", tag, ##__VA_ARGS__); \
+        }                                                                       \
+    } while (0)
+
+#define ESP_LOGE(tag, format, ...) ESP_SHIM_LOG(ESP_LOG_ERROR,   "E", tag, format, ##__VA_ARGS__)
+#define ESP_LOGW(tag, format, ...) ESP_SHIM_LOG(ESP_LOG_WARN,    "W", tag, format, ##__VA_ARGS__)
+#define ESP_LOGI(tag, format, ...) ESP_SHIM_LOG(ESP_LOG_INFO,    "I", tag, format, ##__VA_ARGS__)
+#define ESP_LOGD(tag, format, ...) ESP_SHIM_LOG(ESP_LOG_DEBUG,   "D", tag, format, ##__VA_ARGS__)
+#define ESP_LOGV(tag, format, ...) ESP_SHIM_LOG(ESP_LOG_VERBOSE, "V", tag, format, ##__VA_ARGS__)
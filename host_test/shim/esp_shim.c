@@ -0,0 +1,59 @@
+#include "esp_err.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include <stdio.h>
+#include <stdarg.h>
+#include <time.h>
+
+esp_log_level_t esp_shim_log_level = ESP_LOG_INFO;
+
+const char *esp_err_to_name(esp_err_t code)
+{
+    switch (code) {
+        case ESP_OK:                   return "ESP_OK";
+        case ESP_FAIL:                 return "ESP_FAIL";
+        case ESP_ERR_NO_MEM:           return "ESP_ERR_NO_MEM";
+        case ESP_ERR_INVALID_ARG:      return "ESP_ERR_INVALID_ARG";
+        case ESP_ERR_INVALID_STATE:    return "ESP_ERR_INVALID_STATE";
+        case ESP_ERR_INVALID_SIZE:     return "ESP_ERR_INVALID_SIZE";
+        case ESP_ERR_NOT_FOUND:        return "ESP_ERR_NOT_FOUND";
+        case ESP_ERR_NOT_SUPPORTED:    return "ESP_ERR_NOT_SUPPORTED";
+        case ESP_ERR_TIMEOUT:          return "ESP_ERR_TIMEOUT";
+        case ESP_ERR_INVALID_RESPONSE: return "ESP_ERR_INVALID_RESPONSE";
+        case ESP_ERR_INVALID_CRC:      return "ESP_ERR_INVALID_CRC";
+        case ESP_ERR_INVALID_VERSION:  return "ESP_ERR_INVALID_VERSION";
+        case ESP_ERR_NOT_FINISHED:     return "ESP_ERR_NOT_FINISHED";
+        case ESP_ERR_NOT_ALLOWED:      return "ESP_ERR_NOT_ALLOWED";
+        default:                       return "UNKNOWN ERROR";
+    }
+}
+
+void esp_shim_abort(const char *file, int line, const char *expr, esp_err_t err)
+{
+    fprintf(stderr, "ESP_ERROR_CHECK failed: %s (%s) at %s:%d\n", esp_err_to_name(err), expr, file, line);
+    abort();
+}
+
+// The tag is ignored: the host build has a single log level
+void esp_log_level_set(const char *tag, esp_log_level_t level)
+{
+    (void)tag;
+    esp_shim_log_level = level;
+}
+
+void esp_log_write(esp_log_level_t level, const char *tag, const char *format, ...)
+{
+    (void)level;
+    (void)tag;
+    va_list args;
+    va_start(args, format);
+    vfprintf(stderr, format, args);
+    va_end(args);
+}
+
+int64_t esp_timer_get_time(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
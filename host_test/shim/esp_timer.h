@@ -0,0 +1,9 @@
+#pragma once
+
+// Host build of esp_timer.h: only the clock
+#include "esp_err.h"
+
+/**
+ * @brief Microseconds on CLOCK_MONOTONIC
+ */
+int64_t esp_timer_get_time(void);
@@ -0,0 +1,351 @@
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+
+struct shim_task {
+    TaskFunction_t fn;
+    void *arg;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    uint32_t notify;
+    char name[16];
+};
+
+struct shim_queue {
+    pthread_mutex_t lock;
+    pthread_cond_t not_empty;
+    pthread_cond_t not_full;
+    size_t item_size;
+    size_t length;
+    size_t count;
+    size_t head;
+    uint8_t *items;
+};
+
+// Counting semaphore; mutexes are counting semaphores of one with an owner
+struct shim_semaphore {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    UBaseType_t count;
+    UBaseType_t max_count;
+    bool recursive;
+    pthread_t owner;
+    UBaseType_t depth;
+};
+
+static __thread struct shim_task *current_task = NULL;
+
+// Absolute CLOCK_REALTIME deadline for a wait of the given ticks
+static struct timespec deadline_after(TickType_t ticks)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_sec += ticks / 1000;
+    ts.tv_nsec += (long)(ticks % 1000) * 1000000L;
+    if (ts.tv_nsec >= 1000000000L) {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000L;
+    }
+    return ts;
+}
+
+// Wait on cond until woken or the deadline; false on timeout
+static bool cond_wait(pthread_cond_t *cond, pthread_mutex_t *lock, TickType_t ticks, const struct timespec *deadline)
+{
+    if (ticks == 0) {
+        return false;
+    }
+    if (ticks == portMAX_DELAY) {
+        pthread_cond_wait(cond, lock);
+        return true;
+    }
+    return pthread_cond_timedwait(cond, lock, deadline) != ETIMEDOUT;
+}
+
+static struct shim_task *task_alloc(const char *name)
+{
+    struct shim_task *task = calloc(1, sizeof(struct shim_task));
+    if (!task) {
+        return NULL;
+    }
+    pthread_mutex_init(&task->lock, NULL);
+    pthread_cond_init(&task->cond, NULL);
+    strncpy(task->name, name ? name : "", sizeof(task->name) - 1);
+    return task;
+}
+
+static void *task_entry(void *arg)
+{
+    current_task = arg;
+    current_task->fn(current_task->arg);
+    return NULL;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char *name, uint32_t stack_depth, void *arg,
+                       UBaseType_t priority, TaskHandle_t *handle)
+{
+    (void)stack_depth;
+    (void)priority;
+
+    struct shim_task *task = task_alloc(name);
+    if (!task) {
+        return pdFAIL;
+    }
+    task->fn = fn;
+    task->arg = arg;
+
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, task_entry, task) != 0) {
+        free(task);
+        return pdFAIL;
+    }
+    pthread_detach(thread);
+
+    if (handle) {
+        *handle = task;
+    }
+    return pdPASS;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char *name, uint32_t stack_depth, void *arg,
+                                   UBaseType_t priority, TaskHandle_t *handle, BaseType_t core)
+{
+    (void)core;
+    return xTaskCreate(fn, name, stack_depth, arg, priority, handle);
+}
+
+// Only self-deletion is supported, as used by tasks that finish
+void vTaskDelete(TaskHandle_t task)
+{
+    if (task == NULL || task == current_task) {
+        pthread_exit(NULL);
+    }
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+    usleep((useconds_t)ticks * 1000);
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (TickType_t)((uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000);
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+    // Threads not created by xTaskCreate (e.g. main) get a handle on first use
+    if (!current_task) {
+        current_task = task_alloc("main");
+    }
+    return current_task;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks)
+{
+    struct shim_task *task = xTaskGetCurrentTaskHandle();
+    struct timespec deadline = deadline_after(ticks);
+
+    pthread_mutex_lock(&task->lock);
+    while (task->notify == 0) {
+        if (!cond_wait(&task->cond, &task->lock, ticks, &deadline)) {
+            break;
+        }
+    }
+    uint32_t value = task->notify;
+    if (value > 0) {
+        task->notify = clear_on_exit ? 0 : value - 1;
+    }
+    pthread_mutex_unlock(&task->lock);
+    return value;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task)
+{
+    pthread_mutex_lock(&task->lock);
+    task->notify++;
+    pthread_cond_signal(&task->cond);
+    pthread_mutex_unlock(&task->lock);
+    return pdPASS;
+}
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size)
+{
+    struct shim_queue *queue = calloc(1, sizeof(struct shim_queue));
+    if (!queue) {
+        return NULL;
+    }
+    queue->items = calloc(length, item_size);
+    if (!queue->items) {
+        free(queue);
+        return NULL;
+    }
+    pthread_mutex_init(&queue->lock, NULL);
+    pthread_cond_init(&queue->not_empty, NULL);
+    pthread_cond_init(&queue->not_full, NULL);
+    queue->item_size = item_size;
+    queue->length = length;
+    return queue;
+}
+
+void vQueueDelete(QueueHandle_t queue)
+{
+    if (queue) {
+        free(queue->items);
+        free(queue);
+    }
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t ticks)
+{
+    struct timespec deadline = deadline_after(ticks);
+
+    pthread_mutex_lock(&queue->lock);
+    while (queue->count == queue->length) {
+        if (!cond_wait(&queue->not_full, &queue->lock, ticks, &deadline)) {
+            pthread_mutex_unlock(&queue->lock);
+            return pdFALSE;
+        }
+    }
+    size_t tail = (queue->head + queue->count) % queue->length;
+    memcpy(queue->items + tail * queue->item_size, item, queue->item_size);
+    queue->count++;
+    pthread_cond_signal(&queue->not_empty);
+    pthread_mutex_unlock(&queue->lock);
+    return pdTRUE;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t ticks)
+{
+    struct timespec deadline = deadline_after(ticks);
+
+    pthread_mutex_lock(&queue->lock);
+    while (queue->count == 0) {
+        if (!cond_wait(&queue->not_empty, &queue->lock, ticks, &deadline)) {
+            pthread_mutex_unlock(&queue->lock);
+            return pdFALSE;
+        }
+    }
+    memcpy(item, queue->items + queue->head * queue->item_size, queue->item_size);
+    queue->head = (queue->head + 1) % queue->length;
+    queue->count--;
+    pthread_cond_signal(&queue->not_full);
+    pthread_mutex_unlock(&queue->lock);
+    return pdTRUE;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue)
+{
+    pthread_mutex_lock(&queue->lock);
+    UBaseType_t count = queue->count;
+    pthread_mutex_unlock(&queue->lock);
+    return count;
+}
+
+static SemaphoreHandle_t semaphore_create(UBaseType_t max_count, UBaseType_t initial_count, bool recursive)
+{
+    struct shim_semaphore *sem = calloc(1, sizeof(struct shim_semaphore));
+    if (!sem) {
+        return NULL;
+    }
+    pthread_mutex_init(&sem->lock, NULL);
+    pthread_cond_init(&sem->cond, NULL);
+    sem->max_count = max_count;
+    sem->count = initial_count;
+    sem->recursive = recursive;
+    return sem;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void)
+{
+    return semaphore_create(1, 1, false);
+}
+
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutex(void)
+{
+    return semaphore_create(1, 1, true);
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void)
+{
+    return semaphore_create(1, 0, false);
+}
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t max_count, UBaseType_t initial_count)
+{
+    return semaphore_create(max_count, initial_count, false);
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t sem)
+{
+    free(sem);
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks)
+{
+    struct timespec deadline = deadline_after(ticks);
+
+    pthread_mutex_lock(&sem->lock);
+    while (sem->count == 0) {
+        if (!cond_wait(&sem->cond, &sem->lock, ticks, &deadline)) {
+            pthread_mutex_unlock(&sem->lock);
+            return pdFALSE;
+        }
+    }
+    sem->count--;
+    sem->owner = pthread_self();
+    pthread_mutex_unlock(&sem->lock);
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem)
+{
+    pthread_mutex_lock(&sem->lock);
+    if (sem->count >= sem->max_count) {
+        pthread_mutex_unlock(&sem->lock);
+        return pdFALSE;
+    }
+    sem->count++;
+    pthread_cond_signal(&sem->cond);
+    pthread_mutex_unlock(&sem->lock);
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t sem, TickType_t ticks)
+{
+    pthread_mutex_lock(&sem->lock);
+    if (sem->depth > 0 && pthread_equal(sem->owner, pthread_self())) {
+        sem->depth++;
+        pthread_mutex_unlock(&sem->lock);
+        return pdTRUE;
+    }
+    pthread_mutex_unlock(&sem->lock);
+
+    if (xSemaphoreTake(sem, ticks) != pdTRUE) {
+        return pdFALSE;
+    }
+    pthread_mutex_lock(&sem->lock);
+    sem->depth = 1;
+    pthread_mutex_unlock(&sem->lock);
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t sem)
+{
+    pthread_mutex_lock(&sem->lock);
+    if (sem->depth == 0 || !pthread_equal(sem->owner, pthread_self())) {
+        pthread_mutex_unlock(&sem->lock);
+        return pdFALSE;
+    }
+    bool release = (--sem->depth == 0);
+    pthread_mutex_unlock(&sem->lock);
+    return release ? xSemaphoreGive(sem) : pdTRUE;
+}
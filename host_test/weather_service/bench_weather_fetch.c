@@ -0,0 +1,171 @@
+// End-to-end fetch and parse throughput of weather_service.c against
+// mock_open_meteo.py: each iteration changes the zip code (alternating
+// between two already geocoded ones) and times the fetch it starts, from
+// the request to the parsed forecast being published. The service's own
+// HTTP counters split that into transfer and tokenizer time.
+#include "weather_service.h"
+#include "host_stubs.h"
+#include "mock_client.h"
+#include "esp_log.h"
+#include "cJSON.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define FETCH_TIMEOUT_MS    15000
+
+typedef struct {
+    double requests;
+    double connects;
+    double total_ms;
+    double parse_ms;
+    double bytes;
+} conn_stats_t;
+
+static double now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+static double number(const cJSON *conn, const char *field)
+{
+    const cJSON *item = cJSON_GetObjectItem(conn, field);
+    return cJSON_IsNumber(item) ? item->valuedouble : 0;
+}
+
+static conn_stats_t forecast_stats(void)
+{
+    cJSON *stats = weather_service_get_http_stats();
+    const cJSON *conn = cJSON_GetObjectItem(stats, "forecast");
+    conn_stats_t out = {
+        .requests = number(conn, "requests"),
+        .connects = number(conn, "connects"),
+        .total_ms = number(conn, "avg_ms") * number(conn, "requests"),
+        .parse_ms = number(conn, "parse_ms"),
+        .bytes = number(conn, "bytes"),
+    };
+    cJSON_Delete(stats);
+    return out;
+}
+
+static bool fetch_zip(const char *zip)
+{
+    uint32_t seen = host_stubs_weather_updates();
+    weather_service_set_zip_code(zip);
+    return host_stubs_wait_weather_update(seen, FETCH_TIMEOUT_MS) && !weather_service_last_fetch_failed();
+}
+
+static int compare_double(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+            "usage: %s --mock HOST:PORT [options]\n"
+            "  --iterations N   fetches to time (default 200)\n"
+            "  --locations N    named locations in each request, 0-%d (default 0)\n"
+            "  --oversize N     bytes of padding the mock adds to each response\n"
+            "  --latency-ms N   delay the mock adds to each response\n"
+            "  --chunk N        mock sends chunked bodies in N byte pieces\n",
+            prog, WEATHER_MAX_LOCATIONS - 1);
+}
+
+int main(int argc, char **argv)
+{
+    const char *target = NULL;
+    int iterations = 200;
+    int extra_locations = 0;
+    long oversize = 0, latency_ms = 0, chunk = 0;
+    for (int i = 1; i < argc; i++) {
+        const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+        if (!value) {
+            usage(argv[0]);
+            return 2;
+        }
+        if (strcmp(argv[i], "--mock") == 0) {
+            target = value;
+        } else if (strcmp(argv[i], "--iterations") == 0) {
+            iterations = atoi(value);
+        } else if (strcmp(argv[i], "--locations") == 0) {
+            extra_locations = atoi(value);
+        } else if (strcmp(argv[i], "--oversize") == 0) {
+            oversize = atol(value);
+        } else if (strcmp(argv[i], "--latency-ms") == 0) {
+            latency_ms = atol(value);
+        } else if (strcmp(argv[i], "--chunk") == 0) {
+            chunk = atol(value);
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+        i++;
+    }
+    if (!target || iterations < 1 || extra_locations < 0 || extra_locations >= WEATHER_MAX_LOCATIONS) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    esp_log_level_set("*", ESP_LOG_NONE);
+    if (mock_client_init(target) != ESP_OK) {
+        fprintf(stderr, "mock server not reachable at %s\n", target);
+        return 2;
+    }
+    char config[128];
+    snprintf(config, sizeof(config), "reset=1&oversize=%ld&latency_ms=%ld&chunk=%ld", oversize, latency_ms, chunk);
+    mock_client_configure(config);
+
+    // Geocode everything before timing
+    weather_service_init();
+    static const char *places[] = { "90211", "zurich", "10001" };
+    for (int i = 0; i < extra_locations; i++) {
+        char name[8];
+        snprintf(name, sizeof(name), "loc%d", i + 1);
+        uint32_t seen = host_stubs_weather_updates();
+        weather_service_set_location(name, places[i]);
+        host_stubs_wait_weather_update(seen, FETCH_TIMEOUT_MS);
+    }
+    if (!fetch_zip("90211") || !fetch_zip("90210")) {
+        fprintf(stderr, "warm-up fetch failed\n");
+        return 1;
+    }
+
+    double *wall = malloc(iterations * sizeof(double));
+    conn_stats_t before = forecast_stats();
+    double start = now_ms();
+    for (int i = 0; i < iterations; i++) {
+        double t0 = now_ms();
+        if (!fetch_zip(i % 2 ? "90210" : "90211")) {
+            fprintf(stderr, "fetch %d failed\n", i);
+            free(wall);
+            return 1;
+        }
+        wall[i] = now_ms() - t0;
+    }
+    double elapsed = now_ms() - start;
+    conn_stats_t after = forecast_stats();
+    qsort(wall, iterations, sizeof(double), compare_double);
+
+    double requests = after.requests - before.requests;
+    double bytes = after.bytes - before.bytes;
+    double total_ms = after.total_ms - before.total_ms;
+    double parse_ms = after.parse_ms - before.parse_ms;
+    printf("%d fetches of %d location(s), %.0f bytes each, mock latency %ld ms, %s\n\n",
+           iterations, extra_locations + 1, requests ? bytes / requests : 0, latency_ms,
+           chunk ? "chunked" : "Content-Length");
+    printf("fetch cycle   %8.2f fetches/s   avg %.2f ms   p50 %.2f ms   p99 %.2f ms\n",
+           iterations * 1000.0 / elapsed, elapsed / iterations,
+           wall[iterations / 2], wall[(int)(iterations * 0.99)]);
+    printf("HTTP+parse    %8.1f KB/s        avg %.2f ms per request\n",
+           total_ms ? bytes / total_ms : 0, requests ? total_ms / requests : 0);
+    printf("parse only    %8.1f KB/s        %.1f%% of request time\n",
+           parse_ms ? bytes / parse_ms : 0, total_ms ? parse_ms * 100 / total_ms : 0);
+    printf("connections   %8.0f new for %.0f requests\n", after.connects - before.connects, requests);
+    free(wall);
+    return 0;
+}
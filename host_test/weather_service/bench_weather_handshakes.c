@@ -0,0 +1,187 @@
+// TLS handshakes saved by the forecast connection's keep-alive and session
+// resumption, against mock_open_meteo.py --tls. weather_service.c is built
+// with https URLs here, so this is the firmware's own client configuration
+// (keep_alive_enable, save_client_session). Each mode runs the same fetches:
+//   keep-alive   the mock keeps the connection open
+//   resumed      the mock closes it after every response; reconnects
+//                resume the saved TLS session
+//   full         as resumed, with resumption disabled in the host client
+// "saved" is requests minus full handshakes. Over loopback the latency
+// difference is handshake CPU only; add the network round trips (two for
+// a full TLS 1.2 handshake, one for a resumed one) for a device.
+#include "weather_service.h"
+#include "host_stubs.h"
+#include "mock_client.h"
+#include "esp_http_client.h"
+#include "esp_log.h"
+#include "cJSON.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define FETCH_TIMEOUT_MS    15000
+
+typedef struct {
+    const char *name;
+    int close;                  // Mock closes the connection after each response
+    bool resumption;
+} bench_mode_t;
+
+typedef struct {
+    double requests;
+    double connects;
+    double total_ms;
+    esp_http_client_shim_tls_stats_t tls;
+} conn_stats_t;
+
+static double now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+static double number(const cJSON *conn, const char *field)
+{
+    const cJSON *item = cJSON_GetObjectItem(conn, field);
+    return cJSON_IsNumber(item) ? item->valuedouble : 0;
+}
+
+static conn_stats_t forecast_stats(void)
+{
+    cJSON *stats = weather_service_get_http_stats();
+    const cJSON *conn = cJSON_GetObjectItem(stats, "forecast");
+    conn_stats_t out = {
+        .requests = number(conn, "requests"),
+        .connects = number(conn, "connects"),
+        .total_ms = number(conn, "avg_ms") * number(conn, "requests"),
+    };
+    cJSON_Delete(stats);
+    esp_http_client_shim_get_tls_stats(&out.tls);
+    return out;
+}
+
+static bool fetch_zip(const char *zip)
+{
+    uint32_t seen = host_stubs_weather_updates();
+    weather_service_set_zip_code(zip);
+    return host_stubs_wait_weather_update(seen, FETCH_TIMEOUT_MS) && !weather_service_last_fetch_failed();
+}
+
+static int compare_double(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+            "usage: %s --mock https://HOST:PORT --mock-ca CERT [options]\n"
+            "  (run through run_with_mock.py --mock-args --tls)\n"
+            "  --iterations N   fetches per mode (default 100)\n"
+            "  --latency-ms N   delay the mock adds to each response\n",
+            prog);
+}
+
+// Time iterations fetches in one mode; false if a fetch failed
+static bool run_mode(const bench_mode_t *mode, int iterations, long latency_ms, double *wall)
+{
+    char config[96];
+    snprintf(config, sizeof(config), "reset=1&close=%d&latency_ms=%ld", mode->close, latency_ms);
+    mock_client_configure(config);
+    esp_http_client_shim_set_session_resumption(mode->resumption);
+    // Settle into the mode (the previous one may have left a connection open)
+    if (!fetch_zip("90211")) {
+        return false;
+    }
+
+    conn_stats_t before = forecast_stats();
+    double start = now_ms();
+    for (int i = 0; i < iterations; i++) {
+        double t0 = now_ms();
+        if (!fetch_zip(i % 2 ? "90211" : "90210")) {
+            fprintf(stderr, "%s: fetch %d failed\n", mode->name, i);
+            return false;
+        }
+        wall[i] = now_ms() - t0;
+    }
+    double elapsed = now_ms() - start;
+    conn_stats_t after = forecast_stats();
+    qsort(wall, iterations, sizeof(double), compare_double);
+
+    double requests = after.requests - before.requests;
+    double full = after.tls.full - before.tls.full;
+    double resumed = after.tls.resumed - before.tls.resumed;
+    printf("%-11s %8.0f %8.0f %6.0f %8.0f %6.0f   %8.2f %8.2f %8.2f %8.2f\n", mode->name,
+           requests, after.connects - before.connects, full, resumed, requests - full,
+           requests ? (after.total_ms - before.total_ms) / requests : 0,
+           elapsed / iterations, wall[iterations / 2], wall[(int)(iterations * 0.99)]);
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    const char *target = NULL;
+    const char *ca = NULL;
+    int iterations = 100;
+    long latency_ms = 0;
+    for (int i = 1; i < argc; i++) {
+        const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+        if (!value) {
+            usage(argv[0]);
+            return 2;
+        }
+        if (strcmp(argv[i], "--mock") == 0) {
+            target = value;
+        } else if (strcmp(argv[i], "--mock-ca") == 0) {
+            ca = value;
+        } else if (strcmp(argv[i], "--iterations") == 0) {
+            iterations = atoi(value);
+        } else if (strcmp(argv[i], "--latency-ms") == 0) {
+            latency_ms = atol(value);
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+        i++;
+    }
+    if (!target || strncmp(target, "https://", 8) != 0 || !ca || iterations < 1) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    esp_log_level_set("*", ESP_LOG_NONE);
+    esp_http_client_shim_set_ca_file(ca);
+    if (mock_client_init(target) != ESP_OK) {
+        fprintf(stderr, "mock server not reachable at %s\n", target);
+        return 2;
+    }
+    mock_client_configure("reset=1");
+
+    // Geocode both zip codes before timing
+    weather_service_init();
+    if (!fetch_zip("90211") || !fetch_zip("90210")) {
+        fprintf(stderr, "warm-up fetch failed\n");
+        return 1;
+    }
+
+    static const bench_mode_t modes[] = {
+        { "keep-alive", 0, true },
+        { "resumed", 1, true },
+        { "full", 1, false },
+    };
+    double *wall = malloc(iterations * sizeof(double));
+    printf("%d forecast fetches per mode over TLS, mock latency %ld ms\n\n", iterations, latency_ms);
+    printf("%-11s %8s %8s %6s %8s %6s   %8s %8s %8s %8s\n", "mode", "requests", "connects", "full",
+           "resumed", "saved", "http ms", "fetch ms", "p50 ms", "p99 ms");
+    for (size_t i = 0; i < sizeof(modes) / sizeof(modes[0]); i++) {
+        if (!run_mode(&modes[i], iterations, latency_ms, wall)) {
+            free(wall);
+            return 1;
+        }
+    }
+    free(wall);
+    return 0;
+}
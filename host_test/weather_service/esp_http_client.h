@@ -0,0 +1,99 @@
+#pragma once
+
+// Host build of the esp_http_client API used by main/core: http over a
+// keep-alive socket, bodies delivered as HTTP_EVENT_ON_DATA (chunked
+// transfer decoded). https (with TLS session resumption) needs OpenSSL,
+// which the build enables with HOST_TLS.
+#include "esp_err.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+#define ESP_ERR_HTTP_BASE               0x7000
+#define ESP_ERR_HTTP_MAX_REDIRECT       (ESP_ERR_HTTP_BASE + 1)
+#define ESP_ERR_HTTP_CONNECT            (ESP_ERR_HTTP_BASE + 2)
+#define ESP_ERR_HTTP_WRITE_DATA         (ESP_ERR_HTTP_BASE + 3)
+#define ESP_ERR_HTTP_FETCH_HEADER       (ESP_ERR_HTTP_BASE + 4)
+#define ESP_ERR_HTTP_INVALID_TRANSPORT  (ESP_ERR_HTTP_BASE + 5)
+#define ESP_ERR_HTTP_CONNECTING         (ESP_ERR_HTTP_BASE + 6)
+#define ESP_ERR_HTTP_EAGAIN             (ESP_ERR_HTTP_BASE + 7)
+#define ESP_ERR_HTTP_CONNECTION_CLOSED  (ESP_ERR_HTTP_BASE + 8)
+
+typedef struct esp_http_client *esp_http_client_handle_t;
+
+typedef enum {
+    HTTP_EVENT_ERROR = 0,
+    HTTP_EVENT_ON_CONNECTED,
+    HTTP_EVENT_HEADERS_SENT,
+    HTTP_EVENT_ON_HEADER,
+    HTTP_EVENT_ON_DATA,
+    HTTP_EVENT_ON_FINISH,
+    HTTP_EVENT_DISCONNECTED,
+    HTTP_EVENT_REDIRECT,
+} esp_http_client_event_id_t;
+
+typedef struct {
+    esp_http_client_event_id_t event_id;
+    esp_http_client_handle_t client;
+    void *data;
+    int data_len;
+    void *user_data;
+    char *header_key;
+    char *header_value;
+} esp_http_client_event_t;
+
+typedef esp_err_t (*http_event_handle_cb)(esp_http_client_event_t *evt);
+
+typedef enum {
+    HTTP_TRANSPORT_UNKNOWN = 0,
+    HTTP_TRANSPORT_OVER_TCP,
+    HTTP_TRANSPORT_OVER_SSL,
+} esp_http_client_transport_t;
+
+typedef struct {
+    const char *url;
+    http_event_handle_cb event_handler;
+    void *user_data;
+    int timeout_ms;
+    esp_http_client_transport_t transport_type;
+    bool keep_alive_enable;
+    bool save_client_session;
+    esp_err_t (*crt_bundle_attach)(void *conf);
+} esp_http_client_config_t;
+
+esp_http_client_handle_t esp_http_client_init(const esp_http_client_config_t *config);
+esp_err_t esp_http_client_set_url(esp_http_client_handle_t client, const char *url);
+esp_err_t esp_http_client_set_user_data(esp_http_client_handle_t client, void *data);
+esp_err_t esp_http_client_perform(esp_http_client_handle_t client);
+int esp_http_client_get_status_code(esp_http_client_handle_t client);
+esp_err_t esp_http_client_close(esp_http_client_handle_t client);
+esp_err_t esp_http_client_cleanup(esp_http_client_handle_t client);
+
+/**
+ * @brief Send every request to this server, whatever the URL's host
+ *
+ * The firmware URLs are fixed at build time; the host tests point them at
+ * a mock server started on a free port.
+ */
+void esp_http_client_shim_set_server(const char *host, uint16_t port);
+
+#ifdef HOST_TLS
+/**
+ * @brief Full and resumed TLS handshakes made by all clients
+ */
+typedef struct {
+    uint32_t full;
+    uint32_t resumed;
+} esp_http_client_shim_tls_stats_t;
+
+/**
+ * @brief Trust this PEM file instead of the system store (a mock's own certificate)
+ */
+void esp_http_client_shim_set_ca_file(const char *path);
+
+/**
+ * @brief Let save_client_session resume sessions (default), or force full handshakes
+ */
+void esp_http_client_shim_set_session_resumption(bool enable);
+
+void esp_http_client_shim_get_tls_stats(esp_http_client_shim_tls_stats_t *stats);
+#endif
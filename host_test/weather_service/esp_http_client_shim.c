@@ -0,0 +1,544 @@
+#include "esp_http_client.h"
+#include "esp_log.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <errno.h>
+#include <netdb.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#ifdef HOST_TLS
+#include <signal.h>
+#include <pthread.h>
+#include <openssl/ssl.h>
+#include <openssl/err.h>
+#endif
+
+static const char *TAG = "http_client_shim";
+
+#define SHIM_URL_LEN        1024
+#define SHIM_HOST_LEN       128
+#define SHIM_RX_BUF         2048    // Status line and each header line must fit
+#define SHIM_EVENT_DATA     512     // Body bytes per HTTP_EVENT_ON_DATA, as the device's default buffer
+
+struct esp_http_client {
+    char url[SHIM_URL_LEN];
+    char host[SHIM_HOST_LEN];
+    uint16_t port;
+    const char *path;               // Into url
+    bool tls;
+    http_event_handle_cb event_handler;
+    void *user_data;
+    int timeout_ms;
+    bool keep_alive;
+    int fd;                         // -1 when not connected
+#ifdef HOST_TLS
+    SSL *ssl;                       // Over fd for https
+    SSL_SESSION *session;           // Resumed on the next connect (save_client_session)
+    bool save_session;
+#endif
+    int status_code;
+    char buf[SHIM_RX_BUF];          // Received but unconsumed bytes: buf[pos..len)
+    size_t pos;
+    size_t len;
+};
+
+static char server_override[SHIM_HOST_LEN];
+static uint16_t port_override;
+
+void esp_http_client_shim_set_server(const char *host, uint16_t port)
+{
+    snprintf(server_override, sizeof(server_override), "%s", host);
+    port_override = port;
+}
+
+#ifdef HOST_TLS
+static SSL_CTX *tls_ctx;
+static char ca_file[512];
+static bool session_resumption = true;
+static esp_http_client_shim_tls_stats_t tls_stats;
+static pthread_mutex_t tls_stats_lock = PTHREAD_MUTEX_INITIALIZER;   // The fetch task and mock_client both connect
+
+void esp_http_client_shim_set_ca_file(const char *path)
+{
+    snprintf(ca_file, sizeof(ca_file), "%s", path ? path : "");
+    if (tls_ctx) {
+        SSL_CTX_free(tls_ctx);
+        tls_ctx = NULL;
+    }
+}
+
+void esp_http_client_shim_set_session_resumption(bool enable)
+{
+    session_resumption = enable;
+}
+
+void esp_http_client_shim_get_tls_stats(esp_http_client_shim_tls_stats_t *stats)
+{
+    pthread_mutex_lock(&tls_stats_lock);
+    *stats = tls_stats;
+    pthread_mutex_unlock(&tls_stats_lock);
+}
+
+// Verifies the server against the CA file (or the system store) and its
+// host name, like esp-tls with the certificate bundle
+static SSL_CTX *get_tls_ctx(void)
+{
+    if (tls_ctx) {
+        return tls_ctx;
+    }
+    // A peer that resets the connection must not kill the process in SSL_write
+    signal(SIGPIPE, SIG_IGN);
+    tls_ctx = SSL_CTX_new(TLS_client_method());
+    if (!tls_ctx) {
+        return NULL;
+    }
+    SSL_CTX_set_verify(tls_ctx, SSL_VERIFY_PEER, NULL);
+    int ok = ca_file[0] ? SSL_CTX_load_verify_locations(tls_ctx, ca_file, NULL)
+                        : SSL_CTX_set_default_verify_paths(tls_ctx);
+    if (ok != 1) {
+        ESP_LOGE(TAG, "Cannot load CA certificates %s", ca_file);
+        SSL_CTX_free(tls_ctx);
+        tls_ctx = NULL;
+    }
+    return tls_ctx;
+}
+
+static esp_err_t tls_handshake(esp_http_client_handle_t client)
+{
+    SSL_CTX *ctx = get_tls_ctx();
+    if (!ctx || !(client->ssl = SSL_new(ctx))) {
+        return ESP_ERR_HTTP_CONNECT;
+    }
+    SSL_set_fd(client->ssl, client->fd);
+    SSL_set_tlsext_host_name(client->ssl, client->host);
+    SSL_set1_host(client->ssl, client->host);
+    if (client->session && session_resumption) {
+        SSL_set_session(client->ssl, client->session);
+    }
+    if (SSL_connect(client->ssl) != 1) {
+        ESP_LOGE(TAG, "TLS handshake with %s failed: %s", client->host,
+                 ERR_error_string(ERR_get_error(), NULL));
+        ERR_clear_error();
+        return ESP_ERR_HTTP_CONNECT;
+    }
+    pthread_mutex_lock(&tls_stats_lock);
+    if (SSL_session_reused(client->ssl)) {
+        tls_stats.resumed++;
+    } else {
+        tls_stats.full++;
+    }
+    pthread_mutex_unlock(&tls_stats_lock);
+    // As esp-tls does with save_client_session: keep the session of every
+    // new connection for the next one
+    if (client->save_session) {
+        SSL_SESSION *session = SSL_get1_session(client->ssl);
+        if (session) {
+            SSL_SESSION_free(client->session);
+            client->session = session;
+        }
+    }
+    return ESP_OK;
+}
+#endif
+
+static void emit(esp_http_client_handle_t client, esp_http_client_event_id_t id, void *data, int len)
+{
+    if (!client->event_handler) {
+        return;
+    }
+    esp_http_client_event_t evt = {
+        .event_id = id,
+        .client = client,
+        .data = data,
+        .data_len = len,
+        .user_data = client->user_data,
+    };
+    client->event_handler(&evt);
+}
+
+// Split "http://host[:port]/path?query"
+static esp_err_t parse_url(esp_http_client_handle_t client, const char *url)
+{
+    if (strlen(url) >= sizeof(client->url)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    strcpy(client->url, url);
+    const char *rest;
+    if (strncmp(url, "http://", 7) == 0) {
+        client->tls = false;
+        client->port = 80;
+        rest = client->url + 7;
+    } else if (strncmp(url, "https://", 8) == 0) {
+        client->tls = true;
+        client->port = 443;
+        rest = client->url + 8;
+    } else {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    const char *slash = strchr(rest, '/');
+    size_t host_len = slash ? (size_t)(slash - rest) : strlen(rest);
+    const char *colon = memchr(rest, ':', host_len);
+    if (colon) {
+        client->port = (uint16_t)atoi(colon + 1);
+        host_len = colon - rest;
+    }
+    if (host_len == 0 || host_len >= sizeof(client->host)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    memcpy(client->host, rest, host_len);
+    client->host[host_len] = '\0';
+    client->path = slash ? slash : "/";
+    return ESP_OK;
+}
+
+esp_http_client_handle_t esp_http_client_init(const esp_http_client_config_t *config)
+{
+    esp_http_client_handle_t client = calloc(1, sizeof(*client));
+    if (!client) {
+        return NULL;
+    }
+    client->fd = -1;
+    client->event_handler = config->event_handler;
+    client->user_data = config->user_data;
+    client->timeout_ms = config->timeout_ms > 0 ? config->timeout_ms : 5000;
+    client->keep_alive = config->keep_alive_enable;
+#ifdef HOST_TLS
+    client->save_session = config->save_client_session;
+#endif
+    if (parse_url(client, config->url) != ESP_OK) {
+        ESP_LOGE(TAG, "Invalid URL: %s", config->url);
+        free(client);
+        return NULL;
+    }
+    return client;
+}
+
+esp_err_t esp_http_client_set_url(esp_http_client_handle_t client, const char *url)
+{
+    // A different server drops the connection, as on the device
+    char host[SHIM_HOST_LEN];
+    uint16_t port = client->port;
+    strcpy(host, client->host);
+    esp_err_t err = parse_url(client, url);
+    if (err == ESP_OK && (strcmp(host, client->host) != 0 || port != client->port)) {
+        esp_http_client_close(client);
+    }
+    return err;
+}
+
+esp_err_t esp_http_client_set_user_data(esp_http_client_handle_t client, void *data)
+{
+    client->user_data = data;
+    return ESP_OK;
+}
+
+int esp_http_client_get_status_code(esp_http_client_handle_t client)
+{
+    return client->status_code;
+}
+
+esp_err_t esp_http_client_close(esp_http_client_handle_t client)
+{
+    if (client->fd >= 0) {
+#ifdef HOST_TLS
+        if (client->ssl) {
+            SSL_shutdown(client->ssl);
+            SSL_free(client->ssl);
+            client->ssl = NULL;
+        }
+#endif
+        close(client->fd);
+        client->fd = -1;
+        client->pos = client->len = 0;
+        emit(client, HTTP_EVENT_DISCONNECTED, NULL, 0);
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_http_client_cleanup(esp_http_client_handle_t client)
+{
+    if (client) {
+        esp_http_client_close(client);
+#ifdef HOST_TLS
+        SSL_SESSION_free(client->session);
+#endif
+        free(client);
+    }
+    return ESP_OK;
+}
+
+static esp_err_t shim_connect(esp_http_client_handle_t client)
+{
+    const char *host = server_override[0] ? server_override : client->host;
+    char port[8];
+    snprintf(port, sizeof(port), "%u", port_override ? port_override : client->port);
+
+    struct addrinfo hints = { .ai_family = AF_INET, .ai_socktype = SOCK_STREAM };
+    struct addrinfo *res = NULL;
+    if (getaddrinfo(host, port, &hints, &res) != 0 || !res) {
+        ESP_LOGE(TAG, "Cannot resolve %s", host);
+        return ESP_ERR_HTTP_CONNECT;
+    }
+    int fd = socket(res->ai_family, res->ai_socktype, res->ai_protocol);
+    if (fd < 0 || connect(fd, res->ai_addr, res->ai_addrlen) != 0) {
+        ESP_LOGE(TAG, "Cannot connect to %s:%s (errno %d)", host, port, errno);
+        if (fd >= 0) {
+            close(fd);
+        }
+        freeaddrinfo(res);
+        return ESP_ERR_HTTP_CONNECT;
+    }
+    freeaddrinfo(res);
+
+    struct timeval tv = {
+        .tv_sec = client->timeout_ms / 1000,
+        .tv_usec = (client->timeout_ms % 1000) * 1000,
+    };
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+    client->fd = fd;
+    client->pos = client->len = 0;
+#ifdef HOST_TLS
+    if (client->tls) {
+        esp_err_t err = tls_handshake(client);
+        if (err != ESP_OK) {
+            esp_http_client_close(client);
+            return err;
+        }
+    }
+#endif
+    emit(client, HTTP_EVENT_ON_CONNECTED, NULL, 0);
+    return ESP_OK;
+}
+
+// Receive more bytes after the unconsumed ones
+static esp_err_t fill(esp_http_client_handle_t client)
+{
+    if (client->pos > 0) {
+        memmove(client->buf, client->buf + client->pos, client->len - client->pos);
+        client->len -= client->pos;
+        client->pos = 0;
+    }
+    if (client->len == sizeof(client->buf)) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    ssize_t n;
+#ifdef HOST_TLS
+    if (client->ssl) {
+        n = SSL_read(client->ssl, client->buf + client->len, sizeof(client->buf) - client->len);
+        if (n <= 0) {
+            // A read timeout surfaces as a syscall error with errno EAGAIN
+            int ssl_err = SSL_get_error(client->ssl, (int)n);
+            bool timeout = ssl_err == SSL_ERROR_WANT_READ ||
+                           (ssl_err == SSL_ERROR_SYSCALL && (errno == EAGAIN || errno == EWOULDBLOCK));
+            ERR_clear_error();
+            return timeout ? ESP_ERR_HTTP_EAGAIN : ESP_ERR_HTTP_CONNECTION_CLOSED;
+        }
+        client->len += n;
+        return ESP_OK;
+    }
+#endif
+    do {
+        n = recv(client->fd, client->buf + client->len, sizeof(client->buf) - client->len, 0);
+    } while (n < 0 && errno == EINTR);
+    if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+        return ESP_ERR_HTTP_EAGAIN;
+    }
+    if (n <= 0) {
+        return ESP_ERR_HTTP_CONNECTION_CLOSED;
+    }
+    client->len += n;
+    return ESP_OK;
+}
+
+// Next CRLF-terminated line, NUL terminated in place (without the CRLF)
+static esp_err_t read_line(esp_http_client_handle_t client, char **line)
+{
+    for (;;) {
+        char *start = client->buf + client->pos;
+        char *end = memchr(start, '\n', client->len - client->pos);
+        if (end) {
+            *end = '\0';
+            if (end > start && end[-1] == '\r') {
+                end[-1] = '\0';
+            }
+            client->pos = end + 1 - client->buf;
+            *line = start;
+            return ESP_OK;
+        }
+        esp_err_t err = fill(client);
+        if (err != ESP_OK) {
+            return err;
+        }
+    }
+}
+
+// Deliver len body bytes (or everything until the server closes, len < 0)
+static esp_err_t read_body(esp_http_client_handle_t client, long long len)
+{
+    while (len != 0) {
+        if (client->pos == client->len) {
+            esp_err_t err = fill(client);
+            if (err == ESP_ERR_HTTP_CONNECTION_CLOSED && len < 0) {
+                return ESP_OK;
+            }
+            if (err != ESP_OK) {
+                return err;
+            }
+        }
+        size_t n = client->len - client->pos;
+        if (n > SHIM_EVENT_DATA) {
+            n = SHIM_EVENT_DATA;
+        }
+        if (len > 0 && (long long)n > len) {
+            n = (size_t)len;
+        }
+        emit(client, HTTP_EVENT_ON_DATA, client->buf + client->pos, (int)n);
+        client->pos += n;
+        if (len > 0) {
+            len -= n;
+        }
+    }
+    return ESP_OK;
+}
+
+static esp_err_t read_chunked(esp_http_client_handle_t client)
+{
+    char *line;
+    for (;;) {
+        esp_err_t err = read_line(client, &line);
+        if (err != ESP_OK) {
+            return err;
+        }
+        long long size = strtoll(line, NULL, 16);
+        if (size < 0) {
+            return ESP_FAIL;
+        }
+        if (size == 0) {
+            break;
+        }
+        if ((err = read_body(client, size)) != ESP_OK ||
+            (err = read_line(client, &line)) != ESP_OK) {
+            return err;
+        }
+    }
+    // Trailers up to the empty line
+    do {
+        esp_err_t err = read_line(client, &line);
+        if (err != ESP_OK) {
+            return err;
+        }
+    } while (line[0] != '\0');
+    return ESP_OK;
+}
+
+static ssize_t send_bytes(esp_http_client_handle_t client, const char *data, size_t len)
+{
+#ifdef HOST_TLS
+    if (client->ssl) {
+        int n = SSL_write(client->ssl, data, (int)len);
+        ERR_clear_error();
+        return n;
+    }
+#endif
+    return send(client->fd, data, len, MSG_NOSIGNAL);
+}
+
+static esp_err_t send_request(esp_http_client_handle_t client)
+{
+    char request[SHIM_URL_LEN + 256];
+    int len = snprintf(request, sizeof(request),
+                       "GET %s HTTP/1.1\r\n"
+                       "Host: %s\r\n"
+                       "User-Agent: ESP32 HTTP Client/1.0\r\n"
+                       "Connection: %s\r\n"
+                       "\r\n",
+                       client->path, client->host, client->keep_alive ? "keep-alive" : "close");
+    for (int sent = 0; sent < len;) {
+        ssize_t n = send_bytes(client, request + sent, len - sent);
+        if (n <= 0) {
+            return ESP_ERR_HTTP_WRITE_DATA;
+        }
+        sent += n;
+    }
+    emit(client, HTTP_EVENT_HEADERS_SENT, NULL, 0);
+    return ESP_OK;
+}
+
+esp_err_t esp_http_client_perform(esp_http_client_handle_t client)
+{
+#ifndef HOST_TLS
+    if (client->tls) {
+        ESP_LOGE(TAG, "https needs OpenSSL on the host: %s", client->url);
+        return ESP_ERR_HTTP_INVALID_TRANSPORT;
+    }
+#endif
+    client->status_code = 0;
+    esp_err_t err = ESP_OK;
+    if (client->fd < 0 && (err = shim_connect(client)) != ESP_OK) {
+        return err;
+    }
+    if ((err = send_request(client)) != ESP_OK) {
+        esp_http_client_close(client);
+        return err;
+    }
+
+    // Status line and headers
+    char *line;
+    if (read_line(client, &line) != ESP_OK || sscanf(line, "HTTP/%*d.%*d %d", &client->status_code) != 1) {
+        esp_http_client_close(client);
+        return ESP_ERR_HTTP_FETCH_HEADER;
+    }
+    long long content_length = -1;
+    bool chunked = false;
+    bool server_close = false;
+    for (;;) {
+        if (read_line(client, &line) != ESP_OK) {
+            esp_http_client_close(client);
+            return ESP_ERR_HTTP_FETCH_HEADER;
+        }
+        if (line[0] == '\0') {
+            break;
+        }
+        char *value = strchr(line, ':');
+        if (!value) {
+            continue;
+        }
+        *value++ = '\0';
+        value += strspn(value, " \t");
+        if (strcasecmp(line, "Content-Length") == 0) {
+            content_length = strtoll(value, NULL, 10);
+        } else if (strcasecmp(line, "Transfer-Encoding") == 0) {
+            chunked = strcasecmp(value, "chunked") == 0;
+        } else if (strcasecmp(line, "Connection") == 0) {
+            server_close = strcasecmp(value, "close") == 0;
+        }
+    }
+
+    if (chunked) {
+        err = read_chunked(client);
+    } else {
+        // Without a length the body ends when the server closes
+        err = read_body(client, content_length);
+        server_close |= content_length < 0;
+    }
+    if (err != ESP_OK) {
+        esp_http_client_close(client);
+        return err;
+    }
+
+    emit(client, HTTP_EVENT_ON_FINISH, NULL, 0);
+    if (server_close || !client->keep_alive) {
+        esp_http_client_close(client);
+    }
+    return ESP_OK;
+}
@@ -0,0 +1,6 @@
+#pragma once
+
+// Host build of esp_random.h
+#include <stdint.h>
+
+uint32_t esp_random(void);
@@ -0,0 +1,6 @@
+#pragma once
+
+// Host build of esp_rom_crc.h: same CRC-32 as the ROM
+#include <stdint.h>
+
+uint32_t esp_rom_crc32_le(uint32_t crc, const uint8_t *buf, uint32_t len);
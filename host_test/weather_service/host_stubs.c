@@ -0,0 +1,141 @@
+// Host stand-ins for the modules weather_service.c uses besides HTTP:
+// no SD card (everything stays in RAM), a synced clock, and a ui_state
+// that counts weather updates so the tests can wait for fetches.
+#include "host_stubs.h"
+#include "ui_state.h"
+#include "time_sync.h"
+#include "sd_database.h"
+#include "esp_random.h"
+#include "esp_rom_crc.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+
+static pthread_mutex_t update_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t update_cond = PTHREAD_COND_INITIALIZER;
+static uint32_t weather_updates;
+
+// --- ui_state: count weather updates ---
+
+esp_err_t ui_state_post_data_updated(const char *widget_id)
+{
+    if (widget_id && strcmp(widget_id, "weather") == 0) {
+        pthread_mutex_lock(&update_lock);
+        weather_updates++;
+        pthread_cond_broadcast(&update_cond);
+        pthread_mutex_unlock(&update_lock);
+    }
+    return ESP_OK;
+}
+
+uint32_t host_stubs_weather_updates(void)
+{
+    pthread_mutex_lock(&update_lock);
+    uint32_t count = weather_updates;
+    pthread_mutex_unlock(&update_lock);
+    return count;
+}
+
+bool host_stubs_wait_weather_update(uint32_t seen, uint32_t timeout_ms)
+{
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += timeout_ms / 1000;
+    deadline.tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+
+    pthread_mutex_lock(&update_lock);
+    int rc = 0;
+    while (weather_updates <= seen && rc != ETIMEDOUT) {
+        rc = pthread_cond_timedwait(&update_cond, &update_lock, &deadline);
+    }
+    bool updated = weather_updates > seen;
+    pthread_mutex_unlock(&update_lock);
+    return updated;
+}
+
+// --- time_sync: the host clock is always right ---
+
+bool time_sync_is_synced(void)
+{
+    return true;
+}
+
+esp_err_t time_sync_add_listener(time_sync_cb_t cb)
+{
+    (void)cb;
+    return ESP_OK;
+}
+
+// --- sd_database: no card, callers keep their state in RAM ---
+
+bool sd_db_is_ready(void)
+{
+    return false;
+}
+
+esp_err_t sd_db_set_string(const char *key, const char *value)
+{
+    return ESP_ERR_INVALID_STATE;
+}
+
+esp_err_t sd_db_get_string(const char *key, char *value, size_t max_len)
+{
+    return ESP_ERR_INVALID_STATE;
+}
+
+esp_err_t sd_db_delete(const char *key)
+{
+    return ESP_ERR_INVALID_STATE;
+}
+
+esp_err_t sd_db_set_blob(const char *key, const void *data, size_t len)
+{
+    return ESP_ERR_INVALID_STATE;
+}
+
+esp_err_t sd_db_get_blob(const char *key, void *data, size_t *len)
+{
+    return ESP_ERR_INVALID_STATE;
+}
+
+esp_err_t sd_db_delete_blob(const char *key)
+{
+    return ESP_ERR_INVALID_STATE;
+}
+
+esp_err_t sd_db_save(void)
+{
+    return ESP_ERR_INVALID_STATE;
+}
+
+// --- ESP-IDF ---
+
+uint32_t esp_random(void)
+{
+    return (uint32_t)random();
+}
+
+uint32_t esp_rom_crc32_le(uint32_t crc, const uint8_t *buf, uint32_t len)
+{
+    crc = ~crc;
+    for (uint32_t i = 0; i < len; i++) {
+        crc ^= buf[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (0xEDB88320u & -(crc & 1));
+        }
+    }
+    return ~crc;
+}
+
+// Only referenced for https URLs; the host client verifies with OpenSSL
+esp_err_t esp_crt_bundle_attach(void *conf)
+{
+    (void)conf;
+    return ESP_OK;
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @brief Number of "weather" updates posted to ui_state so far
+ *
+ * The fetch task posts one after every fetch it finishes, failed or not.
+ */
+uint32_t host_stubs_weather_updates(void);
+
+/**
+ * @brief Wait for an update after the first `seen` ones
+ * @return true if one was posted within timeout_ms
+ */
+bool host_stubs_wait_weather_update(uint32_t seen, uint32_t timeout_ms);
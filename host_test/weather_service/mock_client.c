@@ -0,0 +1,98 @@
+// Control requests to mock_open_meteo.py, over the same host HTTP client
+// the weather service uses
+#include "mock_client.h"
+#include "esp_http_client.h"
+#include "esp_log.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *TAG = "mock_client";
+
+static bool mock_tls;
+
+typedef struct {
+    char *data;
+    size_t len;
+} mock_body_t;
+
+static esp_err_t body_event_handler(esp_http_client_event_t *evt)
+{
+    mock_body_t *body = evt->user_data;
+    if (evt->event_id == HTTP_EVENT_ON_DATA && body) {
+        char *grown = realloc(body->data, body->len + evt->data_len + 1);
+        if (!grown) {
+            return ESP_ERR_NO_MEM;
+        }
+        memcpy(grown + body->len, evt->data, evt->data_len);
+        body->data = grown;
+        body->len += evt->data_len;
+        body->data[body->len] = '\0';
+    }
+    return ESP_OK;
+}
+
+// GET a mock control path; the body is returned in *out if not NULL
+static esp_err_t mock_get(const char *path, char **out)
+{
+    char url[512];
+    // The mock's generated certificate names localhost
+    snprintf(url, sizeof(url), mock_tls ? "https://localhost%s" : "http://mock%s", path);
+    mock_body_t body = { 0 };
+    esp_http_client_config_t config = {
+        .url = url,
+        .event_handler = body_event_handler,
+        .user_data = &body,
+        .timeout_ms = 5000,
+    };
+    esp_http_client_handle_t client = esp_http_client_init(&config);
+    if (!client) {
+        return ESP_FAIL;
+    }
+    esp_err_t err = esp_http_client_perform(client);
+    int status = esp_http_client_get_status_code(client);
+    esp_http_client_cleanup(client);
+    if (err == ESP_OK && status != 200) {
+        err = ESP_FAIL;
+    }
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "GET %s failed (%d, HTTP %d)", path, err, status);
+        free(body.data);
+        return err;
+    }
+    if (out) {
+        *out = body.data ? body.data : strdup("");
+    } else {
+        free(body.data);
+    }
+    return ESP_OK;
+}
+
+esp_err_t mock_client_init(const char *target)
+{
+    char host[128];
+    unsigned port = 0;
+    mock_tls = strncmp(target ? target : "", "https://", 8) == 0;
+    if (mock_tls) {
+        target += 8;
+    }
+    if (!target || sscanf(target, "%127[^:]:%u", host, &port) != 2 || port == 0 || port > 65535) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    esp_http_client_shim_set_server(host, (uint16_t)port);
+    return mock_get("/mock/config", NULL);
+}
+
+esp_err_t mock_client_configure(const char *query)
+{
+    char path[256];
+    snprintf(path, sizeof(path), "/mock/config?%s", query);
+    return mock_get(path, NULL);
+}
+
+char *mock_client_requests(bool clear)
+{
+    char *body = NULL;
+    mock_get(clear ? "/mock/requests?clear=1" : "/mock/requests", &body);
+    return body;
+}
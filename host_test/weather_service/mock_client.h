@@ -0,0 +1,23 @@
+#pragma once
+
+#include "esp_err.h"
+#include <stdbool.h>
+
+/**
+ * @brief Send all HTTP requests to the mock server at "host:port"
+ * ("https://host:port" for a mock started with --tls)
+ */
+esp_err_t mock_client_init(const char *target);
+
+/**
+ * @brief Change the mock's fault injection
+ * @param query Options as in mock_open_meteo.py, e.g. "reset=1&latency_ms=200"
+ */
+esp_err_t mock_client_configure(const char *query);
+
+/**
+ * @brief API requests seen by the mock (JSON array of paths)
+ * @param clear Forget them afterwards
+ * @return Response body to free(), NULL on error
+ */
+char *mock_client_requests(bool clear);
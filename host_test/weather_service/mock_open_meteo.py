@@ -0,0 +1,303 @@
+#!/usr/bin/env python3
+"""Local stand-in for the Open-Meteo geocoding and forecast APIs.
+
+Replays the recorded responses in host_test/fixtures/open_meteo and can
+inject latency, error statuses, dropped connections, truncated bodies and
+oversized payloads. Point the firmware at it with
+CONFIG_WEATHER_GEOCODING_URL=http://<host>:<port>/v1/search and
+CONFIG_WEATHER_FORECAST_URL=http://<host>:<port>/v1/forecast.
+
+With --tls it serves https instead, with a throwaway self-signed
+certificate for the Open-Meteo host names, localhost and 127.0.0.1
+(written to a temporary directory and printed as "certificate <path>"),
+or the one given with --cert/--key.
+
+Faults are set on the command line or at run time with
+GET /mock/config?<option>=<value>&... (reset=1 restores the command line
+settings); GET /mock/requests lists the API requests seen since the last
+clear=1.
+"""
+import argparse
+import json
+import os
+import random
+import shutil
+import signal
+import socket
+import ssl
+import subprocess
+import sys
+import tempfile
+import threading
+import time
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+from urllib.parse import parse_qs, urlsplit
+
+FIXTURE_DIR = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "fixtures", "open_meteo")
+
+# Geocoding queries with a recorded answer; other 5-digit zip codes get the
+# 90210 answer, anything else no results
+GEOCODING = {
+    "90210": "geocoding_90210.json",
+    "Zürich": "geocoding_zurich.json",
+    "zurich": "geocoding_zurich.json",
+}
+
+# Fault options: name -> (type, default)
+OPTIONS = {
+    "latency_ms": (int, 0),         # Delay before each API response
+    "status": (int, 500),           # Status of injected errors
+    "errors": (int, 0),             # Answer the next N API requests with status
+    "error_rate": (float, 0.0),     # Or a random share of them
+    "drop": (int, 0),               # Close the connection on the next N requests
+    "truncate": (int, 0),           # Send half the body of the next N responses, then close
+    "oversize": (int, 0),           # Pad each response with this many bytes, before the data
+    "chunk": (int, 0),              # Send bodies chunked in pieces this big (0 = Content-Length)
+    "close": (int, 0),              # Close the connection after every response (no keep-alive)
+}
+
+
+def load(name):
+    with open(os.path.join(FIXTURE_DIR, name), "rb") as f:
+        return json.loads(f.read().decode("utf-8"))
+
+
+class Mock:
+    def __init__(self, defaults, seed):
+        self.lock = threading.Lock()
+        self.defaults = dict(defaults)
+        self.config = dict(defaults)
+        self.requests = []
+        self.random = random.Random(seed)
+        self.series = load("forecast_series.json")
+        self.multi = load("forecast_multi.json")
+        self.geocoding = {key: load(name) for key, name in GEOCODING.items()}
+        self.geocoding_zip = load("geocoding_90210.json")
+        self.geocoding_empty = load("geocoding_empty.json")
+
+    def set(self, query):
+        with self.lock:
+            if query.get("reset", ["0"])[0] == "1":
+                self.config = dict(self.defaults)
+            for key, values in query.items():
+                if key in OPTIONS:
+                    self.config[key] = OPTIONS[key][0](values[0])
+            return dict(self.config)
+
+    def take(self, key):
+        """Consume one of a counted fault (errors, drop, truncate)"""
+        with self.lock:
+            if self.config[key] > 0:
+                self.config[key] -= 1
+                return True
+            return False
+
+    def inject_error(self):
+        if self.take("errors"):
+            return True
+        with self.lock:
+            return self.config["error_rate"] > 0 and self.random.random() < self.config["error_rate"]
+
+    def geocode(self, query):
+        name = query.get("name", [""])[0]
+        if name in self.geocoding:
+            return self.geocoding[name]
+        if len(name) == 5 and name.isdigit():
+            return self.geocoding_zip
+        return self.geocoding_empty
+
+    def forecast(self, query):
+        latitudes = query.get("latitude", [""])[0].split(",")
+        series = "hourly" in query or "daily" in query
+        locations = []
+        for i in range(len(latitudes)):
+            if i == 0 and series:
+                item = dict(self.series)
+            else:
+                item = dict(self.multi[i % len(self.multi)])
+                for key in ("hourly", "hourly_units", "daily", "daily_units"):
+                    item.pop(key, None)
+                if len(latitudes) == 1:
+                    item.pop("location_id", None)
+            if not series:
+                for key in ("hourly", "hourly_units", "daily", "daily_units"):
+                    item.pop(key, None)
+            locations.append(item)
+        # One location is an object, several an array in request order
+        return locations[0] if len(locations) == 1 else locations
+
+
+def padded(document, size):
+    """Serialize with size bytes of unknown fields ahead of the real data"""
+    if isinstance(document, list) and size > 0:
+        # Several locations: pad each object
+        items = [padded(item, size // len(document)) for item in document]
+        return b"[" + b",".join(items) + b"]"
+    body = json.dumps(document, ensure_ascii=False, separators=(",", ":")).encode("utf-8")
+    if size <= 0:
+        return body
+    # Numbers and strings longer than the tokenizer keeps, in every element
+    filler = []
+    used = 0
+    while used < size:
+        item = [used, "x" * 200, {"n": used / 7.0}] if len(filler) % 2 else used
+        filler.append(item)
+        used += len(json.dumps(item, separators=(",", ":"))) + 1
+    pad = json.dumps(filler, separators=(",", ":")).encode("utf-8")
+    return b'{"padding":' + pad + b"," + body[1:]
+
+
+class Server(ThreadingHTTPServer):
+    daemon_threads = True
+
+    def handle_error(self, request, client_address):
+        # Clients that time out on an injected delay hang up mid-response
+        if isinstance(sys.exc_info()[1], ConnectionError):
+            return
+        super().handle_error(request, client_address)
+
+
+class Handler(BaseHTTPRequestHandler):
+    protocol_version = "HTTP/1.1"   # Keep-alive, as the device uses
+    server_version = "mock-open-meteo"
+
+    def setup(self):
+        # Handshake here, in the connection's thread, not in accept()
+        if isinstance(self.request, ssl.SSLSocket):
+            self.request.do_handshake()
+        super().setup()
+        # Headers and body are separate writes; don't let Nagle hold the body
+        self.connection.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+
+    def log_message(self, format, *args):
+        if self.server.verbose:
+            sys.stderr.write("mock: " + (format % args) + "\n")
+
+    def do_GET(self):
+        mock = self.server.mock
+        url = urlsplit(self.path)
+        query = parse_qs(url.query)
+
+        if url.path == "/mock/config":
+            self.send_json(200, json.dumps(mock.set(query)).encode())
+            return
+        if url.path == "/mock/requests":
+            with mock.lock:
+                body = json.dumps(mock.requests).encode()
+                if query.get("clear", ["0"])[0] == "1":
+                    mock.requests = []
+            self.send_json(200, body)
+            return
+
+        if url.path.endswith("/search"):
+            document = mock.geocode(query)
+        elif url.path.endswith("/forecast"):
+            document = mock.forecast(query)
+        else:
+            self.send_json(404, b'{"error":true,"reason":"Not found"}')
+            return
+        with mock.lock:
+            mock.requests.append(self.path)
+            latency_ms = mock.config["latency_ms"]
+            oversize = mock.config["oversize"]
+            chunk = mock.config["chunk"]
+            status = mock.config["status"]
+            self.close_after = mock.config["close"] > 0
+
+        if latency_ms > 0:
+            time.sleep(latency_ms / 1000.0)
+        if mock.take("drop"):
+            self.close_connection = True
+            return
+        if mock.inject_error():
+            body = json.dumps({"error": True, "reason": "Injected HTTP %d" % status}).encode()
+            self.send_json(status, body)
+            return
+        self.send_json(200, padded(document, oversize), chunk, mock.take("truncate"))
+
+    def send_json(self, status, body, chunk=0, truncate=False):
+        self.send_response(status)
+        self.send_header("Content-Type", "application/json; charset=utf-8")
+        if getattr(self, "close_after", False):
+            self.send_header("Connection", "close")
+        if chunk > 0 and not truncate:
+            self.send_header("Transfer-Encoding", "chunked")
+            self.end_headers()
+            for pos in range(0, len(body), chunk):
+                piece = body[pos:pos + chunk]
+                self.wfile.write(b"%x\r\n%s\r\n" % (len(piece), piece))
+            self.wfile.write(b"0\r\n\r\n")
+            return
+        self.send_header("Content-Length", str(len(body)))
+        self.end_headers()
+        if truncate:
+            self.wfile.write(body[:len(body) // 2])
+            self.wfile.flush()
+            self.close_connection = True
+            return
+        self.wfile.write(body)
+
+
+def make_certificate(directory):
+    """Self-signed P-256 certificate valid for a day, as (cert, key) paths"""
+    cert = os.path.join(directory, "cert.pem")
+    key = os.path.join(directory, "key.pem")
+    names = "DNS:api.open-meteo.com,DNS:geocoding-api.open-meteo.com,DNS:localhost,IP:127.0.0.1"
+    subprocess.run(["openssl", "req", "-x509", "-newkey", "ec", "-pkeyopt", "ec_paramgen_curve:prime256v1",
+                    "-nodes", "-days", "1", "-subj", "/CN=mock-open-meteo", "-addext", "subjectAltName=" + names,
+                    "-keyout", key, "-out", cert],
+                   check=True, stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+    return cert, key
+
+
+def tls_context(cert, key):
+    context = ssl.SSLContext(ssl.PROTOCOL_TLS_SERVER)
+    # The device's mbedTLS negotiates TLS 1.2 and resumes with session tickets
+    context.maximum_version = ssl.TLSVersion.TLSv1_2
+    context.load_cert_chain(cert, key)
+    return context
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--bind", default="127.0.0.1", help="address to listen on (0.0.0.0 for a device)")
+    parser.add_argument("--port", type=int, default=8081, help="port (0 = any free port)")
+    parser.add_argument("--seed", type=int, default=1, help="seed for --error-rate")
+    parser.add_argument("--verbose", action="store_true", help="log every request")
+    parser.add_argument("--tls", action="store_true", help="serve https")
+    parser.add_argument("--cert", help="certificate for --tls (default: a generated one)")
+    parser.add_argument("--key", help="private key of --cert")
+    for name, (kind, default) in OPTIONS.items():
+        parser.add_argument("--" + name.replace("_", "-"), type=kind, default=default, dest=name)
+    args = parser.parse_args()
+
+    server = Server((args.bind, args.port), Handler)
+    server.verbose = args.verbose
+    server.mock = Mock({name: getattr(args, name) for name in OPTIONS}, args.seed)
+
+    temp_dir = None
+    if args.tls:
+        cert, key = args.cert, args.key
+        if not cert:
+            temp_dir = tempfile.mkdtemp(prefix="mock_open_meteo_")
+            cert, key = make_certificate(temp_dir)
+        context = tls_context(cert, key or cert)
+        server.socket = context.wrap_socket(server.socket, server_side=True, do_handshake_on_connect=False)
+        print("certificate %s" % os.path.abspath(cert), flush=True)
+
+    # run_with_mock.py stops the mock with SIGTERM; exit through the cleanup
+    signal.signal(signal.SIGTERM, lambda signum, frame: sys.exit(0))
+    # run_with_mock.py waits for this line
+    print("listening on port %d" % server.server_address[1], flush=True)
+    try:
+        server.serve_forever()
+    except KeyboardInterrupt:
+        pass
+    finally:
+        if temp_dir:
+            shutil.rmtree(temp_dir, ignore_errors=True)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
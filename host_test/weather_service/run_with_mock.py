@@ -0,0 +1,49 @@
+#!/usr/bin/env python3
+"""Start mock_open_meteo.py on a free port, run a command with
+--mock 127.0.0.1:<port> appended and return its exit code. With --tls in
+--mock-args it appends --mock https://127.0.0.1:<port> --mock-ca <cert>."""
+import argparse
+import os
+import signal
+import subprocess
+import sys
+
+MOCK = os.path.join(os.path.dirname(os.path.abspath(__file__)), "mock_open_meteo.py")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("--mock-args", default="", help="extra mock_open_meteo.py options")
+    parser.add_argument("command", nargs=argparse.REMAINDER, help="command to run (after --)")
+    args = parser.parse_args()
+    command = args.command[1:] if args.command[:1] == ["--"] else args.command
+    if not command:
+        parser.error("no command")
+
+    mock = subprocess.Popen([sys.executable, MOCK, "--port", "0"] + args.mock_args.split(),
+                            stdout=subprocess.PIPE, text=True)
+    try:
+        port = None
+        cert = None
+        for line in mock.stdout:
+            if line.startswith("certificate "):
+                cert = line.split(" ", 1)[1].strip()
+            elif line.startswith("listening on port "):
+                port = int(line.split()[-1])
+                break
+        if port is None:
+            print("mock_open_meteo.py did not start", file=sys.stderr)
+            return 2
+        if cert:
+            return subprocess.call(command + ["--mock", "https://127.0.0.1:%d" % port, "--mock-ca", cert])
+        return subprocess.call(command + ["--mock", "127.0.0.1:%d" % port])
+    finally:
+        mock.send_signal(signal.SIGTERM)
+        try:
+            mock.wait(timeout=5)
+        except subprocess.TimeoutExpired:
+            mock.kill()
+
+
+if __name__ == "__main__":
+    sys.exit(main())
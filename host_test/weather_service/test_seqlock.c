@@ -0,0 +1,239 @@
+// seqlock.c under one writer and several readers: every copy a reader gets
+// must be one whole snapshot. Two rounds:
+//  - the cached weather (cache_publish / cache_read and
+//    weather_service_get_cached); weather_service.c is included so its
+//    static cache functions can be called directly, no fetch task is started
+//  - a block several cache lines long, where an unsynchronized copy tears
+//    readily, to show the test can see tearing at all
+#include "weather_service.c"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+
+#define CACHE_LINE      64
+#define BLOCK_WORDS     1024        // 4 KB, 64 cache lines
+
+static int failures = 0;
+
+#define CHECK(cond, ...) do {                                   \
+        if (!(cond)) {                                          \
+            failures++;                                         \
+            printf("FAIL %s:%d: ", __FILE__, __LINE__);         \
+            printf(__VA_ARGS__);                                \
+            printf("\n");                                       \
+        }                                                       \
+    } while (0)
+
+typedef enum {
+    READ_GET_CACHED,            // weather_service_get_cached (slot 0)
+    READ_CACHE,                 // cache_read(test_slot)
+    READ_CACHE_UNSYNCHRONIZED,  // Plain copy of test_slot (control)
+    READ_BLOCK,                 // seqlock_read of the block
+    READ_BLOCK_UNSYNCHRONIZED,  // Plain copy of the block (control)
+} read_kind_t;
+
+static const char *kind_names[] = {
+    "get_cached", "cache_read", "cache unlocked", "block", "block unlocked",
+};
+
+typedef struct {
+    read_kind_t kind;
+    uint64_t copies;
+    uint64_t torn;
+} reader_t;
+
+// Every field or word is derived from n, so a mix of two snapshots is detectable
+typedef struct {
+    uint32_t n;
+    uint32_t words[BLOCK_WORDS - 1];
+} block_t;
+
+static atomic_bool stop;
+static uint32_t base_time;
+static int test_slot;
+static block_t block;
+static seqlock_t block_lock;
+
+static void make_snapshot(uint32_t n, weather_data_t *data)
+{
+    memset(data, 0, sizeof(*data));
+    data->weather_code = (int)n;
+    data->temperature = (float)(n & 0x7FFFFF) * 0.5f;
+    data->humidity = (float)(n % 101);
+    data->wind_speed = (float)(n % 997);
+    snprintf(data->condition, sizeof(data->condition), "%010u/%010u/%08x", n, ~n, n * 2654435761u);
+    data->valid = true;
+    data->timestamp = base_time - (n % 1000);   // Never in the future, so never expired
+}
+
+static bool snapshot_consistent(const weather_data_t *data)
+{
+    weather_data_t expected;
+    make_snapshot((uint32_t)data->weather_code, &expected);
+    return data->valid && data->temperature == expected.temperature &&
+           data->humidity == expected.humidity && data->wind_speed == expected.wind_speed &&
+           data->timestamp == expected.timestamp && strcmp(data->condition, expected.condition) == 0;
+}
+
+static void make_block(uint32_t n, block_t *out)
+{
+    out->n = n;
+    for (int i = 0; i < BLOCK_WORDS - 1; i++) {
+        out->words[i] = n ^ ((uint32_t)i * 2654435761u);
+    }
+}
+
+static bool block_consistent(const block_t *copy)
+{
+    for (int i = 0; i < BLOCK_WORDS - 1; i++) {
+        if (copy->words[i] != (copy->n ^ ((uint32_t)i * 2654435761u))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void *reader_thread(void *arg)
+{
+    reader_t *reader = arg;
+    weather_data_t data;
+    static _Thread_local block_t copy;
+    while (!atomic_load_explicit(&stop, memory_order_relaxed)) {
+        bool ok;
+        switch (reader->kind) {
+        case READ_GET_CACHED:
+            // Always published and never expired, so it must succeed
+            ok = weather_service_get_cached(&data) == ESP_OK && snapshot_consistent(&data);
+            break;
+        case READ_CACHE:
+            cache_read(test_slot, &data);
+            ok = snapshot_consistent(&data);
+            break;
+        case READ_CACHE_UNSYNCHRONIZED:
+            memcpy(&data, (const void *)&cached_weather[test_slot].data, sizeof(data));
+            ok = snapshot_consistent(&data);
+            break;
+        case READ_BLOCK:
+            seqlock_read(&block_lock, &copy, &block, sizeof(block));
+            ok = block_consistent(&copy);
+            break;
+        default:
+            memcpy(&copy, (const void *)&block, sizeof(block));
+            ok = block_consistent(&copy);
+            break;
+        }
+        reader->copies++;
+        if (!ok) {
+            reader->torn++;
+        }
+    }
+    return NULL;
+}
+
+// Run the readers while write(n) publishes n = 1, 2, ... for duration_ms
+static void run(const char *title, reader_t *readers, int count, void (*write)(uint32_t), int duration_ms)
+{
+    pthread_t threads[8];
+    atomic_store(&stop, false);
+    for (int i = 0; i < count; i++) {
+        pthread_create(&threads[i], NULL, reader_thread, &readers[i]);
+    }
+
+    uint64_t publishes = 0;
+    int64_t end_us = esp_timer_get_time() + (int64_t)duration_ms * 1000;
+    for (uint32_t n = 1; esp_timer_get_time() < end_us; n++) {
+        write(n);
+        publishes++;
+    }
+    atomic_store(&stop, true);
+    for (int i = 0; i < count; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    printf("%s: %llu publishes\n", title, (unsigned long long)publishes);
+    for (int i = 0; i < count; i++) {
+        printf("  %-15s %10llu copies %8llu torn\n", kind_names[readers[i].kind],
+               (unsigned long long)readers[i].copies, (unsigned long long)readers[i].torn);
+    }
+}
+
+static void write_cache(uint32_t n)
+{
+    weather_data_t data;
+    make_snapshot(n, &data);
+    cache_publish(0, &data);
+    cache_publish(test_slot, &data);
+}
+
+static void write_block(uint32_t n)
+{
+    static block_t next;
+    make_block(n, &next);
+    seqlock_write(&block_lock, &block, &next, sizeof(block));
+}
+
+static void check_readers(const reader_t *readers, int count)
+{
+    for (int i = 0; i < count; i++) {
+        const char *name = kind_names[readers[i].kind];
+        CHECK(readers[i].copies > 0, "%s reader made no copies", name);
+        if (readers[i].kind == READ_CACHE_UNSYNCHRONIZED) {
+            continue;   // Too small to tear reliably; only reported
+        }
+        if (readers[i].kind == READ_BLOCK_UNSYNCHRONIZED) {
+            CHECK(readers[i].torn > 0, "%s reader saw no torn copies, so the test can't detect one", name);
+        } else {
+            CHECK(readers[i].torn == 0, "%s reader saw %llu torn copies", name,
+                  (unsigned long long)readers[i].torn);
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    int duration_ms = argc > 2 && strcmp(argv[1], "--duration-ms") == 0 ? atoi(argv[2]) : 1000;
+    esp_log_level_set("*", ESP_LOG_NONE);
+    base_time = (uint32_t)time(NULL);
+
+    // weather_data_t is smaller than a cache line; use a slot whose copy
+    // spans two lines (with four slots one always does)
+    test_slot = -1;
+    for (int i = 0; i < WEATHER_MAX_LOCATIONS && test_slot < 0; i++) {
+        uintptr_t start = (uintptr_t)&cached_weather[i].data;
+        if (start / CACHE_LINE != (start + sizeof(weather_data_t) - 1) / CACHE_LINE) {
+            test_slot = i;
+        }
+    }
+    CHECK(test_slot >= 0, "no cache slot spans two cache lines");
+    if (test_slot < 0) {
+        return 1;
+    }
+    write_cache(0);
+    printf("cache slot %d at offset %zu of its cache line\n", test_slot,
+           (size_t)((uintptr_t)&cached_weather[test_slot].data % CACHE_LINE));
+
+    // One writer; callers normally serialize through weather_data_mutex
+    reader_t cache_readers[] = {
+        { .kind = READ_GET_CACHED }, { .kind = READ_CACHE }, { .kind = READ_CACHE },
+        { .kind = READ_CACHE_UNSYNCHRONIZED },
+    };
+    int count = sizeof(cache_readers) / sizeof(cache_readers[0]);
+    run("weather cache", cache_readers, count, write_cache, duration_ms / 2);
+    check_readers(cache_readers, count);
+
+    make_block(0, &block);
+    reader_t block_readers[] = {
+        { .kind = READ_BLOCK }, { .kind = READ_BLOCK }, { .kind = READ_BLOCK },
+        { .kind = READ_BLOCK_UNSYNCHRONIZED },
+    };
+    count = sizeof(block_readers) / sizeof(block_readers[0]);
+    run("4 KB block", block_readers, count, write_block, duration_ms / 2);
+    check_readers(block_readers, count);
+
+    if (failures) {
+        printf("%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("seqlock: all checks passed\n");
+    return 0;
+}
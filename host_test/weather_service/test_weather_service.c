@@ -0,0 +1,291 @@
+// weather_service.c end to end against mock_open_meteo.py: the real fetch
+// task, scheduler, geocode cache, HTTP streaming and JSON parsing, with
+// latency, errors, dropped connections and oversized payloads injected
+// by the mock. Run through run_with_mock.py, which passes --mock host:port
+// (and --mock-ca for a mock started with --tls).
+#include "weather_service.h"
+#include "weather_forecast.h"
+#include "host_stubs.h"
+#include "mock_client.h"
+#include "esp_http_client.h"
+#include "esp_log.h"
+#include "cJSON.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define FETCH_TIMEOUT_MS    15000
+#define SERIES_START        1791388800  // hourly.time[0] of forecast_series.json
+#define HTTP_TIMEOUT_MS     2000        // CONFIG_WEATHER_HTTP_TIMEOUT_MS of the host build
+
+static int failures = 0;
+
+#define CHECK(cond, ...) do {                                   \
+        if (!(cond)) {                                          \
+            failures++;                                         \
+            printf("FAIL %s:%d: ", __FILE__, __LINE__);         \
+            printf(__VA_ARGS__);                                \
+            printf("\n");                                       \
+        }                                                       \
+    } while (0)
+
+// Change the primary location and wait for the fetch it starts
+static bool fetch_zip(const char *zip)
+{
+    uint32_t seen = host_stubs_weather_updates();
+    weather_service_set_zip_code(zip);
+    return host_stubs_wait_weather_update(seen, FETCH_TIMEOUT_MS);
+}
+
+static bool set_location(const char *name, const char *query)
+{
+    uint32_t seen = host_stubs_weather_updates();
+    if (weather_service_set_location(name, query) != ESP_OK) {
+        return false;
+    }
+    return host_stubs_wait_weather_update(seen, FETCH_TIMEOUT_MS);
+}
+
+static bool remove_location(const char *name)
+{
+    uint32_t seen = host_stubs_weather_updates();
+    if (weather_service_remove_location(name) != ESP_OK) {
+        return false;
+    }
+    return host_stubs_wait_weather_update(seen, FETCH_TIMEOUT_MS);
+}
+
+static bool requested(const char *requests, const char *part)
+{
+    return requests && strstr(requests, part) != NULL;
+}
+
+// A number from weather_service_get_http_stats(), -1 if missing
+static double http_stat(const char *conn, const char *field)
+{
+    cJSON *stats = weather_service_get_http_stats();
+    cJSON *item = cJSON_GetObjectItem(cJSON_GetObjectItem(stats, conn), field);
+    double value = cJSON_IsNumber(item) ? item->valuedouble : -1;
+    cJSON_Delete(stats);
+    return value;
+}
+
+static void check_primary(const char *scenario)
+{
+    weather_data_t data;
+    CHECK(weather_service_get_cached(&data) == ESP_OK, "%s: no cached weather", scenario);
+    CHECK(data.valid && fabsf(data.temperature - 21.3f) < 0.01f, "%s: temperature %.2f", scenario, data.temperature);
+    CHECK(data.humidity == 61 && fabsf(data.wind_speed - 3.4f) < 0.01f && data.weather_code == 2,
+          "%s: humidity %.0f wind %.2f code %d", scenario, data.humidity, data.wind_speed, data.weather_code);
+    CHECK(strcmp(data.condition, "Cloudy") == 0, "%s: condition %s", scenario, data.condition);
+    CHECK(!weather_service_last_fetch_failed(), "%s: fetch reported failed", scenario);
+}
+
+static void check_series(const char *scenario, const char *zip)
+{
+    weather_forecast_hour_t hour = { 0 };
+    weather_forecast_day_t day = { 0 };
+    CHECK(weather_forecast_matches(zip), "%s: no forecast for %s", scenario, zip);
+    CHECK(weather_forecast_get_hour(SERIES_START + 3600, &hour) == ESP_OK && hour.temp_x10 == 171,
+          "%s: hour 1 temperature %d", scenario, hour.temp_x10);
+    CHECK(weather_forecast_get_day(SERIES_START, &day) == ESP_OK && day.temp_max_x10 == 273,
+          "%s: day 0 max %d", scenario, day.temp_max_x10);
+}
+
+static void test_fetch(void)
+{
+    mock_client_configure("reset=1");
+    free(mock_client_requests(true));
+
+    CHECK(fetch_zip("90210"), "fetch: no update");
+    check_primary("fetch");
+    check_series("fetch", "90210");
+
+    char *requests = mock_client_requests(true);
+    CHECK(requested(requests, "/v1/search?name=90210&"), "fetch: no geocoding request in %s", requests);
+    CHECK(requested(requests, "/v1/forecast?latitude=34.0736&longitude=-118.4004&"),
+          "fetch: no forecast request in %s", requests);
+    CHECK(requested(requests, "&hourly="), "fetch: series not requested in %s", requests);
+    free(requests);
+}
+
+// Named locations share the forecast request; queries are percent-encoded
+static void test_locations(void)
+{
+    free(mock_client_requests(true));
+    CHECK(set_location("zurich", "Z\xc3\xbcrich"), "locations: no update");
+
+    char name[WEATHER_LOCATION_NAME_LEN];
+    weather_data_t data;
+    CHECK(weather_service_get_location(1, name, NULL, 0, &data) == ESP_OK && strcmp(name, "zurich") == 0,
+          "locations: zurich not in slot 1");
+    CHECK(data.valid && fabsf(data.temperature - 14.8f) < 0.01f, "locations: zurich temperature %.2f", data.temperature);
+    check_primary("locations");
+
+    char *requests = mock_client_requests(true);
+    CHECK(requested(requests, "/v1/search?name=Z%C3%BCrich&"), "locations: %s", requests);
+    CHECK(requested(requests, "latitude=34.0736,47.3667&"), "locations: one request for both in %s", requests);
+    free(requests);
+
+    // Reserved characters must not leak into the query string. The mock
+    // has no result for it, which fails only that location.
+    CHECK(set_location("odd", "a&b=c d+e/f"), "locations: no update for odd");
+    requests = mock_client_requests(true);
+    CHECK(requested(requests, "/v1/search?name=a%26b%3Dc%20d%2Be%2Ff&"), "locations: %s", requests);
+    free(requests);
+    CHECK(weather_service_get_location(2, name, NULL, 0, &data) == ESP_OK && !data.valid,
+          "locations: odd has data");
+    check_primary("locations with a failing one");
+
+    CHECK(remove_location("odd") && remove_location("zurich"), "locations: no update after remove");
+}
+
+static void test_http_errors(void)
+{
+    // Geocoding fails: nothing to fetch for a new zip code
+    mock_client_configure("reset=1&errors=1&status=503");
+    CHECK(fetch_zip("90211"), "errors: no update");
+    weather_data_t data;
+    CHECK(weather_service_last_fetch_failed(), "errors: geocoding 503 not reported");
+    CHECK(weather_service_get_cached(&data) != ESP_OK, "errors: data for an unresolved location");
+
+    // Forecast fails after a cached geocode
+    mock_client_configure("reset=1");
+    CHECK(fetch_zip("90210"), "errors: no update");
+    check_primary("errors recovered");
+    mock_client_configure("reset=1&errors=1&status=429");
+    CHECK(fetch_zip("90210"), "errors: no update");
+    CHECK(weather_service_last_fetch_failed(), "errors: forecast 429 not reported");
+
+    mock_client_configure("reset=1");
+    CHECK(fetch_zip("90210"), "errors: no update");
+    check_primary("errors recovered");
+}
+
+static void test_latency(void)
+{
+    mock_client_configure("reset=1&latency_ms=300");
+    CHECK(fetch_zip("90210"), "latency: no update");
+    check_primary("latency");
+    double last_ms = http_stat("forecast", "last_ms");
+    CHECK(last_ms >= 300, "latency: forecast took %.1f ms", last_ms);
+    mock_client_configure("reset=1");
+}
+
+// A keep-alive connection the server dropped is reopened once
+static void test_dropped_connection(void)
+{
+    double connects = http_stat("forecast", "connects");
+    double failed = http_stat("forecast", "failures");
+    mock_client_configure("reset=1&drop=1");
+    CHECK(fetch_zip("90210"), "drop: no update");
+    check_primary("drop");
+    CHECK(http_stat("forecast", "connects") > connects, "drop: no reconnect");
+    CHECK(http_stat("forecast", "failures") == failed, "drop: counted as a failure");
+}
+
+static int count_requests(const char *requests, const char *part)
+{
+    int count = 0;
+    for (const char *p = requests ? strstr(requests, part) : NULL; p; p = strstr(p + 1, part)) {
+        count++;
+    }
+    return count;
+}
+
+// Only a reused connection that failed before any response is retried:
+// not a timeout, and not a connection that was just opened
+static void test_no_retry(void)
+{
+    double failed = http_stat("forecast", "failures");
+    mock_client_configure("reset=1&latency_ms=3000");
+    free(mock_client_requests(true));
+    CHECK(fetch_zip("90210"), "timeout: no update");
+    CHECK(weather_service_last_fetch_failed(), "timeout: not reported");
+    double last_ms = http_stat("forecast", "last_ms");
+    CHECK(last_ms >= HTTP_TIMEOUT_MS && last_ms < 2 * HTTP_TIMEOUT_MS, "timeout: request took %.0f ms", last_ms);
+    CHECK(http_stat("forecast", "failures") == failed + 1, "timeout: not counted as a failure");
+    char *requests = mock_client_requests(true);
+    CHECK(count_requests(requests, "/v1/forecast?") == 1, "timeout: retried in %s", requests);
+    free(requests);
+
+    // The timed out connection was closed, so this one is new
+    double connects = http_stat("forecast", "connects");
+    mock_client_configure("reset=1&drop=1");
+    CHECK(fetch_zip("90210"), "fresh drop: no update");
+    CHECK(weather_service_last_fetch_failed(), "fresh drop: not reported");
+    CHECK(http_stat("forecast", "connects") == connects + 1, "fresh drop: reconnected");
+    requests = mock_client_requests(true);
+    CHECK(count_requests(requests, "/v1/forecast?") == 1, "fresh drop: retried in %s", requests);
+    free(requests);
+
+    mock_client_configure("reset=1");
+    CHECK(fetch_zip("90210"), "no retry: no update");
+    check_primary("no retry recovered");
+}
+
+static void test_truncated(void)
+{
+    mock_client_configure("reset=1&truncate=2");
+    CHECK(fetch_zip("90210"), "truncate: no update");
+    CHECK(weather_service_last_fetch_failed(), "truncate: half a body accepted");
+    mock_client_configure("reset=1");
+    CHECK(fetch_zip("90210"), "truncate: no update");
+    check_primary("truncate recovered");
+}
+
+// The body is parsed as it arrives, so its size is not limited by RAM
+static void test_oversized(void)
+{
+    mock_client_configure("reset=1&oversize=262144&chunk=1000");
+    CHECK(fetch_zip("90210"), "oversize: no update");
+    check_primary("oversize");
+    check_series("oversize", "90210");
+    double bytes = http_stat("forecast", "last_bytes");
+    CHECK(bytes > 262144, "oversize: only %.0f bytes", bytes);
+    mock_client_configure("reset=1");
+}
+
+int main(int argc, char **argv)
+{
+    const char *target = NULL;
+    esp_log_level_t level = ESP_LOG_NONE;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--mock") == 0 && i + 1 < argc) {
+            target = argv[++i];
+#ifdef HOST_TLS
+        } else if (strcmp(argv[i], "--mock-ca") == 0 && i + 1 < argc) {
+            esp_http_client_shim_set_ca_file(argv[++i]);
+#endif
+        } else if (strcmp(argv[i], "--verbose") == 0) {
+            level = ESP_LOG_INFO;
+        }
+    }
+    if (!target) {
+        fprintf(stderr, "usage: %s --mock [https://]HOST:PORT [--mock-ca CERT] [--verbose]\n", argv[0]);
+        return 2;
+    }
+    esp_log_level_set("*", level);
+    if (mock_client_init(target) != ESP_OK) {
+        fprintf(stderr, "mock server not reachable at %s\n", target);
+        return 2;
+    }
+
+    weather_service_init();
+    test_fetch();
+    test_locations();
+    test_http_errors();
+    test_latency();
+    test_dropped_connection();
+    test_no_retry();
+    test_truncated();
+    test_oversized();
+
+    if (failures) {
+        printf("%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("weather_service: all checks passed\n");
+    return 0;
+}
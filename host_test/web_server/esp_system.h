@@ -0,0 +1,6 @@
+#pragma once
+
+// Host build of esp_system.h: a restart is logged, not performed
+#include "esp_err.h"
+
+void esp_restart(void);
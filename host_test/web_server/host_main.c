@@ -0,0 +1,88 @@
+// web_server_host: main/core/web_server.c served on a host socket.
+// Same routes, handlers, worker pool and metrics as the device; the
+// modules below them are host_stubs.c.
+#include "web_server.h"
+#include "layout_manager.h"
+#include "storage_writer.h"
+#include "host_stubs.h"
+#include "esp_log.h"
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+            "usage: %s [--port N] [--scan-ms N] [--save-ms N] [--verbose]\n"
+            "  --port N        listen port (default 8080, 0 = any free port)\n"
+            "  --scan-ms N     simulated blocking Wi-Fi scan time (default 0)\n"
+            "  --save-ms N     simulated sd_db_save() time (default 0)\n"
+            "  --verbose       log at INFO level (default WARN)\n",
+            prog);
+}
+
+int main(int argc, char **argv)
+{
+    long port = 8080;
+    host_stubs_config_t stubs = { 0 };
+    esp_log_level_t level = ESP_LOG_WARN;
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *value = (i + 1 < argc) ? argv[i + 1] : NULL;
+        if (strcmp(arg, "--verbose") == 0) {
+            level = ESP_LOG_INFO;
+            continue;
+        }
+        if (!value) {
+            usage(argv[0]);
+            return 2;
+        }
+        if (strcmp(arg, "--port") == 0) {
+            port = strtol(value, NULL, 10);
+        } else if (strcmp(arg, "--scan-ms") == 0) {
+            stubs.scan_ms = strtoul(value, NULL, 10);
+        } else if (strcmp(arg, "--save-ms") == 0) {
+            stubs.save_ms = strtoul(value, NULL, 10);
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+        i++;
+    }
+    if (port < 0 || port > 65535) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    // Handle shutdown signals synchronously, in every thread started below
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, NULL);
+    signal(SIGPIPE, SIG_IGN);
+
+    esp_log_level_set("*", level);
+    host_stubs_configure(&stubs);
+    storage_writer_init();
+    layout_manager_init();
+
+    httpd_shim_set_port((uint16_t)port);
+    web_server_init("Voxels-HOST");
+    httpd_handle_t server = web_server_start();
+    if (!server) {
+        return 1;
+    }
+
+    // run_gate.py waits for this line
+    printf("listening on port %u\n", httpd_shim_get_port());
+    fflush(stdout);
+
+    int sig = 0;
+    sigwait(&signals, &sig);
+    web_server_stop(server);
+    return 0;
+}
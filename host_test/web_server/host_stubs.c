@@ -0,0 +1,738 @@
+// Host stand-ins for the modules below web_server.c: enough state for the
+// handlers to behave as on the device, with storage and radio costs
+// simulated by configurable delays.
+#include "host_stubs.h"
+#include "widget_manager.h"
+#include "layout_manager.h"
+#include "timer_service.h"
+#include "time_sync.h"
+#include "font_size.h"
+#include "ui_state.h"
+#include "weather_service.h"
+#include "weather_forecast.h"
+#include "redraw_stats.h"
+#include "wifi_ap.h"
+#include "sd_database.h"
+#include "esp_log.h"
+#include "esp_wifi.h"
+#include "esp_system.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+#include <unistd.h>
+
+static const char *TAG = "host_stubs";
+
+#define STUB_DB_ENTRIES     64
+#define STUB_DB_KEY_LEN     32
+#define STUB_DB_VALUE_LEN   128     // Same value limit as sd_database
+#define STUB_SCAN_APS       6
+
+static pthread_mutex_t stub_lock = PTHREAD_MUTEX_INITIALIZER;
+static host_stubs_config_t stub_config;
+
+void host_stubs_configure(const host_stubs_config_t *config)
+{
+    stub_config = *config;
+}
+
+static void simulate(uint32_t ms)
+{
+    if (ms > 0) {
+        usleep(ms * 1000);
+    }
+}
+
+// --- sd_database: in-memory table, saves cost save_ms ---
+
+typedef struct {
+    char key[STUB_DB_KEY_LEN];
+    char value[STUB_DB_VALUE_LEN];
+} stub_db_entry_t;
+
+static stub_db_entry_t db[STUB_DB_ENTRIES];
+static pthread_mutex_t db_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static stub_db_entry_t *db_find(const char *key)
+{
+    for (int i = 0; i < STUB_DB_ENTRIES; i++) {
+        if (db[i].key[0] && strcmp(db[i].key, key) == 0) {
+            return &db[i];
+        }
+    }
+    return NULL;
+}
+
+bool sd_db_is_ready(void)
+{
+    return true;
+}
+
+const char *sd_db_get_storage_type(void)
+{
+    return "HOST";
+}
+
+esp_err_t sd_db_set_string(const char *key, const char *value)
+{
+    if (!key || !value || strlen(key) >= STUB_DB_KEY_LEN || strlen(value) >= STUB_DB_VALUE_LEN) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    pthread_mutex_lock(&db_lock);
+    stub_db_entry_t *entry = db_find(key);
+    for (int i = 0; !entry && i < STUB_DB_ENTRIES; i++) {
+        if (!db[i].key[0]) {
+            entry = &db[i];
+            strcpy(entry->key, key);
+        }
+    }
+    if (entry) {
+        strcpy(entry->value, value);
+    }
+    pthread_mutex_unlock(&db_lock);
+    return entry ? ESP_OK : ESP_ERR_NO_MEM;
+}
+
+esp_err_t sd_db_get_string(const char *key, char *value, size_t max_len)
+{
+    pthread_mutex_lock(&db_lock);
+    stub_db_entry_t *entry = db_find(key);
+    if (entry) {
+        snprintf(value, max_len, "%s", entry->value);
+    }
+    pthread_mutex_unlock(&db_lock);
+    return entry ? ESP_OK : ESP_ERR_NOT_FOUND;
+}
+
+esp_err_t sd_db_delete(const char *key)
+{
+    pthread_mutex_lock(&db_lock);
+    stub_db_entry_t *entry = db_find(key);
+    if (entry) {
+        entry->key[0] = '\0';
+    }
+    pthread_mutex_unlock(&db_lock);
+    return entry ? ESP_OK : ESP_ERR_NOT_FOUND;
+}
+
+bool sd_db_key_exists(const char *key)
+{
+    pthread_mutex_lock(&db_lock);
+    bool exists = db_find(key) != NULL;
+    pthread_mutex_unlock(&db_lock);
+    return exists;
+}
+
+// The device holds the database lock for the whole file write
+esp_err_t sd_db_save(void)
+{
+    pthread_mutex_lock(&db_lock);
+    simulate(stub_config.save_ms);
+    pthread_mutex_unlock(&db_lock);
+    return ESP_OK;
+}
+
+// --- Wi-Fi, netif, events, system ---
+
+esp_event_base_t const WIFI_EVENT = "WIFI_EVENT";
+esp_event_base_t const IP_EVENT = "IP_EVENT";
+
+static wifi_mode_t wifi_mode = WIFI_MODE_AP;
+
+esp_err_t esp_event_handler_instance_register(esp_event_base_t base, int32_t id, esp_event_handler_t handler,
+                                              void *arg, esp_event_handler_instance_t *instance)
+{
+    (void)base;
+    (void)id;
+    (void)handler;
+    (void)arg;
+    (void)instance;
+    return ESP_OK;
+}
+
+esp_netif_t *esp_netif_create_default_wifi_sta(void)
+{
+    static int netif;
+    return (esp_netif_t *)&netif;
+}
+
+esp_err_t esp_wifi_get_mode(wifi_mode_t *mode)
+{
+    pthread_mutex_lock(&stub_lock);
+    *mode = wifi_mode;
+    pthread_mutex_unlock(&stub_lock);
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_set_mode(wifi_mode_t mode)
+{
+    pthread_mutex_lock(&stub_lock);
+    wifi_mode = mode;
+    pthread_mutex_unlock(&stub_lock);
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_set_config(wifi_interface_t interface, wifi_config_t *conf)
+{
+    (void)interface;
+    (void)conf;
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_connect(void)
+{
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_scan_start(const wifi_scan_config_t *config, bool block)
+{
+    (void)config;
+    if (block) {
+        simulate(stub_config.scan_ms);
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_scan_stop(void)
+{
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_scan_get_ap_num(uint16_t *number)
+{
+    *number = STUB_SCAN_APS;
+    return ESP_OK;
+}
+
+esp_err_t esp_wifi_scan_get_ap_records(uint16_t *number, wifi_ap_record_t *ap_records)
+{
+    static const struct {
+        const char *ssid;
+        int8_t rssi;
+        wifi_auth_mode_t auth;
+    } aps[STUB_SCAN_APS] = {
+        { "HomeNet",        -42, WIFI_AUTH_WPA2_PSK },
+        { "HomeNet-5G",     -51, WIFI_AUTH_WPA2_PSK },
+        { "Neighbour",      -67, WIFI_AUTH_WPA_WPA2_PSK },
+        { "CoffeeShop",     -74, WIFI_AUTH_OPEN },
+        { "",               -80, WIFI_AUTH_WPA2_PSK },   // Hidden network
+        { "PrinterDirect",  -85, WIFI_AUTH_WPA2_PSK },
+    };
+
+    uint16_t count = (*number < STUB_SCAN_APS) ? *number : STUB_SCAN_APS;
+    for (uint16_t i = 0; i < count; i++) {
+        memset(&ap_records[i], 0, sizeof(wifi_ap_record_t));
+        snprintf((char *)ap_records[i].ssid, sizeof(ap_records[i].ssid), "%s", aps[i].ssid);
+        ap_records[i].rssi = aps[i].rssi;
+        ap_records[i].authmode = aps[i].auth;
+    }
+    *number = count;
+    return ESP_OK;
+}
+
+void esp_restart(void)
+{
+    ESP_LOGW(TAG, "esp_restart() ignored on host");
+}
+
+bool wifi_ap_is_active(void)
+{
+    return true;
+}
+
+esp_err_t wifi_ap_stop(void)
+{
+    return ESP_OK;
+}
+
+// --- Time, fonts, redraw stats ---
+
+static char tz_name[64] = "UTC0";
+static font_size_preset_t font_preset = FONT_SIZE_NORMAL;
+
+esp_err_t time_sync_set_timezone(const char *tz)
+{
+    if (!tz || strlen(tz) >= sizeof(tz_name)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pthread_mutex_lock(&stub_lock);
+    strcpy(tz_name, tz);
+    pthread_mutex_unlock(&stub_lock);
+    return ESP_OK;
+}
+
+// Not thread-safe on the device either; only read by the timezone handler
+const char *time_sync_get_timezone(void)
+{
+    return tz_name;
+}
+
+font_size_preset_t font_size_get_preset(void)
+{
+    return font_preset;
+}
+
+void font_size_set_preset(font_size_preset_t preset)
+{
+    font_preset = preset;
+}
+
+void redraw_stats_reset(void)
+{
+}
+
+cJSON *redraw_stats_to_json(void)
+{
+    cJSON *json = cJSON_CreateObject();
+    cJSON_AddNumberToObject(json, "frames", 0);
+    cJSON_AddNumberToObject(json, "invalidated_px", 0);
+    return json;
+}
+
+// --- Widgets and UI state ---
+
+static const char *widget_ids[] = { "clock", "timer", "weather", "calendar" };
+#define WIDGET_COUNT (sizeof(widget_ids) / sizeof(widget_ids[0]))
+
+static cJSON *widget_configs[WIDGET_COUNT];
+static char active_widget[LAYOUT_WIDGET_ID_LEN] = "clock";
+static uint32_t retain_budget = 64 * 1024;
+
+static int widget_index(const char *widget_id)
+{
+    for (size_t i = 0; i < WIDGET_COUNT; i++) {
+        if (strcmp(widget_ids[i], widget_id) == 0) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+bool widget_manager_widget_exists(const char *widget_id)
+{
+    return widget_id && widget_index(widget_id) >= 0;
+}
+
+const char *widget_manager_get_active(void)
+{
+    return active_widget;
+}
+
+cJSON *widget_manager_list_widgets(void)
+{
+    cJSON *list = cJSON_CreateArray();
+    for (size_t i = 0; i < WIDGET_COUNT; i++) {
+        cJSON *item = cJSON_CreateObject();
+        cJSON_AddStringToObject(item, "id", widget_ids[i]);
+        cJSON_AddStringToObject(item, "name", widget_ids[i]);
+        cJSON_AddItemToArray(list, item);
+    }
+    return list;
+}
+
+cJSON *widget_manager_get_config(const char *widget_id)
+{
+    int index = widget_index(widget_id);
+    if (index < 0) {
+        return NULL;
+    }
+    pthread_mutex_lock(&stub_lock);
+    cJSON *config = widget_configs[index] ? cJSON_Duplicate(widget_configs[index], true) : cJSON_CreateObject();
+    pthread_mutex_unlock(&stub_lock);
+    return config;
+}
+
+esp_err_t widget_manager_set_retain_budget(uint32_t budget_bytes)
+{
+    retain_budget = budget_bytes;
+    return ESP_OK;
+}
+
+uint32_t widget_manager_get_retain_budget(void)
+{
+    return retain_budget;
+}
+
+cJSON *widget_manager_get_switch_stats(void)
+{
+    cJSON *json = cJSON_CreateObject();
+    cJSON_AddNumberToObject(json, "switches", 0);
+    return json;
+}
+
+// Widget calls land here on the LVGL task on the device; apply them at once
+esp_err_t widget_manager_show_layout(const layout_t *layout)
+{
+    (void)layout;
+    return ESP_OK;
+}
+
+esp_err_t ui_state_post_switch(const char *widget_id)
+{
+    if (widget_index(widget_id) < 0) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    pthread_mutex_lock(&stub_lock);
+    snprintf(active_widget, sizeof(active_widget), "%s", widget_id);
+    pthread_mutex_unlock(&stub_lock);
+    return ESP_OK;
+}
+
+esp_err_t ui_state_post_config(const char *widget_id, const cJSON *cfg)
+{
+    int index = widget_index(widget_id);
+    if (index < 0) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    cJSON *copy = cJSON_Duplicate(cfg, true);
+    pthread_mutex_lock(&stub_lock);
+    cJSON_Delete(widget_configs[index]);
+    widget_configs[index] = copy;
+    pthread_mutex_unlock(&stub_lock);
+    return ESP_OK;
+}
+
+esp_err_t ui_state_post_data_updated(const char *widget_id)
+{
+    (void)widget_id;
+    return ESP_OK;
+}
+
+esp_err_t ui_state_post_font_changed(void)
+{
+    return ESP_OK;
+}
+
+esp_err_t ui_state_post_layout_changed(void)
+{
+    return ESP_OK;
+}
+
+// --- Timers: an in-memory table with the service's validation ---
+
+#define STUB_TIMERS 8
+
+static timer_info_t timers[STUB_TIMERS];
+static bool timer_used[STUB_TIMERS];
+
+static int timer_find(const char *name)
+{
+    for (int i = 0; i < STUB_TIMERS; i++) {
+        if (timer_used[i] && strcmp(timers[i].name, name) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+esp_err_t timer_service_configure(const char *name, timer_kind_t kind, uint32_t duration_s)
+{
+    if (!name || !name[0] || strlen(name) >= TIMER_NAME_LEN) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    pthread_mutex_lock(&stub_lock);
+    int index = timer_find(name);
+    for (int i = 0; index < 0 && i < STUB_TIMERS; i++) {
+        if (!timer_used[i]) {
+            index = i;
+            timer_used[i] = true;
+            strcpy(timers[i].name, name);
+        }
+    }
+    if (index >= 0) {
+        timers[index].kind = kind;
+        timers[index].state = TIMER_STATE_STOPPED;
+        timers[index].duration_s = duration_s;
+        timers[index].value_ms = (kind == TIMER_KIND_COUNTDOWN) ? (int64_t)duration_s * 1000 : 0;
+    }
+    pthread_mutex_unlock(&stub_lock);
+    return (index >= 0) ? ESP_OK : ESP_ERR_NO_MEM;
+}
+
+static esp_err_t timer_set_state(const char *name, timer_state_t state, bool clear)
+{
+    pthread_mutex_lock(&stub_lock);
+    int index = timer_find(name);
+    if (index >= 0) {
+        timers[index].state = state;
+        if (clear) {
+            timers[index].value_ms = (timers[index].kind == TIMER_KIND_COUNTDOWN) ?
+                                     (int64_t)timers[index].duration_s * 1000 : 0;
+        }
+    }
+    pthread_mutex_unlock(&stub_lock);
+    return (index >= 0) ? ESP_OK : ESP_ERR_NOT_FOUND;
+}
+
+esp_err_t timer_service_start(const char *name)
+{
+    return timer_set_state(name, TIMER_STATE_RUNNING, false);
+}
+
+esp_err_t timer_service_pause(const char *name)
+{
+    return timer_set_state(name, TIMER_STATE_PAUSED, false);
+}
+
+esp_err_t timer_service_reset(const char *name)
+{
+    return timer_set_state(name, TIMER_STATE_STOPPED, true);
+}
+
+esp_err_t timer_service_delete(const char *name)
+{
+    pthread_mutex_lock(&stub_lock);
+    int index = timer_find(name);
+    if (index >= 0) {
+        timer_used[index] = false;
+    }
+    pthread_mutex_unlock(&stub_lock);
+    return (index >= 0) ? ESP_OK : ESP_ERR_NOT_FOUND;
+}
+
+cJSON *timer_service_to_json(void)
+{
+    static const char *state_names[] = { "stopped", "running", "paused", "finished" };
+
+    cJSON *list = cJSON_CreateArray();
+    pthread_mutex_lock(&stub_lock);
+    for (int i = 0; i < STUB_TIMERS; i++) {
+        if (!timer_used[i]) {
+            continue;
+        }
+        cJSON *item = cJSON_CreateObject();
+        cJSON_AddStringToObject(item, "name", timers[i].name);
+        cJSON_AddStringToObject(item, "kind", timers[i].kind == TIMER_KIND_COUNTDOWN ? "countdown" : "stopwatch");
+        cJSON_AddStringToObject(item, "state", state_names[timers[i].state]);
+        cJSON_AddNumberToObject(item, "duration_s", timers[i].duration_s);
+        cJSON_AddNumberToObject(item, "value_ms", (double)timers[i].value_ms);
+        cJSON_AddItemToArray(list, item);
+    }
+    pthread_mutex_unlock(&stub_lock);
+    return list;
+}
+
+// --- Weather: fixed readings for up to WEATHER_MAX_LOCATIONS locations ---
+
+static struct {
+    char name[WEATHER_LOCATION_NAME_LEN];
+    char query[WEATHER_LOCATION_QUERY_LEN];
+} locations[WEATHER_MAX_LOCATIONS] = {
+    { WEATHER_PRIMARY_LOCATION, "10001" },
+};
+static weather_temp_unit_t temp_unit = WEATHER_TEMP_CELSIUS;
+static weather_wind_unit_t wind_unit = WEATHER_WIND_KMH;
+
+static void fill_weather(int slot, weather_data_t *data)
+{
+    memset(data, 0, sizeof(weather_data_t));
+    data->temperature = 18.5f + slot;
+    data->humidity = 55.0f;
+    data->wind_speed = 3.2f;
+    data->weather_code = 2;
+    strcpy(data->condition, "Partly cloudy");
+    data->valid = true;
+    data->timestamp = (uint32_t)time(NULL);
+}
+
+static int location_find(const char *name)
+{
+    for (int i = 0; i < WEATHER_MAX_LOCATIONS; i++) {
+        if (locations[i].name[0] && strcasecmp(locations[i].name, name) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+esp_err_t weather_service_set_zip_code(const char *zip_code)
+{
+    if (!zip_code || strlen(zip_code) >= WEATHER_LOCATION_QUERY_LEN) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pthread_mutex_lock(&stub_lock);
+    strcpy(locations[0].query, zip_code);
+    pthread_mutex_unlock(&stub_lock);
+    return ESP_OK;
+}
+
+esp_err_t weather_service_get_zip_code(char *zip_code, size_t max_len)
+{
+    pthread_mutex_lock(&stub_lock);
+    snprintf(zip_code, max_len, "%s", locations[0].query);
+    pthread_mutex_unlock(&stub_lock);
+    return ESP_OK;
+}
+
+esp_err_t weather_service_fetch(weather_data_t *data)
+{
+    fill_weather(0, data);
+    return ESP_OK;
+}
+
+esp_err_t weather_service_get_cached(weather_data_t *data)
+{
+    fill_weather(0, data);
+    return ESP_OK;
+}
+
+esp_err_t weather_service_set_location(const char *name, const char *query)
+{
+    if (!name || !name[0] || strlen(name) >= WEATHER_LOCATION_NAME_LEN ||
+        !query || !query[0] || strlen(query) >= WEATHER_LOCATION_QUERY_LEN) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    pthread_mutex_lock(&stub_lock);
+    int slot = location_find(name);
+    for (int i = 1; slot < 0 && i < WEATHER_MAX_LOCATIONS; i++) {
+        if (!locations[i].name[0]) {
+            slot = i;
+            strcpy(locations[i].name, name);
+        }
+    }
+    if (slot >= 0) {
+        strcpy(locations[slot].query, query);
+    }
+    pthread_mutex_unlock(&stub_lock);
+    return (slot >= 0) ? ESP_OK : ESP_ERR_NO_MEM;
+}
+
+esp_err_t weather_service_remove_location(const char *name)
+{
+    pthread_mutex_lock(&stub_lock);
+    int slot = location_find(name);
+    if (slot > 0) {
+        locations[slot].name[0] = '\0';
+    }
+    pthread_mutex_unlock(&stub_lock);
+    if (slot == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return (slot > 0) ? ESP_OK : ESP_ERR_NOT_FOUND;
+}
+
+esp_err_t weather_service_fetch_location(const char *name, weather_data_t *data)
+{
+    pthread_mutex_lock(&stub_lock);
+    int slot = location_find(name);
+    pthread_mutex_unlock(&stub_lock);
+    if (slot < 0) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    fill_weather(slot, data);
+    return ESP_OK;
+}
+
+esp_err_t weather_service_get_location(int index, char *name, char *query, size_t query_len, weather_data_t *data)
+{
+    if (index < 0 || index >= WEATHER_MAX_LOCATIONS) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    pthread_mutex_lock(&stub_lock);
+    bool used = locations[index].name[0] != '\0';
+    if (used) {
+        snprintf(name, WEATHER_LOCATION_NAME_LEN, "%s", locations[index].name);
+        if (query) {
+            snprintf(query, query_len, "%s", locations[index].query);
+        }
+    }
+    pthread_mutex_unlock(&stub_lock);
+    if (!used) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    fill_weather(index, data);
+    return ESP_OK;
+}
+
+esp_err_t weather_service_set_temp_unit(weather_temp_unit_t unit)
+{
+    temp_unit = unit;
+    return ESP_OK;
+}
+
+weather_temp_unit_t weather_service_get_temp_unit(void)
+{
+    return temp_unit;
+}
+
+esp_err_t weather_service_set_wind_unit(weather_wind_unit_t unit)
+{
+    if (unit > WEATHER_WIND_MS) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    wind_unit = unit;
+    return ESP_OK;
+}
+
+weather_wind_unit_t weather_service_get_wind_unit(void)
+{
+    return wind_unit;
+}
+
+const char *weather_service_wind_unit_name(weather_wind_unit_t unit)
+{
+    switch (unit) {
+        case WEATHER_WIND_MPH: return "mph";
+        case WEATHER_WIND_MS:  return "ms";
+        default:               return "kmh";
+    }
+}
+
+esp_err_t weather_service_parse_wind_unit(const char *name, weather_wind_unit_t *unit)
+{
+    for (int u = WEATHER_WIND_KMH; u <= WEATHER_WIND_MS; u++) {
+        if (name && strcmp(name, weather_service_wind_unit_name(u)) == 0) {
+            *unit = u;
+            return ESP_OK;
+        }
+    }
+    return ESP_ERR_INVALID_ARG;
+}
+
+float weather_service_display_temp(float celsius)
+{
+    return (temp_unit == WEATHER_TEMP_FAHRENHEIT) ? celsius * 9.0f / 5.0f + 32.0f : celsius;
+}
+
+float weather_service_display_wind(float meters_per_second)
+{
+    switch (wind_unit) {
+        case WEATHER_WIND_MPH: return meters_per_second * 2.23694f;
+        case WEATHER_WIND_MS:  return meters_per_second;
+        default:               return meters_per_second * 3.6f;
+    }
+}
+
+cJSON *weather_service_get_http_stats(void)
+{
+    return cJSON_CreateObject();
+}
+
+cJSON *weather_forecast_to_json(time_t now)
+{
+    cJSON *json = cJSON_CreateObject();
+    cJSON *hours = cJSON_AddArrayToObject(json, "hourly");
+    for (int h = 0; h < 24; h++) {
+        cJSON *hour = cJSON_CreateObject();
+        cJSON_AddNumberToObject(hour, "time", (double)(now + h * 3600));
+        cJSON_AddNumberToObject(hour, "temperature", 15.0 + (h % 12));
+        cJSON_AddNumberToObject(hour, "precipitation_probability", (h * 7) % 100);
+        cJSON_AddNumberToObject(hour, "weather_code", 2);
+        cJSON_AddItemToArray(hours, hour);
+    }
+    cJSON *days = cJSON_AddArrayToObject(json, "daily");
+    for (int d = 0; d < 7; d++) {
+        cJSON *day = cJSON_CreateObject();
+        cJSON_AddNumberToObject(day, "time", (double)(now + d * 86400));
+        cJSON_AddNumberToObject(day, "temperature_max", 22.0 + d);
+        cJSON_AddNumberToObject(day, "temperature_min", 11.0 + d);
+        cJSON_AddNumberToObject(day, "weather_code", 3);
+        cJSON_AddItemToArray(days, day);
+    }
+    return json;
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * @brief Simulated device costs for the host stubs (0 = free)
+ */
+typedef struct {
+    uint32_t scan_ms;       // Blocking Wi-Fi scan
+    uint32_t save_ms;       // sd_db_save(), with the database lock held
+} host_stubs_config_t;
+
+/**
+ * @brief Set the simulated costs; call before starting the server
+ */
+void host_stubs_configure(const host_stubs_config_t *config);
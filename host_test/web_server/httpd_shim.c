@@ -0,0 +1,857 @@
+#include "esp_http_server.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+static const char *TAG = "httpd_shim";
+
+#define SHIM_RECV_BUF       2048    // Request line and headers must fit (ESP-IDF allows 512 + headers)
+#define SHIM_RESP_HDR_BUF   512     // Extra response headers set by the handler
+#define SHIM_DRAIN_BUF      512
+
+typedef struct {
+    int fd;                         // -1 for a free slot
+    bool busy;                      // Detached to an async handler, not polled
+    int64_t last_used_us;           // For LRU purge
+    char buf[SHIM_RECV_BUF];        // Received but unparsed bytes
+    size_t len;
+} shim_sock_t;
+
+typedef struct {
+    httpd_config_t config;
+    int listen_fd;
+    int wake[2];                    // Wakes the server task when a detached socket comes back
+    pthread_t thread;
+    volatile bool stop;
+    pthread_mutex_t lock;           // Guards fd and busy of every socket
+    httpd_uri_t *handlers;
+    int handler_count;
+    shim_sock_t *socks;
+} shim_server_t;
+
+// Request state behind httpd_req_t.aux
+typedef struct {
+    shim_server_t *server;
+    shim_sock_t *sock;
+    char headers[SHIM_RECV_BUF];    // Header lines of the request, NUL terminated
+    size_t body_left;               // Body bytes not read by the handler yet
+    char status[48];
+    char type[64];
+    char resp_hdrs[SHIM_RESP_HDR_BUF];
+    size_t resp_hdrs_len;
+    bool headers_sent;
+    bool chunked;
+    bool chunked_done;
+    bool detached;                  // Set on the original when a copy was detached
+    bool close_conn;
+} shim_aux_t;
+
+static uint16_t port_override = 0;
+static bool port_overridden = false;
+static uint16_t bound_port = 0;
+
+void httpd_shim_set_port(uint16_t port)
+{
+    port_override = port;
+    port_overridden = true;
+}
+
+uint16_t httpd_shim_get_port(void)
+{
+    return bound_port;
+}
+
+static const char *method_str(int method)
+{
+    switch (method) {
+        case HTTP_DELETE: return "DELETE";
+        case HTTP_GET:    return "GET";
+        case HTTP_HEAD:   return "HEAD";
+        case HTTP_POST:   return "POST";
+        case HTTP_PUT:    return "PUT";
+        default:          return "?";
+    }
+}
+
+static int method_from_str(const char *str, size_t len)
+{
+    for (int m = HTTP_DELETE; m <= HTTP_PUT; m++) {
+        const char *name = method_str(m);
+        if (strlen(name) == len && strncmp(name, str, len) == 0) {
+            return m;
+        }
+    }
+    return -1;
+}
+
+static bool write_all(int fd, struct iovec *iov, int count)
+{
+    while (count > 0) {
+        ssize_t n = writev(fd, iov, count);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        while (count > 0 && (size_t)n >= iov->iov_len) {
+            n -= iov->iov_len;
+            iov++;
+            count--;
+        }
+        if (count > 0) {
+            iov->iov_base = (char *)iov->iov_base + n;
+            iov->iov_len -= n;
+        }
+    }
+    return true;
+}
+
+// Status line and headers; content_len < 0 starts a chunked response
+static int format_headers(shim_aux_t *aux, char *out, size_t out_len, ssize_t content_len)
+{
+    int n = snprintf(out, out_len, "HTTP/1.1 %s\r\nContent-Type: %s\r\n",
+                     aux->status[0] ? aux->status : "200 OK",
+                     aux->type[0] ? aux->type : "text/html");
+    if (content_len < 0) {
+        n += snprintf(out + n, out_len - n, "Transfer-Encoding: chunked\r\n");
+    } else {
+        n += snprintf(out + n, out_len - n, "Content-Length: %zd\r\n", content_len);
+    }
+    if (aux->close_conn) {
+        n += snprintf(out + n, out_len - n, "Connection: close\r\n");
+    }
+    n += snprintf(out + n, out_len - n, "%.*s\r\n", (int)aux->resp_hdrs_len, aux->resp_hdrs);
+    return n;
+}
+
+esp_err_t httpd_resp_set_status(httpd_req_t *r, const char *status)
+{
+    shim_aux_t *aux = r->aux;
+    snprintf(aux->status, sizeof(aux->status), "%s", status);
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_set_type(httpd_req_t *r, const char *type)
+{
+    shim_aux_t *aux = r->aux;
+    snprintf(aux->type, sizeof(aux->type), "%s", type);
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_set_hdr(httpd_req_t *r, const char *field, const char *value)
+{
+    shim_aux_t *aux = r->aux;
+    size_t room = sizeof(aux->resp_hdrs) - aux->resp_hdrs_len;
+    int n = snprintf(aux->resp_hdrs + aux->resp_hdrs_len, room, "%s: %s\r\n", field, value);
+    if (n < 0 || (size_t)n >= room) {
+        return ESP_ERR_HTTPD_RESP_HDR;
+    }
+    aux->resp_hdrs_len += n;
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_send(httpd_req_t *r, const char *buf, ssize_t buf_len)
+{
+    shim_aux_t *aux = r->aux;
+    if (aux->headers_sent) {
+        return ESP_ERR_HTTPD_RESP_SEND;
+    }
+    if (buf_len == HTTPD_RESP_USE_STRLEN) {
+        buf_len = buf ? strlen(buf) : 0;
+    }
+
+    char head[SHIM_RESP_HDR_BUF + 256];
+    int head_len = format_headers(aux, head, sizeof(head), buf_len);
+    struct iovec iov[2] = {
+        { .iov_base = head, .iov_len = head_len },
+        { .iov_base = (void *)buf, .iov_len = buf ? buf_len : 0 },
+    };
+    aux->headers_sent = true;
+    aux->chunked_done = true;
+    if (!write_all(aux->sock->fd, iov, 2)) {
+        aux->close_conn = true;
+        return ESP_ERR_HTTPD_RESP_SEND;
+    }
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_send_chunk(httpd_req_t *r, const char *buf, ssize_t buf_len)
+{
+    shim_aux_t *aux = r->aux;
+    if (aux->headers_sent && !aux->chunked) {
+        return ESP_ERR_HTTPD_RESP_SEND;
+    }
+    if (buf_len == HTTPD_RESP_USE_STRLEN) {
+        buf_len = buf ? strlen(buf) : 0;
+    }
+
+    char head[SHIM_RESP_HDR_BUF + 256];
+    int head_len = 0;
+    if (!aux->headers_sent) {
+        head_len = format_headers(aux, head, sizeof(head), -1);
+        aux->headers_sent = true;
+        aux->chunked = true;
+    }
+    char size_line[16];
+    int size_len = snprintf(size_line, sizeof(size_line), "%zx\r\n", buf ? buf_len : 0);
+    struct iovec iov[4] = {
+        { .iov_base = head, .iov_len = head_len },
+        { .iov_base = size_line, .iov_len = size_len },
+        { .iov_base = (void *)buf, .iov_len = buf ? buf_len : 0 },
+        { .iov_base = "\r\n", .iov_len = 2 },
+    };
+    if (!buf || buf_len == 0) {
+        aux->chunked_done = true;
+    }
+    if (!write_all(aux->sock->fd, iov, 4)) {
+        aux->close_conn = true;
+        return ESP_ERR_HTTPD_RESP_SEND;
+    }
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_send_err(httpd_req_t *req, httpd_err_code_t error, const char *msg)
+{
+    const char *status;
+    const char *default_msg;
+    switch (error) {
+        case HTTPD_501_METHOD_NOT_IMPLEMENTED:
+            status = "501 Method Not Implemented";
+            default_msg = "Server does not support this method";
+            break;
+        case HTTPD_505_VERSION_NOT_SUPPORTED:
+            status = "505 Version Not Supported";
+            default_msg = "HTTP version not supported by server";
+            break;
+        case HTTPD_400_BAD_REQUEST:
+            status = "400 Bad Request";
+            default_msg = "Bad request";
+            break;
+        case HTTPD_401_UNAUTHORIZED:
+            status = "401 Unauthorized";
+            default_msg = "No permission to access";
+            break;
+        case HTTPD_403_FORBIDDEN:
+            status = "403 Forbidden";
+            default_msg = "Access to the resource is forbidden";
+            break;
+        case HTTPD_404_NOT_FOUND:
+            status = "404 Not Found";
+            default_msg = "Nothing matches the given URI";
+            break;
+        case HTTPD_405_METHOD_NOT_ALLOWED:
+            status = "405 Method Not Allowed";
+            default_msg = "Request method for this URI is not handled by server";
+            break;
+        case HTTPD_408_REQ_TIMEOUT:
+            status = "408 Request Timeout";
+            default_msg = "Server closed this connection";
+            break;
+        case HTTPD_411_LENGTH_REQUIRED:
+            status = "411 Length Required";
+            default_msg = "Chunked encoding not supported";
+            break;
+        case HTTPD_414_URI_TOO_LONG:
+            status = "414 URI Too Long";
+            default_msg = "URI is too long";
+            break;
+        case HTTPD_431_REQ_HDR_FIELDS_TOO_LARGE:
+            status = "431 Request Header Fields Too Large";
+            default_msg = "Header fields are too long";
+            break;
+        default:
+            status = "500 Internal Server Error";
+            default_msg = "Server has encountered an unexpected error";
+            break;
+    }
+
+    httpd_resp_set_status(req, status);
+    httpd_resp_set_type(req, "text/html");
+    return httpd_resp_send(req, msg ? msg : default_msg, HTTPD_RESP_USE_STRLEN);
+}
+
+int httpd_req_recv(httpd_req_t *r, char *buf, size_t buf_len)
+{
+    shim_aux_t *aux = r->aux;
+    shim_sock_t *sock = aux->sock;
+
+    if (aux->body_left == 0) {
+        return 0;
+    }
+    if (buf_len > aux->body_left) {
+        buf_len = aux->body_left;
+    }
+
+    // Body bytes that arrived with the headers first
+    if (sock->len > 0) {
+        size_t n = (sock->len < buf_len) ? sock->len : buf_len;
+        memcpy(buf, sock->buf, n);
+        memmove(sock->buf, sock->buf + n, sock->len - n);
+        sock->len -= n;
+        aux->body_left -= n;
+        return (int)n;
+    }
+
+    ssize_t n = recv(sock->fd, buf, buf_len, 0);
+    if (n < 0) {
+        return (errno == EAGAIN || errno == EWOULDBLOCK) ? HTTPD_SOCK_ERR_TIMEOUT : HTTPD_SOCK_ERR_FAIL;
+    }
+    if (n == 0) {
+        aux->close_conn = true;
+        return HTTPD_SOCK_ERR_FAIL;
+    }
+    aux->body_left -= n;
+    return (int)n;
+}
+
+// Value of a request header (case-insensitive name), or NULL
+static const char *find_header(shim_aux_t *aux, const char *field, size_t *len)
+{
+    size_t field_len = strlen(field);
+    for (const char *line = aux->headers; *line; ) {
+        const char *end = strstr(line, "\r\n");
+        if (!end) {
+            end = line + strlen(line);
+        }
+        if ((size_t)(end - line) > field_len && line[field_len] == ':' &&
+            strncasecmp(line, field, field_len) == 0) {
+            const char *value = line + field_len + 1;
+            while (value < end && (*value == ' ' || *value == '\t')) {
+                value++;
+            }
+            *len = end - value;
+            return value;
+        }
+        line = *end ? end + 2 : end;
+    }
+    return NULL;
+}
+
+size_t httpd_req_get_hdr_value_len(httpd_req_t *r, const char *field)
+{
+    size_t len = 0;
+    return find_header(r->aux, field, &len) ? len : 0;
+}
+
+esp_err_t httpd_req_get_hdr_value_str(httpd_req_t *r, const char *field, char *val, size_t val_size)
+{
+    size_t len = 0;
+    const char *value = find_header(r->aux, field, &len);
+    if (!value) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    if (val_size == 0) {
+        return ESP_ERR_HTTPD_RESULT_TRUNC;
+    }
+    size_t copy = (len < val_size - 1) ? len : val_size - 1;
+    memcpy(val, value, copy);
+    val[copy] = '\0';
+    return (copy < len) ? ESP_ERR_HTTPD_RESULT_TRUNC : ESP_OK;
+}
+
+size_t httpd_req_get_url_query_len(httpd_req_t *r)
+{
+    const char *query = strchr(r->uri, '?');
+    return query ? strlen(query + 1) : 0;
+}
+
+esp_err_t httpd_req_get_url_query_str(httpd_req_t *r, char *buf, size_t buf_len)
+{
+    const char *query = strchr(r->uri, '?');
+    if (!query) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    if (buf_len == 0) {
+        return ESP_ERR_HTTPD_RESULT_TRUNC;
+    }
+    query++;
+    size_t len = strlen(query);
+    size_t copy = (len < buf_len - 1) ? len : buf_len - 1;
+    memcpy(buf, query, copy);
+    buf[copy] = '\0';
+    return (copy < len) ? ESP_ERR_HTTPD_RESULT_TRUNC : ESP_OK;
+}
+
+// Like ESP-IDF: values are returned as sent, without percent-decoding
+esp_err_t httpd_query_key_value(const char *qry, const char *key, char *val, size_t val_size)
+{
+    size_t key_len = strlen(key);
+    for (const char *pair = qry; pair && *pair; ) {
+        const char *end = strchr(pair, '&');
+        if (!end) {
+            end = pair + strlen(pair);
+        }
+        if ((size_t)(end - pair) >= key_len && strncmp(pair, key, key_len) == 0 &&
+            (pair[key_len] == '=' || pair + key_len == end)) {
+            const char *value = (pair + key_len < end) ? pair + key_len + 1 : end;
+            size_t len = end - value;
+            if (val_size == 0) {
+                return ESP_ERR_HTTPD_RESULT_TRUNC;
+            }
+            size_t copy = (len < val_size - 1) ? len : val_size - 1;
+            memcpy(val, value, copy);
+            val[copy] = '\0';
+            return (copy < len) ? ESP_ERR_HTTPD_RESULT_TRUNC : ESP_OK;
+        }
+        pair = *end ? end + 1 : NULL;
+    }
+    return ESP_ERR_NOT_FOUND;
+}
+
+esp_err_t httpd_register_uri_handler(httpd_handle_t handle, const httpd_uri_t *uri_handler)
+{
+    shim_server_t *server = handle;
+    for (int i = 0; i < server->handler_count; i++) {
+        if (server->handlers[i].method == uri_handler->method &&
+            strcmp(server->handlers[i].uri, uri_handler->uri) == 0) {
+            return ESP_ERR_HTTPD_HANDLER_EXISTS;
+        }
+    }
+    if (server->handler_count >= server->config.max_uri_handlers) {
+        ESP_LOGW(TAG, "No slot left for %s %s", method_str(uri_handler->method), uri_handler->uri);
+        return ESP_ERR_HTTPD_HANDLERS_FULL;
+    }
+
+    httpd_uri_t *slot = &server->handlers[server->handler_count++];
+    *slot = *uri_handler;
+    slot->uri = strdup(uri_handler->uri);
+    return ESP_OK;
+}
+
+static void close_sock(shim_server_t *server, shim_sock_t *sock)
+{
+    pthread_mutex_lock(&server->lock);
+    if (sock->fd >= 0) {
+        close(sock->fd);
+    }
+    sock->fd = -1;
+    sock->busy = false;
+    sock->len = 0;
+    pthread_mutex_unlock(&server->lock);
+}
+
+// Discard the unread body so the next request on the socket parses
+static void drain_body(shim_aux_t *aux)
+{
+    char scratch[SHIM_DRAIN_BUF];
+    httpd_req_t fake = { .aux = aux };
+    while (aux->body_left > 0 && !aux->close_conn) {
+        if (httpd_req_recv(&fake, scratch, sizeof(scratch)) <= 0) {
+            aux->close_conn = true;
+        }
+    }
+}
+
+// Called when the handler (sync or detached) is done with the request
+static void finish_request(shim_aux_t *aux, esp_err_t handler_ret)
+{
+    shim_server_t *server = aux->server;
+    shim_sock_t *sock = aux->sock;
+
+    // Like ESP-IDF, a failing handler closes the connection
+    if (handler_ret != ESP_OK || !aux->chunked_done) {
+        aux->close_conn = true;
+    }
+    drain_body(aux);
+
+    if (aux->close_conn) {
+        close_sock(server, sock);
+    } else {
+        pthread_mutex_lock(&server->lock);
+        sock->busy = false;
+        sock->last_used_us = esp_timer_get_time();
+        pthread_mutex_unlock(&server->lock);
+    }
+}
+
+esp_err_t httpd_req_async_handler_begin(httpd_req_t *r, httpd_req_t **out)
+{
+    shim_aux_t *aux = r->aux;
+    httpd_req_t *copy = malloc(sizeof(httpd_req_t));
+    shim_aux_t *aux_copy = malloc(sizeof(shim_aux_t));
+    if (!copy || !aux_copy) {
+        free(copy);
+        free(aux_copy);
+        return ESP_ERR_HTTPD_ALLOC_MEM;
+    }
+    memcpy(copy, r, sizeof(httpd_req_t));
+    memcpy(aux_copy, aux, sizeof(shim_aux_t));
+    copy->aux = aux_copy;
+
+    pthread_mutex_lock(&aux->server->lock);
+    aux->sock->busy = true;
+    pthread_mutex_unlock(&aux->server->lock);
+    aux->detached = true;
+
+    *out = copy;
+    return ESP_OK;
+}
+
+esp_err_t httpd_req_async_handler_complete(httpd_req_t *r)
+{
+    shim_aux_t *aux = r->aux;
+    shim_server_t *server = aux->server;
+
+    finish_request(aux, aux->headers_sent ? ESP_OK : ESP_FAIL);
+    free(aux);
+    free(r);
+
+    char wake = 1;
+    if (write(server->wake[1], &wake, 1) < 0) {
+        ESP_LOGW(TAG, "Failed to wake server task");
+    }
+    return ESP_OK;
+}
+
+// Read until the end of the headers; returns the header length or -1
+static int read_headers(shim_sock_t *sock)
+{
+    while (true) {
+        sock->buf[sock->len] = '\0';
+        char *end = strstr(sock->buf, "\r\n\r\n");
+        if (end) {
+            return (int)(end - sock->buf) + 4;
+        }
+        if (sock->len >= sizeof(sock->buf) - 1) {
+            return -1;
+        }
+        ssize_t n = recv(sock->fd, sock->buf + sock->len, sizeof(sock->buf) - 1 - sock->len, 0);
+        if (n <= 0) {
+            return -1;
+        }
+        sock->len += n;
+    }
+}
+
+static void send_server_error(shim_server_t *server, shim_sock_t *sock, httpd_err_code_t error)
+{
+    shim_aux_t aux = { .server = server, .sock = sock, .close_conn = true };
+    httpd_req_t req = { .handle = server, .aux = &aux };
+    httpd_resp_send_err(&req, error, NULL);
+    close_sock(server, sock);
+}
+
+// Parse and serve one request from a readable socket
+static void serve_request(shim_server_t *server, shim_sock_t *sock)
+{
+    int header_len = read_headers(sock);
+    if (header_len < 0) {
+        if (sock->len >= sizeof(sock->buf) - 1) {
+            send_server_error(server, sock, HTTPD_431_REQ_HDR_FIELDS_TOO_LARGE);
+        } else {
+            close_sock(server, sock);
+        }
+        return;
+    }
+
+    httpd_req_t *req = calloc(1, sizeof(httpd_req_t));
+    shim_aux_t *aux = calloc(1, sizeof(shim_aux_t));
+    if (!req || !aux) {
+        free(req);
+        free(aux);
+        close_sock(server, sock);
+        return;
+    }
+    aux->server = server;
+    aux->sock = sock;
+    req->handle = server;
+    req->aux = aux;
+
+    // Request line: METHOD SP URI SP VERSION
+    char *line_end = strstr(sock->buf, "\r\n");
+    char *method_end = memchr(sock->buf, ' ', line_end - sock->buf);
+    char *uri = method_end ? method_end + 1 : NULL;
+    char *uri_end = uri ? memchr(uri, ' ', line_end - uri) : NULL;
+    int method = method_end ? method_from_str(sock->buf, method_end - sock->buf) : -1;
+    httpd_err_code_t error = HTTPD_500_INTERNAL_SERVER_ERROR;
+    bool bad = false;
+
+    if (!uri_end) {
+        error = HTTPD_400_BAD_REQUEST;
+        bad = true;
+    } else if (method < 0) {
+        error = HTTPD_501_METHOD_NOT_IMPLEMENTED;
+        bad = true;
+    } else if (uri_end - uri > HTTPD_MAX_URI_LEN) {
+        error = HTTPD_414_URI_TOO_LONG;
+        bad = true;
+    }
+
+    if (!bad) {
+        req->method = method;
+        memcpy((char *)req->uri, uri, uri_end - uri);
+        bool http10 = strncmp(uri_end + 1, "HTTP/1.0", 8) == 0;
+
+        size_t headers_len = sock->buf + header_len - 2 - (line_end + 2);
+        memcpy(aux->headers, line_end + 2, headers_len);
+        aux->headers[headers_len] = '\0';
+
+        char value[32];
+        if (httpd_req_get_hdr_value_str(req, "Content-Length", value, sizeof(value)) == ESP_OK) {
+            req->content_len = strtoul(value, NULL, 10);
+        } else if (httpd_req_get_hdr_value_len(req, "Transfer-Encoding") > 0) {
+            error = HTTPD_411_LENGTH_REQUIRED;
+            bad = true;
+        }
+        aux->body_left = req->content_len;
+
+        bool has_connection = httpd_req_get_hdr_value_str(req, "Connection", value, sizeof(value)) == ESP_OK;
+        if (has_connection ? strcasecmp(value, "close") == 0 : http10) {
+            aux->close_conn = true;
+        }
+    }
+
+    // Keep body bytes (and anything pipelined) for httpd_req_recv()
+    memmove(sock->buf, sock->buf + header_len, sock->len - header_len);
+    sock->len -= header_len;
+
+    if (bad) {
+        free(req);
+        free(aux);
+        send_server_error(server, sock, error);
+        return;
+    }
+
+    // Exact match on the path, then the method
+    size_t path_len = strcspn(req->uri, "?");
+    const httpd_uri_t *match = NULL;
+    bool path_known = false;
+    for (int i = 0; i < server->handler_count; i++) {
+        const httpd_uri_t *h = &server->handlers[i];
+        if (strlen(h->uri) == path_len && strncmp(h->uri, req->uri, path_len) == 0) {
+            path_known = true;
+            if (h->method == method) {
+                match = h;
+                break;
+            }
+        }
+    }
+
+    if (!match) {
+        aux->close_conn = true;
+        httpd_resp_send_err(req, path_known ? HTTPD_405_METHOD_NOT_ALLOWED : HTTPD_404_NOT_FOUND, NULL);
+        finish_request(aux, ESP_FAIL);
+        free(aux);
+        free(req);
+        return;
+    }
+
+    req->user_ctx = match->user_ctx;
+    esp_err_t ret = match->handler(req);
+    if (!aux->detached) {
+        finish_request(aux, ret);
+    }
+    free(aux);
+    free(req);
+}
+
+// Take a new connection, purging the least recently used idle one if full
+static void accept_connection(shim_server_t *server)
+{
+    int fd = accept(server->listen_fd, NULL, NULL);
+    if (fd < 0) {
+        return;
+    }
+
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    struct timeval recv_tv = { .tv_sec = server->config.recv_wait_timeout };
+    struct timeval send_tv = { .tv_sec = server->config.send_wait_timeout };
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &recv_tv, sizeof(recv_tv));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &send_tv, sizeof(send_tv));
+
+    shim_sock_t *slot = NULL;
+    shim_sock_t *oldest = NULL;
+    pthread_mutex_lock(&server->lock);
+    for (int i = 0; i < server->config.max_open_sockets; i++) {
+        shim_sock_t *sock = &server->socks[i];
+        if (sock->fd < 0) {
+            slot = sock;
+            break;
+        }
+        if (!sock->busy && (!oldest || sock->last_used_us < oldest->last_used_us)) {
+            oldest = sock;
+        }
+    }
+    pthread_mutex_unlock(&server->lock);
+
+    if (!slot && server->config.lru_purge_enable && oldest) {
+        ESP_LOGD(TAG, "Purging least recently used socket %d", oldest->fd);
+        close_sock(server, oldest);
+        slot = oldest;
+    }
+    if (!slot) {
+        ESP_LOGW(TAG, "No free socket, closing new connection");
+        close(fd);
+        return;
+    }
+
+    pthread_mutex_lock(&server->lock);
+    slot->fd = fd;
+    slot->busy = false;
+    slot->len = 0;
+    slot->last_used_us = esp_timer_get_time();
+    pthread_mutex_unlock(&server->lock);
+}
+
+static void *server_task(void *arg)
+{
+    shim_server_t *server = arg;
+
+    while (!server->stop) {
+        fd_set readable;
+        FD_ZERO(&readable);
+        FD_SET(server->listen_fd, &readable);
+        FD_SET(server->wake[0], &readable);
+        int max_fd = (server->listen_fd > server->wake[0]) ? server->listen_fd : server->wake[0];
+
+        pthread_mutex_lock(&server->lock);
+        for (int i = 0; i < server->config.max_open_sockets; i++) {
+            shim_sock_t *sock = &server->socks[i];
+            if (sock->fd >= 0 && !sock->busy) {
+                FD_SET(sock->fd, &readable);
+                if (sock->fd > max_fd) {
+                    max_fd = sock->fd;
+                }
+            }
+        }
+        pthread_mutex_unlock(&server->lock);
+
+        if (select(max_fd + 1, &readable, NULL, NULL, NULL) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        if (server->stop) {
+            break;
+        }
+
+        if (FD_ISSET(server->wake[0], &readable)) {
+            char drain[64];
+            if (read(server->wake[0], drain, sizeof(drain)) < 0) {
+                ESP_LOGW(TAG, "Wake pipe read failed");
+            }
+        }
+
+        for (int i = 0; i < server->config.max_open_sockets; i++) {
+            shim_sock_t *sock = &server->socks[i];
+            // Polled sockets can only be changed by this task
+            if (sock->fd >= 0 && !sock->busy && FD_ISSET(sock->fd, &readable)) {
+                sock->last_used_us = esp_timer_get_time();
+                serve_request(server, sock);
+            }
+        }
+
+        if (FD_ISSET(server->listen_fd, &readable)) {
+            accept_connection(server);
+        }
+    }
+    return NULL;
+}
+
+esp_err_t httpd_start(httpd_handle_t *handle, const httpd_config_t *config)
+{
+    shim_server_t *server = calloc(1, sizeof(shim_server_t));
+    if (!server) {
+        return ESP_ERR_HTTPD_ALLOC_MEM;
+    }
+    server->config = *config;
+    server->handlers = calloc(config->max_uri_handlers, sizeof(httpd_uri_t));
+    server->socks = calloc(config->max_open_sockets, sizeof(shim_sock_t));
+    if (!server->handlers || !server->socks) {
+        free(server->handlers);
+        free(server->socks);
+        free(server);
+        return ESP_ERR_HTTPD_ALLOC_MEM;
+    }
+    for (int i = 0; i < config->max_open_sockets; i++) {
+        server->socks[i].fd = -1;
+    }
+    pthread_mutex_init(&server->lock, NULL);
+
+    uint16_t port = port_overridden ? port_override : config->server_port;
+    server->listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    int one = 1;
+    setsockopt(server->listen_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(port),
+        .sin_addr.s_addr = htonl(INADDR_ANY),
+    };
+    socklen_t addr_len = sizeof(addr);
+    if (server->listen_fd < 0 ||
+        bind(server->listen_fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+        listen(server->listen_fd, config->backlog_conn) != 0 ||
+        getsockname(server->listen_fd, (struct sockaddr *)&addr, &addr_len) != 0 ||
+        pipe(server->wake) != 0) {
+        ESP_LOGE(TAG, "Failed to listen on port %u: %s", port, strerror(errno));
+        if (server->listen_fd >= 0) {
+            close(server->listen_fd);
+        }
+        free(server->handlers);
+        free(server->socks);
+        free(server);
+        return ESP_ERR_HTTPD_TASK;
+    }
+    bound_port = ntohs(addr.sin_port);
+
+    if (pthread_create(&server->thread, NULL, server_task, server) != 0) {
+        close(server->listen_fd);
+        close(server->wake[0]);
+        close(server->wake[1]);
+        free(server->handlers);
+        free(server->socks);
+        free(server);
+        return ESP_ERR_HTTPD_TASK;
+    }
+
+    ESP_LOGI(TAG, "Listening on port %u", bound_port);
+    *handle = server;
+    return ESP_OK;
+}
+
+// Detached requests must have completed before stopping
+esp_err_t httpd_stop(httpd_handle_t handle)
+{
+    shim_server_t *server = handle;
+    if (!server) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    server->stop = true;
+    char wake = 1;
+    if (write(server->wake[1], &wake, 1) < 0) {
+        ESP_LOGW(TAG, "Failed to wake server task");
+    }
+    pthread_join(server->thread, NULL);
+
+    for (int i = 0; i < server->config.max_open_sockets; i++) {
+        if (server->socks[i].fd >= 0) {
+            close(server->socks[i].fd);
+        }
+    }
+    for (int i = 0; i < server->handler_count; i++) {
+        free((char *)server->handlers[i].uri);
+    }
+    close(server->listen_fd);
+    close(server->wake[0]);
+    close(server->wake[1]);
+    free(server->handlers);
+    free(server->socks);
+    free(server);
+    return ESP_OK;
+}
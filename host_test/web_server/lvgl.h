@@ -0,0 +1,5 @@
+#pragma once
+
+// Host build: the web server only passes LVGL types through headers
+typedef struct _lv_obj_t lv_obj_t;
+typedef struct _lv_font_t lv_font_t;
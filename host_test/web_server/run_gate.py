@@ -0,0 +1,53 @@
+#!/usr/bin/env python3
+"""Start web_server_host on a free port, replay the sessions with web_load
+and return its exit code (non-zero if the gate fails)."""
+import argparse
+import glob
+import os
+import signal
+import subprocess
+import sys
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("--server", required=True, help="web_server_host binary")
+    parser.add_argument("--load", required=True, help="web_load binary")
+    parser.add_argument("--sessions", required=True, help="directory of session files")
+    parser.add_argument("--gate", help="gate file with per-session limits")
+    parser.add_argument("--clients", default="4")
+    parser.add_argument("--duration", default="5")
+    parser.add_argument("--server-args", default="", help="extra web_server_host options")
+    parser.add_argument("load_args", nargs="*", help="extra web_load options (after --)")
+    args = parser.parse_args()
+
+    server = subprocess.Popen([args.server, "--port", "0"] + args.server_args.split(),
+                              stdout=subprocess.PIPE, text=True)
+    try:
+        port = None
+        for line in server.stdout:
+            if line.startswith("listening on port "):
+                port = int(line.split()[-1])
+                break
+        if port is None:
+            print("web_server_host did not start", file=sys.stderr)
+            return 2
+
+        cmd = [args.load, "--target", "127.0.0.1:%d" % port,
+               "--clients", args.clients, "--duration", args.duration]
+        for path in sorted(glob.glob(os.path.join(args.sessions, "*.txt"))):
+            cmd += ["--session", path]
+        if args.gate:
+            cmd += ["--gate", args.gate]
+        cmd += args.load_args
+        return subprocess.call(cmd)
+    finally:
+        server.send_signal(signal.SIGTERM)
+        try:
+            server.wait(timeout=5)
+        except subprocess.TimeoutExpired:
+            server.kill()
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,702 @@
+// web_load: replays browsing sessions from concurrent keep-alive clients
+// and reports throughput and latency percentiles per session and route.
+// Runs against web_server_host or a device (--target 192.168.4.1:80), and
+// can gate the results against limits recorded with --write-baseline.
+#include <errno.h>
+#include <math.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#define MAX_SESSIONS        8
+#define MAX_STEPS           64
+#define MAX_ROUTES          64
+#define MAX_GATE_LINES      (MAX_SESSIONS + 1)
+#define READ_BUF            16384
+#define HEADER_MAX          8192
+#define IO_TIMEOUT_SEC      10
+
+typedef struct {
+    char method[8];             // Empty for a think step
+    char path[256];
+    char *body;
+    uint32_t think_ms;
+    int route;                  // Index into routes[]
+} step_t;
+
+typedef struct {
+    char name[32];
+    step_t steps[MAX_STEPS];
+    int step_count;
+} session_t;
+
+typedef struct {
+    uint32_t *us;               // Latency of each completed request
+    size_t count;
+    size_t cap;
+    uint64_t rejected;          // 503 (busy) responses
+    uint64_t errors;            // Other non-2xx responses and connection failures
+} samples_t;
+
+typedef struct {
+    int id;
+    pthread_t thread;
+    samples_t by_session[MAX_SESSIONS];
+    samples_t by_route[MAX_ROUTES];
+} client_t;
+
+typedef struct {
+    int fd;
+    char buf[READ_BUF];
+    size_t start;
+    size_t end;
+} conn_t;
+
+typedef struct {
+    char name[32];
+    double min_rps;
+    double max_p99_ms;
+    double max_reject_pct;
+} gate_line_t;
+
+typedef struct {
+    double rps;
+    double p50_ms;
+    double p99_ms;
+    double max_ms;
+    double reject_pct;
+    uint64_t requests;
+    uint64_t rejected;
+    uint64_t errors;
+} summary_t;
+
+static session_t sessions[MAX_SESSIONS];
+static int session_count = 0;
+static char routes[MAX_ROUTES][272];
+static int route_count = 0;
+
+static struct addrinfo *target_addr = NULL;
+static char target_host[128];
+static int client_count = 4;
+static double duration_s = 10.0;
+static double warmup_s = 1.0;
+static double think_scale = 0.0;
+static int64_t measure_start_us;
+static int64_t end_us;
+
+static int64_t now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static int route_index(const char *method, const char *path)
+{
+    char name[sizeof(routes[0])];
+    snprintf(name, sizeof(name), "%s %.*s", method, (int)strcspn(path, "?"), path);
+    for (int i = 0; i < route_count; i++) {
+        if (strcmp(routes[i], name) == 0) {
+            return i;
+        }
+    }
+    if (route_count == MAX_ROUTES) {
+        fprintf(stderr, "Too many routes (max %d)\n", MAX_ROUTES);
+        exit(2);
+    }
+    strcpy(routes[route_count], name);
+    return route_count++;
+}
+
+// Session file: "GET /path", "POST /path <body>", "think <ms>", '#' comments
+static void load_session(const char *file)
+{
+    if (session_count == MAX_SESSIONS) {
+        fprintf(stderr, "Too many sessions (max %d)\n", MAX_SESSIONS);
+        exit(2);
+    }
+    FILE *f = fopen(file, "r");
+    if (!f) {
+        perror(file);
+        exit(2);
+    }
+
+    session_t *session = &sessions[session_count++];
+    const char *base = strrchr(file, '/');
+    base = base ? base + 1 : file;
+    snprintf(session->name, sizeof(session->name), "%.*s", (int)strcspn(base, "."), base);
+
+    char line[1024];
+    int line_no = 0;
+    while (fgets(line, sizeof(line), f)) {
+        line_no++;
+        line[strcspn(line, "\r\n")] = '\0';
+        char *p = line + strspn(line, " \t");
+        if (*p == '\0' || *p == '#') {
+            continue;
+        }
+        if (session->step_count == MAX_STEPS) {
+            fprintf(stderr, "%s: too many steps (max %d)\n", file, MAX_STEPS);
+            exit(2);
+        }
+
+        step_t *step = &session->steps[session->step_count];
+        char word[16];
+        int used = 0;
+        if (sscanf(p, "%15s %n", word, &used) != 1) {
+            continue;
+        }
+        if (strcmp(word, "think") == 0) {
+            step->think_ms = strtoul(p + used, NULL, 10);
+        } else if (strcmp(word, "GET") == 0 || strcmp(word, "POST") == 0) {
+            strcpy(step->method, word);
+            char *path = p + used;
+            size_t path_len = strcspn(path, " \t");
+            if (path_len == 0 || path_len >= sizeof(step->path)) {
+                fprintf(stderr, "%s:%d: bad path\n", file, line_no);
+                exit(2);
+            }
+            memcpy(step->path, path, path_len);
+            char *body = path + path_len + strspn(path + path_len, " \t");
+            step->body = *body ? strdup(body) : NULL;
+            step->route = route_index(step->method, step->path);
+        } else {
+            fprintf(stderr, "%s:%d: unknown step '%s'\n", file, line_no, word);
+            exit(2);
+        }
+        session->step_count++;
+    }
+    fclose(f);
+}
+
+static void samples_add(samples_t *s, uint32_t us)
+{
+    if (s->count == s->cap) {
+        s->cap = s->cap ? s->cap * 2 : 1024;
+        s->us = realloc(s->us, s->cap * sizeof(uint32_t));
+        if (!s->us) {
+            fprintf(stderr, "Out of memory\n");
+            exit(1);
+        }
+    }
+    s->us[s->count++] = us;
+}
+
+static void samples_merge(samples_t *into, const samples_t *from)
+{
+    for (size_t i = 0; i < from->count; i++) {
+        samples_add(into, from->us[i]);
+    }
+    into->rejected += from->rejected;
+    into->errors += from->errors;
+}
+
+static int compare_u32(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+// Nearest-rank percentile of sorted samples
+static double percentile_ms(const samples_t *s, double pct)
+{
+    if (s->count == 0) {
+        return 0.0;
+    }
+    size_t rank = (size_t)ceil(pct / 100.0 * s->count);
+    if (rank < 1) {
+        rank = 1;
+    }
+    return s->us[rank - 1] / 1000.0;
+}
+
+static summary_t summarize(samples_t *s, double window_s)
+{
+    qsort(s->us, s->count, sizeof(uint32_t), compare_u32);
+    uint64_t total = s->count + s->errors;
+    summary_t sum = {
+        .rps = s->count / window_s,
+        .p50_ms = percentile_ms(s, 50.0),
+        .p99_ms = percentile_ms(s, 99.0),
+        .max_ms = s->count ? s->us[s->count - 1] / 1000.0 : 0.0,
+        .reject_pct = total ? 100.0 * s->rejected / total : 0.0,
+        .requests = s->count,
+        .rejected = s->rejected,
+        .errors = s->errors,
+    };
+    return sum;
+}
+
+static int connect_target(void)
+{
+    int fd = socket(target_addr->ai_family, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    struct timeval tv = { .tv_sec = IO_TIMEOUT_SEC };
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+    if (connect(fd, target_addr->ai_addr, target_addr->ai_addrlen) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static bool send_all(int fd, const char *data, size_t len)
+{
+    while (len > 0) {
+        ssize_t n = send(fd, data, len, MSG_NOSIGNAL);
+        if (n <= 0) {
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += n;
+        len -= n;
+    }
+    return true;
+}
+
+static bool conn_fill(conn_t *c)
+{
+    if (c->start == c->end) {
+        c->start = c->end = 0;
+    }
+    if (c->end == sizeof(c->buf)) {
+        memmove(c->buf, c->buf + c->start, c->end - c->start);
+        c->end -= c->start;
+        c->start = 0;
+    }
+    ssize_t n = recv(c->fd, c->buf + c->end, sizeof(c->buf) - c->end, 0);
+    if (n <= 0) {
+        return false;
+    }
+    c->end += n;
+    return true;
+}
+
+// Read one CRLF-terminated line (without the CRLF)
+static bool conn_line(conn_t *c, char *out, size_t out_len)
+{
+    while (true) {
+        char *nl = memchr(c->buf + c->start, '\n', c->end - c->start);
+        if (nl) {
+            size_t len = nl - (c->buf + c->start);
+            if (len > 0 && nl[-1] == '\r') {
+                len--;
+            }
+            if (len >= out_len) {
+                return false;
+            }
+            memcpy(out, c->buf + c->start, len);
+            out[len] = '\0';
+            c->start = nl + 1 - c->buf;
+            return true;
+        }
+        if (c->end - c->start >= HEADER_MAX || !conn_fill(c)) {
+            return false;
+        }
+    }
+}
+
+static bool conn_skip(conn_t *c, size_t len)
+{
+    while (len > 0) {
+        if (c->start == c->end && !conn_fill(c)) {
+            return false;
+        }
+        size_t n = c->end - c->start;
+        if (n > len) {
+            n = len;
+        }
+        c->start += n;
+        len -= n;
+    }
+    return true;
+}
+
+// Send one request and read the whole response; false on connection failure
+static bool do_request(conn_t *c, const step_t *step, int *status, bool *keep_alive)
+{
+    char head[512];
+    size_t body_len = step->body ? strlen(step->body) : 0;
+    int head_len = snprintf(head, sizeof(head),
+                            "%s %s HTTP/1.1\r\nHost: %s\r\n%s", step->method, step->path, target_host,
+                            step->body ? "Content-Type: application/json\r\n" : "");
+    head_len += snprintf(head + head_len, sizeof(head) - head_len, "Content-Length: %zu\r\n\r\n", body_len);
+    if (!send_all(c->fd, head, head_len) || (body_len && !send_all(c->fd, step->body, body_len))) {
+        return false;
+    }
+
+    char line[HEADER_MAX];
+    if (!conn_line(c, line, sizeof(line)) || sscanf(line, "HTTP/1.%*d %d", status) != 1) {
+        return false;
+    }
+
+    long content_len = -1;
+    bool chunked = false;
+    *keep_alive = true;
+    while (true) {
+        if (!conn_line(c, line, sizeof(line))) {
+            return false;
+        }
+        if (line[0] == '\0') {
+            break;
+        }
+        if (strncasecmp(line, "Content-Length:", 15) == 0) {
+            content_len = strtol(line + 15, NULL, 10);
+        } else if (strncasecmp(line, "Transfer-Encoding:", 18) == 0 && strcasestr(line, "chunked")) {
+            chunked = true;
+        } else if (strncasecmp(line, "Connection:", 11) == 0 && strcasestr(line, "close")) {
+            *keep_alive = false;
+        }
+    }
+
+    if (chunked) {
+        while (true) {
+            if (!conn_line(c, line, sizeof(line))) {
+                return false;
+            }
+            size_t size = strtoul(line, NULL, 16);
+            if (!conn_skip(c, size) || !conn_line(c, line, sizeof(line))) {
+                return false;
+            }
+            if (size == 0) {
+                break;
+            }
+        }
+    } else if (content_len >= 0) {
+        if (!conn_skip(c, content_len)) {
+            return false;
+        }
+    } else {
+        // No length: the body runs until the server closes
+        while (conn_fill(c)) {
+            c->start = c->end;
+        }
+        *keep_alive = false;
+    }
+    return true;
+}
+
+static void conn_close(conn_t *c)
+{
+    if (c->fd >= 0) {
+        close(c->fd);
+    }
+    c->fd = -1;
+    c->start = c->end = 0;
+}
+
+static void *client_task(void *arg)
+{
+    client_t *client = arg;
+    conn_t *c = calloc(1, sizeof(conn_t));
+    c->fd = -1;
+    int next_session = client->id % session_count;
+
+    while (now_us() < end_us) {
+        int s = next_session;
+        next_session = (next_session + 1) % session_count;
+        const session_t *session = &sessions[s];
+
+        // Every session is a new visitor on a new connection
+        conn_close(c);
+
+        for (int i = 0; i < session->step_count && now_us() < end_us; i++) {
+            const step_t *step = &session->steps[i];
+            if (step->method[0] == '\0') {
+                if (think_scale > 0) {
+                    usleep((useconds_t)(step->think_ms * think_scale * 1000));
+                }
+                continue;
+            }
+
+            int64_t start = now_us();
+            int status = 0;
+            bool keep_alive = false;
+            bool reused = c->fd >= 0;
+            bool ok = false;
+            if (c->fd < 0) {
+                c->fd = connect_target();
+            }
+            if (c->fd >= 0) {
+                ok = do_request(c, step, &status, &keep_alive);
+                // An idle keep-alive socket may have been purged: retry once, like browsers
+                if (!ok && reused) {
+                    conn_close(c);
+                    c->fd = connect_target();
+                    ok = c->fd >= 0 && do_request(c, step, &status, &keep_alive);
+                }
+            }
+            int64_t elapsed = now_us() - start;
+            if (!ok || !keep_alive) {
+                conn_close(c);
+            }
+
+            if (start < measure_start_us) {
+                continue;
+            }
+            samples_t *targets[2] = { &client->by_session[s], &client->by_route[step->route] };
+            for (int t = 0; t < 2; t++) {
+                if (!ok) {
+                    targets[t]->errors++;
+                    continue;
+                }
+                samples_add(targets[t], (uint32_t)elapsed);
+                if (status == 503) {
+                    targets[t]->rejected++;
+                } else if (status < 200 || status >= 300) {
+                    targets[t]->errors++;
+                }
+            }
+        }
+    }
+
+    conn_close(c);
+    free(c);
+    return NULL;
+}
+
+static int load_gate(const char *file, gate_line_t *lines)
+{
+    FILE *f = fopen(file, "r");
+    if (!f) {
+        perror(file);
+        exit(2);
+    }
+    int count = 0;
+    char line[256];
+    while (fgets(line, sizeof(line), f) && count < MAX_GATE_LINES) {
+        gate_line_t *g = &lines[count];
+        if (line[0] == '#' || sscanf(line, "%31s %lf %lf %lf", g->name, &g->min_rps,
+                                     &g->max_p99_ms, &g->max_reject_pct) != 4) {
+            continue;
+        }
+        count++;
+    }
+    fclose(f);
+    return count;
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+            "usage: %s --target HOST:PORT --session FILE [--session FILE ...] [options]\n"
+            "  --clients N           concurrent clients (default 4)\n"
+            "  --duration S          measured seconds (default 10)\n"
+            "  --warmup S            seconds before measuring (default 1)\n"
+            "  --think-scale F       scale 'think' steps (default 0: back-to-back requests)\n"
+            "  --json FILE           write the summary as JSON\n"
+            "  --gate FILE           fail if a session or 'all' misses its limits\n"
+            "  --write-baseline FILE record limits from this run\n"
+            "  --tolerance F         baseline headroom for rate and p99 (default 0.5)\n"
+            "  --p99-slack-ms F      extra p99 headroom in the baseline (default 2)\n",
+            prog);
+    exit(2);
+}
+
+int main(int argc, char **argv)
+{
+    const char *target = NULL;
+    const char *json_file = NULL;
+    const char *gate_file = NULL;
+    const char *baseline_file = NULL;
+    double tolerance = 0.5;
+    double p99_slack_ms = 2.0;
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        if (i + 1 >= argc) {
+            usage(argv[0]);
+        }
+        const char *value = argv[++i];
+        if (strcmp(arg, "--target") == 0) {
+            target = value;
+        } else if (strcmp(arg, "--session") == 0) {
+            load_session(value);
+        } else if (strcmp(arg, "--clients") == 0) {
+            client_count = atoi(value);
+        } else if (strcmp(arg, "--duration") == 0) {
+            duration_s = atof(value);
+        } else if (strcmp(arg, "--warmup") == 0) {
+            warmup_s = atof(value);
+        } else if (strcmp(arg, "--think-scale") == 0) {
+            think_scale = atof(value);
+        } else if (strcmp(arg, "--json") == 0) {
+            json_file = value;
+        } else if (strcmp(arg, "--gate") == 0) {
+            gate_file = value;
+        } else if (strcmp(arg, "--write-baseline") == 0) {
+            baseline_file = value;
+        } else if (strcmp(arg, "--tolerance") == 0) {
+            tolerance = atof(value);
+        } else if (strcmp(arg, "--p99-slack-ms") == 0) {
+            p99_slack_ms = atof(value);
+        } else {
+            usage(argv[0]);
+        }
+    }
+    if (!target || session_count == 0 || client_count < 1 || duration_s <= 0) {
+        usage(argv[0]);
+    }
+
+    const char *colon = strrchr(target, ':');
+    if (!colon || (size_t)(colon - target) >= sizeof(target_host)) {
+        usage(argv[0]);
+    }
+    snprintf(target_host, sizeof(target_host), "%.*s", (int)(colon - target), target);
+    struct addrinfo hints = { .ai_family = AF_UNSPEC, .ai_socktype = SOCK_STREAM };
+    int gai = getaddrinfo(target_host, colon + 1, &hints, &target_addr);
+    if (gai != 0) {
+        fprintf(stderr, "%s: %s\n", target, gai_strerror(gai));
+        return 2;
+    }
+
+    client_t *clients = calloc(client_count, sizeof(client_t));
+    int64_t start = now_us();
+    measure_start_us = start + (int64_t)(warmup_s * 1e6);
+    end_us = measure_start_us + (int64_t)(duration_s * 1e6);
+    for (int i = 0; i < client_count; i++) {
+        clients[i].id = i;
+        pthread_create(&clients[i].thread, NULL, client_task, &clients[i]);
+    }
+    for (int i = 0; i < client_count; i++) {
+        pthread_join(clients[i].thread, NULL);
+    }
+
+    // Requests finishing after end_us still count, so measure to the last one
+    double window_s = (now_us() - measure_start_us) / 1e6;
+
+    samples_t all = { 0 };
+    samples_t by_session[MAX_SESSIONS] = { 0 };
+    samples_t by_route[MAX_ROUTES] = { 0 };
+    for (int i = 0; i < client_count; i++) {
+        for (int s = 0; s < session_count; s++) {
+            samples_merge(&by_session[s], &clients[i].by_session[s]);
+            samples_merge(&all, &clients[i].by_session[s]);
+        }
+        for (int r = 0; r < route_count; r++) {
+            samples_merge(&by_route[r], &clients[i].by_route[r]);
+        }
+    }
+
+    summary_t all_sum = summarize(&all, window_s);
+    summary_t session_sum[MAX_SESSIONS];
+    for (int s = 0; s < session_count; s++) {
+        session_sum[s] = summarize(&by_session[s], window_s);
+    }
+
+    printf("%d clients, %.1f s measured against %s\n\n", client_count, window_s, target);
+    printf("%-32s %9s %9s %8s %8s %8s %8s %6s\n",
+           "", "requests", "req/s", "p50 ms", "p99 ms", "max ms", "503", "errors");
+    printf("%-32s %9llu %9.1f %8.2f %8.2f %8.2f %8llu %6llu\n", "all",
+           (unsigned long long)all_sum.requests, all_sum.rps, all_sum.p50_ms, all_sum.p99_ms,
+           all_sum.max_ms, (unsigned long long)all_sum.rejected, (unsigned long long)all_sum.errors);
+    for (int s = 0; s < session_count; s++) {
+        summary_t *sum = &session_sum[s];
+        printf("%-32s %9llu %9.1f %8.2f %8.2f %8.2f %8llu %6llu\n", sessions[s].name,
+               (unsigned long long)sum->requests, sum->rps, sum->p50_ms, sum->p99_ms, sum->max_ms,
+               (unsigned long long)sum->rejected, (unsigned long long)sum->errors);
+    }
+    printf("\n");
+    for (int r = 0; r < route_count; r++) {
+        summary_t sum = summarize(&by_route[r], window_s);
+        printf("  %-30s %9llu %9.1f %8.2f %8.2f %8.2f %8llu %6llu\n", routes[r],
+               (unsigned long long)sum.requests, sum.rps, sum.p50_ms, sum.p99_ms, sum.max_ms,
+               (unsigned long long)sum.rejected, (unsigned long long)sum.errors);
+    }
+
+    if (json_file) {
+        FILE *f = fopen(json_file, "w");
+        if (!f) {
+            perror(json_file);
+            return 2;
+        }
+        fprintf(f, "{\"clients\":%d,\"seconds\":%.3f,\"sessions\":{", client_count, window_s);
+        for (int s = -1; s < session_count; s++) {
+            summary_t *sum = (s < 0) ? &all_sum : &session_sum[s];
+            fprintf(f, "%s\"%s\":{\"requests\":%llu,\"rps\":%.2f,\"p50_ms\":%.3f,\"p99_ms\":%.3f,"
+                    "\"max_ms\":%.3f,\"rejected\":%llu,\"errors\":%llu}",
+                    (s < 0) ? "" : ",", (s < 0) ? "all" : sessions[s].name,
+                    (unsigned long long)sum->requests, sum->rps, sum->p50_ms, sum->p99_ms, sum->max_ms,
+                    (unsigned long long)sum->rejected, (unsigned long long)sum->errors);
+        }
+        fprintf(f, "}}\n");
+        fclose(f);
+    }
+
+    if (baseline_file) {
+        FILE *f = fopen(baseline_file, "w");
+        if (!f) {
+            perror(baseline_file);
+            return 2;
+        }
+        fprintf(f, "# Recorded by web_load (%d clients, tolerance %.2f, p99 slack %.1f ms)\n",
+                client_count, tolerance, p99_slack_ms);
+        fprintf(f, "# name min_req_per_s max_p99_ms max_503_pct\n");
+        for (int s = -1; s < session_count; s++) {
+            summary_t *sum = (s < 0) ? &all_sum : &session_sum[s];
+            fprintf(f, "%s %.1f %.2f %.1f\n", (s < 0) ? "all" : sessions[s].name,
+                    sum->rps * (1.0 - tolerance), sum->p99_ms * (1.0 + tolerance) + p99_slack_ms,
+                    sum->reject_pct * (1.0 + tolerance) + 1.0);
+        }
+        fclose(f);
+        printf("\nBaseline written to %s\n", baseline_file);
+    }
+
+    int failures = 0;
+    if (all_sum.errors > 0) {
+        printf("\nFAIL: %llu failed requests\n", (unsigned long long)all_sum.errors);
+        failures++;
+    }
+    if (gate_file) {
+        gate_line_t gate[MAX_GATE_LINES];
+        int gate_count = load_gate(gate_file, gate);
+        printf("\nGate %s:\n", gate_file);
+        for (int g = 0; g < gate_count; g++) {
+            summary_t *sum = NULL;
+            if (strcmp(gate[g].name, "all") == 0) {
+                sum = &all_sum;
+            }
+            for (int s = 0; !sum && s < session_count; s++) {
+                if (strcmp(gate[g].name, sessions[s].name) == 0) {
+                    sum = &session_sum[s];
+                }
+            }
+            if (!sum) {
+                printf("  %-12s not run\n", gate[g].name);
+                failures++;
+                continue;
+            }
+            bool rps_ok = sum->rps >= gate[g].min_rps;
+            bool p99_ok = sum->p99_ms <= gate[g].max_p99_ms;
+            bool reject_ok = sum->reject_pct <= gate[g].max_reject_pct;
+            printf("  %-12s %s  %.1f req/s (min %.1f)  p99 %.2f ms (max %.2f)  503 %.1f%% (max %.1f%%)\n",
+                   gate[g].name, (rps_ok && p99_ok && reject_ok) ? "ok  " : "FAIL",
+                   sum->rps, gate[g].min_rps, sum->p99_ms, gate[g].max_p99_ms,
+                   sum->reject_pct, gate[g].max_reject_pct);
+            if (!rps_ok || !p99_ok || !reject_ok) {
+                failures++;
+            }
+        }
+    }
+
+    freeaddrinfo(target_addr);
+    return failures ? 1 : 0;
+}
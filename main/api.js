@@ -62,6 +62,24 @@ const api = {
     return this.post(`/api/widgets/${widgetId}/config`, config);
   },
 
+  // Dashboard layout API
+  async getLayout() {
+    return this.get("/api/layout");
+  },
+
+  async setLayout(type, widgets) {
+    return this.post("/api/layout", { type: type, widgets: widgets });
+  },
+
+  // Timer API
+  async getTimers() {
+    return this.get("/api/timers");
+  },
+
+  async timerAction(name, action, options = {}) {
+    return this.post("/api/timers", { name: name, action: action, ...options });
+  },
+
   // Timezone API
   async getTimezone() {
     return this.get("/api/timezone");
@@ -89,8 +107,25 @@ const api = {
     return this.post("/api/weather/zip-code", { zip_code: zipCode });
   },
 
-  async getWeatherData() {
-    return this.get("/api/weather/data");
+  async getWeatherData(location) {
+    const query = location ? `?location=${encodeURIComponent(location)}` : "";
+    return this.get(`/api/weather/data${query}`);
+  },
+
+  async getWeatherLocations() {
+    return this.get("/api/weather/locations");
+  },
+
+  async setWeatherLocation(name, zipCode) {
+    return this.post("/api/weather/locations", { name, zip_code: zipCode });
+  },
+
+  async removeWeatherLocation(name) {
+    return this.post("/api/weather/locations", { name, remove: true });
+  },
+
+  async getWeatherForecast() {
+    return this.get("/api/weather/forecast");
   },
 
   async getWeatherTempUnit() {
@@ -100,4 +135,12 @@ const api = {
   async setWeatherTempUnit(tempUnit) {
     return this.post("/api/weather/temp-unit", { temp_unit: tempUnit });
   },
+
+  async getWeatherWindUnit() {
+    return this.get("/api/weather/wind-unit");
+  },
+
+  async setWeatherWindUnit(windUnit) {
+    return this.post("/api/weather/wind-unit", { wind_unit: windUnit });
+  },
 };
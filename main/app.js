@@ -487,11 +487,108 @@ async function initWidgetsSection() {
     if (activeWidget && activeWidget.widget_id) {
       loadWidgetConfig(activeWidget.widget_id);
     }
+
+    renderLayoutEditor(widgets, document.getElementById("layoutConfig"));
   } catch (err) {
     console.error("Error loading widgets:", err);
   }
 }
 
+// Dashboard layouts and how many widgets each one shows
+const LAYOUTS = [
+  { type: "single", name: "Single Widget", regions: ["Full screen"] },
+  { type: "split_v", name: "Top / Bottom", regions: ["Top", "Bottom"] },
+  { type: "split_h", name: "Left / Right", regions: ["Left", "Right"] },
+  {
+    type: "grid_2x2",
+    name: "2 x 2 Grid",
+    regions: ["Top left", "Top right", "Bottom left", "Bottom right"],
+  },
+];
+
+async function renderLayoutEditor(widgets, panel) {
+  if (!panel) return;
+
+  let current = { type: "single", widgets: [] };
+  try {
+    current = await api.getLayout();
+  } catch (err) {
+    console.error("Error loading layout:", err);
+  }
+
+  const renderRegions = (type, selected) => {
+    const layout = LAYOUTS.find((l) => l.type === type) || LAYOUTS[0];
+    return layout.regions
+      .map((region, i) => {
+        // New regions default to a different widget each
+        const value = selected[i] || widgets[i % widgets.length].id;
+        return `
+        <div class="config-group">
+          <label for="layoutRegion${i}">${region}</label>
+          <select id="layoutRegion${i}" class="layout-region">
+            ${widgets
+              .map(
+                (w) => `<option value="${w.id}" ${
+                  w.id === value ? "selected" : ""
+                }>${w.icon || ""} ${w.name}</option>`
+              )
+              .join("")}
+          </select>
+        </div>
+      `;
+      })
+      .join("");
+  };
+
+  panel.innerHTML = `
+    <h2>Dashboard Layout</h2>
+    <div class="config-group">
+      <label for="layoutType">Layout</label>
+      <select id="layoutType">
+        ${LAYOUTS.map(
+          (l) =>
+            `<option value="${l.type}" ${
+              l.type === current.type ? "selected" : ""
+            }>${l.name}</option>`
+        ).join("")}
+      </select>
+      <p style="color: #888; font-size: 0.8rem; margin-top: 5px;">
+        Show several widgets at once. Each widget can be used in one region.
+      </p>
+    </div>
+    <div id="layoutRegions">${renderRegions(current.type, current.widgets || [])}</div>
+    <button class="btn" onclick="saveLayout()">Apply</button>
+  `;
+
+  const typeSelect = document.getElementById("layoutType");
+  typeSelect.addEventListener("change", () => {
+    document.getElementById("layoutRegions").innerHTML = renderRegions(
+      typeSelect.value,
+      []
+    );
+  });
+
+  window.saveLayout = async function () {
+    const type = typeSelect.value;
+    const selected = Array.from(panel.querySelectorAll(".layout-region")).map(
+      (s) => s.value
+    );
+
+    if (new Set(selected).size !== selected.length) {
+      showToast("Error", "Each region needs a different widget", "error");
+      return;
+    }
+
+    try {
+      await api.setLayout(type, selected);
+      showToast("Layout Saved", "Dashboard layout applied!", "success");
+    } catch (err) {
+      showToast("Error", "Failed to save layout", "error");
+      console.error("Error saving layout:", err);
+    }
+  };
+}
+
 async function loadWidgetConfig(widgetId) {
   try {
     const config = await api.getWidgetConfig(widgetId);
@@ -599,8 +696,25 @@ function renderTimerConfig(config, panel) {
       </div>
     </div>
     <button class="btn" onclick="saveTimerConfig()">Apply</button>
+
+    <div class="config-group" style="margin-top: 20px;">
+      <label>Timers</label>
+      <div id="timerList"></div>
+      <div style="display: flex; gap: 10px;">
+        <input type="text" id="timerName" placeholder="tea" maxlength="15" />
+        <select id="timerType">
+          <option value="countdown">Countdown</option>
+          <option value="stopwatch">Stopwatch</option>
+        </select>
+        <input type="number" id="timerMinutes" placeholder="min" min="1" max="5999" value="5" style="width: 80px;" />
+        <button class="btn" onclick="addTimer()">Add</button>
+      </div>
+    </div>
   `;
 
+  const timerList = panel.querySelector("#timerList");
+  refreshTimerList(timerList);
+
   // Add toggle handlers
   panel.querySelectorAll(".toggle-group button").forEach((btn) => {
     btn.addEventListener("click", () => {
@@ -626,6 +740,82 @@ function renderTimerConfig(config, panel) {
       showToast("Error", "Failed to save timer settings", "error");
     }
   };
+
+  window.addTimer = async function () {
+    const name = document.getElementById("timerName").value.trim();
+    const type = document.getElementById("timerType").value;
+    const minutes = parseInt(document.getElementById("timerMinutes").value, 10);
+    if (!name) return;
+
+    try {
+      await api.timerAction(name, "create", {
+        type: type,
+        duration_seconds: type === "countdown" ? minutes * 60 : 0,
+      });
+      refreshTimerList(timerList);
+    } catch (err) {
+      showToast("Error", "Failed to add timer", "error");
+      console.error("Error adding timer:", err);
+    }
+  };
+}
+
+function formatTimerMs(ms) {
+  const total = Math.floor(ms / 1000);
+  const hours = Math.floor(total / 3600);
+  const minutes = Math.floor((total % 3600) / 60);
+  const seconds = String(total % 60).padStart(2, "0");
+  return hours > 0
+    ? `${hours}:${String(minutes).padStart(2, "0")}:${seconds}`
+    : `${minutes}:${seconds}`;
+}
+
+// Timer rows with start/pause/reset/delete; built with DOM calls since
+// names may contain quotes
+async function refreshTimerList(list) {
+  if (!list) return;
+
+  let timers = [];
+  try {
+    timers = (await api.getTimers()).timers || [];
+  } catch (err) {
+    console.error("Error loading timers:", err);
+  }
+
+  list.innerHTML = "";
+  timers.forEach((timer) => {
+    const row = document.createElement("div");
+    row.style.cssText =
+      "display: flex; gap: 10px; align-items: center; margin-bottom: 5px;";
+
+    const label = document.createElement("span");
+    label.style.flex = "1";
+    const value =
+      timer.type === "countdown" ? timer.remaining_ms : timer.elapsed_ms;
+    label.textContent = `${timer.name} (${timer.state}, ${formatTimerMs(
+      value || 0
+    )})`;
+    row.appendChild(label);
+
+    const actions = [timer.state === "running" ? "pause" : "start", "reset", "delete"];
+    actions.forEach((action) => {
+      const btn = document.createElement("button");
+      btn.className = "btn";
+      btn.textContent = action.charAt(0).toUpperCase() + action.slice(1);
+      btn.addEventListener("click", async () => {
+        try {
+          await api.timerAction(timer.name, action);
+          refreshTimerList(list);
+        } catch (err) {
+          showToast("Error", `Failed to ${action} timer`, "error");
+          console.error("Error changing timer:", err);
+        }
+      });
+      row.appendChild(btn);
+    });
+
+    list.appendChild(row);
+  });
 }
 
 function renderWeatherConfig(config, panel) {
@@ -636,9 +826,22 @@ function renderWeatherConfig(config, panel) {
     try {
       const zipData = await api.getWeatherZipCode();
       const tempUnitData = await api.getWeatherTempUnit();
+      const windUnitData = await api.getWeatherWindUnit();
+      const locationsData = await api.getWeatherLocations();
 
       const zipCode = zipData.zip_code || "";
       const tempUnit = tempUnitData.temp_unit || "celsius";
+      const windUnit = windUnitData.wind_unit || "kmh";
+      const others = (locationsData.locations || []).filter((l) => !l.primary);
+      const locationRows = others
+        .map(
+          (l) => `
+            <div style="display: flex; gap: 10px; align-items: center; margin-bottom: 5px;">
+              <span style="flex: 1;">${l.name} (${l.zip_code})</span>
+              <button class="btn" onclick="removeWeatherLocation('${l.name}')">Remove</button>
+            </div>`
+        )
+        .join("");
 
       panel.innerHTML = `
         <h2>Weather Settings</h2>
@@ -671,8 +874,45 @@ function renderWeatherConfig(config, panel) {
             Select the temperature unit for weather display.
           </p>
         </div>
+
+        <div class="config-group">
+          <label for="weatherWindUnit">Wind Speed Unit</label>
+          <select id="weatherWindUnit" name="weather_wind_unit">
+            <option value="kmh" ${
+              windUnit === "kmh" ? "selected" : ""
+            }>Kilometers per hour (km/h)</option>
+            <option value="mph" ${
+              windUnit === "mph" ? "selected" : ""
+            }>Miles per hour (mph)</option>
+            <option value="ms" ${
+              windUnit === "ms" ? "selected" : ""
+            }>Meters per second (m/s)</option>
+          </select>
+        </div>
+
+        <div class="config-group">
+          <label>Other Locations</label>
+          ${locationRows}
+          <div style="display: flex; gap: 10px;">
+            <input type="text" id="weatherLocationName" placeholder="office" maxlength="15" />
+            <input type="text" id="weatherLocationZip" placeholder="10001" maxlength="31" />
+            <button class="btn" onclick="addWeatherLocation()">Add</button>
+          </div>
+          <p style="color: #888; font-size: 0.8rem; margin-top: 5px;">
+            Shown under the main location on the weather widget (up to ${
+              (locationsData.max || 4) - 1
+            }).
+          </p>
+        </div>
+
+        <div class="config-group">
+          <label>Forecast</label>
+          <div id="weatherForecast" style="color: #888;">Loading...</div>
+        </div>
         <button class="btn" onclick="saveWeatherConfig()">Apply</button>
       `;
+
+      renderWeatherForecast(panel.querySelector("#weatherForecast"));
     } catch (err) {
       console.error("Error loading weather config:", err);
       panel.innerHTML = `
@@ -701,20 +941,55 @@ function renderWeatherConfig(config, panel) {
             Select the temperature unit for weather display.
           </p>
         </div>
+
+        <div class="config-group">
+          <label for="weatherWindUnit">Wind Speed Unit</label>
+          <select id="weatherWindUnit" name="weather_wind_unit">
+            <option value="kmh" selected>Kilometers per hour (km/h)</option>
+            <option value="mph">Miles per hour (mph)</option>
+            <option value="ms">Meters per second (m/s)</option>
+          </select>
+        </div>
         <button class="btn" onclick="saveWeatherConfig()">Apply</button>
       `;
     }
   })();
 
+  window.addWeatherLocation = async function () {
+    const name = document.getElementById("weatherLocationName").value.trim();
+    const zipCode = document.getElementById("weatherLocationZip").value.trim();
+    if (!name || !zipCode) return;
+
+    try {
+      await api.setWeatherLocation(name, zipCode);
+      renderWeatherConfig(config, panel);
+    } catch (err) {
+      showToast("Error", "Failed to add location", "error");
+      console.error("Error adding weather location:", err);
+    }
+  };
+
+  window.removeWeatherLocation = async function (name) {
+    try {
+      await api.removeWeatherLocation(name);
+      renderWeatherConfig(config, panel);
+    } catch (err) {
+      showToast("Error", "Failed to remove location", "error");
+      console.error("Error removing weather location:", err);
+    }
+  };
+
   window.saveWeatherConfig = async function () {
     const zipCode = document.getElementById("weatherZipCode").value.trim();
     const tempUnit = document.getElementById("weatherTempUnit").value;
+    const windUnit = document.getElementById("weatherWindUnit").value;
 
     try {
       if (zipCode) {
         await api.setWeatherZipCode(zipCode);
       }
       await api.setWeatherTempUnit(tempUnit);
+      await api.setWeatherWindUnit(windUnit);
       showToast(
         "Settings Saved",
         "Weather settings saved successfully!",
@@ -727,6 +1002,42 @@ function renderWeatherConfig(config, panel) {
   };
 }
 
+// Daily forecast stored on the device for the zip code location
+async function renderWeatherForecast(el) {
+  if (!el) return;
+
+  try {
+    const forecast = await api.getWeatherForecast();
+    const days = forecast.daily || [];
+    if (days.length === 0) {
+      el.textContent = "No forecast yet.";
+      return;
+    }
+
+    const unit = forecast.temp_unit === "fahrenheit" ? "°F" : "°C";
+    el.innerHTML = days
+      .map((day) => {
+        // day.time is local midnight at the location; noon UTC of it names the day
+        const date = new Date((day.time + 43200) * 1000).toLocaleDateString(undefined, {
+          weekday: "short",
+          timeZone: "UTC",
+        });
+        return `
+          <div style="display: flex; gap: 10px; margin-bottom: 3px;">
+            <span style="width: 50px;">${date}</span>
+            <span style="flex: 1;">${Math.round(day.temperature_max)}${unit} / ${Math.round(
+          day.temperature_min
+        )}${unit}</span>
+            <span>${day.precipitation_probability}% rain</span>
+          </div>`;
+      })
+      .join("");
+  } catch (err) {
+    el.textContent = "Forecast unavailable.";
+    console.error("Error loading weather forecast:", err);
+  }
+}
+
 // Settings section initialization
 async function initSettingsSection() {
   try {
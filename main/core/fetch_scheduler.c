@@ -0,0 +1,112 @@
+#include "fetch_scheduler.h"
+#include <string.h>
+
+// xorshift32 - enough to spread retries from many devices apart
+static uint32_t next_random(fetch_scheduler_t *sched)
+{
+    uint32_t x = sched->rng;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    sched->rng = x;
+    return x;
+}
+
+void fetch_scheduler_init(fetch_scheduler_t *sched, const fetch_policy_t *policy, uint32_t seed)
+{
+    memset(sched, 0, sizeof(*sched));
+    sched->policy = *policy;
+    sched->rng = seed ? seed : 0x9E3779B9u;
+}
+
+// When the next fetch is due, ignoring in_flight
+static int64_t due_at(const fetch_scheduler_t *sched)
+{
+    if (sched->failures > 0) {
+        return sched->retry_at;
+    }
+    if (!sched->has_data || sched->requested) {
+        return INT64_MIN;
+    }
+    return sched->last_success + sched->policy.soft_ttl;
+}
+
+void fetch_scheduler_request(fetch_scheduler_t *sched, int64_t now)
+{
+    // Fresh data or the fetch in flight satisfies the request; otherwise
+    // the next due fetch does
+    if (!sched->in_flight && fetch_scheduler_data_state(sched, now) != FETCH_DATA_FRESH) {
+        sched->requested = true;
+    }
+}
+
+void fetch_scheduler_invalidate(fetch_scheduler_t *sched)
+{
+    sched->has_data = false;
+    sched->failures = 0;
+    sched->retry_at = 0;
+    sched->requested = true;
+}
+
+bool fetch_scheduler_begin(fetch_scheduler_t *sched, int64_t now)
+{
+    if (sched->in_flight || now < due_at(sched)) {
+        return false;
+    }
+    sched->in_flight = true;
+    sched->requested = false;
+    return true;
+}
+
+void fetch_scheduler_complete(fetch_scheduler_t *sched, int64_t now, bool success)
+{
+    sched->in_flight = false;
+
+    if (success) {
+        sched->has_data = true;
+        sched->last_success = now;
+        sched->failures = 0;
+        return;
+    }
+
+    // Exponential backoff with "equal jitter": half fixed, half random
+    uint32_t delay = sched->policy.backoff_min;
+    for (uint32_t i = 0; i < sched->failures && delay < sched->policy.backoff_max; i++) {
+        delay *= 2;
+    }
+    if (delay > sched->policy.backoff_max) {
+        delay = sched->policy.backoff_max;
+    }
+    uint32_t half = delay / 2;
+    delay = half + next_random(sched) % (delay - half + 1);
+
+    sched->failures++;
+    sched->retry_at = now + delay;
+}
+
+uint32_t fetch_scheduler_next_delay(const fetch_scheduler_t *sched, int64_t now)
+{
+    if (sched->in_flight) {
+        return UINT32_MAX;
+    }
+    int64_t due = due_at(sched);
+    if (due <= now) {
+        return 0;
+    }
+    return due - now > UINT32_MAX ? UINT32_MAX : (uint32_t)(due - now);
+}
+
+fetch_data_state_t fetch_scheduler_data_state(const fetch_scheduler_t *sched, int64_t now)
+{
+    if (!sched->has_data) {
+        return FETCH_DATA_NONE;
+    }
+    int64_t age = now - sched->last_success;
+    if (age >= sched->policy.hard_ttl) {
+        return FETCH_DATA_EXPIRED;
+    }
+    if (age >= sched->policy.soft_ttl) {
+        return FETCH_DATA_STALE;
+    }
+    return FETCH_DATA_FRESH;
+}
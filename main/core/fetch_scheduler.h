@@ -0,0 +1,98 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Refresh policy for a cached remote resource
+ * Data is fresh until the soft TTL, then still served while a refresh
+ * runs in the background, and unusable after the hard TTL. Failed
+ * fetches back off exponentially with jitter, and any number of
+ * requests while one is due or in flight collapse into one fetch.
+ *
+ * The scheduler is plain state with the clock passed in (monotonic
+ * seconds), so it can be driven by a simulated clock. It does no
+ * locking; the owner serializes calls.
+ */
+
+/**
+ * @brief Timing policy (seconds)
+ */
+typedef struct {
+    uint32_t soft_ttl;          // Refresh after this
+    uint32_t hard_ttl;          // Stop serving after this
+    uint32_t backoff_min;       // First retry delay
+    uint32_t backoff_max;       // Retry delay cap
+} fetch_policy_t;
+
+/**
+ * @brief Freshness of the last successful fetch
+ */
+typedef enum {
+    FETCH_DATA_NONE = 0,        // Never fetched (or invalidated)
+    FETCH_DATA_FRESH = 1,
+    FETCH_DATA_STALE = 2,       // Past soft TTL, still served
+    FETCH_DATA_EXPIRED = 3      // Past hard TTL
+} fetch_data_state_t;
+
+typedef struct {
+    fetch_policy_t policy;
+    bool has_data;
+    int64_t last_success;       // When the data was fetched
+    int64_t retry_at;           // Earliest next attempt while backing off
+    uint32_t failures;          // Consecutive failures
+    bool requested;             // Someone asked for fresh data
+    bool in_flight;
+    uint32_t rng;               // Jitter state
+} fetch_scheduler_t;
+
+/**
+ * @brief Initialize a scheduler (no data, first fetch due at once)
+ * @param sched Scheduler
+ * @param policy Timing policy
+ * @param seed Jitter seed (non-zero)
+ */
+void fetch_scheduler_init(fetch_scheduler_t *sched, const fetch_policy_t *policy, uint32_t seed);
+
+/**
+ * @brief Ask for fresh data
+ * Fetches now unless the data is fresh, a fetch is in flight, or a
+ * failed fetch is backing off. Repeated requests are coalesced.
+ */
+void fetch_scheduler_request(fetch_scheduler_t *sched, int64_t now);
+
+/**
+ * @brief Forget the data and any backoff (e.g. the location changed)
+ */
+void fetch_scheduler_invalidate(fetch_scheduler_t *sched);
+
+/**
+ * @brief Check if a fetch should start now, and mark it in flight if so
+ * @return true if the caller should fetch and then call fetch_scheduler_complete
+ */
+bool fetch_scheduler_begin(fetch_scheduler_t *sched, int64_t now);
+
+/**
+ * @brief Record the result of a fetch started with fetch_scheduler_begin
+ * @param success true if fresh data was stored
+ */
+void fetch_scheduler_complete(fetch_scheduler_t *sched, int64_t now, bool success);
+
+/**
+ * @brief Seconds until the next fetch is due
+ * @return 0 if due now, UINT32_MAX while a fetch is in flight
+ */
+uint32_t fetch_scheduler_next_delay(const fetch_scheduler_t *sched, int64_t now);
+
+/**
+ * @brief Freshness of the data at a time
+ */
+fetch_data_state_t fetch_scheduler_data_state(const fetch_scheduler_t *sched, int64_t now);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,146 @@
+#include "geocode_cache.h"
+#include "sd_database.h"
+#include "esp_log.h"
+#include "esp_rom_crc.h"
+#include "freertos/FreeRTOS.h"
+#include <string.h>
+#include <stdlib.h>
+#include <ctype.h>
+#include <stddef.h>
+
+static const char *TAG = "geocode_cache";
+
+#define GEOCODE_MAGIC       0x47454F43  // "GEOC"
+#define GEOCODE_VERSION     1
+#define GEOCODE_BLOB_KEY    "wx_geo"
+
+typedef struct {
+    uint32_t magic;
+    uint8_t version;
+    uint8_t count;
+    uint16_t reserved;
+    uint32_t use_counter;       // Source of last_used values
+    geocode_entry_t entries[GEOCODE_CACHE_SIZE];
+    uint32_t crc;
+} geocode_table_t;
+
+static geocode_table_t table;
+static portMUX_TYPE table_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static uint32_t table_crc(const geocode_table_t *t)
+{
+    return esp_rom_crc32_le(0, (const uint8_t *)t, offsetof(geocode_table_t, crc));
+}
+
+// Lowercase and trim, so " 90210" and "Paris " / "paris" share an entry
+static void normalize(const char *query, char *out, size_t len)
+{
+    while (*query && isspace((unsigned char)*query)) {
+        query++;
+    }
+    size_t n = 0;
+    for (; query[n] && n < len - 1; n++) {
+        out[n] = (char)tolower((unsigned char)query[n]);
+    }
+    while (n > 0 && isspace((unsigned char)out[n - 1])) {
+        n--;
+    }
+    out[n] = '\0';
+}
+
+static int find(const char *key)
+{
+    for (int i = 0; i < table.count; i++) {
+        if (strcmp(table.entries[i].query, key) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void geocode_cache_init(void)
+{
+    memset(&table, 0, sizeof(table));
+    table.magic = GEOCODE_MAGIC;
+    table.version = GEOCODE_VERSION;
+
+    if (!sd_db_is_ready()) {
+        return;
+    }
+
+    geocode_table_t stored;
+    size_t len = sizeof(stored);
+    if (sd_db_get_blob(GEOCODE_BLOB_KEY, &stored, &len) != ESP_OK) {
+        return;
+    }
+    if (len != sizeof(stored) || stored.magic != GEOCODE_MAGIC || stored.version != GEOCODE_VERSION ||
+        stored.count > GEOCODE_CACHE_SIZE || stored.crc != table_crc(&stored)) {
+        ESP_LOGW(TAG, "Ignoring stored geocode table (old format or corrupt)");
+        return;
+    }
+
+    portENTER_CRITICAL(&table_lock);
+    table = stored;
+    portEXIT_CRITICAL(&table_lock);
+    ESP_LOGI(TAG, "Loaded %d geocoded locations", stored.count);
+}
+
+esp_err_t geocode_cache_lookup(const char *query, geocode_entry_t *entry)
+{
+    if (!query || !entry) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    char key[GEOCODE_QUERY_LEN];
+    normalize(query, key, sizeof(key));
+
+    portENTER_CRITICAL(&table_lock);
+    int i = find(key);
+    if (i >= 0) {
+        // Recency is saved with the next store, not on every hit
+        table.entries[i].last_used = ++table.use_counter;
+        *entry = table.entries[i];
+    }
+    portEXIT_CRITICAL(&table_lock);
+
+    return i >= 0 ? ESP_OK : ESP_ERR_NOT_FOUND;
+}
+
+void geocode_cache_store(const char *query, const geocode_entry_t *entry)
+{
+    if (!query || !entry) {
+        return;
+    }
+
+    geocode_entry_t copy = *entry;
+    normalize(query, copy.query, sizeof(copy.query));
+
+    geocode_table_t *snapshot = malloc(sizeof(geocode_table_t));
+    if (!snapshot) {
+        return;
+    }
+
+    portENTER_CRITICAL(&table_lock);
+    int i = find(copy.query);
+    if (i < 0 && table.count < GEOCODE_CACHE_SIZE) {
+        i = table.count++;
+    } else if (i < 0) {
+        // Evict the least recently used location
+        i = 0;
+        for (int j = 1; j < table.count; j++) {
+            if (table.entries[j].last_used < table.entries[i].last_used) {
+                i = j;
+            }
+        }
+    }
+    copy.last_used = ++table.use_counter;
+    table.entries[i] = copy;
+    table.crc = table_crc(&table);
+    *snapshot = table;
+    portEXIT_CRITICAL(&table_lock);
+
+    if (sd_db_is_ready()) {
+        sd_db_set_blob(GEOCODE_BLOB_KEY, snapshot, sizeof(*snapshot));
+    }
+    free(snapshot);
+}
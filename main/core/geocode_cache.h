@@ -0,0 +1,60 @@
+#pragma once
+
+#include "esp_err.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Persisted geocoding results
+ * Maps a location string (zip code or place name) to its coordinates,
+ * resolved name and timezone, so a location is geocoded once rather than
+ * on every boot. Holds the GEOCODE_CACHE_SIZE most recently used
+ * locations and is stored as one sd_database blob.
+ *
+ * All functions are thread-safe.
+ */
+
+#define GEOCODE_CACHE_SIZE      8
+#define GEOCODE_QUERY_LEN       32
+#define GEOCODE_NAME_LEN        40
+#define GEOCODE_TIMEZONE_LEN    40
+
+/**
+ * @brief A resolved location
+ */
+typedef struct {
+    char query[GEOCODE_QUERY_LEN];          // Normalized location string
+    float latitude;
+    float longitude;
+    char name[GEOCODE_NAME_LEN];            // e.g. "Beverly Hills"
+    char timezone[GEOCODE_TIMEZONE_LEN];    // e.g. "America/Los_Angeles"
+    uint32_t last_used;                     // LRU order (higher is more recent)
+} geocode_entry_t;
+
+/**
+ * @brief Load the stored table
+ */
+void geocode_cache_init(void);
+
+/**
+ * @brief Look up a location string (case and surrounding spaces are ignored)
+ * @param query Location string
+ * @param entry Output entry
+ * @return ESP_OK on a hit, ESP_ERR_NOT_FOUND on a miss
+ */
+esp_err_t geocode_cache_lookup(const char *query, geocode_entry_t *entry);
+
+/**
+ * @brief Add or update a location, evicting the least recently used one
+ * @param query Location string
+ * @param entry Resolved location (query and last_used are filled in)
+ */
+void geocode_cache_store(const char *query, const geocode_entry_t *entry);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,127 @@
+#include "http_worker.h"
+#include "esp_log.h"
+#include <stdio.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+
+static const char *TAG = "http_worker";
+
+// Worker pool configuration
+#define HTTP_WORKER_COUNT        2     // Max slow jobs running at once
+#define HTTP_WORKER_BACKLOG      2     // Max slow jobs waiting for a worker
+#define HTTP_WORKER_STACK_SIZE   6144
+#define HTTP_WORKER_PRIORITY     4     // Below the httpd task (5) so it keeps serving
+
+typedef struct {
+    httpd_req_t *req;                // Async copy owned by the worker
+    http_worker_handler_t handler;
+} http_worker_job_t;
+
+static QueueHandle_t job_queue = NULL;
+static SemaphoreHandle_t job_slots = NULL;  // Running + queued jobs
+static bool workers_running = false;
+
+// Worker task: runs detached requests one at a time
+static void http_worker_task(void *pvParameters)
+{
+    (void)pvParameters;
+
+    http_worker_job_t job;
+    while (true) {
+        if (xQueueReceive(job_queue, &job, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+
+        esp_err_t ret = job.handler(job.req);
+        if (ret != ESP_OK) {
+            ESP_LOGW(TAG, "Handler for %s returned %s", job.req->uri, esp_err_to_name(ret));
+        }
+
+        // Hand the socket back to the httpd task
+        httpd_req_async_handler_complete(job.req);
+        xSemaphoreGive(job_slots);
+    }
+}
+
+esp_err_t http_worker_start(void)
+{
+    if (workers_running) {
+        return ESP_OK;
+    }
+
+    const int total_slots = HTTP_WORKER_COUNT + HTTP_WORKER_BACKLOG;
+
+    // Queue holds every slot, so a job that got a slot can always be queued
+    job_queue = xQueueCreate(total_slots, sizeof(http_worker_job_t));
+    job_slots = xSemaphoreCreateCounting(total_slots, total_slots);
+    if (job_queue == NULL || job_slots == NULL) {
+        ESP_LOGE(TAG, "Failed to create worker queue");
+        return ESP_ERR_NO_MEM;
+    }
+
+    for (int i = 0; i < HTTP_WORKER_COUNT; i++) {
+        char name[16];
+        snprintf(name, sizeof(name), "http_worker%d", i);
+        if (xTaskCreate(http_worker_task, name, HTTP_WORKER_STACK_SIZE, NULL,
+                        HTTP_WORKER_PRIORITY, NULL) != pdPASS) {
+            ESP_LOGE(TAG, "Failed to create worker task %d", i);
+            return ESP_FAIL;
+        }
+    }
+
+    workers_running = true;
+    ESP_LOGI(TAG, "Started %d HTTP workers (backlog %d)", HTTP_WORKER_COUNT, HTTP_WORKER_BACKLOG);
+    return ESP_OK;
+}
+
+esp_err_t http_worker_submit(httpd_req_t *req, http_worker_handler_t handler)
+{
+    if (!req || !handler) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // Without workers, behave like a regular synchronous handler
+    if (!workers_running) {
+        return handler(req);
+    }
+
+    // Reserve a slot before detaching so we can still answer on the httpd task
+    if (xSemaphoreTake(job_slots, 0) != pdTRUE) {
+        ESP_LOGW(TAG, "Worker pool busy, rejecting %s", req->uri);
+        httpd_resp_set_status(req, "503 Service Unavailable");
+        httpd_resp_set_hdr(req, "Retry-After", "1");
+        httpd_resp_set_type(req, "application/json");
+        httpd_resp_sendstr(req, "{\"status\":\"busy\"}");
+        return ESP_ERR_TIMEOUT;
+    }
+
+    httpd_req_t *async_req = NULL;
+    esp_err_t ret = httpd_req_async_handler_begin(req, &async_req);
+    if (ret != ESP_OK) {
+        xSemaphoreGive(job_slots);
+        ESP_LOGE(TAG, "Failed to detach request %s: %s", req->uri, esp_err_to_name(ret));
+        httpd_resp_send_500(req);
+        return ESP_FAIL;
+    }
+
+    http_worker_job_t job = {
+        .req = async_req,
+        .handler = handler
+    };
+
+    if (xQueueSend(job_queue, &job, 0) != pdTRUE) {
+        // Cannot happen while the queue is sized to the slot count
+        httpd_req_async_handler_complete(async_req);
+        xSemaphoreGive(job_slots);
+        return ESP_FAIL;
+    }
+
+    return ESP_OK;
+}
+
+bool http_worker_is_running(void)
+{
+    return workers_running;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "esp_err.h"
+#include "esp_http_server.h"
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief HTTP worker pool
+ * Runs slow request handlers outside the httpd task using the
+ * esp_http_server async request API, so static files and status
+ * requests stay responsive while heavy operations are in progress.
+ */
+
+/**
+ * @brief Handler executed by a worker for a detached request
+ * @param req Async copy of the request (valid until the handler returns)
+ * @return ESP_OK on success
+ */
+typedef esp_err_t (*http_worker_handler_t)(httpd_req_t *req);
+
+/**
+ * @brief Start the worker tasks
+ * Must be called once before http_worker_submit()
+ * @return ESP_OK on success
+ */
+esp_err_t http_worker_start(void);
+
+/**
+ * @brief Hand a request over to the worker pool
+ * The request is detached from the httpd task and queued for a worker.
+ * If the pool is saturated a 503 response is sent instead.
+ * If the pool is not running, the handler is executed inline.
+ * @param req Request received by the httpd task
+ * @param handler Handler to run on the worker
+ * @return ESP_OK if the request was queued or handled inline,
+ *         ESP_ERR_TIMEOUT if the pool was busy and a 503 was sent
+ */
+esp_err_t http_worker_submit(httpd_req_t *req, http_worker_handler_t handler);
+
+/**
+ * @brief Check if the worker pool is running
+ * @return true if workers are started
+ */
+bool http_worker_is_running(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,387 @@
+#include "json_stream.h"
+#include <string.h>
+#include <stdlib.h>
+
+enum {
+    JS_VALUE = 0,           // Expecting a value
+    JS_VALUE_OR_END,        // After '[': a value or ']'
+    JS_KEY_OR_END,          // After '{': a key or '}'
+    JS_KEY,                 // After ',' in an object
+    JS_COLON,
+    JS_AFTER_VALUE,         // Expecting ',' or a closing bracket
+    JS_STRING,
+    JS_ESCAPE,
+    JS_UNICODE,
+    JS_BARE                 // Number, true, false or null
+};
+
+void json_stream_init(json_stream_t *js, json_stream_cb_t cb, void *user_data)
+{
+    js->cb = cb;
+    js->user_data = user_data;
+    json_stream_reset(js);
+}
+
+void json_stream_reset(json_stream_t *js)
+{
+    js->state = JS_VALUE;
+    js->is_key = false;
+    js->done = false;
+    js->error = false;
+    js->depth = 0;
+    js->path[0] = '\0';
+    js->path_len = 0;
+    js->path_truncated = false;
+    js->token_len = 0;
+    js->token_truncated = false;
+}
+
+static void path_set_len(json_stream_t *js, uint16_t len)
+{
+    js->path_len = len;
+    js->path[len] = '\0';
+}
+
+static void path_append(json_stream_t *js, const char *text, size_t len)
+{
+    size_t room = sizeof(js->path) - 1 - js->path_len;
+    if (len > room) {
+        len = room;
+        js->path_truncated = true;
+    }
+    memcpy(js->path + js->path_len, text, len);
+    path_set_len(js, js->path_len + len);
+}
+
+static void token_add(json_stream_t *js, char c)
+{
+    if (js->token_len < sizeof(js->token) - 1) {
+        js->token[js->token_len++] = c;
+    } else {
+        js->token_truncated = true;
+    }
+}
+
+static json_stream_frame_t* top(json_stream_t *js)
+{
+    return js->depth > 0 ? &js->stack[js->depth - 1] : NULL;
+}
+
+// Index of the element being read in the innermost enclosing array
+static int current_index(json_stream_t *js)
+{
+    for (int i = js->depth - 1; i >= 0; i--) {
+        if (js->stack[i].array) {
+            return js->stack[i].index;
+        }
+    }
+    return -1;
+}
+
+// A value starts: inside an array its path is the array's path + "[]"
+static void begin_value(json_stream_t *js)
+{
+    json_stream_frame_t *frame = top(js);
+    if (frame && frame->array) {
+        frame->index++;
+        path_set_len(js, frame->path_len);
+        path_append(js, "[]", 2);
+    }
+}
+
+static void value_done(json_stream_t *js)
+{
+    js->state = JS_AFTER_VALUE;
+    if (js->depth == 0) {
+        js->done = true;
+    }
+}
+
+static void emit(json_stream_t *js, json_stream_type_t type)
+{
+    js->token[js->token_len] = '\0';
+    if (js->cb) {
+        json_stream_value_t value = {
+            .path = js->path,
+            .type = type,
+            .text = js->token,
+            .len = js->token_len,
+            .index = current_index(js),
+            .outer_index = (js->depth > 0 && js->stack[0].array) ? js->stack[0].index : -1,
+            .truncated = js->token_truncated || js->path_truncated,
+        };
+        js->cb(&value, js->user_data);
+    }
+    js->token_len = 0;
+    js->token_truncated = false;
+}
+
+static bool push(json_stream_t *js, bool array)
+{
+    if (js->depth >= JSON_STREAM_MAX_DEPTH) {
+        return false;
+    }
+    js->stack[js->depth++] = (json_stream_frame_t) {
+        .array = array,
+        .index = -1,
+        .path_len = js->path_len,
+    };
+    js->state = array ? JS_VALUE_OR_END : JS_KEY_OR_END;
+    return true;
+}
+
+static bool close_container(json_stream_t *js, char c)
+{
+    json_stream_frame_t *frame = top(js);
+    if (!frame || frame->array != (c == ']')) {
+        return false;
+    }
+    js->depth--;
+    value_done(js);
+    return true;
+}
+
+static bool finish_bare(json_stream_t *js)
+{
+    js->token[js->token_len] = '\0';
+    const char *t = js->token;
+
+    json_stream_type_t type;
+    if (strcmp(t, "true") == 0 || strcmp(t, "false") == 0) {
+        type = JSON_STREAM_BOOL;
+    } else if (strcmp(t, "null") == 0) {
+        type = JSON_STREAM_NULL;
+    } else {
+        char *end = NULL;
+        strtod(t, &end);
+        if (js->token_len == 0 || js->token_truncated || end != t + js->token_len) {
+            return false;
+        }
+        type = JSON_STREAM_NUMBER;
+    }
+
+    emit(js, type);
+    value_done(js);
+    return true;
+}
+
+static void append_utf8(json_stream_t *js, uint32_t cp)
+{
+    if (cp < 0x80) {
+        token_add(js, (char)cp);
+    } else if (cp < 0x800) {
+        token_add(js, (char)(0xC0 | (cp >> 6)));
+        token_add(js, (char)(0x80 | (cp & 0x3F)));
+    } else if (cp >= 0xD800 && cp <= 0xDFFF) {
+        token_add(js, '?');     // Surrogate pairs are not combined
+    } else {
+        token_add(js, (char)(0xE0 | (cp >> 12)));
+        token_add(js, (char)(0x80 | ((cp >> 6) & 0x3F)));
+        token_add(js, (char)(0x80 | (cp & 0x3F)));
+    }
+}
+
+static bool is_space(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+static bool is_bare_char(char c)
+{
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+           c == '-' || c == '+' || c == '.';
+}
+
+static int hex_value(char c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// Process one character. Returns false on a syntax error. *reprocess is
+// set when the character ended a bare token and must be read again.
+static bool step(json_stream_t *js, char c, bool *reprocess)
+{
+    switch (js->state) {
+        case JS_VALUE_OR_END:
+            if (c == ']') {
+                return close_container(js, c);
+            }
+            // fall through
+        case JS_VALUE:
+            if (is_space(c)) {
+                return true;
+            }
+            begin_value(js);
+            if (c == '"') {
+                js->is_key = false;
+                js->state = JS_STRING;
+                return true;
+            }
+            if (c == '{' || c == '[') {
+                return push(js, c == '[');
+            }
+            if (c == '-' || (c >= '0' && c <= '9') || c == 't' || c == 'f' || c == 'n') {
+                token_add(js, c);
+                js->state = JS_BARE;
+                return true;
+            }
+            return false;
+
+        case JS_KEY_OR_END:
+            if (c == '}') {
+                return close_container(js, c);
+            }
+            // fall through
+        case JS_KEY:
+            if (is_space(c)) {
+                return true;
+            }
+            if (c == '"') {
+                js->is_key = true;
+                js->state = JS_STRING;
+                return true;
+            }
+            return false;
+
+        case JS_COLON:
+            if (is_space(c)) {
+                return true;
+            }
+            if (c == ':') {
+                js->state = JS_VALUE;
+                return true;
+            }
+            return false;
+
+        case JS_AFTER_VALUE:
+            if (is_space(c)) {
+                return true;
+            }
+            if (js->done) {
+                return false;   // Data after the root value
+            }
+            if (c == ',') {
+                js->state = top(js)->array ? JS_VALUE : JS_KEY;
+                return true;
+            }
+            if (c == '}' || c == ']') {
+                return close_container(js, c);
+            }
+            return false;
+
+        case JS_STRING:
+            if (c == '\\') {
+                js->state = JS_ESCAPE;
+                return true;
+            }
+            if (c == '"') {
+                if (js->is_key) {
+                    // The member's path is the object's path + "." + key
+                    uint16_t base = top(js)->path_len;
+                    path_set_len(js, base);
+                    if (base > 0) {
+                        path_append(js, ".", 1);
+                    }
+                    path_append(js, js->token, js->token_len);
+                    js->token_len = 0;
+                    js->token_truncated = false;
+                    js->state = JS_COLON;
+                } else {
+                    emit(js, JSON_STREAM_STRING);
+                    value_done(js);
+                }
+                return true;
+            }
+            if ((unsigned char)c < 0x20) {
+                return false;
+            }
+            token_add(js, c);
+            return true;
+
+        case JS_ESCAPE: {
+            char out;
+            switch (c) {
+                case '"': case '\\': case '/': out = c; break;
+                case 'b': out = '\b'; break;
+                case 'f': out = '\f'; break;
+                case 'n': out = '\n'; break;
+                case 'r': out = '\r'; break;
+                case 't': out = '\t'; break;
+                case 'u':
+                    js->unicode_digits = 0;
+                    js->unicode_value = 0;
+                    js->state = JS_UNICODE;
+                    return true;
+                default:
+                    return false;
+            }
+            token_add(js, out);
+            js->state = JS_STRING;
+            return true;
+        }
+
+        case JS_UNICODE: {
+            int digit = hex_value(c);
+            if (digit < 0) {
+                return false;
+            }
+            js->unicode_value = (js->unicode_value << 4) | (uint32_t)digit;
+            if (++js->unicode_digits == 4) {
+                append_utf8(js, js->unicode_value);
+                js->state = JS_STRING;
+            }
+            return true;
+        }
+
+        case JS_BARE:
+            if (is_bare_char(c)) {
+                token_add(js, c);
+                return true;
+            }
+            *reprocess = true;
+            return finish_bare(js);
+
+        default:
+            return false;
+    }
+}
+
+esp_err_t json_stream_feed(json_stream_t *js, const char *data, size_t len)
+{
+    if (!js || (!data && len > 0)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (js->error) {
+        return ESP_FAIL;
+    }
+
+    for (size_t i = 0; i < len; i++) {
+        bool reprocess = false;
+        if (!step(js, data[i], &reprocess)) {
+            js->error = true;
+            return ESP_FAIL;
+        }
+        if (reprocess && !step(js, data[i], &reprocess)) {
+            js->error = true;
+            return ESP_FAIL;
+        }
+    }
+    return ESP_OK;
+}
+
+esp_err_t json_stream_finish(json_stream_t *js)
+{
+    if (!js || js->error) {
+        return ESP_FAIL;
+    }
+
+    // A bare root value ("42") ends with the input
+    if (js->state == JS_BARE && js->depth == 0 && !finish_bare(js)) {
+        js->error = true;
+        return ESP_FAIL;
+    }
+    return js->done ? ESP_OK : ESP_FAIL;
+}
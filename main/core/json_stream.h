@@ -0,0 +1,116 @@
+#pragma once
+
+#include "esp_err.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Incremental JSON tokenizer
+ * Bytes are fed as they arrive (e.g. from HTTP_EVENT_ON_DATA) and every
+ * scalar value is reported with its path, so a caller can pick out the
+ * fields it needs without buffering the document or building a tree.
+ * Memory use is fixed by the limits below.
+ *
+ * Paths join object keys with '.' and mark array elements with "[]":
+ * {"results":[{"latitude":1.5}]} reports "results[].latitude" with
+ * index 0 (the element index in the innermost enclosing array). For a
+ * document that is itself an array of objects, outer_index tells the
+ * top-level elements apart.
+ */
+
+#define JSON_STREAM_MAX_DEPTH   8       // Nested objects/arrays
+#define JSON_STREAM_PATH_LEN    96      // Longer paths are reported truncated
+#define JSON_STREAM_TOKEN_LEN   64      // Longer strings are reported truncated
+
+/**
+ * @brief Value type
+ */
+typedef enum {
+    JSON_STREAM_STRING = 0,
+    JSON_STREAM_NUMBER = 1,
+    JSON_STREAM_BOOL = 2,
+    JSON_STREAM_NULL = 3
+} json_stream_type_t;
+
+/**
+ * @brief A scalar value (valid only during the callback)
+ */
+typedef struct {
+    const char *path;           // "current.temperature_2m"
+    json_stream_type_t type;
+    const char *text;           // Unescaped string, or the literal as written
+    size_t len;
+    int index;                  // Element index in the innermost array, -1 if none
+    int outer_index;            // Element index in the outermost array, -1 if none
+    bool truncated;             // text or path was cut to fit
+} json_stream_value_t;
+
+/**
+ * @brief Called for every scalar value in document order
+ */
+typedef void (*json_stream_cb_t)(const json_stream_value_t *value, void *user_data);
+
+typedef struct {
+    bool array;
+    int index;
+    uint16_t path_len;          // Path length of the container itself
+} json_stream_frame_t;
+
+/**
+ * @brief Tokenizer state (opaque, allocate on the stack or statically)
+ */
+typedef struct {
+    uint8_t state;
+    uint8_t unicode_digits;
+    uint32_t unicode_value;
+    bool is_key;
+    bool done;
+    bool error;
+    int depth;
+    json_stream_frame_t stack[JSON_STREAM_MAX_DEPTH];
+    char path[JSON_STREAM_PATH_LEN];
+    uint16_t path_len;
+    bool path_truncated;
+    char token[JSON_STREAM_TOKEN_LEN];
+    uint16_t token_len;
+    bool token_truncated;
+    json_stream_cb_t cb;
+    void *user_data;
+} json_stream_t;
+
+/**
+ * @brief Initialize a tokenizer
+ * @param js Tokenizer
+ * @param cb Value callback
+ * @param user_data Passed to the callback
+ */
+void json_stream_init(json_stream_t *js, json_stream_cb_t cb, void *user_data);
+
+/**
+ * @brief Start a new document, keeping the callback
+ */
+void json_stream_reset(json_stream_t *js);
+
+/**
+ * @brief Feed the next chunk of the document
+ * @param js Tokenizer
+ * @param data Bytes (need not end on a token boundary)
+ * @param len Number of bytes
+ * @return ESP_OK, or ESP_FAIL once the input is not valid JSON
+ */
+esp_err_t json_stream_feed(json_stream_t *js, const char *data, size_t len);
+
+/**
+ * @brief Finish the document
+ * @return ESP_OK if a complete JSON value was read, ESP_FAIL otherwise
+ */
+esp_err_t json_stream_finish(json_stream_t *js);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,227 @@
+#include "layout_manager.h"
+#include "widget_manager.h"
+#include "ui_state.h"
+#include "sd_database.h"
+#include "storage_writer.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+static const char *TAG = "layout_manager";
+
+#define LAYOUT_REGION_GAP    8      // Pixels between regions
+
+static const char *layout_type_names[] = {
+    [LAYOUT_SINGLE] = "single",
+    [LAYOUT_SPLIT_V] = "split_v",
+    [LAYOUT_SPLIT_H] = "split_h",
+    [LAYOUT_GRID_2X2] = "grid_2x2"
+};
+
+// Written by HTTP handlers, read by the LVGL task
+static layout_t current_layout = { .type = LAYOUT_SINGLE };
+static portMUX_TYPE layout_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static void save_layout(const layout_t *layout)
+{
+    if (!sd_db_is_ready()) {
+        return;
+    }
+
+    cJSON *json = layout_manager_to_json(layout);
+    char *json_str = json ? cJSON_PrintUnformatted(json) : NULL;
+    cJSON_Delete(json);
+    if (!json_str) {
+        return;
+    }
+
+    // Single-widget layouts are set from the LVGL task, so never write here
+    storage_writer_set_string("layout", json_str, 0);
+    free(json_str);
+}
+
+void layout_manager_init(void)
+{
+    if (!sd_db_is_ready()) {
+        return;
+    }
+
+    char layout_json[128];
+    if (sd_db_get_string("layout", layout_json, sizeof(layout_json)) != ESP_OK) {
+        return;
+    }
+
+    cJSON *json = cJSON_Parse(layout_json);
+    layout_t layout;
+    if (json && layout_manager_from_json(json, &layout) == ESP_OK) {
+        current_layout = layout;
+        ESP_LOGI(TAG, "Layout loaded: %s", layout_type_names[layout.type]);
+    } else {
+        ESP_LOGW(TAG, "Ignoring invalid saved layout");
+    }
+    cJSON_Delete(json);
+}
+
+void layout_manager_get(layout_t *layout)
+{
+    portENTER_CRITICAL(&layout_lock);
+    *layout = current_layout;
+    portEXIT_CRITICAL(&layout_lock);
+}
+
+esp_err_t layout_manager_set(const layout_t *layout)
+{
+    if (!layout || layout->type > LAYOUT_GRID_2X2) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // Every region needs a widget, and a widget can only be in one region
+    int count = layout_manager_region_count(layout->type);
+    for (int i = 0; i < count; i++) {
+        if (!widget_manager_widget_exists(layout->widgets[i])) {
+            return ESP_ERR_NOT_FOUND;
+        }
+        for (int j = 0; j < i; j++) {
+            if (strcmp(layout->widgets[i], layout->widgets[j]) == 0) {
+                return ESP_ERR_INVALID_ARG;
+            }
+        }
+    }
+
+    layout_t copy = *layout;
+    for (int i = count; i < LAYOUT_MAX_REGIONS; i++) {
+        copy.widgets[i][0] = '\0';
+    }
+
+    portENTER_CRITICAL(&layout_lock);
+    current_layout = copy;
+    portEXIT_CRITICAL(&layout_lock);
+
+    save_layout(&copy);
+    ESP_LOGI(TAG, "Layout set: %s", layout_type_names[copy.type]);
+
+    // Applied by the LVGL task on the next frame
+    return ui_state_post_layout_changed();
+}
+
+esp_err_t layout_manager_restore(void)
+{
+    layout_t layout;
+    layout_manager_get(&layout);
+
+    if (layout.type == LAYOUT_SINGLE) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    return widget_manager_show_layout(&layout);
+}
+
+void layout_manager_set_single(const char *widget_id)
+{
+    if (!widget_id) {
+        return;
+    }
+
+    layout_t layout = { .type = LAYOUT_SINGLE };
+    strncpy(layout.widgets[0], widget_id, LAYOUT_WIDGET_ID_LEN - 1);
+
+    portENTER_CRITICAL(&layout_lock);
+    bool changed = (current_layout.type != LAYOUT_SINGLE);
+    current_layout = layout;
+    portEXIT_CRITICAL(&layout_lock);
+
+    // The single widget itself is persisted as "active_widget"
+    if (changed) {
+        save_layout(&layout);
+    }
+}
+
+int layout_manager_region_count(layout_type_t type)
+{
+    switch (type) {
+        case LAYOUT_SPLIT_V:
+        case LAYOUT_SPLIT_H:
+            return 2;
+        case LAYOUT_GRID_2X2:
+            return 4;
+        case LAYOUT_SINGLE:
+        default:
+            return 1;
+    }
+}
+
+void layout_manager_region_area(layout_type_t type, int region, int32_t width, int32_t height,
+                                layout_region_t *out)
+{
+    // Split the display into columns and rows, leaving a gap between them
+    int cols = (type == LAYOUT_SPLIT_H || type == LAYOUT_GRID_2X2) ? 2 : 1;
+    int rows = (type == LAYOUT_SPLIT_V || type == LAYOUT_GRID_2X2) ? 2 : 1;
+    int col = region % cols;
+    int row = region / cols;
+
+    int32_t cell_w = (width - (cols - 1) * LAYOUT_REGION_GAP) / cols;
+    int32_t cell_h = (height - (rows - 1) * LAYOUT_REGION_GAP) / rows;
+
+    out->x = col * (cell_w + LAYOUT_REGION_GAP);
+    out->y = row * (cell_h + LAYOUT_REGION_GAP);
+
+    // Last column/row takes the rounding remainder
+    out->w = (col == cols - 1) ? width - out->x : cell_w;
+    out->h = (row == rows - 1) ? height - out->y : cell_h;
+}
+
+cJSON* layout_manager_to_json(const layout_t *layout)
+{
+    cJSON *json = cJSON_CreateObject();
+    if (!json) {
+        return NULL;
+    }
+
+    cJSON_AddStringToObject(json, "type", layout_type_names[layout->type]);
+    cJSON *widgets = cJSON_AddArrayToObject(json, "widgets");
+    int count = layout_manager_region_count(layout->type);
+    for (int i = 0; i < count; i++) {
+        cJSON_AddItemToArray(widgets, cJSON_CreateString(layout->widgets[i]));
+    }
+
+    return json;
+}
+
+esp_err_t layout_manager_from_json(const cJSON *json, layout_t *layout)
+{
+    const cJSON *type = cJSON_GetObjectItem(json, "type");
+    const cJSON *widgets = cJSON_GetObjectItem(json, "widgets");
+    if (!type || !cJSON_IsString(type) || !widgets || !cJSON_IsArray(widgets)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(layout, 0, sizeof(*layout));
+
+    int type_index = -1;
+    for (int i = 0; i <= LAYOUT_GRID_2X2; i++) {
+        if (strcmp(type->valuestring, layout_type_names[i]) == 0) {
+            type_index = i;
+            break;
+        }
+    }
+    if (type_index < 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    layout->type = (layout_type_t)type_index;
+
+    int count = layout_manager_region_count(layout->type);
+    if (cJSON_GetArraySize(widgets) != count) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    for (int i = 0; i < count; i++) {
+        const cJSON *id = cJSON_GetArrayItem(widgets, i);
+        if (!cJSON_IsString(id) || strlen(id->valuestring) >= LAYOUT_WIDGET_ID_LEN) {
+            return ESP_ERR_INVALID_ARG;
+        }
+        strcpy(layout->widgets[i], id->valuestring);
+    }
+
+    return ESP_OK;
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+#include "esp_err.h"
+#include "cJSON.h"
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Dashboard layout manager
+ * Tiles several widgets into fixed regions of the display. The layout
+ * is stored in the database and applied by widget_manager on the LVGL
+ * task; the single layout is the regular one-widget-at-a-time mode.
+ */
+
+#define LAYOUT_MAX_REGIONS    4
+#define LAYOUT_WIDGET_ID_LEN  32
+
+/**
+ * @brief Layout types
+ */
+typedef enum {
+    LAYOUT_SINGLE = 0,        // One widget, full screen
+    LAYOUT_SPLIT_V = 1,       // Two widgets, top and bottom
+    LAYOUT_SPLIT_H = 2,       // Two widgets, left and right
+    LAYOUT_GRID_2X2 = 3       // Four widgets in a 2x2 grid
+} layout_type_t;
+
+/**
+ * @brief A layout: its type and the widget shown in each region
+ */
+typedef struct {
+    layout_type_t type;
+    char widgets[LAYOUT_MAX_REGIONS][LAYOUT_WIDGET_ID_LEN];
+} layout_t;
+
+/**
+ * @brief Region position and size in pixels
+ */
+typedef struct {
+    int32_t x;
+    int32_t y;
+    int32_t w;
+    int32_t h;
+} layout_region_t;
+
+/**
+ * @brief Initialize layout manager
+ * Loads the saved layout from the database
+ */
+void layout_manager_init(void);
+
+/**
+ * @brief Get the current layout
+ * @param layout Output layout
+ */
+void layout_manager_get(layout_t *layout);
+
+/**
+ * @brief Validate, persist and apply a layout
+ * Applied by the LVGL task on the next frame.
+ * @param layout Layout to use
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG if the layout is invalid,
+ *         ESP_ERR_NOT_FOUND if a widget doesn't exist
+ */
+esp_err_t layout_manager_set(const layout_t *layout);
+
+/**
+ * @brief Show the saved layout if it is a dashboard (LVGL task)
+ * Called once the widget system takes over the display, before any
+ * widget is shown, so a dashboard is built only once.
+ * @return ESP_OK if the dashboard is showing, ESP_ERR_NOT_FOUND if the
+ *         saved layout is a single widget (the caller shows it), or the
+ *         error from widget_manager_show_layout()
+ */
+esp_err_t layout_manager_restore(void);
+
+/**
+ * @brief Record that a single widget was selected, leaving the dashboard
+ * @param widget_id Widget now shown full screen
+ */
+void layout_manager_set_single(const char *widget_id);
+
+/**
+ * @brief Number of regions in a layout type
+ */
+int layout_manager_region_count(layout_type_t type);
+
+/**
+ * @brief Compute a region's area for a display size
+ * @param type Layout type
+ * @param region Region index
+ * @param width Display width
+ * @param height Display height
+ * @param out Output area
+ */
+void layout_manager_region_area(layout_type_t type, int region, int32_t width, int32_t height,
+                                layout_region_t *out);
+
+/**
+ * @brief Layout as JSON ({"type": "split_v", "widgets": ["clock", "weather"]})
+ * @return JSON object, caller must free with cJSON_Delete
+ */
+cJSON* layout_manager_to_json(const layout_t *layout);
+
+/**
+ * @brief Parse a layout from JSON
+ * @param json Object in the layout_manager_to_json() format
+ * @param layout Output layout
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG if malformed
+ */
+esp_err_t layout_manager_from_json(const cJSON *json, layout_t *layout);
+
+#ifdef __cplusplus
+}
+#endif
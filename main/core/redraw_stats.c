@@ -0,0 +1,92 @@
+#include "redraw_stats.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "bsp/esp-bsp.h"
+#include "lvgl.h"
+#include <stdint.h>
+
+static const char *TAG = "redraw_stats";
+
+// Written by the LVGL task only, read racily for reporting
+static volatile uint32_t invalidations = 0;
+static volatile uint64_t invalidated_px = 0;
+static volatile uint32_t frames_rendered = 0;
+static volatile uint32_t labels_set = 0;
+static volatile uint32_t labels_skipped = 0;
+static int64_t window_start_us = 0;
+
+static void display_event_cb(lv_event_t *e)
+{
+    switch (lv_event_get_code(e)) {
+        case LV_EVENT_INVALIDATE_AREA: {
+            const lv_area_t *area = lv_event_get_param(e);
+            if (area) {
+                invalidations++;
+                invalidated_px += lv_area_get_size(area);
+            }
+            break;
+        }
+        case LV_EVENT_RENDER_START:
+            frames_rendered++;
+            break;
+        default:
+            break;
+    }
+}
+
+void redraw_stats_init(void)
+{
+    bsp_display_lock(0);
+    lv_display_t *disp = lv_display_get_default();
+    if (disp) {
+        lv_display_add_event_cb(disp, display_event_cb, LV_EVENT_INVALIDATE_AREA, NULL);
+        lv_display_add_event_cb(disp, display_event_cb, LV_EVENT_RENDER_START, NULL);
+    }
+    bsp_display_unlock();
+
+    if (!disp) {
+        ESP_LOGW(TAG, "No display, redraw stats disabled");
+        return;
+    }
+
+    window_start_us = esp_timer_get_time();
+    ESP_LOGI(TAG, "Redraw stats enabled");
+}
+
+void redraw_stats_count_label(bool changed)
+{
+    if (changed) {
+        labels_set++;
+    } else {
+        labels_skipped++;
+    }
+}
+
+void redraw_stats_reset(void)
+{
+    invalidations = 0;
+    invalidated_px = 0;
+    frames_rendered = 0;
+    labels_set = 0;
+    labels_skipped = 0;
+    window_start_us = esp_timer_get_time();
+}
+
+cJSON* redraw_stats_to_json(void)
+{
+    double window_s = (esp_timer_get_time() - window_start_us) / 1000000.0;
+    if (window_s <= 0) {
+        window_s = 1;
+    }
+
+    cJSON *json = cJSON_CreateObject();
+    cJSON_AddNumberToObject(json, "window_s", window_s);
+    cJSON_AddNumberToObject(json, "invalidations", invalidations);
+    cJSON_AddNumberToObject(json, "invalidated_px", (double)invalidated_px);
+    cJSON_AddNumberToObject(json, "invalidated_px_per_sec", invalidated_px / window_s);
+    cJSON_AddNumberToObject(json, "frames_rendered", frames_rendered);
+    cJSON_AddNumberToObject(json, "frames_per_sec", frames_rendered / window_s);
+    cJSON_AddNumberToObject(json, "labels_set", labels_set);
+    cJSON_AddNumberToObject(json, "labels_skipped", labels_skipped);
+    return json;
+}
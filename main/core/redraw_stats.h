@@ -0,0 +1,42 @@
+#pragma once
+
+#include "cJSON.h"
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Redraw statistics
+ * Counts the area LVGL invalidates and the frames it renders, plus label
+ * updates applied or skipped by widget_label_set_text(). A static screen
+ * should show close to zero invalidated pixels per second.
+ */
+
+/**
+ * @brief Start counting invalidations on the default display
+ * Must be called after bsp_display_start()
+ */
+void redraw_stats_init(void);
+
+/**
+ * @brief Record a label update
+ * @param changed true if the text changed, false if it was skipped
+ */
+void redraw_stats_count_label(bool changed);
+
+/**
+ * @brief Clear all counters and start a new window
+ */
+void redraw_stats_reset(void);
+
+/**
+ * @brief Get the counters as JSON, with per-second rates over the window
+ * @return JSON object, caller must free with cJSON_Delete
+ */
+cJSON* redraw_stats_to_json(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,29 @@
+#include "seqlock.h"
+#include <string.h>
+
+void seqlock_write(seqlock_t *lock, void *dst, const void *src, size_t len)
+{
+    unsigned seq = atomic_load_explicit(&lock->seq, memory_order_relaxed);
+    atomic_store_explicit(&lock->seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    if (src) {
+        memcpy(dst, src, len);
+    } else {
+        memset(dst, 0, len);
+    }
+    atomic_store_explicit(&lock->seq, seq + 2, memory_order_release);
+}
+
+void seqlock_read(seqlock_t *lock, void *dst, const void *src, size_t len)
+{
+    unsigned start, end = 0;
+    do {
+        start = atomic_load_explicit(&lock->seq, memory_order_acquire);
+        if (start & 1) {
+            continue;   // Write in progress on the other core
+        }
+        memcpy(dst, src, len);
+        atomic_thread_fence(memory_order_acquire);
+        end = atomic_load_explicit(&lock->seq, memory_order_relaxed);
+    } while ((start & 1) || start != end);
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdatomic.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Sequence lock for a small block of data with one writer at a time
+ * Readers copy the data without blocking and retry if a write overlapped
+ * the copy, so a reader on the other core never waits on a preempted
+ * writer. Writers must be serialized by the owner, normally inside a
+ * critical section so the odd (writing) phase stays short.
+ */
+typedef struct {
+    atomic_uint seq;            // Odd while a write is in progress
+} seqlock_t;
+
+/**
+ * @brief Replace the protected data
+ * @param lock Lock guarding dst
+ * @param dst Protected data
+ * @param src New contents, or NULL to zero dst
+ * @param len Size of dst
+ */
+void seqlock_write(seqlock_t *lock, void *dst, const void *src, size_t len);
+
+/**
+ * @brief Copy a consistent snapshot of the protected data
+ * @param lock Lock guarding src
+ * @param dst Where to copy
+ * @param src Protected data
+ * @param len Size of src
+ */
+void seqlock_read(seqlock_t *lock, void *dst, const void *src, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,163 @@
+#include "storage_writer.h"
+#include "sd_database.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+static const char *TAG = "storage_writer";
+
+#define STORAGE_WRITER_QUEUE_SIZE   16
+#define STORAGE_WRITER_STACK_SIZE   4096
+#define STORAGE_WRITER_PRIORITY     2       // Below the UI and network tasks
+
+typedef struct {
+    char key[STORAGE_WRITER_KEY_LEN];       // Empty for a free entry
+    char *value;                            // NULL deletes the key
+    TickType_t due;
+} pending_write_t;
+
+static pending_write_t pending[STORAGE_WRITER_QUEUE_SIZE];
+static portMUX_TYPE pending_lock = portMUX_INITIALIZER_UNLOCKED;
+static TaskHandle_t writer_task = NULL;
+
+// Write a value unless storage already holds it; true if anything changed
+static bool apply_write(const char *key, const char *value)
+{
+    if (!value) {
+        return sd_db_key_exists(key) && sd_db_delete(key) == ESP_OK;
+    }
+
+    size_t len = strlen(value) + 2;     // Room to tell a longer stored value apart
+    char *stored = malloc(len);
+    bool same = stored && sd_db_get_string(key, stored, len) == ESP_OK && strcmp(stored, value) == 0;
+    free(stored);
+    return !same && sd_db_set_string(key, value) == ESP_OK;
+}
+
+static void storage_writer_task(void *pvParameters)
+{
+    (void)pvParameters;
+
+    while (true) {
+        TickType_t now = xTaskGetTickCount();
+        TickType_t wait = portMAX_DELAY;
+        bool wrote = false;
+
+        // Take due entries one at a time; storage is only touched unlocked
+        while (true) {
+            pending_write_t entry = { 0 };
+            portENTER_CRITICAL(&pending_lock);
+            for (int i = 0; i < STORAGE_WRITER_QUEUE_SIZE; i++) {
+                if (pending[i].key[0] == '\0') {
+                    continue;
+                }
+                TickType_t left = pending[i].due - now;
+                if ((int32_t)left <= 0) {
+                    entry = pending[i];
+                    pending[i].key[0] = '\0';
+                    pending[i].value = NULL;
+                    break;
+                }
+                if (left < wait) {
+                    wait = left;
+                }
+            }
+            portEXIT_CRITICAL(&pending_lock);
+
+            if (entry.key[0] == '\0') {
+                break;
+            }
+            if (sd_db_is_ready() && apply_write(entry.key, entry.value)) {
+                wrote = true;
+            }
+            free(entry.value);
+        }
+
+        // One save for the whole batch
+        if (wrote) {
+            sd_db_save();
+        }
+        ulTaskNotifyTake(pdTRUE, wait);
+    }
+}
+
+static esp_err_t queue_write(const char *key, const char *value, uint32_t delay_ms)
+{
+    if (!key || key[0] == '\0' || strlen(key) >= STORAGE_WRITER_KEY_LEN) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    char *copy = NULL;
+    if (value) {
+        copy = strdup(value);
+        if (!copy) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    char *replaced = NULL;
+    int slot = -1;
+    TickType_t due = xTaskGetTickCount() + pdMS_TO_TICKS(delay_ms);
+
+    portENTER_CRITICAL(&pending_lock);
+    for (int i = 0; i < STORAGE_WRITER_QUEUE_SIZE; i++) {
+        if (strcmp(pending[i].key, key) == 0) {
+            slot = i;
+            replaced = pending[i].value;
+            break;
+        }
+        if (slot < 0 && pending[i].key[0] == '\0') {
+            slot = i;
+        }
+    }
+    if (slot >= 0) {
+        strcpy(pending[slot].key, key);
+        pending[slot].value = copy;
+        pending[slot].due = due;
+    }
+    portEXIT_CRITICAL(&pending_lock);
+
+    free(replaced);
+    if (slot < 0) {
+        free(copy);
+        ESP_LOGW(TAG, "Write queue full, dropping write to '%s'", key);
+        return ESP_ERR_NO_MEM;
+    }
+
+    if (writer_task) {
+        xTaskNotifyGive(writer_task);
+    }
+    return ESP_OK;
+}
+
+void storage_writer_init(void)
+{
+    if (writer_task) {
+        return;
+    }
+
+    if (xTaskCreate(storage_writer_task, "storage_writer", STORAGE_WRITER_STACK_SIZE, NULL,
+                    STORAGE_WRITER_PRIORITY, &writer_task) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create storage writer task");
+        writer_task = NULL;
+        return;
+    }
+
+    ESP_LOGI(TAG, "Storage writer started");
+}
+
+esp_err_t storage_writer_set_string(const char *key, const char *value, uint32_t delay_ms)
+{
+    if (!value) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return queue_write(key, value, delay_ms);
+}
+
+esp_err_t storage_writer_delete(const char *key)
+{
+    return queue_write(key, NULL, 0);
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "esp_err.h"
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Deferred sd_database writes
+ * sd_db_save() rewrites the whole database file (or NVS namespace) and
+ * the database lock is also held across blob writes, so storage calls can
+ * stall for a long time. Code running on the LVGL task hands its writes
+ * to this module instead. A background task applies them and saves once
+ * per batch. Writes to the same key are coalesced (the last value wins),
+ * and a value equal to the stored one is not written.
+ *
+ * All functions are thread-safe and never block on storage.
+ */
+
+#define STORAGE_WRITER_KEY_LEN  32
+
+/**
+ * @brief Start the writer task
+ */
+void storage_writer_init(void);
+
+/**
+ * @brief Queue a string write
+ * @param key Database key (shorter than STORAGE_WRITER_KEY_LEN)
+ * @param value Value (copied)
+ * @param delay_ms Quiet time before writing; a later write to the same key
+ *        restarts it (0 = as soon as possible)
+ * @return ESP_OK, ESP_ERR_INVALID_ARG, or ESP_ERR_NO_MEM if the queue is full
+ */
+esp_err_t storage_writer_set_string(const char *key, const char *value, uint32_t delay_ms);
+
+/**
+ * @brief Queue a key deletion (replaces a pending write to the key)
+ * @return ESP_OK, ESP_ERR_INVALID_ARG, or ESP_ERR_NO_MEM if the queue is full
+ */
+esp_err_t storage_writer_delete(const char *key);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,182 @@
+#include "tick_scheduler.h"
+#include "esp_log.h"
+#include "lvgl.h"
+#include <sys/time.h>
+#include <string.h>
+
+static const char *TAG = "tick_scheduler";
+
+#define TICK_MAX_SUBSCRIBERS    16
+#define TICK_ALIGN_MARGIN_MS    5       // Fire just after the boundary, not just before
+
+typedef struct {
+    bool used;
+    bool paused;
+    uint32_t period_s;
+    time_t next_due;
+    tick_cb_t cb;
+    void *user_data;
+} tick_sub_t;
+
+static tick_sub_t subs[TICK_MAX_SUBSCRIBERS];
+static lv_timer_t *tick_timer = NULL;
+
+static int64_t now_ms(void)
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (int64_t)tv.tv_sec * 1000 + tv.tv_usec / 1000;
+}
+
+static uint32_t interest_period(tick_interest_t interest, uint32_t period_s)
+{
+    switch (interest) {
+        case TICK_ON_MINUTE:
+            return 60;
+        case TICK_EVERY_N_SECONDS:
+            return (period_s > 0) ? period_s : 1;
+        case TICK_ON_SECOND:
+        default:
+            return 1;
+    }
+}
+
+// First multiple of the period after 'now'. Minute boundaries line up with
+// local time too, since timezone offsets are whole minutes.
+static time_t next_boundary(time_t now, uint32_t period_s)
+{
+    return (now / period_s + 1) * period_s;
+}
+
+// Arm the timer for the earliest due subscriber, or pause it if there is none
+static void reschedule(void)
+{
+    if (!tick_timer) {
+        return;
+    }
+
+    int64_t now = now_ms();
+    time_t now_s = (time_t)(now / 1000);
+    time_t earliest = 0;
+    bool any = false;
+
+    for (int i = 0; i < TICK_MAX_SUBSCRIBERS; i++) {
+        if (!subs[i].used || subs[i].paused) {
+            continue;
+        }
+
+        // The wall clock jumped back (e.g. SNTP sync) - realign
+        if (subs[i].next_due - now_s > (time_t)subs[i].period_s) {
+            subs[i].next_due = next_boundary(now_s, subs[i].period_s);
+        }
+
+        if (!any || subs[i].next_due < earliest) {
+            earliest = subs[i].next_due;
+            any = true;
+        }
+    }
+
+    if (!any) {
+        // Nothing to do - let the LVGL task sleep
+        lv_timer_pause(tick_timer);
+        return;
+    }
+
+    int64_t delay = (int64_t)earliest * 1000 - now + TICK_ALIGN_MARGIN_MS;
+    if (delay < 1) {
+        delay = 1;
+    }
+
+    lv_timer_set_period(tick_timer, (uint32_t)delay);
+    lv_timer_reset(tick_timer);
+    lv_timer_resume(tick_timer);
+}
+
+// Runs in the LVGL task with the display lock held: every due callback
+// is batched into this one call
+static void tick_timer_cb(lv_timer_t *timer)
+{
+    (void)timer;
+
+    time_t now = (time_t)(now_ms() / 1000);
+
+    for (int i = 0; i < TICK_MAX_SUBSCRIBERS; i++) {
+        if (!subs[i].used || subs[i].paused || subs[i].next_due > now) {
+            continue;
+        }
+        subs[i].next_due = next_boundary(now, subs[i].period_s);
+        subs[i].cb(now, subs[i].user_data);
+    }
+
+    reschedule();
+}
+
+int tick_scheduler_subscribe(tick_interest_t interest, uint32_t period_s, tick_cb_t cb, void *user_data)
+{
+    if (!cb) {
+        return -1;
+    }
+
+    if (!tick_timer) {
+        tick_timer = lv_timer_create(tick_timer_cb, 1000, NULL);
+        if (!tick_timer) {
+            ESP_LOGE(TAG, "Failed to create tick timer");
+            return -1;
+        }
+    }
+
+    for (int i = 0; i < TICK_MAX_SUBSCRIBERS; i++) {
+        if (subs[i].used) {
+            continue;
+        }
+
+        uint32_t period = interest_period(interest, period_s);
+        subs[i] = (tick_sub_t) {
+            .used = true,
+            .paused = false,
+            .period_s = period,
+            .next_due = next_boundary((time_t)(now_ms() / 1000), period),
+            .cb = cb,
+            .user_data = user_data
+        };
+        reschedule();
+        return i;
+    }
+
+    ESP_LOGE(TAG, "Too many tick subscribers (max %d)", TICK_MAX_SUBSCRIBERS);
+    return -1;
+}
+
+void tick_scheduler_unsubscribe(int id)
+{
+    if (id < 0 || id >= TICK_MAX_SUBSCRIBERS) {
+        return;
+    }
+
+    memset(&subs[id], 0, sizeof(subs[id]));
+    reschedule();
+}
+
+void tick_scheduler_set_interest(int id, tick_interest_t interest, uint32_t period_s)
+{
+    if (id < 0 || id >= TICK_MAX_SUBSCRIBERS || !subs[id].used) {
+        return;
+    }
+
+    subs[id].period_s = interest_period(interest, period_s);
+    subs[id].next_due = next_boundary((time_t)(now_ms() / 1000), subs[id].period_s);
+    reschedule();
+}
+
+void tick_scheduler_set_paused(int id, bool paused)
+{
+    if (id < 0 || id >= TICK_MAX_SUBSCRIBERS || !subs[id].used) {
+        return;
+    }
+
+    subs[id].paused = paused;
+    if (!paused) {
+        subs[id].next_due = next_boundary((time_t)(now_ms() / 1000), subs[id].period_s);
+    }
+    reschedule();
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Wall-clock aligned tick scheduler
+ * One LVGL timer drives all widget updates. Callbacks fire right after
+ * real second/minute boundaries (or multiples of N seconds), all due
+ * callbacks run in the same timer call with the display lock held, and
+ * the timer is paused while nothing is subscribed.
+ *
+ * All functions must be called from the LVGL task or with the display
+ * lock held (e.g. from widget show/hide).
+ */
+
+/**
+ * @brief When a subscriber wants to be called
+ */
+typedef enum {
+    TICK_ON_SECOND,         // Every second, on the second
+    TICK_ON_MINUTE,         // Every minute, on the minute
+    TICK_EVERY_N_SECONDS    // Every N seconds, on multiples of N
+} tick_interest_t;
+
+/**
+ * @brief Tick callback
+ * @param now Current wall-clock time
+ * @param user_data Pointer passed at subscription
+ */
+typedef void (*tick_cb_t)(time_t now, void *user_data);
+
+/**
+ * @brief Subscribe to ticks
+ * @param interest When to be called
+ * @param period_s Period for TICK_EVERY_N_SECONDS (ignored otherwise)
+ * @param cb Callback
+ * @param user_data Passed to the callback
+ * @return Subscription ID, or -1 if the table is full
+ */
+int tick_scheduler_subscribe(tick_interest_t interest, uint32_t period_s, tick_cb_t cb, void *user_data);
+
+/**
+ * @brief Remove a subscription
+ * @param id Subscription ID (ignored if -1)
+ */
+void tick_scheduler_unsubscribe(int id);
+
+/**
+ * @brief Change when a subscriber is called
+ * @param id Subscription ID
+ * @param interest When to be called
+ * @param period_s Period for TICK_EVERY_N_SECONDS (ignored otherwise)
+ */
+void tick_scheduler_set_interest(int id, tick_interest_t interest, uint32_t period_s);
+
+/**
+ * @brief Pause or resume a subscription without losing it
+ * @param id Subscription ID
+ * @param paused true to stop callbacks
+ */
+void tick_scheduler_set_paused(int id, bool paused);
+
+#ifdef __cplusplus
+}
+#endif
@@ -2,12 +2,16 @@
 #include "sd_database.h"
 #include "esp_log.h"
 #include "esp_sntp.h"
+#include "freertos/FreeRTOS.h"
 #include <string.h>
 #include <time.h>
 
 static const char *TAG = "time_sync";
 static bool time_synced = false;
 static char timezone[64] = "UTC0";
+static time_sync_cb_t listeners[TIME_SYNC_MAX_LISTENERS];
+static int listener_count = 0;
+static portMUX_TYPE listeners_lock = portMUX_INITIALIZER_UNLOCKED;
 
 static void load_timezone(void)
 {
@@ -36,6 +40,33 @@ static void time_sync_notification_cb(struct timeval *tv)
 {
     time_synced = true;
     ESP_LOGI(TAG, "Time synchronized: %s", ctime(&tv->tv_sec));
+    
+    time_sync_cb_t copy[TIME_SYNC_MAX_LISTENERS];
+    portENTER_CRITICAL(&listeners_lock);
+    int count = listener_count;
+    memcpy(copy, listeners, sizeof(copy));
+    portEXIT_CRITICAL(&listeners_lock);
+    
+    for (int i = 0; i < count; i++) {
+        copy[i]();
+    }
+}
+
+esp_err_t time_sync_add_listener(time_sync_cb_t cb)
+{
+    if (!cb) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    esp_err_t ret = ESP_OK;
+    portENTER_CRITICAL(&listeners_lock);
+    if (listener_count < TIME_SYNC_MAX_LISTENERS) {
+        listeners[listener_count++] = cb;
+    } else {
+        ret = ESP_ERR_NO_MEM;
+    }
+    portEXIT_CRITICAL(&listeners_lock);
+    return ret;
 }
 
 void time_sync_init(void)
@@ -8,6 +8,14 @@
 extern "C" {
 #endif
 
+#define TIME_SYNC_MAX_LISTENERS 4
+
+/**
+ * @brief Called after SNTP sets the clock
+ * Runs on the SNTP task, so it should only signal another task.
+ */
+typedef void (*time_sync_cb_t)(void);
+
 /**
  * @brief Initialize SNTP time synchronization
  * Should be called after WiFi is connected
@@ -20,6 +28,14 @@ void time_sync_init(void);
  */
 bool time_sync_is_synced(void);
 
+/**
+ * @brief Get notified of every time synchronization
+ * May be called before time_sync_init().
+ * @param cb Callback
+ * @return ESP_OK, or ESP_ERR_NO_MEM if TIME_SYNC_MAX_LISTENERS are registered
+ */
+esp_err_t time_sync_add_listener(time_sync_cb_t cb);
+
 /**
  * @brief Get current time
  * @param now Pointer to time_t to fill
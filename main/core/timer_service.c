@@ -0,0 +1,513 @@
+#include "timer_service.h"
+#include "time_sync.h"
+#include "sd_database.h"
+#include "storage_writer.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+
+static const char *TAG = "timer_service";
+
+#define TIMER_RESTORE_RETRY_US    (5 * 1000000LL)    // Poll for SNTP while saved timers wait
+#define TIMER_VALUE_MAX           128                // sd_database string value limit
+
+typedef struct {
+    bool used;
+    char name[TIMER_NAME_LEN];
+    timer_kind_t kind;
+    timer_state_t state;
+    uint32_t duration_s;
+    int64_t banked_ms;          // Remaining/elapsed time when (last) started or paused
+    int64_t anchor_us;          // Running: countdown deadline or stopwatch start (esp_timer clock)
+    int64_t anchor_wall_ms;     // The same instant on the wall clock, saved for reboots (0 if unknown)
+    bool restore_pending;       // Saved while running, waiting for the wall clock to be set
+} timer_slot_t;
+
+static timer_slot_t slots[TIMER_SERVICE_MAX];
+static SemaphoreHandle_t timers_mutex = NULL;
+static esp_timer_handle_t deadline_timer = NULL;
+static timer_finished_cb_t finished_cb = NULL;
+
+static const char *kind_names[] = {
+    [TIMER_KIND_COUNTDOWN] = "countdown",
+    [TIMER_KIND_STOPWATCH] = "stopwatch"
+};
+
+static const char *state_names[] = {
+    [TIMER_STATE_STOPPED] = "stopped",
+    [TIMER_STATE_RUNNING] = "running",
+    [TIMER_STATE_PAUSED] = "paused",
+    [TIMER_STATE_FINISHED] = "finished"
+};
+
+static int64_t wall_now_ms(void)
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (int64_t)tv.tv_sec * 1000 + tv.tv_usec / 1000;
+}
+
+static int find_slot(const char *name)
+{
+    for (int i = 0; i < TIMER_SERVICE_MAX; i++) {
+        if (slots[i].used && strcmp(slots[i].name, name) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// Remaining (countdown) or elapsed (stopwatch) time at 'now_us'
+static int64_t slot_value_ms(const timer_slot_t *slot, int64_t now_us)
+{
+    if (slot->state != TIMER_STATE_RUNNING || slot->restore_pending) {
+        return slot->banked_ms;
+    }
+
+    if (slot->kind == TIMER_KIND_COUNTDOWN) {
+        int64_t remaining = (slot->anchor_us - now_us) / 1000;
+        return (remaining > 0) ? remaining : 0;
+    }
+    return slot->banked_ms + (now_us - slot->anchor_us) / 1000;
+}
+
+// Reset to the full countdown (or a zero stopwatch)
+static void slot_reset(timer_slot_t *slot)
+{
+    slot->state = TIMER_STATE_STOPPED;
+    slot->banked_ms = (slot->kind == TIMER_KIND_COUNTDOWN) ? (int64_t)slot->duration_s * 1000 : 0;
+    slot->anchor_us = 0;
+    slot->anchor_wall_ms = 0;
+    slot->restore_pending = false;
+}
+
+// Map saved wall-clock anchors onto the esp_timer clock once time is set
+static bool resolve_pending_locked(int64_t now_us)
+{
+    bool still_pending = false;
+    bool synced = time_sync_is_synced();
+
+    for (int i = 0; i < TIMER_SERVICE_MAX; i++) {
+        if (!slots[i].used || !slots[i].restore_pending) {
+            continue;
+        }
+        if (!synced) {
+            still_pending = true;
+            continue;
+        }
+
+        slots[i].anchor_us = now_us + (slots[i].anchor_wall_ms - wall_now_ms()) * 1000;
+        slots[i].restore_pending = false;
+        ESP_LOGI(TAG, "Timer '%s' resumed from saved %s", slots[i].name,
+                 slots[i].kind == TIMER_KIND_COUNTDOWN ? "deadline" : "start time");
+    }
+
+    return still_pending;
+}
+
+// Arm the one-shot timer for the earliest countdown deadline; nothing
+// else needs the CPU until then
+static void arm_deadline_locked(void)
+{
+    if (!deadline_timer) {
+        return;
+    }
+
+    int64_t now_us = esp_timer_get_time();
+    bool pending = resolve_pending_locked(now_us);
+    int64_t earliest = 0;
+    bool any = false;
+
+    for (int i = 0; i < TIMER_SERVICE_MAX; i++) {
+        const timer_slot_t *slot = &slots[i];
+        if (!slot->used || slot->kind != TIMER_KIND_COUNTDOWN ||
+            slot->state != TIMER_STATE_RUNNING || slot->restore_pending) {
+            continue;
+        }
+        if (!any || slot->anchor_us < earliest) {
+            earliest = slot->anchor_us;
+            any = true;
+        }
+    }
+
+    if (pending && (!any || earliest > now_us + TIMER_RESTORE_RETRY_US)) {
+        earliest = now_us + TIMER_RESTORE_RETRY_US;
+        any = true;
+    }
+
+    esp_timer_stop(deadline_timer);
+    if (any) {
+        int64_t delay = earliest - now_us;
+        esp_timer_start_once(deadline_timer, (delay > 0) ? (uint64_t)delay : 1);
+    }
+}
+
+static void save_slot(int index, const timer_slot_t *slot)
+{
+    if (!sd_db_is_ready()) {
+        return;
+    }
+
+    char key[16];
+    snprintf(key, sizeof(key), "timer_%d", index);
+
+    // Deferred to the storage task: timers are also changed from the LVGL task
+    if (!slot->used) {
+        storage_writer_delete(key);
+        return;
+    }
+
+    cJSON *json = cJSON_CreateObject();
+    if (!json) {
+        return;
+    }
+    cJSON_AddStringToObject(json, "n", slot->name);
+    cJSON_AddNumberToObject(json, "k", slot->kind);
+    cJSON_AddNumberToObject(json, "s", slot->state);
+    cJSON_AddNumberToObject(json, "d", slot->duration_s);
+    cJSON_AddNumberToObject(json, "b", (double)slot->banked_ms);
+    cJSON_AddNumberToObject(json, "w", (double)slot->anchor_wall_ms);
+    char *value = cJSON_PrintUnformatted(json);
+    cJSON_Delete(json);
+    if (!value) {
+        return;
+    }
+
+    // Names are at most 15 bytes without control characters, so even with
+    // every character escaped this stays under the value limit
+    if (strlen(value) >= TIMER_VALUE_MAX) {
+        ESP_LOGE(TAG, "Timer '%s' too long to save", slot->name);
+    } else {
+        storage_writer_set_string(key, value, 0);
+    }
+    free(value);
+}
+
+static void load_slot(int index)
+{
+    char key[16];
+    char value[TIMER_VALUE_MAX];
+    snprintf(key, sizeof(key), "timer_%d", index);
+    if (sd_db_get_string(key, value, sizeof(value)) != ESP_OK) {
+        return;
+    }
+
+    cJSON *json = cJSON_Parse(value);
+    const cJSON *name = cJSON_GetObjectItem(json, "n");
+    const cJSON *kind = cJSON_GetObjectItem(json, "k");
+    const cJSON *state = cJSON_GetObjectItem(json, "s");
+    const cJSON *duration = cJSON_GetObjectItem(json, "d");
+    const cJSON *banked = cJSON_GetObjectItem(json, "b");
+    const cJSON *wall = cJSON_GetObjectItem(json, "w");
+
+    if (!cJSON_IsString(name) || strlen(name->valuestring) >= TIMER_NAME_LEN ||
+        !cJSON_IsNumber(kind) || !cJSON_IsNumber(state) || !cJSON_IsNumber(duration) ||
+        !cJSON_IsNumber(banked) || !cJSON_IsNumber(wall)) {
+        ESP_LOGW(TAG, "Ignoring invalid saved timer %d", index);
+        cJSON_Delete(json);
+        return;
+    }
+
+    timer_slot_t *slot = &slots[index];
+    memset(slot, 0, sizeof(*slot));
+    slot->used = true;
+    strcpy(slot->name, name->valuestring);
+    slot->kind = (kind->valueint == TIMER_KIND_STOPWATCH) ? TIMER_KIND_STOPWATCH : TIMER_KIND_COUNTDOWN;
+    slot->state = (state->valueint >= TIMER_STATE_STOPPED && state->valueint <= TIMER_STATE_FINISHED) ?
+                  (timer_state_t)state->valueint : TIMER_STATE_STOPPED;
+    slot->duration_s = (uint32_t)duration->valuedouble;
+    slot->banked_ms = (int64_t)banked->valuedouble;
+    slot->anchor_wall_ms = (int64_t)wall->valuedouble;
+    cJSON_Delete(json);
+
+    if (slot->state == TIMER_STATE_RUNNING) {
+        if (slot->anchor_wall_ms > 0) {
+            // Resumed against the wall clock once it is known
+            slot->restore_pending = true;
+        } else {
+            // Started before the clock was set - the deadline is lost
+            slot->state = TIMER_STATE_PAUSED;
+        }
+    }
+}
+
+static void deadline_timer_cb(void *arg)
+{
+    (void)arg;
+
+    char finished[TIMER_SERVICE_MAX][TIMER_NAME_LEN];
+    int finished_count = 0;
+
+    xSemaphoreTake(timers_mutex, portMAX_DELAY);
+
+    int64_t now_us = esp_timer_get_time();
+    resolve_pending_locked(now_us);
+
+    for (int i = 0; i < TIMER_SERVICE_MAX; i++) {
+        timer_slot_t *slot = &slots[i];
+        if (!slot->used || slot->kind != TIMER_KIND_COUNTDOWN ||
+            slot->state != TIMER_STATE_RUNNING || slot->restore_pending || slot->anchor_us > now_us) {
+            continue;
+        }
+
+        // Not saved here: a saved deadline in the past restores as finished
+        slot->state = TIMER_STATE_FINISHED;
+        slot->banked_ms = 0;
+        strcpy(finished[finished_count++], slot->name);
+    }
+
+    arm_deadline_locked();
+    timer_finished_cb_t cb = finished_cb;
+
+    xSemaphoreGive(timers_mutex);
+
+    for (int i = 0; i < finished_count; i++) {
+        ESP_LOGI(TAG, "Timer '%s' finished", finished[i]);
+        if (cb) {
+            cb(finished[i]);
+        }
+    }
+}
+
+void timer_service_init(void)
+{
+    timers_mutex = xSemaphoreCreateMutex();
+    if (!timers_mutex) {
+        ESP_LOGE(TAG, "Failed to create timer mutex");
+        return;
+    }
+
+    const esp_timer_create_args_t args = {
+        .callback = deadline_timer_cb,
+        .name = "timer_deadline"
+    };
+    if (esp_timer_create(&args, &deadline_timer) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create deadline timer");
+        return;
+    }
+
+    if (sd_db_is_ready()) {
+        for (int i = 0; i < TIMER_SERVICE_MAX; i++) {
+            load_slot(i);
+        }
+    }
+
+    xSemaphoreTake(timers_mutex, portMAX_DELAY);
+    arm_deadline_locked();
+    xSemaphoreGive(timers_mutex);
+
+    ESP_LOGI(TAG, "Timer service initialized");
+}
+
+// Non-empty, shorter than TIMER_NAME_LEN, no control characters
+static bool valid_name(const char *name)
+{
+    if (!name || name[0] == '\0' || strlen(name) >= TIMER_NAME_LEN) {
+        return false;
+    }
+    for (const char *p = name; *p; p++) {
+        if ((unsigned char)*p < 0x20 || *p == 0x7f) {
+            return false;
+        }
+    }
+    return true;
+}
+
+esp_err_t timer_service_configure(const char *name, timer_kind_t kind, uint32_t duration_s)
+{
+    if (!valid_name(name) || kind > TIMER_KIND_STOPWATCH || !timers_mutex) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    xSemaphoreTake(timers_mutex, portMAX_DELAY);
+
+    int index = find_slot(name);
+    if (index >= 0 && slots[index].kind == kind &&
+        (kind == TIMER_KIND_STOPWATCH || slots[index].duration_s == duration_s)) {
+        xSemaphoreGive(timers_mutex);
+        return ESP_OK;
+    }
+
+    for (int i = 0; i < TIMER_SERVICE_MAX && index < 0; i++) {
+        if (!slots[i].used) {
+            index = i;
+        }
+    }
+    if (index < 0) {
+        xSemaphoreGive(timers_mutex);
+        return ESP_ERR_NO_MEM;
+    }
+
+    timer_slot_t *slot = &slots[index];
+    slot->used = true;
+    strcpy(slot->name, name);
+    slot->kind = kind;
+    slot->duration_s = duration_s;
+    slot_reset(slot);
+    arm_deadline_locked();
+    timer_slot_t copy = *slot;
+
+    xSemaphoreGive(timers_mutex);
+
+    save_slot(index, &copy);
+    return ESP_OK;
+}
+
+// Apply a state change to a named timer and save it
+static esp_err_t change_timer(const char *name, void (*change)(timer_slot_t *slot, int64_t now_us))
+{
+    if (!name || !timers_mutex) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    xSemaphoreTake(timers_mutex, portMAX_DELAY);
+
+    int index = find_slot(name);
+    if (index < 0) {
+        xSemaphoreGive(timers_mutex);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    change(&slots[index], esp_timer_get_time());
+    arm_deadline_locked();
+    timer_slot_t copy = slots[index];
+
+    xSemaphoreGive(timers_mutex);
+
+    save_slot(index, &copy);
+    return ESP_OK;
+}
+
+static void start_slot(timer_slot_t *slot, int64_t now_us)
+{
+    if (slot->state == TIMER_STATE_RUNNING) {
+        return;
+    }
+    if (slot->state == TIMER_STATE_FINISHED) {
+        slot_reset(slot);
+    }
+
+    slot->state = TIMER_STATE_RUNNING;
+    slot->anchor_us = (slot->kind == TIMER_KIND_COUNTDOWN) ? now_us + slot->banked_ms * 1000 : now_us;
+
+    // Without a set clock the wall-clock anchor would be meaningless after a reboot
+    slot->anchor_wall_ms = time_sync_is_synced() ? wall_now_ms() + (slot->anchor_us - now_us) / 1000 : 0;
+}
+
+static void pause_slot(timer_slot_t *slot, int64_t now_us)
+{
+    if (slot->state != TIMER_STATE_RUNNING) {
+        return;
+    }
+
+    slot->banked_ms = slot_value_ms(slot, now_us);
+    slot->state = TIMER_STATE_PAUSED;
+    slot->anchor_wall_ms = 0;
+    slot->restore_pending = false;
+}
+
+static void reset_slot(timer_slot_t *slot, int64_t now_us)
+{
+    (void)now_us;
+    slot_reset(slot);
+}
+
+static void delete_slot(timer_slot_t *slot, int64_t now_us)
+{
+    (void)now_us;
+    memset(slot, 0, sizeof(*slot));
+}
+
+esp_err_t timer_service_start(const char *name)
+{
+    return change_timer(name, start_slot);
+}
+
+esp_err_t timer_service_pause(const char *name)
+{
+    return change_timer(name, pause_slot);
+}
+
+esp_err_t timer_service_reset(const char *name)
+{
+    return change_timer(name, reset_slot);
+}
+
+esp_err_t timer_service_delete(const char *name)
+{
+    return change_timer(name, delete_slot);
+}
+
+static void fill_info(const timer_slot_t *slot, int64_t now_us, timer_info_t *info)
+{
+    strcpy(info->name, slot->name);
+    info->kind = slot->kind;
+    info->state = slot->state;
+    info->duration_s = slot->duration_s;
+    info->value_ms = slot_value_ms(slot, now_us);
+}
+
+esp_err_t timer_service_get(const char *name, timer_info_t *info)
+{
+    if (!name || !info || !timers_mutex) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    xSemaphoreTake(timers_mutex, portMAX_DELAY);
+
+    int index = find_slot(name);
+    if (index >= 0) {
+        fill_info(&slots[index], esp_timer_get_time(), info);
+    }
+
+    xSemaphoreGive(timers_mutex);
+    return (index >= 0) ? ESP_OK : ESP_ERR_NOT_FOUND;
+}
+
+void timer_service_set_finished_cb(timer_finished_cb_t cb)
+{
+    finished_cb = cb;
+}
+
+cJSON* timer_service_to_json(void)
+{
+    if (!timers_mutex) {
+        return NULL;
+    }
+
+    timer_info_t infos[TIMER_SERVICE_MAX];
+    int count = 0;
+
+    xSemaphoreTake(timers_mutex, portMAX_DELAY);
+    int64_t now_us = esp_timer_get_time();
+    for (int i = 0; i < TIMER_SERVICE_MAX; i++) {
+        if (slots[i].used) {
+            fill_info(&slots[i], now_us, &infos[count++]);
+        }
+    }
+    xSemaphoreGive(timers_mutex);
+
+    cJSON *json = cJSON_CreateObject();
+    if (!json) {
+        return NULL;
+    }
+
+    cJSON *timers = cJSON_AddArrayToObject(json, "timers");
+    for (int i = 0; i < count; i++) {
+        cJSON *item = cJSON_CreateObject();
+        cJSON_AddStringToObject(item, "name", infos[i].name);
+        cJSON_AddStringToObject(item, "type", kind_names[infos[i].kind]);
+        cJSON_AddStringToObject(item, "state", state_names[infos[i].state]);
+        cJSON_AddNumberToObject(item, "duration_seconds", infos[i].duration_s);
+        cJSON_AddNumberToObject(item, infos[i].kind == TIMER_KIND_COUNTDOWN ? "remaining_ms" : "elapsed_ms",
+                                (double)infos[i].value_ms);
+        cJSON_AddItemToArray(timers, item);
+    }
+
+    return json;
+}
@@ -0,0 +1,125 @@
+#pragma once
+
+#include "esp_err.h"
+#include "cJSON.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Named countdowns and stopwatches
+ * Timers run on the monotonic esp_timer clock: a running countdown is a
+ * deadline and a running stopwatch a start time, so the remaining or
+ * elapsed time is computed when asked and never drifts. Timers keep
+ * running with no widget shown, one esp_timer fires at the earliest
+ * countdown deadline, and deadlines are stored as wall-clock times so
+ * they survive a reboot.
+ *
+ * All functions are thread-safe.
+ */
+
+#define TIMER_SERVICE_MAX       8
+#define TIMER_NAME_LEN          16
+
+/**
+ * @brief Timer kind
+ */
+typedef enum {
+    TIMER_KIND_COUNTDOWN = 0,
+    TIMER_KIND_STOPWATCH = 1
+} timer_kind_t;
+
+/**
+ * @brief Timer state
+ */
+typedef enum {
+    TIMER_STATE_STOPPED = 0,    // Reset, not started
+    TIMER_STATE_RUNNING = 1,
+    TIMER_STATE_PAUSED = 2,
+    TIMER_STATE_FINISHED = 3    // Countdown reached zero
+} timer_state_t;
+
+/**
+ * @brief Snapshot of a timer
+ */
+typedef struct {
+    char name[TIMER_NAME_LEN];
+    timer_kind_t kind;
+    timer_state_t state;
+    uint32_t duration_s;        // Countdown length
+    int64_t value_ms;           // Remaining (countdown) or elapsed (stopwatch) time
+} timer_info_t;
+
+/**
+ * @brief Called when a countdown finishes (esp_timer task, keep it short)
+ * @param name Timer name
+ */
+typedef void (*timer_finished_cb_t)(const char *name);
+
+/**
+ * @brief Initialize timer service
+ * Restores saved timers; running ones continue from their saved deadline.
+ */
+void timer_service_init(void);
+
+/**
+ * @brief Create a timer, or change an existing one's kind or duration
+ * A changed timer is reset. An unchanged one is left as it is.
+ * @param name Timer name (1-15 bytes, no control characters)
+ * @param kind Countdown or stopwatch
+ * @param duration_s Countdown length (ignored for stopwatches)
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG if the name is invalid,
+ *         ESP_ERR_NO_MEM if all timer slots are used
+ */
+esp_err_t timer_service_configure(const char *name, timer_kind_t kind, uint32_t duration_s);
+
+/**
+ * @brief Start or resume a timer (a finished countdown starts over)
+ * @return ESP_OK on success, ESP_ERR_NOT_FOUND if there is no such timer
+ */
+esp_err_t timer_service_start(const char *name);
+
+/**
+ * @brief Pause a running timer
+ * @return ESP_OK on success, ESP_ERR_NOT_FOUND if there is no such timer
+ */
+esp_err_t timer_service_pause(const char *name);
+
+/**
+ * @brief Stop a timer and reset it to its full duration (or zero)
+ * @return ESP_OK on success, ESP_ERR_NOT_FOUND if there is no such timer
+ */
+esp_err_t timer_service_reset(const char *name);
+
+/**
+ * @brief Delete a timer
+ * @return ESP_OK on success, ESP_ERR_NOT_FOUND if there is no such timer
+ */
+esp_err_t timer_service_delete(const char *name);
+
+/**
+ * @brief Get a timer's current state and time
+ * @param name Timer name
+ * @param info Output snapshot
+ * @return ESP_OK on success, ESP_ERR_NOT_FOUND if there is no such timer
+ */
+esp_err_t timer_service_get(const char *name, timer_info_t *info);
+
+/**
+ * @brief Set the callback for finished countdowns
+ * @param cb Callback, or NULL to remove it
+ */
+void timer_service_set_finished_cb(timer_finished_cb_t cb);
+
+/**
+ * @brief All timers as JSON ({"timers": [{"name": ..., "type": "countdown", ...}]})
+ * @return JSON object, caller must free with cJSON_Delete
+ */
+cJSON* timer_service_to_json(void);
+
+#ifdef __cplusplus
+}
+#endif
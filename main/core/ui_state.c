@@ -1,13 +1,284 @@
 #include "ui_state.h"
 #include "widget_manager.h"
+#include "layout_manager.h"
 #include "esp_log.h"
+#include "bsp/esp-bsp.h"
+#include "lvgl.h"
 #include <string.h>
+#include <stdint.h>
+#include <stdatomic.h>
 
 static const char *TAG = "ui_state";
 static bool initialized = false;
 
+// Command queue configuration
+#define UI_CMD_QUEUE_SIZE     16    // Must be a power of two
+#define UI_CMD_ID_LEN         32
+
+typedef enum {
+    UI_CMD_SWITCH_WIDGET,
+    UI_CMD_APPLY_CONFIG,
+    UI_CMD_DATA_UPDATED,
+} ui_cmd_type_t;
+
+typedef struct {
+    ui_cmd_type_t type;
+    char widget_id[UI_CMD_ID_LEN];
+    cJSON *cfg;                      // Owned copy (APPLY_CONFIG only)
+} ui_cmd_t;
+
+// Bounded MPSC ring: each slot carries a sequence number that tells
+// producers when it is free and the consumer when it is published
+typedef struct {
+    atomic_size_t seq;
+    ui_cmd_t cmd;
+} ui_cmd_slot_t;
+
+static ui_cmd_slot_t cmd_ring[UI_CMD_QUEUE_SIZE];
+static atomic_size_t cmd_enqueue_pos;
+static size_t cmd_dequeue_pos;       // Only touched by the LVGL task
+
+// Configs posted between two frames are merged per widget and applied
+// together; widget_manager debounces the resulting storage writes
+#define UI_MAX_PENDING_CONFIGS    8
+
+typedef struct {
+    char widget_id[UI_CMD_ID_LEN];
+    cJSON *cfg;
+} pending_config_entry_t;
+
+static pending_config_entry_t pending_configs[UI_MAX_PENDING_CONFIGS];
+static int pending_config_count = 0;    // Only touched by the LVGL task
+
+// Data sources that publish into bound subjects instead of refreshing widgets
+#define UI_MAX_PUBLISHERS    4
+
+typedef struct {
+    char widget_id[UI_CMD_ID_LEN];
+    ui_data_publisher_t publish;
+} publisher_entry_t;
+
+static publisher_entry_t publishers[UI_MAX_PUBLISHERS];
+static int publisher_count = 0;
+
+// Flag commands that carry no payload are coalesced here instead of queued
+#define UI_PENDING_REFRESH    (1u << 0)
+#define UI_PENDING_FONT       (1u << 1)
+#define UI_PENDING_LAYOUT     (1u << 2)
+static atomic_uint pending_flags;
+
+static lv_timer_t *drain_timer = NULL;
+
+static bool cmd_enqueue(const ui_cmd_t *cmd)
+{
+    size_t pos = atomic_load_explicit(&cmd_enqueue_pos, memory_order_relaxed);
+    ui_cmd_slot_t *slot;
+
+    while (true) {
+        slot = &cmd_ring[pos & (UI_CMD_QUEUE_SIZE - 1)];
+        size_t seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+
+        if (diff == 0) {
+            // Slot is free for this position, try to claim it
+            if (atomic_compare_exchange_weak_explicit(&cmd_enqueue_pos, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            // Consumer hasn't caught up - queue is full
+            return false;
+        } else {
+            pos = atomic_load_explicit(&cmd_enqueue_pos, memory_order_relaxed);
+        }
+    }
+
+    slot->cmd = *cmd;
+    atomic_store_explicit(&slot->seq, pos + 1, memory_order_release);
+    return true;
+}
+
+static bool cmd_dequeue(ui_cmd_t *cmd)
+{
+    ui_cmd_slot_t *slot = &cmd_ring[cmd_dequeue_pos & (UI_CMD_QUEUE_SIZE - 1)];
+    size_t seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+
+    if ((intptr_t)seq - (intptr_t)(cmd_dequeue_pos + 1) != 0) {
+        return false;  // Empty (or the producer hasn't published yet)
+    }
+
+    *cmd = slot->cmd;
+    atomic_store_explicit(&slot->seq, cmd_dequeue_pos + UI_CMD_QUEUE_SIZE, memory_order_release);
+    cmd_dequeue_pos++;
+    return true;
+}
+
+// Merge the items of src into dst (later values win)
+static void merge_config(cJSON *dst, const cJSON *src)
+{
+    const cJSON *item = NULL;
+    cJSON_ArrayForEach(item, src) {
+        cJSON *copy = cJSON_Duplicate(item, true);
+        if (!copy) {
+            continue;
+        }
+        if (cJSON_GetObjectItem(dst, item->string)) {
+            cJSON_ReplaceItemInObject(dst, item->string, copy);
+        } else {
+            cJSON_AddItemToObject(dst, item->string, copy);
+        }
+    }
+}
+
+// Apply a pending config and drop it from the table (LVGL task)
+static void apply_pending_config(int index)
+{
+    widget_manager_set_config(pending_configs[index].widget_id, pending_configs[index].cfg);
+    cJSON_Delete(pending_configs[index].cfg);
+
+    pending_configs[index] = pending_configs[--pending_config_count];
+}
+
+// Add a posted config to the pending table, merging with an earlier one
+static void queue_pending_config(const char *widget_id, cJSON *cfg)
+{
+    for (int i = 0; i < pending_config_count; i++) {
+        if (strcmp(pending_configs[i].widget_id, widget_id) == 0) {
+            merge_config(pending_configs[i].cfg, cfg);
+            cJSON_Delete(cfg);
+            return;
+        }
+    }
+
+    if (pending_config_count >= UI_MAX_PENDING_CONFIGS) {
+        // Table full - make room by applying the oldest entry now
+        apply_pending_config(0);
+    }
+
+    pending_config_entry_t *entry = &pending_configs[pending_config_count++];
+    strcpy(entry->widget_id, widget_id);
+    entry->cfg = cfg;
+}
+
+// Publish a data update through its registered publisher, if there is one
+static bool publish_data(const char *widget_id)
+{
+    for (int i = 0; i < publisher_count; i++) {
+        if (strcmp(publishers[i].widget_id, widget_id) == 0) {
+            publishers[i].publish();
+            return true;
+        }
+    }
+    return false;
+}
+
+// Drain the command queue (LVGL timer, display lock already held)
+static void ui_state_drain_cb(lv_timer_t *timer)
+{
+    (void)timer;
+
+    char switch_to[UI_CMD_ID_LEN] = {0};
+    char updated[UI_CMD_QUEUE_SIZE][UI_CMD_ID_LEN];
+    int updated_count = 0;
+
+    // Collect everything posted since the last frame, coalescing as we go
+    ui_cmd_t cmd;
+    while (cmd_dequeue(&cmd)) {
+        switch (cmd.type) {
+            case UI_CMD_SWITCH_WIDGET:
+                strcpy(switch_to, cmd.widget_id);  // Last switch wins
+                break;
+
+            case UI_CMD_APPLY_CONFIG:
+                queue_pending_config(cmd.widget_id, cmd.cfg);
+                break;
+
+            case UI_CMD_DATA_UPDATED: {
+                // Bound data only touches the objects bound to it
+                if (publish_data(cmd.widget_id)) {
+                    break;
+                }
+                int i;
+                for (i = 0; i < updated_count; i++) {
+                    if (strcmp(updated[i], cmd.widget_id) == 0) {
+                        break;
+                    }
+                }
+                if (i == updated_count) {
+                    strcpy(updated[updated_count++], cmd.widget_id);
+                }
+                break;
+            }
+        }
+    }
+
+    unsigned flags = atomic_exchange(&pending_flags, 0);
+
+    if (pending_config_count == 0 && switch_to[0] == '\0' && updated_count == 0 && flags == 0) {
+        return;
+    }
+
+    bool rebuilt = false;
+
+    // Apply configs before switching so a newly shown widget is built once
+    for (int i = pending_config_count - 1; i >= 0; i--) {
+        if (widget_manager_is_shown(pending_configs[i].widget_id)) {
+            rebuilt = true;
+        }
+        apply_pending_config(i);
+    }
+
+    if (flags & UI_PENDING_LAYOUT) {
+        layout_t layout;
+        layout_manager_get(&layout);
+        widget_manager_show_layout(&layout);
+        rebuilt = true;
+    }
+
+    if (switch_to[0] != '\0') {
+        const char *active = widget_manager_get_active();
+        if (!active || strcmp(active, switch_to) != 0) {
+            widget_manager_switch(switch_to);
+            rebuilt = true;
+        }
+    }
+
+    if (!rebuilt && (flags & UI_PENDING_FONT) && !(flags & UI_PENDING_REFRESH)) {
+        // Widgets swap fonts in place if they can
+        widget_manager_apply_font_change();
+        rebuilt = true;
+    }
+
+    if (!rebuilt) {
+        bool refresh = (flags & UI_PENDING_REFRESH) != 0;
+        for (int i = 0; i < updated_count && !refresh; i++) {
+            refresh = widget_manager_is_shown(updated[i]);
+        }
+        if (refresh) {
+            widget_manager_refresh();
+        }
+    }
+}
+
 void ui_state_init(void)
 {
+    for (size_t i = 0; i < UI_CMD_QUEUE_SIZE; i++) {
+        atomic_init(&cmd_ring[i].seq, i);
+    }
+    atomic_init(&cmd_enqueue_pos, 0);
+    cmd_dequeue_pos = 0;
+    atomic_init(&pending_flags, 0);
+
+    // Drain once per display refresh period
+    bsp_display_lock(0);
+    drain_timer = lv_timer_create(ui_state_drain_cb, LV_DEF_REFR_PERIOD, NULL);
+    bsp_display_unlock();
+
+    if (!drain_timer) {
+        ESP_LOGE(TAG, "Failed to create UI command timer");
+        return;
+    }
+
     initialized = true;
     ESP_LOGI(TAG, "UI state manager initialized");
 }
@@ -17,22 +288,87 @@ const char* ui_state_get_active_widget(void)
     return widget_manager_get_active();
 }
 
+static esp_err_t post_command(ui_cmd_type_t type, const char *widget_id, cJSON *cfg)
+{
+    if (!widget_id || strlen(widget_id) >= UI_CMD_ID_LEN) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (!initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    ui_cmd_t cmd = {
+        .type = type,
+        .cfg = cfg
+    };
+    strcpy(cmd.widget_id, widget_id);
+
+    if (!cmd_enqueue(&cmd)) {
+        ESP_LOGW(TAG, "UI command queue full, dropping command for '%s'", widget_id);
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+esp_err_t ui_state_post_switch(const char *widget_id)
+{
+    return post_command(UI_CMD_SWITCH_WIDGET, widget_id, NULL);
+}
+
+esp_err_t ui_state_post_config(const char *widget_id, const cJSON *cfg)
+{
+    if (!cfg) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    cJSON *copy = cJSON_Duplicate(cfg, true);
+    if (!copy) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    esp_err_t ret = post_command(UI_CMD_APPLY_CONFIG, widget_id, copy);
+    if (ret != ESP_OK) {
+        cJSON_Delete(copy);
+    }
+    return ret;
+}
+
+esp_err_t ui_state_post_data_updated(const char *widget_id)
+{
+    esp_err_t ret = post_command(UI_CMD_DATA_UPDATED, widget_id, NULL);
+    if (ret == ESP_ERR_NO_MEM) {
+        // A full refresh covers any data update
+        return ui_state_refresh();
+    }
+    return ret;
+}
+
+esp_err_t ui_state_register_publisher(const char *widget_id, ui_data_publisher_t publish)
+{
+    if (!widget_id || !publish || strlen(widget_id) >= UI_CMD_ID_LEN) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // Registered once at startup, before any updates are posted
+    if (publisher_count >= UI_MAX_PUBLISHERS) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    strcpy(publishers[publisher_count].widget_id, widget_id);
+    publishers[publisher_count].publish = publish;
+    publisher_count++;
+    return ESP_OK;
+}
+
 esp_err_t ui_state_notify_config_changed(const char *widget_id)
 {
     if (!widget_id) {
         return ESP_ERR_INVALID_ARG;
     }
-    
-    const char *active = widget_manager_get_active();
-    
-    // If the changed widget is currently active, ensure it's refreshed
-    if (active && strcmp(active, widget_id) == 0) {
-        ESP_LOGI(TAG, "Config changed for active widget '%s', ensuring refresh", widget_id);
-        // Widget's set_config should handle refresh, but we can force it if needed
-        return widget_manager_refresh();
-    }
-    
-    ESP_LOGI(TAG, "Config changed for inactive widget '%s'", widget_id);
+
+    // widget_manager_set_config() already rebuilt the widget if it is shown
+    ESP_LOGD(TAG, "Config changed for widget '%s'", widget_id);
     return ESP_OK;
 }
 
@@ -41,13 +377,26 @@ esp_err_t ui_state_notify_widget_switched(const char *widget_id)
     if (!widget_id) {
         return ESP_ERR_INVALID_ARG;
     }
-    
+
     ESP_LOGI(TAG, "Widget switched to: %s", widget_id);
     return ESP_OK;
 }
 
-esp_err_t ui_state_refresh(void)
+esp_err_t ui_state_post_font_changed(void)
 {
-    return widget_manager_refresh();
+    atomic_fetch_or(&pending_flags, UI_PENDING_FONT);
+    return ESP_OK;
 }
 
+esp_err_t ui_state_post_layout_changed(void)
+{
+    atomic_fetch_or(&pending_flags, UI_PENDING_LAYOUT);
+    return ESP_OK;
+}
+
+esp_err_t ui_state_refresh(void)
+{
+    // Coalesced with any other refresh requested before the next frame
+    atomic_fetch_or(&pending_flags, UI_PENDING_REFRESH);
+    return ESP_OK;
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "esp_err.h"
+#include "cJSON.h"
 #include <stdbool.h>
 
 #ifdef __cplusplus
@@ -9,20 +10,84 @@ extern "C" {
 
 /**
  * @brief UI State Manager
- * Tracks the current UI state and ensures widgets are properly refreshed
+ * Tracks the current UI state and ensures widgets are properly refreshed.
+ *
+ * Other tasks (HTTP handlers, network services) never touch LVGL directly;
+ * they post commands to a lock-free queue that the LVGL task drains once
+ * per frame. Posting never blocks, and redundant commands are coalesced
+ * so a burst of requests results in a single rebuild.
  */
 
 /**
  * @brief Initialize the UI state manager
+ * Must be called after bsp_display_start() (creates the drain timer)
  */
 void ui_state_init(void);
 
+/**
+ * @brief Queue a switch to another widget
+ * Only the last switch posted before the next frame is applied.
+ * @param widget_id Widget ID to switch to
+ * @return ESP_OK if queued, ESP_ERR_NO_MEM if the queue is full
+ */
+esp_err_t ui_state_post_switch(const char *widget_id);
+
+/**
+ * @brief Queue a config change for a widget
+ * The config is copied; configs posted for the same widget before the
+ * next frame are merged and applied together. Only the changed fields
+ * are applied and storage writes are debounced.
+ * @param widget_id Widget ID to configure
+ * @param cfg JSON object with config (not consumed)
+ * @return ESP_OK if queued, ESP_ERR_NO_MEM if the queue is full
+ */
+esp_err_t ui_state_post_config(const char *widget_id, const cJSON *cfg);
+
+/**
+ * @brief Queue a notification that a widget's data source has new data
+ * If a publisher is registered for the ID it is called on the next frame;
+ * otherwise the widget is refreshed if it is shown.
+ * @param widget_id Widget ID whose data changed
+ * @return ESP_OK if queued
+ */
+esp_err_t ui_state_post_data_updated(const char *widget_id);
+
+/**
+ * @brief Data publisher, called on the LVGL task with the display lock held
+ */
+typedef void (*ui_data_publisher_t)(void);
+
+/**
+ * @brief Route data updates for an ID to a publisher instead of a refresh
+ * The publisher pushes the new data into bound subjects, so only the
+ * bound objects change.
+ * @param widget_id ID passed to ui_state_post_data_updated()
+ * @param publish Publisher
+ * @return ESP_OK on success, ESP_ERR_NO_MEM if the table is full
+ */
+esp_err_t ui_state_register_publisher(const char *widget_id, ui_data_publisher_t publish);
+
 /**
  * @brief Get the currently active widget ID
  * @return Widget ID string, or NULL if none active
  */
 const char* ui_state_get_active_widget(void);
 
+/**
+ * @brief Queue a notification that the font size preset changed
+ * The active widget swaps its fonts in place on the next frame
+ * (or is rebuilt if it can't).
+ * @return ESP_OK on success
+ */
+esp_err_t ui_state_post_font_changed(void);
+
+/**
+ * @brief Queue a notification that the dashboard layout changed
+ * The layout from layout_manager is shown on the next frame.
+ * @return ESP_OK on success
+ */
+esp_err_t ui_state_post_layout_changed(void);
+
 /**
  * @brief Notify that a widget config has changed
  * @param widget_id Widget ID that changed
@@ -38,7 +103,9 @@ esp_err_t ui_state_notify_config_changed(const char *widget_id);
 esp_err_t ui_state_notify_widget_switched(const char *widget_id);
 
 /**
- * @brief Force refresh of the current UI state
+ * @brief Request a refresh of the current UI state
+ * Non-blocking: the active widget is rebuilt on the next frame.
+ * Multiple requests before that frame collapse into one.
  * @return ESP_OK on success
  */
 esp_err_t ui_state_refresh(void);
@@ -0,0 +1,253 @@
+#include "weather_binding.h"
+#include "weather_service.h"
+#include "weather_forecast.h"
+#include "ui_state.h"
+#include "esp_log.h"
+#include "bsp/esp-bsp.h"
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+
+static const char *TAG = "weather_binding";
+
+#define TEXT_SHORT    32
+#define TEXT_LONG     64
+#define TEXT_OTHERS   (TEXT_SHORT * (WEATHER_MAX_LOCATIONS - 1))
+
+static lv_subject_t state_subject;
+static lv_subject_t temperature_subject;
+static lv_subject_t condition_subject;
+static lv_subject_t details_subject;
+static lv_subject_t message_subject;
+static lv_subject_t others_subject;
+
+static char temperature_buf[TEXT_SHORT], temperature_prev[TEXT_SHORT];
+static char condition_buf[TEXT_SHORT], condition_prev[TEXT_SHORT];
+static char details_buf[TEXT_LONG], details_prev[TEXT_LONG];
+static char message_buf[TEXT_LONG], message_prev[TEXT_LONG];
+static char others_buf[TEXT_OTHERS], others_prev[TEXT_OTHERS];
+
+static bool initialized = false;
+static int active_views = 0;
+static bool fetch_pending = false;
+static lv_timer_t *refresh_timer = NULL;   // Cache expiry, only while active
+
+// Subjects notify their observers on every write, so skip unchanged values
+static void set_string(lv_subject_t *subject, const char *text)
+{
+    if (strcmp(lv_subject_get_string(subject), text) != 0) {
+        lv_subject_copy_string(subject, text);
+    }
+}
+
+static void set_state(weather_view_state_t state)
+{
+    if (lv_subject_get_int(&state_subject) != (int32_t)state) {
+        lv_subject_set_int(&state_subject, state);
+    }
+}
+
+static void request_fetch(void)
+{
+    weather_data_t unused;
+    if (weather_service_fetch(&unused) != ESP_ERR_INVALID_STATE) {
+        fetch_pending = true;
+    }
+}
+
+// Fires when the shown data expires (weather_service refreshes it before
+// that, so this only matters when it keeps failing)
+static void refresh_timer_cb(lv_timer_t *timer)
+{
+    (void)timer;
+    refresh_timer = NULL;   // One-shot, deleted by LVGL after this call
+
+    if (active_views > 0) {
+        request_fetch();
+    }
+    weather_binding_publish();
+}
+
+static void cancel_refresh(void)
+{
+    if (refresh_timer) {
+        lv_timer_delete(refresh_timer);
+        refresh_timer = NULL;
+    }
+}
+
+static void arm_refresh(uint32_t delay_ms)
+{
+    cancel_refresh();
+    if (active_views == 0) {
+        return;
+    }
+
+    refresh_timer = lv_timer_create(refresh_timer_cb, delay_ms, NULL);
+    if (refresh_timer) {
+        lv_timer_set_repeat_count(refresh_timer, 1);
+    }
+}
+
+// One line per named location: "office  18° Cloudy"
+static void publish_others(void)
+{
+    char text[TEXT_OTHERS] = "";
+    size_t len = 0;
+    for (int i = 1; i < WEATHER_MAX_LOCATIONS && len < sizeof(text); i++) {
+        char name[WEATHER_LOCATION_NAME_LEN];
+        weather_data_t weather;
+        if (weather_service_get_location(i, name, NULL, 0, &weather) != ESP_OK) {
+            continue;
+        }
+        if (weather.valid) {
+            len += snprintf(text + len, sizeof(text) - len, "%s%s  %.0f° %s", len ? "\n" : "", name,
+                            weather_service_display_temp(weather.temperature), weather.condition);
+        } else {
+            len += snprintf(text + len, sizeof(text) - len, "%s%s  --", len ? "\n" : "", name);
+        }
+    }
+    set_string(&others_subject, text);
+}
+
+void weather_binding_publish(void)
+{
+    if (!initialized) {
+        return;
+    }
+
+    char zip_code[WEATHER_LOCATION_QUERY_LEN] = {0};
+    weather_service_get_zip_code(zip_code, sizeof(zip_code));
+
+    weather_data_t weather = {0};
+    if (zip_code[0] == '\0') {
+        fetch_pending = false;
+        set_string(&message_subject, "Configure zip code in settings");
+        set_state(WEATHER_VIEW_NO_ZIP);
+        cancel_refresh();
+        return;
+    }
+
+    if (weather_service_get_cached(&weather) == ESP_OK && weather.valid) {
+        fetch_pending = false;
+
+        char text[TEXT_LONG];
+        // Cached data is canonical (°C, m/s); convert to the selected units
+        snprintf(text, sizeof(text), "%.1f%s", weather_service_display_temp(weather.temperature),
+                 weather_service_temp_symbol());
+        set_string(&temperature_subject, text);
+        set_string(&condition_subject, weather.condition);
+        int len = snprintf(text, sizeof(text), "Humidity: %.0f%%\nWind: %.1f %s", weather.humidity,
+                           weather_service_display_wind(weather.wind_speed), weather_service_wind_symbol());
+        
+        // Today's range from the stored forecast
+        weather_forecast_day_t today;
+        if (weather_forecast_get_day(time(NULL), &today) == ESP_OK && len > 0 && len < (int)sizeof(text)) {
+            snprintf(text + len, sizeof(text) - len, "\nHigh %.0f° / Low %.0f°",
+                     weather_service_display_temp(today.temp_max_x10 / 10.0f),
+                     weather_service_display_temp(today.temp_min_x10 / 10.0f));
+        }
+        set_string(&details_subject, text);
+        publish_others();
+        set_state(WEATHER_VIEW_DATA);
+
+        // Republish when the cached data expires
+        int64_t expires_s = (int64_t)weather.timestamp + WEATHER_CACHE_TIMEOUT_SEC - time(NULL);
+        arm_refresh(expires_s > 0 ? (uint32_t)expires_s * 1000 : 1);
+        return;
+    }
+
+    if (weather_service_last_fetch_failed() && !fetch_pending) {
+        // weather_service retries with backoff and posts the result
+        set_string(&message_subject, "Failed to fetch weather");
+        set_state(WEATHER_VIEW_ERROR);
+        cancel_refresh();
+        return;
+    }
+
+    // No data yet (or it expired) - ask for it once and wait for the result
+    if (active_views > 0 && !fetch_pending) {
+        request_fetch();
+    }
+    set_string(&condition_subject, "Loading...");
+    set_state(WEATHER_VIEW_LOADING);
+}
+
+void weather_binding_set_active(bool active)
+{
+    if (!initialized) {
+        return;
+    }
+
+    active_views += active ? 1 : -1;
+    if (active_views < 0) {
+        active_views = 0;
+    }
+
+    if (active_views == 0) {
+        cancel_refresh();
+        return;
+    }
+
+    if (active) {
+        weather_binding_publish();
+    }
+}
+
+// Called from ui_state when weather_service posts an update
+static void weather_publisher(void)
+{
+    // A finished fetch (good or bad) ends the wait
+    fetch_pending = false;
+    weather_binding_publish();
+}
+
+void weather_binding_init(void)
+{
+    bsp_display_lock(0);
+
+    lv_subject_init_int(&state_subject, WEATHER_VIEW_LOADING);
+    lv_subject_init_string(&temperature_subject, temperature_buf, temperature_prev, TEXT_SHORT, "--°C");
+    lv_subject_init_string(&condition_subject, condition_buf, condition_prev, TEXT_SHORT, "Loading...");
+    lv_subject_init_string(&details_subject, details_buf, details_prev, TEXT_LONG, "");
+    lv_subject_init_string(&message_subject, message_buf, message_prev, TEXT_LONG, "");
+    lv_subject_init_string(&others_subject, others_buf, others_prev, TEXT_OTHERS, "");
+    initialized = true;
+
+    weather_binding_publish();
+
+    bsp_display_unlock();
+
+    ui_state_register_publisher("weather", weather_publisher);
+    ESP_LOGI(TAG, "Weather binding initialized");
+}
+
+lv_subject_t* weather_binding_state(void)
+{
+    return &state_subject;
+}
+
+lv_subject_t* weather_binding_temperature(void)
+{
+    return &temperature_subject;
+}
+
+lv_subject_t* weather_binding_condition(void)
+{
+    return &condition_subject;
+}
+
+lv_subject_t* weather_binding_details(void)
+{
+    return &details_subject;
+}
+
+lv_subject_t* weather_binding_message(void)
+{
+    return &message_subject;
+}
+
+lv_subject_t* weather_binding_others(void)
+{
+    return &others_subject;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "lvgl.h"
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Weather data as LVGL subjects
+ * weather_service data updates are published into these subjects on the
+ * LVGL task; labels bound to them change only when their text does.
+ * Subjects are only written when the value actually changes.
+ */
+
+/**
+ * @brief What the weather view should show
+ */
+typedef enum {
+    WEATHER_VIEW_LOADING = 0,   // Waiting for the first fetch
+    WEATHER_VIEW_DATA = 1,      // Temperature, condition and details are valid
+    WEATHER_VIEW_NO_ZIP = 2,    // No location configured
+    WEATHER_VIEW_ERROR = 3      // The last fetch failed
+} weather_view_state_t;
+
+/**
+ * @brief Create the subjects and register the publisher with ui_state
+ * Call after ui_state_init() and weather_service_init().
+ */
+void weather_binding_init(void);
+
+/**
+ * @brief Publish the current weather_service data (LVGL task)
+ */
+void weather_binding_publish(void);
+
+/**
+ * @brief Tell the binding whether anything is showing the data
+ * While active, missing data is requested right away (weather_service
+ * refreshes and retries on its own). Call with the display lock held.
+ * @param active true while a weather view is visible
+ */
+void weather_binding_set_active(bool active);
+
+/**
+ * @brief Subjects (valid after weather_binding_init)
+ */
+lv_subject_t* weather_binding_state(void);          // int: weather_view_state_t
+lv_subject_t* weather_binding_temperature(void);    // string: "21.5°C"
+lv_subject_t* weather_binding_condition(void);      // string: "Sunny" or "Loading..."
+lv_subject_t* weather_binding_details(void);        // string: humidity and wind
+lv_subject_t* weather_binding_message(void);        // string: error or setup hint
+lv_subject_t* weather_binding_others(void);         // string: one line per named location
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,314 @@
+#include "weather_forecast.h"
+#include "sd_database.h"
+#include "weather_service.h"
+#include "esp_log.h"
+#include "esp_rom_crc.h"
+#include "freertos/FreeRTOS.h"
+#include <string.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <math.h>
+
+static const char *TAG = "weather_forecast";
+
+#define FORECAST_MAGIC      0x46435354  // "FCST"
+#define FORECAST_VERSION    3   // 2: canonical units, 3: 32-byte location
+#define FORECAST_BLOB_KEY   "wx_fcst"
+
+static weather_forecast_t forecast;
+static bool has_forecast = false;
+static portMUX_TYPE forecast_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static uint32_t forecast_crc(const weather_forecast_t *fc)
+{
+    return esp_rom_crc32_le(0, (const uint8_t *)fc, offsetof(weather_forecast_t, crc));
+}
+
+static int16_t to_x10(float value)
+{
+    float scaled = roundf(value * 10.0f);
+    if (scaled > INT16_MAX) return INT16_MAX;
+    if (scaled < INT16_MIN) return INT16_MIN;
+    return (int16_t)scaled;
+}
+
+static uint8_t to_u8(float value)
+{
+    if (value <= 0.0f) return 0;
+    if (value >= 255.0f) return 255;
+    return (uint8_t)roundf(value);
+}
+
+void weather_forecast_init(void)
+{
+    if (!sd_db_is_ready()) {
+        return;
+    }
+
+    weather_forecast_t stored;
+    size_t len = sizeof(stored);
+    if (sd_db_get_blob(FORECAST_BLOB_KEY, &stored, &len) != ESP_OK) {
+        return;
+    }
+
+    if (len != sizeof(stored) || stored.magic != FORECAST_MAGIC ||
+        stored.version != FORECAST_VERSION || stored.crc != forecast_crc(&stored)) {
+        ESP_LOGW(TAG, "Ignoring stored forecast (old format or corrupt)");
+        return;
+    }
+
+    portENTER_CRITICAL(&forecast_lock);
+    forecast = stored;
+    has_forecast = true;
+    portEXIT_CRITICAL(&forecast_lock);
+
+    ESP_LOGI(TAG, "Loaded forecast for %s (%d hours, %d days)",
+             stored.zip_code, stored.hour_count, stored.day_count);
+}
+
+void weather_forecast_begin(weather_forecast_t *fc, const char *zip_code)
+{
+    memset(fc, 0, sizeof(*fc));
+    fc->magic = FORECAST_MAGIC;
+    fc->version = FORECAST_VERSION;
+    strncpy(fc->zip_code, zip_code, sizeof(fc->zip_code) - 1);
+}
+
+static bool parse_hourly(weather_forecast_t *fc, const char *field, int i, float number)
+{
+    if (i < 0 || i >= WEATHER_FORECAST_HOURS) {
+        return true;    // Beyond what we keep
+    }
+
+    weather_forecast_hour_t *hour = &fc->hours[i];
+    if (strcmp(field, "time[]") == 0) {
+        if (i == 0) {
+            fc->hourly_start = (uint32_t)number;
+        }
+        if (i + 1 > fc->hour_count) {
+            fc->hour_count = i + 1;
+        }
+    } else if (strcmp(field, "temperature_2m[]") == 0) {
+        hour->temp_x10 = to_x10(number);
+    } else if (strcmp(field, "relative_humidity_2m[]") == 0) {
+        hour->humidity = to_u8(number);
+    } else if (strcmp(field, "wind_speed_10m[]") == 0) {
+        float wind = roundf(number * 10.0f);
+        hour->wind_x10 = wind <= 0.0f ? 0 : (wind >= UINT16_MAX ? UINT16_MAX : (uint16_t)wind);
+    } else if (strcmp(field, "precipitation_probability[]") == 0) {
+        hour->precip_prob = to_u8(number);
+    } else if (strcmp(field, "weather_code[]") == 0) {
+        hour->weather_code = to_u8(number);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+static bool parse_daily(weather_forecast_t *fc, const char *field, int i, float number)
+{
+    if (i < 0 || i >= WEATHER_FORECAST_DAYS) {
+        return true;
+    }
+
+    weather_forecast_day_t *day = &fc->days[i];
+    if (strcmp(field, "time[]") == 0) {
+        if (i == 0) {
+            fc->daily_start = (uint32_t)number;
+        }
+        if (i + 1 > fc->day_count) {
+            fc->day_count = i + 1;
+        }
+    } else if (strcmp(field, "temperature_2m_max[]") == 0) {
+        day->temp_max_x10 = to_x10(number);
+    } else if (strcmp(field, "temperature_2m_min[]") == 0) {
+        day->temp_min_x10 = to_x10(number);
+    } else if (strcmp(field, "precipitation_probability_max[]") == 0) {
+        day->precip_prob = to_u8(number);
+    } else if (strcmp(field, "weather_code[]") == 0) {
+        day->weather_code = to_u8(number);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool weather_forecast_parse_value(weather_forecast_t *fc, const json_stream_value_t *value)
+{
+    bool hourly = strncmp(value->path, "hourly.", 7) == 0;
+    bool daily = strncmp(value->path, "daily.", 6) == 0;
+    if (!hourly && !daily) {
+        return false;
+    }
+
+    // Missing values (null) stay zero
+    if (value->type != JSON_STREAM_NUMBER) {
+        return true;
+    }
+
+    float number = strtof(value->text, NULL);
+    if (hourly) {
+        return parse_hourly(fc, value->path + 7, value->index, number);
+    }
+    return parse_daily(fc, value->path + 6, value->index, number);
+}
+
+esp_err_t weather_forecast_commit(weather_forecast_t *fc)
+{
+    if (fc->hour_count == 0 || fc->day_count == 0) {
+        return ESP_ERR_INVALID_RESPONSE;
+    }
+
+    fc->fetched_at = (uint32_t)time(NULL);
+    fc->crc = forecast_crc(fc);
+
+    portENTER_CRITICAL(&forecast_lock);
+    forecast = *fc;
+    has_forecast = true;
+    portEXIT_CRITICAL(&forecast_lock);
+
+    if (sd_db_is_ready()) {
+        sd_db_set_blob(FORECAST_BLOB_KEY, fc, sizeof(*fc));
+    }
+
+    ESP_LOGI(TAG, "Forecast updated (%d hours, %d days, %u bytes)",
+             fc->hour_count, fc->day_count, (unsigned)sizeof(*fc));
+    return ESP_OK;
+}
+
+void weather_forecast_clear(void)
+{
+    portENTER_CRITICAL(&forecast_lock);
+    has_forecast = false;
+    portEXIT_CRITICAL(&forecast_lock);
+
+    if (sd_db_is_ready()) {
+        sd_db_delete_blob(FORECAST_BLOB_KEY);
+    }
+}
+
+// Copy the forecast out, false if there is none
+static bool snapshot(weather_forecast_t *out)
+{
+    portENTER_CRITICAL(&forecast_lock);
+    bool valid = has_forecast;
+    if (valid) {
+        *out = forecast;
+    }
+    portEXIT_CRITICAL(&forecast_lock);
+    return valid;
+}
+
+bool weather_forecast_matches(const char *zip_code)
+{
+    portENTER_CRITICAL(&forecast_lock);
+    bool match = has_forecast &&
+                 strncmp(forecast.zip_code, zip_code, sizeof(forecast.zip_code)) == 0;
+    portEXIT_CRITICAL(&forecast_lock);
+    return match;
+}
+
+bool weather_forecast_needs_refresh(const char *zip_code, time_t now)
+{
+    if (!weather_forecast_matches(zip_code)) {
+        return true;
+    }
+
+    portENTER_CRITICAL(&forecast_lock);
+    time_t fetched_at = (time_t)forecast.fetched_at;
+    portEXIT_CRITICAL(&forecast_lock);
+
+    // A fetch "in the future" was made before the clock was set
+    return now - fetched_at >= WEATHER_FORECAST_REFRESH_SEC || now < fetched_at;
+}
+
+// Index of the slot containing now, or -1
+static int slot_index(time_t now, uint32_t start, uint32_t slot_sec, int count)
+{
+    if (now < (time_t)start) {
+        return -1;
+    }
+    int64_t index = ((int64_t)now - start) / slot_sec;
+    return index < count ? (int)index : -1;
+}
+
+esp_err_t weather_forecast_get_hour(time_t now, weather_forecast_hour_t *hour)
+{
+    weather_forecast_t fc;
+    if (!snapshot(&fc)) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    int i = slot_index(now, fc.hourly_start, 3600, fc.hour_count);
+    if (i < 0) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    *hour = fc.hours[i];
+    return ESP_OK;
+}
+
+esp_err_t weather_forecast_get_day(time_t now, weather_forecast_day_t *day)
+{
+    weather_forecast_t fc;
+    if (!snapshot(&fc)) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    int i = slot_index(now, fc.daily_start, 86400, fc.day_count);
+    if (i < 0) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    *day = fc.days[i];
+    return ESP_OK;
+}
+
+cJSON* weather_forecast_to_json(time_t now)
+{
+    cJSON *json = cJSON_CreateObject();
+    cJSON *hourly = cJSON_AddArrayToObject(json, "hourly");
+    cJSON *daily = cJSON_AddArrayToObject(json, "daily");
+
+    weather_forecast_t fc;
+    if (!snapshot(&fc)) {
+        return json;
+    }
+
+    cJSON_AddStringToObject(json, "temp_unit",
+                            weather_service_get_temp_unit() == WEATHER_TEMP_FAHRENHEIT ? "fahrenheit" : "celsius");
+    cJSON_AddStringToObject(json, "wind_unit", weather_service_wind_unit_name(weather_service_get_wind_unit()));
+    cJSON_AddNumberToObject(json, "fetched_at", fc.fetched_at);
+
+    // Skip the hours and days that have passed
+    int first_hour = 0;
+    if (now > (time_t)fc.hourly_start) {
+        first_hour = (int)(((int64_t)now - fc.hourly_start) / 3600);
+    }
+    for (int i = first_hour; i < fc.hour_count; i++) {
+        const weather_forecast_hour_t *h = &fc.hours[i];
+        cJSON *item = cJSON_CreateObject();
+        cJSON_AddNumberToObject(item, "time", fc.hourly_start + (uint32_t)i * 3600);
+        cJSON_AddNumberToObject(item, "temperature", weather_service_display_temp(h->temp_x10 / 10.0f));
+        cJSON_AddNumberToObject(item, "humidity", h->humidity);
+        cJSON_AddNumberToObject(item, "wind_speed", weather_service_display_wind(h->wind_x10 / 10.0f));
+        cJSON_AddNumberToObject(item, "precipitation_probability", h->precip_prob);
+        cJSON_AddNumberToObject(item, "weather_code", h->weather_code);
+        cJSON_AddItemToArray(hourly, item);
+    }
+
+    int first_day = 0;
+    if (now > (time_t)fc.daily_start) {
+        first_day = (int)(((int64_t)now - fc.daily_start) / 86400);
+    }
+    for (int i = first_day; i < fc.day_count; i++) {
+        const weather_forecast_day_t *d = &fc.days[i];
+        cJSON *item = cJSON_CreateObject();
+        cJSON_AddNumberToObject(item, "time", fc.daily_start + (uint32_t)i * 86400);
+        cJSON_AddNumberToObject(item, "temperature_max", weather_service_display_temp(d->temp_max_x10 / 10.0f));
+        cJSON_AddNumberToObject(item, "temperature_min", weather_service_display_temp(d->temp_min_x10 / 10.0f));
+        cJSON_AddNumberToObject(item, "precipitation_probability", d->precip_prob);
+        cJSON_AddNumberToObject(item, "weather_code", d->weather_code);
+        cJSON_AddItemToArray(daily, item);
+    }
+
+    return json;
+}
@@ -0,0 +1,139 @@
+#pragma once
+
+#include "esp_err.h"
+#include "cJSON.h"
+#include "json_stream.h"
+#include "weather_service.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Hourly and daily forecast cache
+ * Filled by weather_service from the forecast response (in °C and m/s,
+ * like weather_data_t) and kept in a
+ * packed fixed-point layout (about 400 bytes), which is stored as a blob
+ * so the forecast is available straight after a reboot. Series are
+ * refreshed every WEATHER_FORECAST_REFRESH_SEC; fetches in between only
+ * ask for current conditions.
+ *
+ * All functions are thread-safe.
+ */
+
+#define WEATHER_FORECAST_HOURS          48
+#define WEATHER_FORECAST_DAYS           7
+#define WEATHER_FORECAST_REFRESH_SEC    3600
+
+/**
+ * @brief One hour (temperatures in 0.1 °C)
+ */
+typedef struct __attribute__((packed)) {
+    int16_t temp_x10;
+    uint16_t wind_x10;          // 0.1 m/s
+    uint8_t humidity;           // %
+    uint8_t precip_prob;        // %
+    uint8_t weather_code;       // WMO code
+} weather_forecast_hour_t;
+
+/**
+ * @brief One day
+ */
+typedef struct __attribute__((packed)) {
+    int16_t temp_max_x10;
+    int16_t temp_min_x10;
+    uint8_t precip_prob;        // %
+    uint8_t weather_code;       // WMO code
+} weather_forecast_day_t;
+
+/**
+ * @brief The whole forecast, also the persisted layout
+ */
+typedef struct __attribute__((packed)) {
+    uint32_t magic;
+    uint8_t version;
+    uint8_t reserved;
+    uint8_t hour_count;
+    uint8_t day_count;
+    char zip_code[WEATHER_LOCATION_QUERY_LEN];  // Location the forecast is for
+    uint32_t fetched_at;        // Unix time
+    uint32_t hourly_start;      // Unix time of hours[0]
+    uint32_t daily_start;       // Unix time of local midnight of days[0]
+    weather_forecast_hour_t hours[WEATHER_FORECAST_HOURS];
+    weather_forecast_day_t days[WEATHER_FORECAST_DAYS];
+    uint32_t crc;               // Over everything above
+} weather_forecast_t;
+
+/**
+ * @brief Load the stored forecast
+ */
+void weather_forecast_init(void);
+
+/**
+ * @brief Start filling a forecast from a response
+ * @param fc Scratch forecast to fill
+ * @param zip_code Location being fetched
+ */
+void weather_forecast_begin(weather_forecast_t *fc, const char *zip_code);
+
+/**
+ * @brief Take a "hourly.*" or "daily.*" value from the response
+ * The request must use timeformat=unixtime.
+ * @return true if the value belonged to the forecast
+ */
+bool weather_forecast_parse_value(weather_forecast_t *fc, const json_stream_value_t *value);
+
+/**
+ * @brief Publish a filled forecast and store it
+ * @return ESP_OK on success, ESP_ERR_INVALID_RESPONSE if it has no series
+ */
+esp_err_t weather_forecast_commit(weather_forecast_t *fc);
+
+/**
+ * @brief Drop the forecast (location or unit changed)
+ */
+void weather_forecast_clear(void);
+
+/**
+ * @brief Check whether the forecast is for a location
+ * @return true if there is a forecast for zip_code
+ */
+bool weather_forecast_matches(const char *zip_code);
+
+/**
+ * @brief Check whether the series should be fetched again
+ * @param zip_code Current location
+ * @param now Current time
+ * @return true if there is no forecast for this location, or it is stale
+ */
+bool weather_forecast_needs_refresh(const char *zip_code, time_t now);
+
+/**
+ * @brief Get the forecast hour containing a time
+ * @param now Time to look up
+ * @param hour Output hour
+ * @return ESP_OK, or ESP_ERR_NOT_FOUND if the forecast does not cover it
+ */
+esp_err_t weather_forecast_get_hour(time_t now, weather_forecast_hour_t *hour);
+
+/**
+ * @brief Get the forecast day containing a time
+ * @return ESP_OK, or ESP_ERR_NOT_FOUND if the forecast does not cover it
+ */
+esp_err_t weather_forecast_get_day(time_t now, weather_forecast_day_t *day);
+
+/**
+ * @brief The forecast from the current hour and day on, as JSON
+ * Temperatures and wind speeds are in the selected display units.
+ * @param now Current time
+ * @return JSON object ({"hourly": [...], "daily": [...]}),
+ *         caller must free with cJSON_Delete
+ */
+cJSON* weather_forecast_to_json(time_t now);
+
+#ifdef __cplusplus
+}
+#endif
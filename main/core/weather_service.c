@@ -1,14 +1,25 @@
 #include "weather_service.h"
+#include "ui_state.h"
+#include "json_stream.h"
+#include "weather_forecast.h"
+#include "time_sync.h"
+#include "fetch_scheduler.h"
+#include "geocode_cache.h"
+#include "seqlock.h"
+#include "esp_random.h"
 #include "sd_database.h"
 #include "esp_log.h"
 #include "esp_http_client.h"
+#include "esp_timer.h"
 #include "cJSON.h"
+#include <stdio.h>
 #include <string.h>
+#include <strings.h>
+#include <ctype.h>
 #include <stdlib.h>
 #include <time.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
-#include "freertos/queue.h"
 #include "freertos/semphr.h"
 
 // Forward declaration for certificate bundle attach function
@@ -17,43 +28,192 @@ extern esp_err_t esp_crt_bundle_attach(void *conf);
 
 static const char *TAG = "weather_service";
 
+// API endpoints come from menuconfig (or -D on builds without sdkconfig)
+#ifdef CONFIG_WEATHER_GEOCODING_URL
+#define OPEN_METEO_GEOCODING_API CONFIG_WEATHER_GEOCODING_URL
+#else
 #define OPEN_METEO_GEOCODING_API "https://geocoding-api.open-meteo.com/v1/search"
+#endif
+#ifdef CONFIG_WEATHER_FORECAST_URL
+#define OPEN_METEO_FORECAST_API CONFIG_WEATHER_FORECAST_URL
+#else
 #define OPEN_METEO_FORECAST_API "https://api.open-meteo.com/v1/forecast"
-#define WEATHER_CACHE_TIMEOUT_SEC 600  // 10 minutes
+#endif
+#ifdef CONFIG_WEATHER_HTTP_TIMEOUT_MS
+#define WEATHER_HTTP_TIMEOUT_MS CONFIG_WEATHER_HTTP_TIMEOUT_MS
+#else
+#define WEATHER_HTTP_TIMEOUT_MS 10000
+#endif
 
-static char zip_code[16] = {0};
-static weather_data_t cached_weather = {0};
-static float cached_latitude = 0.0f;
-static float cached_longitude = 0.0f;
+// Retry delays after failed fetches (exponential with jitter)
+#define WEATHER_BACKOFF_MIN_SEC     5
+#define WEATHER_BACKOFF_MAX_SEC     900
+#define WEATHER_MAX_SLEEP_SEC       3600
+
+// Series requested when the stored forecast is due for a refresh
+#define FORECAST_SERIES_PARAMS \
+    "&hourly=temperature_2m,relative_humidity_2m,wind_speed_10m,precipitation_probability,weather_code" \
+    "&daily=weather_code,temperature_2m_max,temperature_2m_min,precipitation_probability_max" \
+    "&forecast_hours=48&forecast_days=7"
+
+// Slot 0 is the zip code location; the others are named locations added
+// through the API. All of them are refreshed by one forecast request.
+typedef struct {
+    char name[WEATHER_LOCATION_NAME_LEN];   // Empty for an unused slot
+    char query[WEATHER_LOCATION_QUERY_LEN]; // Zip code or place name
+} weather_location_t;
+
+static weather_location_t locations[WEATHER_MAX_LOCATIONS] = {
+    [0] = { .name = WEATHER_PRIMARY_LOCATION },
+};
+static portMUX_TYPE locations_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// Cached weather per location is published through a seqlock: readers
+// (the LVGL task, httpd) copy it without blocking and retry if a write
+// overlapped the copy
+typedef struct {
+    weather_data_t data;
+    seqlock_t lock;
+} weather_cache_slot_t;
+
+static weather_cache_slot_t cached_weather[WEATHER_MAX_LOCATIONS];
+static portMUX_TYPE cached_weather_write_lock = portMUX_INITIALIZER_UNLOCKED;
 static weather_temp_unit_t temp_unit = WEATHER_TEMP_CELSIUS;  // Default to Celsius
+static weather_wind_unit_t wind_unit = WEATHER_WIND_KMH;
 
 // Task and synchronization
 static TaskHandle_t weather_task_handle = NULL;
-static QueueHandle_t weather_fetch_queue = NULL;
-static SemaphoreHandle_t weather_data_mutex = NULL;
+static SemaphoreHandle_t weather_data_mutex = NULL;   // Serializes writers only
 static bool weather_task_running = false;
+static volatile bool last_fetch_failed = false;
+
+// Decides when the fetch task refreshes; requests only wake the task
+static fetch_scheduler_t scheduler;
+static portMUX_TYPE scheduler_lock = portMUX_INITIALIZER_UNLOCKED;
+static volatile uint32_t location_generation = 0;   // Bumped on a location change (under weather_data_mutex)
+
+// Scheduler clock: monotonic seconds, unaffected by SNTP steps
+static int64_t scheduler_now(void)
+{
+    return esp_timer_get_time() / 1000000;
+}
+
+static void wake_fetch_task(void)
+{
+    if (weather_task_handle != NULL) {
+        xTaskNotifyGive(weather_task_handle);
+    }
+}
+
+// Forget the data after a location change and fetch again now
+static void invalidate_schedule(void)
+{
+    portENTER_CRITICAL(&scheduler_lock);
+    fetch_scheduler_invalidate(&scheduler);
+    portEXIT_CRITICAL(&scheduler_lock);
+    wake_fetch_task();
+}
+
+// Replace a location's cached weather (NULL clears it). Callers hold
+// weather_data_mutex.
+static void cache_publish(int slot, const weather_data_t *data)
+{
+    weather_cache_slot_t *cache = &cached_weather[slot];
+
+    // The copy runs in a critical section so a reader never waits on a
+    // preempted writer
+    portENTER_CRITICAL(&cached_weather_write_lock);
+    seqlock_write(&cache->lock, &cache->data, data, sizeof(weather_data_t));
+    portEXIT_CRITICAL(&cached_weather_write_lock);
+}
+
+// Copy a consistent snapshot of a location's cached weather without
+// taking a lock
+static void cache_read(int slot, weather_data_t *out)
+{
+    weather_cache_slot_t *cache = &cached_weather[slot];
+    seqlock_read(&cache->lock, out, &cache->data, sizeof(weather_data_t));
+}
 
-// Structure to pass response buffer through event handler
+// Copy the locations table (any task)
+static void locations_snapshot(weather_location_t *out)
+{
+    portENTER_CRITICAL(&locations_lock);
+    memcpy(out, locations, sizeof(locations));
+    portEXIT_CRITICAL(&locations_lock);
+}
+
+// Slot of a named location (case-insensitive), -1 if none. Callers hold
+// locations_lock.
+static int find_location(const char *name)
+{
+    for (int i = 0; i < WEATHER_MAX_LOCATIONS; i++) {
+        if (locations[i].name[0] != '\0' && strcasecmp(locations[i].name, name) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// A long-lived HTTPS client for one API host. Requests reuse the
+// keep-alive connection and resume the TLS session when it was dropped,
+// so only the first fetch pays for a full handshake.
+//
+// The session is kept for this boot only. esp_http_client keeps it inside
+// its transport with no API to export it, and a saved session holds the
+// master secret, which must not go to the unencrypted, removable SD card
+// behind sd_db. What this costs is one full handshake per host after a
+// reboot; host_test/weather_service/bench_weather_handshakes measures it.
 typedef struct {
-    char *buffer;
-    int len;
-    int max_len;
+    const char *name;
+    esp_http_client_handle_t client;
+    uint32_t requests;
+    uint32_t connects;          // New TCP/TLS connections
+    uint32_t failures;
+    int64_t total_us;
+    int64_t last_us;
+    uint64_t bytes;             // Response bodies parsed
+    uint32_t last_bytes;
+    int64_t parse_us;           // Time spent in the JSON tokenizer
+} weather_conn_t;
+
+static weather_conn_t geocode_conn = { .name = "geocoding" };
+static weather_conn_t forecast_conn = { .name = "forecast" };
+static portMUX_TYPE conn_stats_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// Per-request state passed through the event handler. The body is parsed
+// as it arrives, so no response buffer is needed whatever its size.
+typedef struct {
+    json_stream_t *parser;
+    bool parse_failed;
+    weather_conn_t *conn;
+    uint32_t bytes;
+    int64_t parse_us;
 } http_response_t;
 
-// HTTP event handler for geocoding
-static esp_err_t geocoding_http_event_handler(esp_http_client_event_t *evt)
+// HTTP event handler shared by the geocoding and forecast requests
+static esp_err_t weather_http_event_handler(esp_http_client_event_t *evt)
 {
     http_response_t *response = (http_response_t *)evt->user_data;
 
     switch (evt->event_id) {
+        case HTTP_EVENT_ON_CONNECTED:
+            if (response && response->conn) {
+                portENTER_CRITICAL(&conn_stats_lock);
+                response->conn->connects++;
+                portEXIT_CRITICAL(&conn_stats_lock);
+            }
+            break;
         case HTTP_EVENT_ON_DATA:
-            if (response) {
-                int len = evt->data_len;
-                if (response->buffer && (response->len + len) < response->max_len) {
-                    memcpy(response->buffer + response->len, evt->data, len);
-                    response->len += len;
-                    response->buffer[response->len] = '\0';
+            // Error bodies are not JSON we understand, skip them
+            if (response && response->parser && !response->parse_failed &&
+                esp_http_client_get_status_code(evt->client) == 200) {
+                int64_t start_us = esp_timer_get_time();
+                if (json_stream_feed(response->parser, evt->data, evt->data_len) != ESP_OK) {
+                    response->parse_failed = true;
                 }
+                response->parse_us += esp_timer_get_time() - start_us;
+                response->bytes += evt->data_len;
             }
             break;
         default:
@@ -62,22 +222,141 @@ static esp_err_t geocoding_http_event_handler(esp_http_client_event_t *evt)
     return ESP_OK;
 }
 
-// Geocode zip code to latitude/longitude using Open-Meteo Geocoding API
-static esp_err_t geocode_zip_code(const char *zip, float *latitude, float *longitude)
+// GET a URL over the host's persistent connection (weather fetch task only)
+static esp_err_t weather_http_get(weather_conn_t *conn, const char *url, http_response_t *response, int *status_code)
+{
+    if (conn->client == NULL) {
+        // Plain http is allowed so the APIs can be pointed at a local server
+        bool tls = strncmp(url, "https://", 8) == 0;
+        esp_http_client_config_t config = {
+            .url = url,
+            .event_handler = weather_http_event_handler,
+            .timeout_ms = WEATHER_HTTP_TIMEOUT_MS,
+            .transport_type = tls ? HTTP_TRANSPORT_OVER_SSL : HTTP_TRANSPORT_OVER_TCP,
+            .keep_alive_enable = true,
+            .save_client_session = tls,     // Resume the TLS session on reconnect
+        };
+        if (tls) {
+            // Use certificate bundle if available (configured via sdkconfig)
+            config.crt_bundle_attach = esp_crt_bundle_attach;
+        }
+
+        conn->client = esp_http_client_init(&config);
+        if (conn->client == NULL) {
+            ESP_LOGE(TAG, "Failed to initialize HTTP client");
+            return ESP_FAIL;
+        }
+    } else {
+        esp_http_client_set_url(conn->client, url);
+    }
+
+    response->conn = conn;
+    esp_http_client_set_user_data(conn->client, response);
+
+    int64_t start_us = esp_timer_get_time();
+    uint32_t connects = conn->connects;
+    esp_err_t err = esp_http_client_perform(conn->client);
+    // The server may have closed the idle keep-alive connection: reconnect
+    // once, but only if the request went out on a reused connection and
+    // failed before any response arrived. A fresh connection failing would
+    // fail again, and a timeout (reported as a header fetch error in
+    // blocking mode, so told apart by the time taken) would double the wait.
+    bool timed_out = err == ESP_ERR_HTTP_EAGAIN ||
+                     esp_timer_get_time() - start_us >= (int64_t)WEATHER_HTTP_TIMEOUT_MS * 1000;
+    if (err != ESP_OK && !timed_out && conn->connects == connects && response->bytes == 0) {
+        ESP_LOGW(TAG, "%s keep-alive connection lost (%s), reconnecting", conn->name, esp_err_to_name(err));
+        esp_http_client_close(conn->client);
+        json_stream_reset(response->parser);
+        response->parse_failed = false;
+        response->bytes = 0;
+        response->parse_us = 0;
+        err = esp_http_client_perform(conn->client);
+    }
+    int64_t elapsed_us = esp_timer_get_time() - start_us;
+
+    portENTER_CRITICAL(&conn_stats_lock);
+    conn->requests++;
+    conn->total_us += elapsed_us;
+    conn->last_us = elapsed_us;
+    conn->bytes += response->bytes;
+    conn->last_bytes = response->bytes;
+    conn->parse_us += response->parse_us;
+    if (err != ESP_OK) {
+        conn->failures++;
+    }
+    portEXIT_CRITICAL(&conn_stats_lock);
+
+    if (err != ESP_OK) {
+        esp_http_client_close(conn->client);
+        return err;
+    }
+
+    *status_code = esp_http_client_get_status_code(conn->client);
+    if (*status_code == 200 && (response->parse_failed || json_stream_finish(response->parser) != ESP_OK)) {
+        ESP_LOGE(TAG, "%s response is not valid JSON", conn->name);
+        return ESP_FAIL;
+    }
+    ESP_LOGI(TAG, "%s request took %lld ms (%lu bytes, %lld us parsing)", conn->name,
+             (long long)(elapsed_us / 1000), (unsigned long)response->bytes, (long long)response->parse_us);
+    return ESP_OK;
+}
+
+typedef struct {
+    geocode_entry_t *entry;
+    bool has_latitude;
+    bool has_longitude;
+} geocode_result_t;
+
+static void copy_text(char *dest, size_t len, const char *text)
+{
+    strncpy(dest, text, len - 1);
+    dest[len - 1] = '\0';
+}
+
+// Take the coordinates, name and timezone of the first result
+static void geocode_value_cb(const json_stream_value_t *value, void *user_data)
+{
+    geocode_result_t *result = (geocode_result_t *)user_data;
+    if (value->index != 0) {
+        return;
+    }
+    if (value->type == JSON_STREAM_NUMBER) {
+        if (strcmp(value->path, "results[].latitude") == 0) {
+            result->entry->latitude = strtof(value->text, NULL);
+            result->has_latitude = true;
+        } else if (strcmp(value->path, "results[].longitude") == 0) {
+            result->entry->longitude = strtof(value->text, NULL);
+            result->has_longitude = true;
+        }
+    } else if (value->type == JSON_STREAM_STRING) {
+        if (strcmp(value->path, "results[].name") == 0) {
+            copy_text(result->entry->name, sizeof(result->entry->name), value->text);
+        } else if (strcmp(value->path, "results[].timezone") == 0) {
+            copy_text(result->entry->timezone, sizeof(result->entry->timezone), value->text);
+        }
+    }
+}
+
+// Geocode a zip code using Open-Meteo Geocoding API
+static esp_err_t geocode_zip_code(const char *zip, geocode_entry_t *entry)
 {
     if (!zip || strlen(zip) == 0) {
         return ESP_ERR_INVALID_ARG;
     }
 
     char url[256];
-    // URL encode the zip code (simple version - just handle spaces)
-    char encoded_zip[32];
-    int j = 0;
-    for (int i = 0; zip[i] && j < sizeof(encoded_zip) - 1; i++) {
-        if (zip[i] == ' ') {
-            encoded_zip[j++] = '+';
+    // Percent-encode everything but RFC 3986 unreserved characters
+    static const char hex[] = "0123456789ABCDEF";
+    char encoded_zip[WEATHER_LOCATION_QUERY_LEN * 3];
+    size_t j = 0;
+    for (size_t i = 0; zip[i] && j + 3 < sizeof(encoded_zip); i++) {
+        unsigned char c = (unsigned char)zip[i];
+        if (isalnum(c) || c == '-' || c == '_' || c == '.' || c == '~') {
+            encoded_zip[j++] = (char)c;
         } else {
-            encoded_zip[j++] = zip[i];
+            encoded_zip[j++] = '%';
+            encoded_zip[j++] = hex[c >> 4];
+            encoded_zip[j++] = hex[c & 0x0F];
         }
     }
     encoded_zip[j] = '\0';
@@ -91,67 +370,30 @@ static esp_err_t geocode_zip_code(const char *zip, float *latitude, float *longi
 
     ESP_LOGI(TAG, "Geocoding zip code: %s", zip);
 
-    char response_buffer[2048] = {0};
-    http_response_t response = {
-        .buffer = response_buffer,
-        .len = 0,
-        .max_len = sizeof(response_buffer) - 1
-    };
-
-    esp_http_client_config_t config = {
-        .url = url,
-        .event_handler = geocoding_http_event_handler,
-        .user_data = &response,
-        .timeout_ms = 10000,
-        .transport_type = HTTP_TRANSPORT_OVER_SSL,
-    };
-    // Use certificate bundle if available (configured via sdkconfig)
-    config.crt_bundle_attach = esp_crt_bundle_attach;
+    memset(entry, 0, sizeof(*entry));
+    geocode_result_t result = { .entry = entry };
+    json_stream_t parser;
+    json_stream_init(&parser, geocode_value_cb, &result);
+    http_response_t response = { .parser = &parser };
 
-    esp_http_client_handle_t client = esp_http_client_init(&config);
-    if (client == NULL) {
-        ESP_LOGE(TAG, "Failed to initialize HTTP client");
+    int status_code = 0;
+    esp_err_t err = weather_http_get(&geocode_conn, url, &response, &status_code);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "HTTP GET request failed: %s", esp_err_to_name(err));
         return ESP_FAIL;
     }
-
-    esp_err_t err = esp_http_client_perform(client);
-    if (err == ESP_OK) {
-        int status_code = esp_http_client_get_status_code(client);
-        
-        ESP_LOGI(TAG, "HTTP Status = %d, response length = %d", status_code, response.len);
-        
-        if (status_code != 200 && response.len > 0) {
-            ESP_LOGE(TAG, "Geocoding API error. Response: %.*s", response.len, response.buffer);
-        }
-        
-        if (status_code == 200 && response.len > 0) {
-            // Parse JSON response
-            cJSON *json = cJSON_Parse(response.buffer);
-            if (json) {
-                cJSON *results = cJSON_GetObjectItem(json, "results");
-                if (results && cJSON_IsArray(results) && cJSON_GetArraySize(results) > 0) {
-                    cJSON *first_result = cJSON_GetArrayItem(results, 0);
-                    cJSON *lat = cJSON_GetObjectItem(first_result, "latitude");
-                    cJSON *lon = cJSON_GetObjectItem(first_result, "longitude");
-                    
-                    if (lat && lon && cJSON_IsNumber(lat) && cJSON_IsNumber(lon)) {
-                        *latitude = (float)cJSON_GetNumberValue(lat);
-                        *longitude = (float)cJSON_GetNumberValue(lon);
-                        ESP_LOGI(TAG, "Geocoded %s to lat=%.4f, lon=%.4f", zip, *latitude, *longitude);
-                        cJSON_Delete(json);
-                        esp_http_client_cleanup(client);
-                        return ESP_OK;
-                    }
-                }
-                cJSON_Delete(json);
-            }
-        }
-    } else {
-        ESP_LOGE(TAG, "HTTP GET request failed: %s", esp_err_to_name(err));
+    if (status_code != 200) {
+        ESP_LOGE(TAG, "Geocoding API error: HTTP %d", status_code);
+        return ESP_FAIL;
+    }
+    if (!result.has_latitude || !result.has_longitude) {
+        ESP_LOGE(TAG, "No geocoding result for %s", zip);
+        return ESP_FAIL;
     }
 
-    esp_http_client_cleanup(client);
-    return ESP_FAIL;
+    ESP_LOGI(TAG, "Geocoded %s to %s (lat=%.4f, lon=%.4f, %s)", zip, entry->name,
+             entry->latitude, entry->longitude, entry->timezone);
+    return ESP_OK;
 }
 
 // Convert WMO weather code to human-readable condition
@@ -180,157 +422,308 @@ static void weather_code_to_condition(int code, char *condition, size_t len)
     }
 }
 
-// HTTP event handler for weather data
-static esp_err_t weather_http_event_handler(esp_http_client_event_t *evt)
+// One location in a forecast request
+typedef struct {
+    int slot;                   // Index into locations
+    float latitude;
+    float longitude;
+    weather_data_t data;
+    bool has_current;
+} weather_request_t;
+
+typedef struct {
+    weather_request_t *requests;
+    int count;
+    weather_forecast_t *series;     // NULL when only current conditions were requested
+} forecast_result_t;
+
+// Pick the current conditions out of the forecast response. With several
+// coordinates the response is an array with one object per location, in
+// request order; with one it is that object.
+static void forecast_value_cb(const json_stream_value_t *value, void *user_data)
 {
-    http_response_t *response = (http_response_t *)evt->user_data;
+    forecast_result_t *result = (forecast_result_t *)user_data;
+    json_stream_value_t local = *value;
+    int position = 0;
+    if (strncmp(value->path, "[].", 3) == 0) {
+        local.path = value->path + 3;
+        position = value->outer_index;
+    }
+    if (position < 0 || position >= result->count) {
+        return;
+    }
 
-    switch (evt->event_id) {
-        case HTTP_EVENT_ON_DATA:
-            if (response) {
-                int len = evt->data_len;
-                if (response->buffer && (response->len + len) < response->max_len) {
-                    memcpy(response->buffer + response->len, evt->data, len);
-                    response->len += len;
-                    response->buffer[response->len] = '\0';
-                }
-            }
-            break;
-        default:
-            break;
+    // The series belong to the zip code location, which is requested first
+    if (result->series && position == 0 && weather_forecast_parse_value(result->series, &local)) {
+        return;
     }
-    return ESP_OK;
+    if (local.type != JSON_STREAM_NUMBER || strncmp(local.path, "current.", 8) != 0) {
+        return;
+    }
+
+    const char *field = local.path + 8;
+    float number = strtof(local.text, NULL);
+    weather_data_t *data = &result->requests[position].data;
+    if (strcmp(field, "temperature_2m") == 0) {
+        data->temperature = number;
+    } else if (strcmp(field, "relative_humidity_2m") == 0) {
+        data->humidity = number;
+    } else if (strcmp(field, "wind_speed_10m") == 0) {
+        data->wind_speed = number;
+    } else if (strcmp(field, "weather_code") == 0) {
+        data->weather_code = (int)number;
+        weather_code_to_condition(data->weather_code, data->condition, sizeof(data->condition));
+    } else {
+        return;
+    }
+    result->requests[position].has_current = true;
 }
 
-// Fetch weather data from Open-Meteo Forecast API
-static esp_err_t fetch_weather_data(float latitude, float longitude, weather_data_t *data)
+// Append ",a,b,c" style coordinate lists to the URL
+static int append_coordinates(char *url, size_t len, int pos, const char *key,
+                              const weather_request_t *requests, int count, bool latitude)
 {
-    char url[512];
-    const char *temp_unit_str = (temp_unit == WEATHER_TEMP_FAHRENHEIT) ? "fahrenheit" : "celsius";
-    snprintf(url, sizeof(url), 
-             "%s?latitude=%.4f&longitude=%.4f&current=temperature_2m,relative_humidity_2m,wind_speed_10m,weather_code&temperature_unit=%s&timezone=auto",
-             OPEN_METEO_FORECAST_API, latitude, longitude, temp_unit_str);
+    pos += snprintf(url + pos, pos < (int)len ? len - pos : 0, "%s", key);
+    for (int i = 0; i < count; i++) {
+        pos += snprintf(url + pos, pos < (int)len ? len - pos : 0, "%s%.4f", i ? "," : "",
+                        latitude ? requests[i].latitude : requests[i].longitude);
+    }
+    return pos;
+}
 
-    ESP_LOGI(TAG, "Fetching weather data");
+// Fetch current conditions for every requested location with one
+// Open-Meteo Forecast API call (comma-separated coordinates). The hourly
+// and daily series are only requested when the zip code location is first
+// in the request and its stored forecast is due for a refresh.
+static esp_err_t fetch_weather_data(weather_request_t *requests, int count, const char *primary_zip)
+{
+    static weather_forecast_t series;   // Fetch task only; too big for its stack
+    bool want_series = requests[0].slot == 0 && weather_forecast_needs_refresh(primary_zip, time(NULL));
+    
+    // Always fetched in canonical units (°C, m/s); converted for display
+    char url[768];
+    int pos = snprintf(url, sizeof(url), "%s", OPEN_METEO_FORECAST_API);
+    pos = append_coordinates(url, sizeof(url), pos, "?latitude=", requests, count, true);
+    pos = append_coordinates(url, sizeof(url), pos, "&longitude=", requests, count, false);
+    pos += snprintf(url + pos, pos < (int)sizeof(url) ? sizeof(url) - pos : 0,
+                    "&current=temperature_2m,relative_humidity_2m,wind_speed_10m,weather_code&wind_speed_unit=ms&timezone=auto&timeformat=unixtime%s",
+                    want_series ? FORECAST_SERIES_PARAMS : "");
+    if (pos >= (int)sizeof(url)) {
+        ESP_LOGE(TAG, "Weather URL too long");
+        return ESP_FAIL;
+    }
 
-    char response_buffer[4096] = {0};
-    http_response_t response = {
-        .buffer = response_buffer,
-        .len = 0,
-        .max_len = sizeof(response_buffer) - 1
-    };
+    ESP_LOGI(TAG, "Fetching weather data for %d location(s)", count);
 
-    esp_http_client_config_t config = {
-        .url = url,
-        .event_handler = weather_http_event_handler,
-        .user_data = &response,
-        .timeout_ms = 10000,
-        .transport_type = HTTP_TRANSPORT_OVER_SSL,
-    };
-    // Use certificate bundle if available (configured via sdkconfig)
-    config.crt_bundle_attach = esp_crt_bundle_attach;
+    forecast_result_t result = { .requests = requests, .count = count };
+    if (want_series) {
+        weather_forecast_begin(&series, primary_zip);
+        result.series = &series;
+    }
+    json_stream_t parser;
+    json_stream_init(&parser, forecast_value_cb, &result);
+    http_response_t response = { .parser = &parser };
 
-    esp_http_client_handle_t client = esp_http_client_init(&config);
-    if (client == NULL) {
-        ESP_LOGE(TAG, "Failed to initialize HTTP client");
+    int status_code = 0;
+    esp_err_t err = weather_http_get(&forecast_conn, url, &response, &status_code);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "HTTP GET request failed: %s", esp_err_to_name(err));
+        return ESP_FAIL;
+    }
+    if (status_code != 200) {
+        ESP_LOGE(TAG, "Weather API error: HTTP %d", status_code);
         return ESP_FAIL;
     }
 
-    esp_err_t err = esp_http_client_perform(client);
-    if (err == ESP_OK) {
-        int status_code = esp_http_client_get_status_code(client);
-        
-        ESP_LOGI(TAG, "HTTP Status = %d, response length = %d", status_code, response.len);
-        
-        if (status_code != 200 && response.len > 0) {
-            ESP_LOGE(TAG, "Weather API error. Response: %.*s", response.len, response.buffer);
+    uint32_t now = (uint32_t)time(NULL);
+    bool any = false;
+    for (int i = 0; i < count; i++) {
+        weather_data_t *data = &requests[i].data;
+        if (!requests[i].has_current) {
+            ESP_LOGE(TAG, "Weather response has no current conditions for location %d", requests[i].slot);
+            continue;
         }
-        
-        if (status_code == 200 && response.len > 0) {
-            // Parse JSON response
-            cJSON *json = cJSON_Parse(response.buffer);
-            if (json) {
-                cJSON *current = cJSON_GetObjectItem(json, "current");
-                if (current) {
-                    cJSON *temp = cJSON_GetObjectItem(current, "temperature_2m");
-                    cJSON *humidity = cJSON_GetObjectItem(current, "relative_humidity_2m");
-                    cJSON *wind = cJSON_GetObjectItem(current, "wind_speed_10m");
-                    cJSON *weather_code = cJSON_GetObjectItem(current, "weather_code");
-                    
-                    if (temp && cJSON_IsNumber(temp)) {
-                        data->temperature = (float)cJSON_GetNumberValue(temp);
-                    }
-                    if (humidity && cJSON_IsNumber(humidity)) {
-                        data->humidity = (float)cJSON_GetNumberValue(humidity);
-                    }
-                    if (wind && cJSON_IsNumber(wind)) {
-                        data->wind_speed = (float)cJSON_GetNumberValue(wind);
-                    }
-                    if (weather_code && cJSON_IsNumber(weather_code)) {
-                        data->weather_code = (int)cJSON_GetNumberValue(weather_code);
-                        weather_code_to_condition(data->weather_code, data->condition, sizeof(data->condition));
-                    }
-                    
-                    data->valid = true;
-                    data->timestamp = (uint32_t)time(NULL);
-                    
-                    ESP_LOGI(TAG, "Weather: %.1f°C, %.0f%% humidity, %.1f km/h wind, %s", 
-                            data->temperature, data->humidity, data->wind_speed, data->condition);
-                    
-                    cJSON_Delete(json);
-                    esp_http_client_cleanup(client);
-                    return ESP_OK;
-                }
-                cJSON_Delete(json);
-            }
+        data->valid = true;
+        data->timestamp = now;
+        any = true;
+        ESP_LOGI(TAG, "Weather[%d]: %.1f°C, %.0f%% humidity, %.1f m/s wind, %s", requests[i].slot,
+                 data->temperature, data->humidity, data->wind_speed, data->condition);
+    }
+    
+    if (want_series && requests[0].has_current && weather_forecast_commit(&series) != ESP_OK) {
+        ESP_LOGW(TAG, "Weather response has no forecast series");
+    }
+    return any ? ESP_OK : ESP_FAIL;
+}
+
+// Show the stored forecast for the current hour until the first fetch
+// lands, so a reboot does not start from "Loading..."
+static void seed_from_forecast(void)
+{
+    weather_data_t current;
+    cache_read(0, &current);
+    if (current.valid) {
+        return;
+    }
+    
+    weather_location_t snapshot[WEATHER_MAX_LOCATIONS];
+    locations_snapshot(snapshot);
+    
+    time_t now = time(NULL);
+    weather_forecast_hour_t hour;
+    if (!weather_forecast_matches(snapshot[0].query) ||
+        weather_forecast_get_hour(now, &hour) != ESP_OK) {
+        return;     // Stored forecast is for another location, or has run out
+    }
+    
+    weather_data_t weather = {
+        .temperature = hour.temp_x10 / 10.0f,
+        .humidity = hour.humidity,
+        .wind_speed = hour.wind_x10 / 10.0f,
+        .weather_code = hour.weather_code,
+        .valid = true,
+        .timestamp = (uint32_t)now,
+    };
+    weather_code_to_condition(weather.weather_code, weather.condition, sizeof(weather.condition));
+    
+    if (xSemaphoreTake(weather_data_mutex, portMAX_DELAY) == pdTRUE) {
+        cache_publish(0, &weather);
+        xSemaphoreGive(weather_data_mutex);
+    }
+    ESP_LOGI(TAG, "Showing stored forecast until the first fetch");
+    ui_state_post_data_updated("weather");
+}
+
+// Resolve a location from the geocode table, asking the API only on a miss
+static bool resolve_location(const char *query, float *latitude, float *longitude)
+{
+    geocode_entry_t entry;
+    if (geocode_cache_lookup(query, &entry) != ESP_OK) {
+        if (geocode_zip_code(query, &entry) != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to geocode location: %s", query);
+            return false;
         }
-    } else {
-        ESP_LOGE(TAG, "HTTP GET request failed: %s", esp_err_to_name(err));
+        geocode_cache_store(query, &entry);
     }
+    
+    *latitude = entry.latitude;
+    *longitude = entry.longitude;
+    return true;
+}
 
-    esp_http_client_cleanup(client);
-    return ESP_FAIL;
+// Geocode the configured locations, then fetch all of them in one request.
+// Returns the number of requests filled in (0 if nothing could be fetched).
+static int fetch_current(const weather_location_t *snapshot, weather_request_t *requests, bool *complete)
+{
+    int count = 0;
+    int configured = 0;
+    for (int i = 0; i < WEATHER_MAX_LOCATIONS; i++) {
+        if (snapshot[i].name[0] == '\0' || snapshot[i].query[0] == '\0') {
+            continue;
+        }
+        configured++;
+        weather_request_t *request = &requests[count];
+        memset(request, 0, sizeof(*request));
+        request->slot = i;
+        if (resolve_location(snapshot[i].query, &request->latitude, &request->longitude)) {
+            count++;
+        }
+    }
+    
+    if (count == 0 || fetch_weather_data(requests, count, snapshot[0].query) != ESP_OK) {
+        *complete = false;
+        return 0;
+    }
+    
+    int fetched = 0;
+    for (int i = 0; i < count; i++) {
+        fetched += requests[i].has_current ? 1 : 0;
+    }
+    *complete = fetched == configured;
+    return count;
 }
 
-// Weather fetch task (runs HTTP operations in background)
+// Weather fetch task (runs HTTP operations in background). Sleeps until
+// the scheduler says a refresh is due or a request wakes it.
 static void weather_fetch_task(void *pvParameters)
 {
     (void)pvParameters;
+    bool seeded = false;
     
     while (weather_task_running) {
-        // Wait for fetch request
-        bool fetch_requested = false;
-        if (xQueueReceive(weather_fetch_queue, &fetch_requested, pdMS_TO_TICKS(1000)) == pdTRUE) {
-            if (!fetch_requested) {
-                continue;
-            }
-            
-            if (strlen(zip_code) == 0) {
-                ESP_LOGW(TAG, "No zip code configured, skipping fetch");
-                continue;
-            }
-            
-            // Geocode zip code if needed
-            if (cached_latitude == 0.0f && cached_longitude == 0.0f) {
-                if (geocode_zip_code(zip_code, &cached_latitude, &cached_longitude) != ESP_OK) {
-                    ESP_LOGE(TAG, "Failed to geocode zip code: %s", zip_code);
-                    continue;
-                }
+        // The stored forecast can be used once the clock is right
+        if (!seeded && time_sync_is_synced()) {
+            seeded = true;
+            seed_from_forecast();
+        }
+        
+        // Read before the snapshot so any later change is noticed
+        uint32_t generation = location_generation;
+        weather_location_t snapshot[WEATHER_MAX_LOCATIONS];
+        locations_snapshot(snapshot);
+        bool has_location = false;
+        for (int i = 0; i < WEATHER_MAX_LOCATIONS; i++) {
+            has_location |= snapshot[i].name[0] != '\0' && snapshot[i].query[0] != '\0';
+        }
+        
+        portENTER_CRITICAL(&scheduler_lock);
+        int64_t now = scheduler_now();
+        bool start = has_location && fetch_scheduler_begin(&scheduler, now);
+        uint32_t wait_s = fetch_scheduler_next_delay(&scheduler, now);
+        portEXIT_CRITICAL(&scheduler_lock);
+        
+        if (!start) {
+            TickType_t wait = portMAX_DELAY;
+            if (has_location && wait_s <= WEATHER_MAX_SLEEP_SEC) {
+                wait = pdMS_TO_TICKS(wait_s * 1000);
+            } else if (has_location) {
+                wait = pdMS_TO_TICKS(WEATHER_MAX_SLEEP_SEC * 1000);
             }
-            
-            // Fetch weather data
-            weather_data_t weather = {0};
-            if (fetch_weather_data(cached_latitude, cached_longitude, &weather) == ESP_OK) {
-                // Update cached data with mutex protection
-                if (xSemaphoreTake(weather_data_mutex, portMAX_DELAY) == pdTRUE) {
-                    memcpy(&cached_weather, &weather, sizeof(weather_data_t));
-                    xSemaphoreGive(weather_data_mutex);
+            // A time sync also wakes the task (to seed from the stored forecast)
+            ulTaskNotifyTake(pdTRUE, wait);
+            continue;
+        }
+        
+        // Succeeds only when every location was fetched, so one that keeps
+        // failing is retried with backoff while the others stay current
+        weather_request_t requests[WEATHER_MAX_LOCATIONS];
+        bool ok = false;
+        int count = fetch_current(snapshot, requests, &ok);
+        
+        // A location change during the fetch makes the result useless. The
+        // check and the publish share the mutex with the location setters.
+        bool changed = true;
+        bool primary_ok = false;
+        if (xSemaphoreTake(weather_data_mutex, portMAX_DELAY) == pdTRUE) {
+            changed = generation != location_generation;
+            for (int i = 0; i < count && !changed; i++) {
+                if (requests[i].has_current) {
+                    // Publish the new data to lock-free readers
+                    cache_publish(requests[i].slot, &requests[i].data);
+                    primary_ok |= requests[i].slot == 0;
                 }
-                // Notify UI to refresh weather widget
-                extern void ui_state_refresh(void);
-                ui_state_refresh();
             }
+            xSemaphoreGive(weather_data_mutex);
+        }
+        
+        portENTER_CRITICAL(&scheduler_lock);
+        fetch_scheduler_complete(&scheduler, scheduler_now(), ok && !changed);
+        if (changed) {
+            fetch_scheduler_invalidate(&scheduler);
+        }
+        uint32_t retry_s = fetch_scheduler_next_delay(&scheduler, scheduler_now());
+        portEXIT_CRITICAL(&scheduler_lock);
+        
+        if (changed) {
+            continue;
+        }
+        if (!ok) {
+            ESP_LOGW(TAG, "Weather fetch failed, retrying in %lu s", (unsigned long)retry_s);
         }
+        last_fetch_failed = !primary_ok;
+        
+        // Publish the new data (or the failure) to the bound UI
+        ui_state_post_data_updated("weather");
     }
     
     vTaskDelete(NULL);
@@ -339,7 +732,8 @@ static void weather_fetch_task(void *pvParameters)
 static void load_zip_code(void)
 {
     if (sd_db_is_ready()) {
-        if (sd_db_get_string("weather_zip_code", zip_code, sizeof(zip_code)) == ESP_OK) {
+        char *zip_code = locations[0].query;
+        if (sd_db_get_string("weather_zip_code", zip_code, sizeof(locations[0].query)) == ESP_OK) {
             if (strlen(zip_code) > 0) {
                 ESP_LOGI(TAG, "Loaded zip code from storage: %s", zip_code);
             }
@@ -347,6 +741,54 @@ static void load_zip_code(void)
     }
 }
 
+// Named locations are stored as "weather_loc_<slot>" = "<name>|<query>"
+static void location_key(int slot, char *key, size_t len)
+{
+    snprintf(key, len, "weather_loc_%d", slot);
+}
+
+static void load_locations(void)
+{
+    if (!sd_db_is_ready()) {
+        return;
+    }
+    
+    for (int i = 1; i < WEATHER_MAX_LOCATIONS; i++) {
+        char key[16];
+        char value[WEATHER_LOCATION_NAME_LEN + WEATHER_LOCATION_QUERY_LEN];
+        location_key(i, key, sizeof(key));
+        if (sd_db_get_string(key, value, sizeof(value)) != ESP_OK) {
+            continue;
+        }
+        char *separator = strchr(value, '|');
+        if (!separator || separator == value || separator[1] == '\0') {
+            continue;
+        }
+        *separator = '\0';
+        copy_text(locations[i].name, sizeof(locations[i].name), value);
+        copy_text(locations[i].query, sizeof(locations[i].query), separator + 1);
+        ESP_LOGI(TAG, "Loaded location %s: %s", locations[i].name, locations[i].query);
+    }
+}
+
+static void save_location(int slot, const char *name, const char *query)
+{
+    if (!sd_db_is_ready()) {
+        return;
+    }
+    
+    char key[16];
+    location_key(slot, key, sizeof(key));
+    if (name[0] == '\0') {
+        sd_db_delete(key);
+    } else {
+        char value[WEATHER_LOCATION_NAME_LEN + WEATHER_LOCATION_QUERY_LEN];
+        snprintf(value, sizeof(value), "%s|%s", name, query);
+        sd_db_set_string(key, value);
+    }
+    sd_db_save();
+}
+
 static void load_temp_unit(void)
 {
     if (sd_db_is_ready()) {
@@ -362,6 +804,18 @@ static void load_temp_unit(void)
     }
 }
 
+static const char *wind_unit_names[] = { "kmh", "mph", "ms" };
+
+static void load_wind_unit(void)
+{
+    if (sd_db_is_ready()) {
+        char wind_unit_str[16];
+        if (sd_db_get_string("weather_wind_unit", wind_unit_str, sizeof(wind_unit_str)) == ESP_OK) {
+            weather_service_parse_wind_unit(wind_unit_str, &wind_unit);
+        }
+    }
+}
+
 static void save_temp_unit(void)
 {
     if (sd_db_is_ready()) {
@@ -372,7 +826,7 @@ static void save_temp_unit(void)
     }
 }
 
-static void save_zip_code(void)
+static void save_zip_code(const char *zip_code)
 {
     if (sd_db_is_ready()) {
         sd_db_set_string("weather_zip_code", zip_code);
@@ -384,8 +838,14 @@ static void save_zip_code(void)
 void weather_service_init(void)
 {
     load_zip_code();
+    load_locations();
     load_temp_unit();
-    memset(&cached_weather, 0, sizeof(cached_weather));
+    load_wind_unit();
+    for (int i = 0; i < WEATHER_MAX_LOCATIONS; i++) {
+        cache_publish(i, NULL);
+    }
+    weather_forecast_init();
+    geocode_cache_init();
     
     // Create mutex for thread-safe access to cached weather data
     weather_data_mutex = xSemaphoreCreateMutex();
@@ -394,12 +854,16 @@ void weather_service_init(void)
         return;
     }
     
-    // Create queue for fetch requests
-    weather_fetch_queue = xQueueCreate(5, sizeof(bool));
-    if (weather_fetch_queue == NULL) {
-        ESP_LOGE(TAG, "Failed to create weather fetch queue");
-        return;
-    }
+    fetch_policy_t policy = {
+        .soft_ttl = WEATHER_SOFT_TTL_SEC,
+        .hard_ttl = WEATHER_CACHE_TIMEOUT_SEC,
+        .backoff_min = WEATHER_BACKOFF_MIN_SEC,
+        .backoff_max = WEATHER_BACKOFF_MAX_SEC,
+    };
+    fetch_scheduler_init(&scheduler, &policy, esp_random());
+    
+    // Registered before the task starts, so a sync after its first check still wakes it
+    time_sync_add_listener(wake_fetch_task);
     
     // Create background task for HTTP operations
     weather_task_running = true;
@@ -421,22 +885,39 @@ void weather_service_init(void)
     ESP_LOGI(TAG, "Weather service initialized");
 }
 
+// Change a location slot (an empty name frees it). Its cached data is
+// dropped and a fetch in flight discards its result; both happen under
+// weather_data_mutex so the fetch task cannot publish stale data between.
+static void apply_location(int slot, const char *name, const char *query)
+{
+    bool locked = weather_data_mutex != NULL && xSemaphoreTake(weather_data_mutex, portMAX_DELAY) == pdTRUE;
+    portENTER_CRITICAL(&locations_lock);
+    copy_text(locations[slot].name, sizeof(locations[slot].name), name);
+    copy_text(locations[slot].query, sizeof(locations[slot].query), query);
+    portEXIT_CRITICAL(&locations_lock);
+    cache_publish(slot, NULL);
+    location_generation++;
+    if (locked) {
+        xSemaphoreGive(weather_data_mutex);
+    }
+    invalidate_schedule();
+}
+
 esp_err_t weather_service_set_zip_code(const char *zip_code_str)
 {
-    if (!zip_code_str || strlen(zip_code_str) == 0) {
+    if (!zip_code_str || strlen(zip_code_str) == 0 || strlen(zip_code_str) >= WEATHER_LOCATION_QUERY_LEN) {
         return ESP_ERR_INVALID_ARG;
     }
     
-    strncpy(zip_code, zip_code_str, sizeof(zip_code) - 1);
-    zip_code[sizeof(zip_code) - 1] = '\0';
-    
-    // Clear cached coordinates and weather data when zip code changes
-    cached_latitude = 0.0f;
-    cached_longitude = 0.0f;
-    memset(&cached_weather, 0, sizeof(cached_weather));
+    // Clear cached weather data when zip code changes. The forecast goes
+    // first, so the fetch this wakes asks for the series again, and the
+    // failure flag too, so a fetch that fails at once is not forgotten.
+    weather_forecast_clear();
+    last_fetch_failed = false;
+    apply_location(0, WEATHER_PRIMARY_LOCATION, zip_code_str);
     
-    save_zip_code();
-    ESP_LOGI(TAG, "Zip code set to: %s", zip_code);
+    save_zip_code(zip_code_str);
+    ESP_LOGI(TAG, "Zip code set to: %s", zip_code_str);
     return ESP_OK;
 }
 
@@ -446,27 +927,57 @@ esp_err_t weather_service_get_zip_code(char *zip_code_out, size_t max_len)
         return ESP_ERR_INVALID_ARG;
     }
     
-    strncpy(zip_code_out, zip_code, max_len - 1);
+    portENTER_CRITICAL(&locations_lock);
+    strncpy(zip_code_out, locations[0].query, max_len - 1);
+    portEXIT_CRITICAL(&locations_lock);
     zip_code_out[max_len - 1] = '\0';
     return ESP_OK;
 }
 
+// Ask the scheduler (non-blocking); repeated requests from any caller and
+// for any location are coalesced into the next fetch
+static void request_refresh(void)
+{
+    portENTER_CRITICAL(&scheduler_lock);
+    fetch_scheduler_request(&scheduler, scheduler_now());
+    portEXIT_CRITICAL(&scheduler_lock);
+    wake_fetch_task();
+}
+
+// Cached data of a location if it is recent (never blocks)
+static esp_err_t read_cached(int slot, weather_data_t *data)
+{
+    weather_data_t snapshot;
+    cache_read(slot, &snapshot);
+    if (!snapshot.valid) {
+        return ESP_FAIL;
+    }
+    
+    // Check if cache is still valid (within timeout)
+    uint32_t now = (uint32_t)time(NULL);
+    if (now - snapshot.timestamp > WEATHER_CACHE_TIMEOUT_SEC) {
+        ESP_LOGI(TAG, "Weather cache expired");
+        return ESP_FAIL;
+    }
+    
+    memcpy(data, &snapshot, sizeof(weather_data_t));
+    return ESP_OK;
+}
+
 esp_err_t weather_service_fetch(weather_data_t *data)
 {
     if (!data) {
         return ESP_ERR_INVALID_ARG;
     }
     
+    char zip_code[WEATHER_LOCATION_QUERY_LEN];
+    weather_service_get_zip_code(zip_code, sizeof(zip_code));
     if (strlen(zip_code) == 0) {
         ESP_LOGW(TAG, "No zip code configured");
         return ESP_ERR_INVALID_STATE;
     }
     
-    // Request fetch from background task (non-blocking)
-    bool fetch_request = true;
-    if (weather_fetch_queue != NULL) {
-        xQueueSend(weather_fetch_queue, &fetch_request, 0);  // Non-blocking
-    }
+    request_refresh();
     
     // Return cached data immediately (if available)
     return weather_service_get_cached(data);
@@ -478,25 +989,127 @@ esp_err_t weather_service_get_cached(weather_data_t *data)
         return ESP_ERR_INVALID_ARG;
     }
     
-    // Get cached data with mutex protection
-    if (weather_data_mutex != NULL && xSemaphoreTake(weather_data_mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
-        bool valid = cached_weather.valid;
-        if (valid) {
-            // Check if cache is still valid (within timeout)
-            uint32_t now = (uint32_t)time(NULL);
-            if (now - cached_weather.timestamp > WEATHER_CACHE_TIMEOUT_SEC) {
-                ESP_LOGI(TAG, "Weather cache expired");
-                valid = false;
-            } else {
-                memcpy(data, &cached_weather, sizeof(weather_data_t));
-            }
+    // Never blocks: safe to call from the LVGL task with the display lock held
+    return read_cached(0, data);
+}
+
+// Names end up in storage keys and URLs, so keep them simple
+static bool valid_location_name(const char *name)
+{
+    size_t len = name ? strlen(name) : 0;
+    if (len == 0 || len >= WEATHER_LOCATION_NAME_LEN) {
+        return false;
+    }
+    for (size_t i = 0; i < len; i++) {
+        char c = name[i];
+        if (!isalnum((unsigned char)c) && c != '-' && c != '_') {
+            return false;
         }
-        xSemaphoreGive(weather_data_mutex);
-        
-        return valid ? ESP_OK : ESP_FAIL;
+    }
+    return true;
+}
+
+esp_err_t weather_service_set_location(const char *name, const char *query)
+{
+    if (!valid_location_name(name) || !query || query[0] == '\0' ||
+        strlen(query) >= WEATHER_LOCATION_QUERY_LEN || strchr(query, '|')) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (strcasecmp(name, WEATHER_PRIMARY_LOCATION) == 0) {
+        return weather_service_set_zip_code(query);
     }
     
-    return ESP_FAIL;
+    // Same name updates in place, otherwise take a free slot
+    portENTER_CRITICAL(&locations_lock);
+    int slot = find_location(name);
+    bool unchanged = slot >= 0 && strcmp(locations[slot].query, query) == 0;
+    for (int i = 1; i < WEATHER_MAX_LOCATIONS && slot < 0; i++) {
+        if (locations[i].name[0] == '\0') {
+            // Claim it now so a concurrent add can't pick the same slot
+            copy_text(locations[i].name, sizeof(locations[i].name), name);
+            slot = i;
+        }
+    }
+    portEXIT_CRITICAL(&locations_lock);
+    
+    if (slot < 0) {
+        return ESP_ERR_NO_MEM;
+    }
+    if (unchanged) {
+        return ESP_OK;
+    }
+    
+    apply_location(slot, name, query);
+    save_location(slot, name, query);
+    ESP_LOGI(TAG, "Location %s set to: %s", name, query);
+    return ESP_OK;
+}
+
+esp_err_t weather_service_remove_location(const char *name)
+{
+    if (!name) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (strcasecmp(name, WEATHER_PRIMARY_LOCATION) == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    portENTER_CRITICAL(&locations_lock);
+    int slot = find_location(name);
+    portEXIT_CRITICAL(&locations_lock);
+    if (slot < 0) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    
+    apply_location(slot, "", "");
+    save_location(slot, "", "");
+    ESP_LOGI(TAG, "Location %s removed", name);
+    return ESP_OK;
+}
+
+esp_err_t weather_service_fetch_location(const char *name, weather_data_t *data)
+{
+    if (!name || !data) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    portENTER_CRITICAL(&locations_lock);
+    int slot = find_location(name);
+    bool configured = slot >= 0 && locations[slot].query[0] != '\0';
+    portEXIT_CRITICAL(&locations_lock);
+    if (slot < 0) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    if (!configured) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    request_refresh();
+    return read_cached(slot, data);
+}
+
+esp_err_t weather_service_get_location(int index, char *name, char *query, size_t query_len, weather_data_t *data)
+{
+    if (index < 0 || index >= WEATHER_MAX_LOCATIONS || !name || !data) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    weather_location_t location;
+    portENTER_CRITICAL(&locations_lock);
+    location = locations[index];
+    portEXIT_CRITICAL(&locations_lock);
+    if (location.name[0] == '\0' || location.query[0] == '\0') {
+        return ESP_ERR_NOT_FOUND;
+    }
+    
+    copy_text(name, WEATHER_LOCATION_NAME_LEN, location.name);
+    if (query && query_len > 0) {
+        copy_text(query, query_len, location.query);
+    }
+    if (read_cached(index, data) != ESP_OK) {
+        memset(data, 0, sizeof(*data));
+    }
+    return ESP_OK;
 }
 
 esp_err_t weather_service_set_temp_unit(weather_temp_unit_t unit)
@@ -505,17 +1118,10 @@ esp_err_t weather_service_set_temp_unit(weather_temp_unit_t unit)
         return ESP_ERR_INVALID_ARG;
     }
     
+    // Cached data is in Celsius, so only the display changes
     temp_unit = unit;
     save_temp_unit();
     
-    // Clear cached weather data so it will be refetched with new unit
-    if (weather_data_mutex != NULL && xSemaphoreTake(weather_data_mutex, portMAX_DELAY) == pdTRUE) {
-        memset(&cached_weather, 0, sizeof(weather_data_t));
-        cached_latitude = 0.0f;
-        cached_longitude = 0.0f;
-        xSemaphoreGive(weather_data_mutex);
-    }
-    
     ESP_LOGI(TAG, "Temperature unit set to: %s", (unit == WEATHER_TEMP_FAHRENHEIT) ? "Fahrenheit" : "Celsius");
     return ESP_OK;
 }
@@ -525,3 +1131,103 @@ weather_temp_unit_t weather_service_get_temp_unit(void)
     return temp_unit;
 }
 
+esp_err_t weather_service_set_wind_unit(weather_wind_unit_t unit)
+{
+    if (unit != WEATHER_WIND_KMH && unit != WEATHER_WIND_MPH && unit != WEATHER_WIND_MS) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    wind_unit = unit;
+    if (sd_db_is_ready()) {
+        sd_db_set_string("weather_wind_unit", wind_unit_names[unit]);
+        sd_db_save();
+    }
+    
+    ESP_LOGI(TAG, "Wind unit set to: %s", wind_unit_names[unit]);
+    return ESP_OK;
+}
+
+weather_wind_unit_t weather_service_get_wind_unit(void)
+{
+    return wind_unit;
+}
+
+const char* weather_service_wind_unit_name(weather_wind_unit_t unit)
+{
+    return (unit >= WEATHER_WIND_KMH && unit <= WEATHER_WIND_MS) ? wind_unit_names[unit] : "kmh";
+}
+
+esp_err_t weather_service_parse_wind_unit(const char *name, weather_wind_unit_t *unit)
+{
+    for (int i = 0; i < 3; i++) {
+        if (name && strcmp(name, wind_unit_names[i]) == 0) {
+            *unit = (weather_wind_unit_t)i;
+            return ESP_OK;
+        }
+    }
+    return ESP_ERR_INVALID_ARG;
+}
+
+float weather_service_display_temp(float celsius)
+{
+    return temp_unit == WEATHER_TEMP_FAHRENHEIT ? celsius * 9.0f / 5.0f + 32.0f : celsius;
+}
+
+float weather_service_display_wind(float meters_per_second)
+{
+    switch (wind_unit) {
+        case WEATHER_WIND_MPH: return meters_per_second * 2.236936f;
+        case WEATHER_WIND_MS:  return meters_per_second;
+        default:               return meters_per_second * 3.6f;
+    }
+}
+
+const char* weather_service_temp_symbol(void)
+{
+    return temp_unit == WEATHER_TEMP_FAHRENHEIT ? "°F" : "°C";
+}
+
+const char* weather_service_wind_symbol(void)
+{
+    switch (wind_unit) {
+        case WEATHER_WIND_MPH: return "mph";
+        case WEATHER_WIND_MS:  return "m/s";
+        default:               return "km/h";
+    }
+}
+
+bool weather_service_last_fetch_failed(void)
+{
+    return last_fetch_failed;
+}
+
+static cJSON* conn_stats_to_json(const weather_conn_t *conn)
+{
+    weather_conn_t copy;
+    portENTER_CRITICAL(&conn_stats_lock);
+    copy = *conn;
+    portEXIT_CRITICAL(&conn_stats_lock);
+    
+    cJSON *json = cJSON_CreateObject();
+    cJSON_AddNumberToObject(json, "requests", copy.requests);
+    cJSON_AddNumberToObject(json, "connects", copy.connects);
+    cJSON_AddNumberToObject(json, "reused", copy.requests > copy.connects ? copy.requests - copy.connects : 0);
+    cJSON_AddNumberToObject(json, "failures", copy.failures);
+    cJSON_AddNumberToObject(json, "avg_ms", copy.requests ? copy.total_us / 1000.0 / copy.requests : 0.0);
+    cJSON_AddNumberToObject(json, "last_ms", copy.last_us / 1000.0);
+    cJSON_AddNumberToObject(json, "bytes", (double)copy.bytes);
+    cJSON_AddNumberToObject(json, "last_bytes", copy.last_bytes);
+    cJSON_AddNumberToObject(json, "parse_ms", copy.parse_us / 1000.0);
+    // End-to-end (request + transfer + parse) and tokenizer-only throughput
+    cJSON_AddNumberToObject(json, "kb_per_s", copy.total_us ? copy.bytes * 1000.0 / copy.total_us : 0.0);
+    cJSON_AddNumberToObject(json, "parse_kb_per_s", copy.parse_us ? copy.bytes * 1000.0 / copy.parse_us : 0.0);
+    return json;
+}
+
+cJSON* weather_service_get_http_stats(void)
+{
+    cJSON *json = cJSON_CreateObject();
+    cJSON_AddItemToObject(json, geocode_conn.name, conn_stats_to_json(&geocode_conn));
+    cJSON_AddItemToObject(json, forecast_conn.name, conn_stats_to_json(&forecast_conn));
+    return json;
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "esp_err.h"
+#include "cJSON.h"
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
@@ -22,13 +23,25 @@ typedef enum {
     WEATHER_TEMP_FAHRENHEIT = 1
 } weather_temp_unit_t;
 
+/**
+ * @brief Wind speed unit enumeration
+ */
+typedef enum {
+    WEATHER_WIND_KMH = 0,
+    WEATHER_WIND_MPH = 1,
+    WEATHER_WIND_MS = 2
+} weather_wind_unit_t;
+
 /**
  * @brief Weather data structure
+ * Always in canonical units; convert with weather_service_display_temp()
+ * and weather_service_display_wind() when showing it, so a unit change
+ * needs no refetch.
  */
 typedef struct {
-    float temperature;        // Current temperature (in selected unit)
+    float temperature;        // Current temperature in °C
     float humidity;           // Relative humidity %
-    float wind_speed;        // Wind speed in km/h
+    float wind_speed;         // Wind speed in m/s
     int weather_code;         // WMO weather code
     char condition[32];       // Human-readable condition (e.g., "Sunny", "Cloudy")
     bool valid;               // True if data is valid
@@ -56,21 +69,74 @@ esp_err_t weather_service_set_zip_code(const char *zip_code);
 esp_err_t weather_service_get_zip_code(char *zip_code, size_t max_len);
 
 /**
- * @brief Fetch weather data from Open-Meteo API
+ * @brief Ask for fresh weather data and return what is cached now
+ * The fetch task refreshes on its own schedule; this only makes a due or
+ * missing refresh happen now. Requests while one is pending are coalesced,
+ * and failed fetches are retried with backoff rather than on request.
  * @param data Pointer to weather_data_t structure to fill
- * @return ESP_OK on success
+ * @return ESP_OK if cached data is available, ESP_ERR_INVALID_STATE if no
+ *         zip code is configured
  */
 esp_err_t weather_service_fetch(weather_data_t *data);
 
+#define WEATHER_SOFT_TTL_SEC      600   // Refreshed in the background after 10 minutes
+#define WEATHER_CACHE_TIMEOUT_SEC 3600  // Stale data is still shown for up to an hour
+
 /**
  * @brief Get cached weather data (if available and recent)
+ * Lock-free: never blocks on a fetch in progress, so it is safe to call
+ * with the display lock held.
  * @param data Pointer to weather_data_t structure to fill
  * @return ESP_OK if cached data is available and recent, ESP_FAIL otherwise
  */
 esp_err_t weather_service_get_cached(weather_data_t *data);
 
+#define WEATHER_MAX_LOCATIONS       4       // The zip code location plus three named ones
+#define WEATHER_LOCATION_NAME_LEN   16
+#define WEATHER_LOCATION_QUERY_LEN  32
+#define WEATHER_PRIMARY_LOCATION    "home"  // Name of the zip code location
+
+/**
+ * @brief Add a named location, or change the zip code/place of one
+ * Every configured location is refreshed by the same forecast request
+ * (Open-Meteo takes a list of coordinates), so adding one costs no extra
+ * request. Setting WEATHER_PRIMARY_LOCATION is weather_service_set_zip_code().
+ * @param name Location name (letters, digits, '-' and '_')
+ * @param query Zip code or place name
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG for a bad name or query,
+ *         ESP_ERR_NO_MEM if all WEATHER_MAX_LOCATIONS slots are in use
+ */
+esp_err_t weather_service_set_location(const char *name, const char *query);
+
+/**
+ * @brief Remove a named location
+ * @return ESP_OK on success, ESP_ERR_NOT_FOUND for an unknown name,
+ *         ESP_ERR_INVALID_ARG for the primary location
+ */
+esp_err_t weather_service_remove_location(const char *name);
+
 /**
- * @brief Set temperature unit preference
+ * @brief weather_service_fetch() for a named location
+ * Requests are coalesced across locations and callers: one refresh
+ * serves them all.
+ * @return ESP_OK if recent cached data is available, ESP_ERR_NOT_FOUND for
+ *         an unknown name, ESP_ERR_INVALID_STATE if it has no zip code
+ */
+esp_err_t weather_service_fetch_location(const char *name, weather_data_t *data);
+
+/**
+ * @brief Get a location by slot, for listing (never blocks)
+ * @param index 0 to WEATHER_MAX_LOCATIONS - 1, 0 being the primary location
+ * @param name Output name, WEATHER_LOCATION_NAME_LEN bytes
+ * @param query Output zip code or place name (may be NULL)
+ * @param query_len Size of query
+ * @param data Output cached data; valid is false if there is none
+ * @return ESP_OK on success, ESP_ERR_NOT_FOUND for an unused slot
+ */
+esp_err_t weather_service_get_location(int index, char *name, char *query, size_t query_len, weather_data_t *data);
+
+/**
+ * @brief Set temperature unit preference (display only, no refetch)
  * @param unit Temperature unit (WEATHER_TEMP_CELSIUS or WEATHER_TEMP_FAHRENHEIT)
  * @return ESP_OK on success
  */
@@ -82,6 +148,64 @@ esp_err_t weather_service_set_temp_unit(weather_temp_unit_t unit);
  */
 weather_temp_unit_t weather_service_get_temp_unit(void);
 
+/**
+ * @brief Set wind speed unit preference (display only, no refetch)
+ * @param unit Wind unit
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG for an unknown unit
+ */
+esp_err_t weather_service_set_wind_unit(weather_wind_unit_t unit);
+
+/**
+ * @brief Get current wind speed unit preference
+ * @return Current wind unit
+ */
+weather_wind_unit_t weather_service_get_wind_unit(void);
+
+/**
+ * @brief Wind unit name as used by the API ("kmh", "mph", "ms")
+ */
+const char* weather_service_wind_unit_name(weather_wind_unit_t unit);
+
+/**
+ * @brief Parse a wind unit name ("kmh", "mph", "ms")
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG for an unknown name
+ */
+esp_err_t weather_service_parse_wind_unit(const char *name, weather_wind_unit_t *unit);
+
+/**
+ * @brief Convert a temperature in °C to the selected unit
+ */
+float weather_service_display_temp(float celsius);
+
+/**
+ * @brief Convert a wind speed in m/s to the selected unit
+ */
+float weather_service_display_wind(float meters_per_second);
+
+/**
+ * @brief Symbol of the selected temperature unit ("°C" or "°F")
+ */
+const char* weather_service_temp_symbol(void);
+
+/**
+ * @brief Symbol of the selected wind unit ("km/h", "mph" or "m/s")
+ */
+const char* weather_service_wind_symbol(void);
+
+/**
+ * @brief Check if the last fetch attempt failed
+ * Cleared by the next successful fetch or a location change.
+ * @return true if the last geocode or forecast request failed
+ */
+bool weather_service_last_fetch_failed(void);
+
+/**
+ * @brief Get HTTP connection statistics per API host
+ * @return JSON object (requests, new connections, reused, latency, bytes,
+ *         parse time and throughput), caller must free with cJSON_Delete
+ */
+cJSON* weather_service_get_http_stats(void);
+
 #ifdef __cplusplus
 }
 #endif
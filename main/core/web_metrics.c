@@ -0,0 +1,518 @@
+#include "web_metrics.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdarg.h>
+
+static const char *TAG = "web_metrics";
+
+// Metrics configuration
+#define WEB_METRICS_MAX_ROUTES    48
+#define WEB_METRICS_PROM_BUF      1024   // Prometheus output is streamed in chunks of this size
+#define WEB_METRICS_MIN_SAMPLES   20     // Requests needed before a p99 budget is enforced
+
+// Latency histogram bucket upper bounds in milliseconds (+Inf is implicit)
+static const uint32_t bucket_bounds_ms[] = { 1, 2, 5, 10, 25, 50, 100, 250, 500, 1000, 2500 };
+#define WEB_METRICS_BUCKETS   (sizeof(bucket_bounds_ms) / sizeof(bucket_bounds_ms[0]))
+
+typedef enum {
+    PHASE_RECV,
+    PHASE_HANDLE,
+    PHASE_SEND,
+    PHASE_TOTAL,
+    PHASE_COUNT
+} metrics_phase_t;
+
+static const char *phase_names[PHASE_COUNT] = { "recv", "handle", "send", "total" };
+
+typedef struct {
+    uint32_t buckets[WEB_METRICS_BUCKETS + 1];   // Last bucket is +Inf
+    uint64_t sum_us;
+} latency_histogram_t;
+
+typedef struct {
+    const char *uri;
+    httpd_method_t method;
+    uint32_t requests;
+    uint32_t errors;
+    uint32_t rejected;                // Answered 503 without running the handler
+    uint64_t bytes_in;
+    uint64_t bytes_out;
+    latency_histogram_t phase[PHASE_COUNT];
+    uint32_t p99_budget_ms;           // 0 = no budget
+    bool over_budget;
+} route_stats_t;
+
+static route_stats_t routes[WEB_METRICS_MAX_ROUTES];
+static int route_count = 0;
+static int64_t window_start_us = 0;   // Start of the current measurement window
+
+// Handlers run on the httpd task and on HTTP workers
+static portMUX_TYPE metrics_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// Request being timed on the current task (set by web_metrics_request_begin)
+static __thread web_metrics_req_t *current_req = NULL;
+
+static const char *method_name(httpd_method_t method)
+{
+    switch (method) {
+        case HTTP_GET:    return "GET";
+        case HTTP_POST:   return "POST";
+        case HTTP_PUT:    return "PUT";
+        case HTTP_DELETE: return "DELETE";
+        default:          return "OTHER";
+    }
+}
+
+// Estimate a percentile from a histogram by interpolating inside its bucket
+static double histogram_percentile_ms(const latency_histogram_t *hist, double percentile)
+{
+    uint32_t total = 0;
+    for (size_t b = 0; b <= WEB_METRICS_BUCKETS; b++) {
+        total += hist->buckets[b];
+    }
+    if (total == 0) {
+        return 0.0;
+    }
+
+    double rank = percentile / 100.0 * total;
+    uint32_t cumulative = 0;
+    for (size_t b = 0; b < WEB_METRICS_BUCKETS; b++) {
+        if (hist->buckets[b] > 0 && cumulative + hist->buckets[b] >= rank) {
+            double lower = (b == 0) ? 0.0 : bucket_bounds_ms[b - 1];
+            double upper = bucket_bounds_ms[b];
+            return lower + (upper - lower) * (rank - cumulative) / hist->buckets[b];
+        }
+        cumulative += hist->buckets[b];
+    }
+
+    // Falls in the +Inf bucket - the last bound is the best we can say
+    return bucket_bounds_ms[WEB_METRICS_BUCKETS - 1];
+}
+
+static void histogram_add(latency_histogram_t *hist, int64_t us)
+{
+    if (us < 0) {
+        us = 0;
+    }
+
+    size_t i = 0;
+    while (i < WEB_METRICS_BUCKETS && us > (int64_t)bucket_bounds_ms[i] * 1000) {
+        i++;
+    }
+    hist->buckets[i]++;
+    hist->sum_us += (uint64_t)us;
+}
+
+int web_metrics_register_route(const char *uri, httpd_method_t method, uint32_t p99_budget_ms)
+{
+    if (!uri) {
+        return -1;
+    }
+
+    portENTER_CRITICAL(&metrics_lock);
+
+    // Several URIs may share one route (e.g. per-widget config routes)
+    for (int i = 0; i < route_count; i++) {
+        if (routes[i].method == method && strcmp(routes[i].uri, uri) == 0) {
+            portEXIT_CRITICAL(&metrics_lock);
+            return i;
+        }
+    }
+
+    if (route_count >= WEB_METRICS_MAX_ROUTES) {
+        portEXIT_CRITICAL(&metrics_lock);
+        ESP_LOGW(TAG, "Route table full, %s %s not measured", method_name(method), uri);
+        return -1;
+    }
+
+    int id = route_count++;
+    memset(&routes[id], 0, sizeof(routes[id]));
+    routes[id].uri = uri;
+    routes[id].method = method;
+    routes[id].p99_budget_ms = p99_budget_ms;
+
+    if (window_start_us == 0) {
+        window_start_us = esp_timer_get_time();
+    }
+
+    portEXIT_CRITICAL(&metrics_lock);
+    return id;
+}
+
+void web_metrics_request_begin(web_metrics_req_t *ctx, int route_id)
+{
+    if (!ctx) {
+        return;
+    }
+
+    memset(ctx, 0, sizeof(*ctx));
+    ctx->route_id = route_id;
+    ctx->start_us = esp_timer_get_time();
+    current_req = ctx;
+}
+
+void web_metrics_request_end(web_metrics_req_t *ctx, esp_err_t result)
+{
+    if (!ctx) {
+        return;
+    }
+
+    current_req = NULL;
+
+    if (ctx->route_id < 0 || ctx->route_id >= route_count) {
+        return;
+    }
+
+    int64_t total_us = esp_timer_get_time() - ctx->start_us;
+    int64_t handle_us = total_us - ctx->recv_us - ctx->send_us;
+
+    portENTER_CRITICAL(&metrics_lock);
+    route_stats_t *stats = &routes[ctx->route_id];
+    stats->requests++;
+    if (result != ESP_OK) {
+        stats->errors++;
+    }
+    stats->bytes_in += ctx->bytes_in;
+    stats->bytes_out += ctx->bytes_out;
+    histogram_add(&stats->phase[PHASE_RECV], ctx->recv_us);
+    histogram_add(&stats->phase[PHASE_HANDLE], handle_us);
+    histogram_add(&stats->phase[PHASE_SEND], ctx->send_us);
+    histogram_add(&stats->phase[PHASE_TOTAL], total_us);
+
+    // Flag routes whose p99 drifts past their budget (logged on transition only)
+    bool was_over = stats->over_budget;
+    double p99_ms = 0.0;
+    if (stats->p99_budget_ms > 0 && stats->requests >= WEB_METRICS_MIN_SAMPLES) {
+        p99_ms = histogram_percentile_ms(&stats->phase[PHASE_TOTAL], 99.0);
+        stats->over_budget = (p99_ms > stats->p99_budget_ms);
+    }
+    bool now_over = stats->over_budget;
+    portEXIT_CRITICAL(&metrics_lock);
+
+    if (now_over && !was_over) {
+        ESP_LOGW(TAG, "%s %s p99 %.1f ms exceeds budget of %lu ms",
+                 method_name(stats->method), stats->uri, p99_ms, (unsigned long)stats->p99_budget_ms);
+    } else if (was_over && !now_over) {
+        ESP_LOGI(TAG, "%s %s back within its p99 budget", method_name(stats->method), stats->uri);
+    }
+}
+
+void web_metrics_record_rejected(int route_id)
+{
+    if (route_id < 0 || route_id >= route_count) {
+        return;
+    }
+
+    portENTER_CRITICAL(&metrics_lock);
+    routes[route_id].rejected++;
+    portEXIT_CRITICAL(&metrics_lock);
+}
+
+int web_metrics_recv(httpd_req_t *req, char *buf, size_t len)
+{
+    int64_t start = esp_timer_get_time();
+    int received = httpd_req_recv(req, buf, len);
+
+    web_metrics_req_t *ctx = current_req;
+    if (ctx) {
+        ctx->recv_us += esp_timer_get_time() - start;
+        if (received > 0) {
+            ctx->bytes_in += received;
+        }
+    }
+    return received;
+}
+
+// Charge send time, and bytes if the write succeeded, to the current request
+static void account_send(int64_t start, esp_err_t ret, size_t bytes)
+{
+    web_metrics_req_t *ctx = current_req;
+    if (ctx) {
+        ctx->send_us += esp_timer_get_time() - start;
+        if (ret == ESP_OK) {
+            ctx->bytes_out += bytes;
+        }
+    }
+}
+
+esp_err_t web_metrics_send(httpd_req_t *req, const char *buf, ssize_t len)
+{
+    int64_t start = esp_timer_get_time();
+    esp_err_t ret = httpd_resp_send(req, buf, len);
+    if (buf) {
+        account_send(start, ret, (len == HTTPD_RESP_USE_STRLEN) ? strlen(buf) : (size_t)len);
+    }
+    return ret;
+}
+
+esp_err_t web_metrics_sendstr(httpd_req_t *req, const char *str)
+{
+    return web_metrics_send(req, str, HTTPD_RESP_USE_STRLEN);
+}
+
+esp_err_t web_metrics_send_chunk(httpd_req_t *req, const char *buf, ssize_t len)
+{
+    int64_t start = esp_timer_get_time();
+    esp_err_t ret = httpd_resp_send_chunk(req, buf, len);
+    account_send(start, ret, buf ? ((len == HTTPD_RESP_USE_STRLEN) ? strlen(buf) : (size_t)len) : 0);
+    return ret;
+}
+
+// Same wording as httpd's defaults, passed explicitly so the body size is known
+static const char *default_error_message(httpd_err_code_t error)
+{
+    switch (error) {
+        case HTTPD_400_BAD_REQUEST:           return "Bad request";
+        case HTTPD_404_NOT_FOUND:             return "Nothing matches the given URI";
+        case HTTPD_405_METHOD_NOT_ALLOWED:    return "Request method for this URI is not handled by server";
+        case HTTPD_408_REQ_TIMEOUT:           return "Server closed this connection";
+        case HTTPD_500_INTERNAL_SERVER_ERROR: return "Server has encountered an unexpected error";
+        default:                              return "Error";
+    }
+}
+
+esp_err_t web_metrics_send_err(httpd_req_t *req, httpd_err_code_t error, const char *msg)
+{
+    if (!msg) {
+        msg = default_error_message(error);
+    }
+
+    int64_t start = esp_timer_get_time();
+    esp_err_t ret = httpd_resp_send_err(req, error, msg);
+    account_send(start, ret, strlen(msg));
+    return ret;
+}
+
+void web_metrics_reset(void)
+{
+    portENTER_CRITICAL(&metrics_lock);
+    for (int i = 0; i < route_count; i++) {
+        route_stats_t *stats = &routes[i];
+        stats->requests = 0;
+        stats->errors = 0;
+        stats->rejected = 0;
+        stats->bytes_in = 0;
+        stats->bytes_out = 0;
+        stats->over_budget = false;
+        memset(stats->phase, 0, sizeof(stats->phase));
+    }
+    window_start_us = esp_timer_get_time();
+    portEXIT_CRITICAL(&metrics_lock);
+
+    ESP_LOGI(TAG, "Metrics reset");
+}
+
+// Seconds covered by the current measurement window
+static double window_seconds(void)
+{
+    double seconds = (esp_timer_get_time() - window_start_us) / 1000000.0;
+    return seconds > 0.0 ? seconds : 0.0;
+}
+
+// Copy one route's stats so formatting happens outside the critical section
+static bool snapshot_route(int id, route_stats_t *out)
+{
+    if (id >= route_count) {
+        return false;
+    }
+
+    portENTER_CRITICAL(&metrics_lock);
+    memcpy(out, &routes[id], sizeof(*out));
+    portEXIT_CRITICAL(&metrics_lock);
+    return true;
+}
+
+cJSON* web_metrics_to_json(void)
+{
+    cJSON *json = cJSON_CreateObject();
+
+    cJSON *bounds = cJSON_AddArrayToObject(json, "bucket_bounds_ms");
+    for (size_t i = 0; i < WEB_METRICS_BUCKETS; i++) {
+        cJSON_AddItemToArray(bounds, cJSON_CreateNumber(bucket_bounds_ms[i]));
+    }
+
+    double window_s = window_seconds();
+    uint32_t total_requests = 0;
+    cJSON_AddNumberToObject(json, "window_s", window_s);
+
+    cJSON *over_budget = cJSON_AddArrayToObject(json, "over_budget");
+    cJSON *route_array = cJSON_AddArrayToObject(json, "routes");
+    route_stats_t stats;
+    for (int id = 0; snapshot_route(id, &stats); id++) {
+        total_requests += stats.requests;
+
+        cJSON *route = cJSON_CreateObject();
+        cJSON_AddStringToObject(route, "uri", stats.uri);
+        cJSON_AddStringToObject(route, "method", method_name(stats.method));
+        cJSON_AddNumberToObject(route, "requests", stats.requests);
+        cJSON_AddNumberToObject(route, "errors", stats.errors);
+        cJSON_AddNumberToObject(route, "rejected", stats.rejected);
+        cJSON_AddNumberToObject(route, "bytes_in", (double)stats.bytes_in);
+        cJSON_AddNumberToObject(route, "bytes_out", (double)stats.bytes_out);
+        cJSON_AddNumberToObject(route, "requests_per_sec", window_s > 0.0 ? stats.requests / window_s : 0.0);
+        cJSON_AddNumberToObject(route, "p50_ms", histogram_percentile_ms(&stats.phase[PHASE_TOTAL], 50.0));
+        cJSON_AddNumberToObject(route, "p90_ms", histogram_percentile_ms(&stats.phase[PHASE_TOTAL], 90.0));
+        cJSON_AddNumberToObject(route, "p99_ms", histogram_percentile_ms(&stats.phase[PHASE_TOTAL], 99.0));
+        cJSON_AddNumberToObject(route, "p99_budget_ms", stats.p99_budget_ms);
+        cJSON_AddBoolToObject(route, "over_budget", stats.over_budget);
+        if (stats.over_budget) {
+            char label[80];
+            snprintf(label, sizeof(label), "%s %s", method_name(stats.method), stats.uri);
+            cJSON_AddItemToArray(over_budget, cJSON_CreateString(label));
+        }
+
+        cJSON *latency = cJSON_AddObjectToObject(route, "latency");
+        for (int p = 0; p < PHASE_COUNT; p++) {
+            cJSON *phase = cJSON_AddObjectToObject(latency, phase_names[p]);
+            cJSON_AddNumberToObject(phase, "sum_ms", stats.phase[p].sum_us / 1000.0);
+            cJSON *buckets = cJSON_AddArrayToObject(phase, "buckets");
+            for (size_t b = 0; b <= WEB_METRICS_BUCKETS; b++) {
+                cJSON_AddItemToArray(buckets, cJSON_CreateNumber(stats.phase[p].buckets[b]));
+            }
+        }
+
+        cJSON_AddItemToArray(route_array, route);
+    }
+
+    cJSON_AddNumberToObject(json, "requests", total_requests);
+    cJSON_AddNumberToObject(json, "requests_per_sec", window_s > 0.0 ? total_requests / window_s : 0.0);
+
+    return json;
+}
+
+// Buffered writer for chunked Prometheus output
+typedef struct {
+    httpd_req_t *req;
+    char buf[WEB_METRICS_PROM_BUF];
+    size_t len;
+    esp_err_t err;
+} prom_writer_t;
+
+static void prom_flush(prom_writer_t *w)
+{
+    if (w->len > 0 && w->err == ESP_OK) {
+        w->err = web_metrics_send_chunk(w->req, w->buf, w->len);
+    }
+    w->len = 0;
+}
+
+static void prom_printf(prom_writer_t *w, const char *fmt, ...)
+{
+    va_list args;
+    for (int attempt = 0; attempt < 2; attempt++) {
+        va_start(args, fmt);
+        int n = vsnprintf(w->buf + w->len, sizeof(w->buf) - w->len, fmt, args);
+        va_end(args);
+
+        if (n >= 0 && (size_t)n < sizeof(w->buf) - w->len) {
+            w->len += n;
+            return;
+        }
+        // Didn't fit - flush and retry once with an empty buffer
+        prom_flush(w);
+    }
+}
+
+esp_err_t web_metrics_send_prometheus(httpd_req_t *req)
+{
+    prom_writer_t *w = calloc(1, sizeof(prom_writer_t));
+    if (!w) {
+        web_metrics_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, NULL);
+        return ESP_ERR_NO_MEM;
+    }
+    w->req = req;
+
+    httpd_resp_set_type(req, "text/plain; version=0.0.4");
+
+    static const struct {
+        const char *name;
+        const char *help;
+    } counters[] = {
+        { "voxels_http_requests_total", "Requests handled" },
+        { "voxels_http_errors_total", "Requests whose handler failed" },
+        { "voxels_http_rejected_total", "Requests rejected because the worker pool was busy" },
+        { "voxels_http_received_bytes_total", "Request body bytes received" },
+        { "voxels_http_sent_bytes_total", "Response body bytes sent" },
+    };
+
+    route_stats_t stats;
+    for (size_t c = 0; c < sizeof(counters) / sizeof(counters[0]); c++) {
+        prom_printf(w, "# HELP %s %s\n# TYPE %s counter\n", counters[c].name, counters[c].help, counters[c].name);
+        for (int id = 0; snapshot_route(id, &stats); id++) {
+            uint64_t value = 0;
+            switch (c) {
+                case 0: value = stats.requests; break;
+                case 1: value = stats.errors; break;
+                case 2: value = stats.rejected; break;
+                case 3: value = stats.bytes_in; break;
+                case 4: value = stats.bytes_out; break;
+            }
+            prom_printf(w, "%s{route=\"%s\",method=\"%s\"} %llu\n", counters[c].name,
+                        stats.uri, method_name(stats.method), (unsigned long long)value);
+        }
+    }
+
+    static const struct {
+        const char *name;
+        const char *help;
+    } gauges[] = {
+        { "voxels_http_request_p99_seconds", "Estimated p99 request latency in the current window" },
+        { "voxels_http_request_p99_budget_seconds", "Configured p99 latency budget" },
+        { "voxels_http_over_budget", "1 if the route's p99 exceeds its budget" },
+    };
+
+    for (size_t g = 0; g < sizeof(gauges) / sizeof(gauges[0]); g++) {
+        prom_printf(w, "# HELP %s %s\n# TYPE %s gauge\n", gauges[g].name, gauges[g].help, gauges[g].name);
+        for (int id = 0; snapshot_route(id, &stats); id++) {
+            double value = 0.0;
+            switch (g) {
+                case 0: value = histogram_percentile_ms(&stats.phase[PHASE_TOTAL], 99.0) / 1000.0; break;
+                case 1: value = stats.p99_budget_ms / 1000.0; break;
+                case 2: value = stats.over_budget ? 1.0 : 0.0; break;
+            }
+            prom_printf(w, "%s{route=\"%s\",method=\"%s\"} %.6f\n", gauges[g].name,
+                        stats.uri, method_name(stats.method), value);
+        }
+    }
+
+    const char *hist_name = "voxels_http_request_duration_seconds";
+    prom_printf(w, "# HELP %s Request latency by phase\n# TYPE %s histogram\n", hist_name, hist_name);
+    for (int id = 0; snapshot_route(id, &stats); id++) {
+        for (int p = 0; p < PHASE_COUNT; p++) {
+            const latency_histogram_t *hist = &stats.phase[p];
+            uint32_t cumulative = 0;
+            for (size_t b = 0; b <= WEB_METRICS_BUCKETS; b++) {
+                cumulative += hist->buckets[b];
+                char le[16];
+                if (b < WEB_METRICS_BUCKETS) {
+                    snprintf(le, sizeof(le), "%.3f", bucket_bounds_ms[b] / 1000.0);
+                } else {
+                    strcpy(le, "+Inf");
+                }
+                prom_printf(w, "%s_bucket{route=\"%s\",method=\"%s\",phase=\"%s\",le=\"%s\"} %lu\n",
+                            hist_name, stats.uri, method_name(stats.method), phase_names[p],
+                            le, (unsigned long)cumulative);
+            }
+            prom_printf(w, "%s_sum{route=\"%s\",method=\"%s\",phase=\"%s\"} %.6f\n",
+                        hist_name, stats.uri, method_name(stats.method), phase_names[p],
+                        hist->sum_us / 1000000.0);
+            prom_printf(w, "%s_count{route=\"%s\",method=\"%s\",phase=\"%s\"} %lu\n",
+                        hist_name, stats.uri, method_name(stats.method), phase_names[p],
+                        (unsigned long)cumulative);
+        }
+    }
+
+    prom_flush(w);
+    esp_err_t ret = w->err;
+    free(w);
+
+    // Terminate the chunked response
+    if (ret == ESP_OK) {
+        ret = web_metrics_send_chunk(req, NULL, 0);
+    }
+    return ret;
+}
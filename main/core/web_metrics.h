@@ -0,0 +1,120 @@
+#pragma once
+
+#include "esp_err.h"
+#include "esp_http_server.h"
+#include "cJSON.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Web server metrics
+ * Per-route request count, bytes in/out, error count and latency
+ * histograms for the receive, handle and send phases of a request.
+ * Percentiles are estimated from the histogram buckets.
+ *
+ * A request is timed between web_metrics_request_begin() and
+ * web_metrics_request_end() on the task running the handler. Receive
+ * and send time is measured by routing body reads and response writes
+ * (chunks and error responses included) through web_metrics_recv() and
+ * the web_metrics_send*() wrappers; the remainder is accounted as
+ * handle time.
+ */
+
+/**
+ * @brief Per-request measurement context
+ * Lives on the stack of the task running the handler
+ */
+typedef struct {
+    int route_id;
+    int64_t start_us;
+    int64_t recv_us;
+    int64_t send_us;
+    uint32_t bytes_in;
+    uint32_t bytes_out;
+} web_metrics_req_t;
+
+/**
+ * @brief Register a route for metrics collection
+ * @param uri URI (or URI pattern) used as the route label, must persist
+ * @param method HTTP method
+ * @param p99_budget_ms p99 latency budget; a warning is logged and the
+ *        route is reported as over budget once it is exceeded (0 = none)
+ * @return Route ID, or -1 if the route table is full
+ */
+int web_metrics_register_route(const char *uri, httpd_method_t method, uint32_t p99_budget_ms);
+
+/**
+ * @brief Start timing a request on the current task
+ * @param ctx Context to fill (must stay valid until web_metrics_request_end)
+ * @param route_id Route ID from web_metrics_register_route()
+ */
+void web_metrics_request_begin(web_metrics_req_t *ctx, int route_id);
+
+/**
+ * @brief Finish timing a request and record it
+ * @param ctx Context passed to web_metrics_request_begin()
+ * @param result Handler result, anything but ESP_OK counts as an error
+ */
+void web_metrics_request_end(web_metrics_req_t *ctx, esp_err_t result);
+
+/**
+ * @brief Record a request that was rejected before reaching its handler
+ * @param route_id Route ID
+ */
+void web_metrics_record_rejected(int route_id);
+
+/**
+ * @brief httpd_req_recv() that accounts receive time and bytes
+ */
+int web_metrics_recv(httpd_req_t *req, char *buf, size_t len);
+
+/**
+ * @brief httpd_resp_send() that accounts send time and bytes
+ */
+esp_err_t web_metrics_send(httpd_req_t *req, const char *buf, ssize_t len);
+
+/**
+ * @brief httpd_resp_sendstr() that accounts send time and bytes
+ */
+esp_err_t web_metrics_sendstr(httpd_req_t *req, const char *str);
+
+/**
+ * @brief httpd_resp_send_chunk() that accounts send time and bytes
+ */
+esp_err_t web_metrics_send_chunk(httpd_req_t *req, const char *buf, ssize_t len);
+
+/**
+ * @brief httpd_resp_send_err() that accounts send time and bytes
+ * @param msg Response body, NULL for the standard message of the status
+ */
+esp_err_t web_metrics_send_err(httpd_req_t *req, httpd_err_code_t error, const char *msg);
+
+/**
+ * @brief Clear all counters and histograms and start a new window
+ * Throughput and percentiles are reported over the current window.
+ */
+void web_metrics_reset(void);
+
+/**
+ * @brief Get all metrics as JSON
+ * Includes per-route p50/p90/p99 estimates, requests per second over
+ * the current window and the list of routes over their p99 budget.
+ * @return JSON object, caller must free with cJSON_Delete
+ */
+cJSON* web_metrics_to_json(void);
+
+/**
+ * @brief Stream all metrics in Prometheus text exposition format
+ * Sends a chunked response on the given request.
+ * @param req Request to respond to
+ * @return ESP_OK on success
+ */
+esp_err_t web_metrics_send_prometheus(httpd_req_t *req);
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,11 +1,18 @@
 #include "web_server.h"
 #include "widget_manager.h"
+#include "layout_manager.h"
+#include "timer_service.h"
 #include "time_sync.h"
 #include "font_size.h"
 #include "ui_state.h"
 #include "weather_service.h"
+#include "weather_forecast.h"
+#include "http_worker.h"
+#include "web_metrics.h"
+#include "redraw_stats.h"
 #include <string.h>
 #include <stdlib.h>
+#include <stdio.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "esp_log.h"
@@ -22,6 +29,10 @@ static const char *TAG = "web_server";
 #define WEB_SERVER_PORT   80
 #define MAX_POST_SIZE     512
 
+// p99 latency budgets reported by /api/metrics
+#define WEB_P99_BUDGET_FAST_MS   100    // Routes served on the httpd task
+#define WEB_P99_BUDGET_SLOW_MS   2000   // Routes handed to the worker pool
+
 // Config values
 static const char *ap_ssid = NULL;
 static char device_name[64] = {0};
@@ -43,6 +54,15 @@ static bool disable_ap_on_connect = false;
 // Flag to track if STA event handlers are registered
 static bool sta_handlers_registered = false;
 
+// Route descriptor, passed to route_dispatch() as user_ctx
+typedef struct {
+    const char *uri;
+    httpd_method_t method;
+    esp_err_t (*handler)(httpd_req_t *req);
+    bool slow;                   // Run on the worker pool instead of the httpd task
+    int metrics_id;              // Assigned at registration
+} web_route_t;
+
 // Embedded web files
 // Files are in root directory - ESP-IDF converts dots to underscores in symbol names
 extern const uint8_t index_html_start[] asm("_binary_index_html_start");
@@ -98,13 +118,23 @@ static char* replace_placeholder(const char *template, const char *placeholder,
     return result;
 }
 
+// UI command queue full: transient, so ask the client to retry like http_worker does
+static esp_err_t send_ui_busy(httpd_req_t *req)
+{
+    httpd_resp_set_status(req, "503 Service Unavailable");
+    httpd_resp_set_hdr(req, "Retry-After", "1");
+    httpd_resp_set_type(req, "application/json");
+    web_metrics_sendstr(req, "{\"status\":\"busy\"}");
+    return ESP_FAIL;
+}
+
 
 // HTTP GET handler for root path (shell HTML)
 static esp_err_t root_get_handler(httpd_req_t *req)
 {
     ESP_LOGI(TAG, "Serving shell HTML");
     httpd_resp_set_type(req, "text/html");
-    httpd_resp_send(req, (const char *)index_html_start, index_html_end - index_html_start);
+    web_metrics_send(req, (const char *)index_html_start, index_html_end - index_html_start);
     return ESP_OK;
 }
 
@@ -117,7 +147,7 @@ static esp_err_t serve_file(httpd_req_t *req, const uint8_t *start, const uint8_
         len--;
     }
     httpd_resp_set_type(req, content_type);
-    httpd_resp_send(req, (const char *)start, len);
+    web_metrics_send(req, (const char *)start, len);
     return ESP_OK;
 }
 
@@ -131,7 +161,7 @@ static esp_err_t section_handler(httpd_req_t *req)
         // Process placeholders for setup.html
         char *html = strndup((const char *)setup_html_start, setup_html_end - setup_html_start);
         if (!html) {
-            httpd_resp_send_500(req);
+            web_metrics_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, NULL);
             return ESP_FAIL;
         }
         
@@ -150,14 +180,14 @@ static esp_err_t section_handler(httpd_req_t *req)
                 free(html);
                 html = new_html;
                 if (!html) {
-                    httpd_resp_send_500(req);
+                    web_metrics_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, NULL);
                     return ESP_FAIL;
                 }
             }
         }
         
         httpd_resp_set_type(req, "text/html");
-        httpd_resp_send(req, html, strlen(html));
+        web_metrics_send(req, html, strlen(html));
         free(html);
         return ESP_OK;
     } else if (strstr(uri, "widgets.html")) {
@@ -166,7 +196,7 @@ static esp_err_t section_handler(httpd_req_t *req)
         return serve_file(req, settings_html_start, settings_html_end, "text/html");
     }
     
-    httpd_resp_send_404(req);
+    web_metrics_send_err(req, HTTPD_404_NOT_FOUND, NULL);
     return ESP_FAIL;
 }
 
@@ -189,7 +219,7 @@ static esp_err_t js_handler(httpd_req_t *req)
         return serve_file(req, api_js_start, api_js_end, "application/javascript");
     }
     
-    httpd_resp_send_404(req);
+    web_metrics_send_err(req, HTTPD_404_NOT_FOUND, NULL);
     return ESP_FAIL;
 }
 
@@ -200,21 +230,21 @@ static esp_err_t config_post_handler(httpd_req_t *req)
     
     // Check content length
     if (req->content_len > MAX_POST_SIZE) {
-        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Content too large");
+        web_metrics_send_err(req, HTTPD_400_BAD_REQUEST, "Content too large");
         return ESP_FAIL;
     }
     
     // Read request body
     char *buf = malloc(req->content_len + 1);
     if (!buf) {
-        httpd_resp_send_500(req);
+        web_metrics_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, NULL);
         return ESP_FAIL;
     }
     
-    int received = httpd_req_recv(req, buf, req->content_len);
+    int received = web_metrics_recv(req, buf, req->content_len);
     if (received <= 0) {
         free(buf);
-        httpd_resp_send_500(req);
+        web_metrics_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, NULL);
         return ESP_FAIL;
     }
     buf[received] = '\0';
@@ -226,7 +256,7 @@ static esp_err_t config_post_handler(httpd_req_t *req)
     free(buf);
     
     if (!json) {
-        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid JSON");
+        web_metrics_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid JSON");
         return ESP_FAIL;
     }
     
@@ -272,7 +302,7 @@ static esp_err_t config_post_handler(httpd_req_t *req)
     
     // Send success response first
     httpd_resp_set_type(req, "application/json");
-    httpd_resp_sendstr(req, "{\"status\":\"ok\"}");
+    web_metrics_sendstr(req, "{\"status\":\"ok\"}");
     
     // Connect to WiFi if credentials provided
     if (wifi_ssid[0] && wifi_pass[0]) {
@@ -296,7 +326,7 @@ static esp_err_t config_get_handler(httpd_req_t *req)
     cJSON_Delete(json);
     
     httpd_resp_set_type(req, "application/json");
-    httpd_resp_sendstr(req, response);
+    web_metrics_sendstr(req, response);
     
     free(response);
     return ESP_OK;
@@ -394,7 +424,7 @@ static esp_err_t status_get_handler(httpd_req_t *req)
     cJSON_Delete(json);
     
     httpd_resp_set_type(req, "application/json");
-    httpd_resp_sendstr(req, response);
+    web_metrics_sendstr(req, response);
     
     free(response);
     return ESP_OK;
@@ -463,7 +493,7 @@ static esp_err_t scan_get_handler(httpd_req_t *req)
             esp_wifi_set_mode(original_mode);
         }
         httpd_resp_set_type(req, "application/json");
-        httpd_resp_sendstr(req, "[]");
+        web_metrics_sendstr(req, "[]");
         return ESP_OK;
     }
     
@@ -477,7 +507,7 @@ static esp_err_t scan_get_handler(httpd_req_t *req)
             esp_wifi_set_mode(original_mode);
         }
         httpd_resp_set_type(req, "application/json");
-        httpd_resp_sendstr(req, "[]");
+        web_metrics_sendstr(req, "[]");
         return ESP_OK;
     }
     
@@ -489,7 +519,7 @@ static esp_err_t scan_get_handler(httpd_req_t *req)
         if (switched_mode) {
             esp_wifi_set_mode(original_mode);
         }
-        httpd_resp_send_500(req);
+        web_metrics_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, NULL);
         return ESP_FAIL;
     }
     
@@ -523,7 +553,7 @@ static esp_err_t scan_get_handler(httpd_req_t *req)
     cJSON_Delete(json_array);
     
     httpd_resp_set_type(req, "application/json");
-    httpd_resp_sendstr(req, response);
+    web_metrics_sendstr(req, response);
     
     free(response);
     return ESP_OK;
@@ -552,7 +582,7 @@ static esp_err_t reset_post_handler(httpd_req_t *req)
     
     // Send response before restarting
     httpd_resp_set_type(req, "application/json");
-    httpd_resp_sendstr(req, "{\"status\":\"ok\",\"message\":\"Resetting...\"}");
+    web_metrics_sendstr(req, "{\"status\":\"ok\",\"message\":\"Resetting...\"}");
     
     // Schedule restart after short delay
     ESP_LOGW(TAG, "Restarting device in 1 second...");
@@ -567,7 +597,7 @@ static esp_err_t widgets_get_handler(httpd_req_t *req)
 {
     cJSON *widgets = widget_manager_list_widgets();
     if (!widgets) {
-        httpd_resp_send_500(req);
+        web_metrics_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, NULL);
         return ESP_FAIL;
     }
     
@@ -575,7 +605,7 @@ static esp_err_t widgets_get_handler(httpd_req_t *req)
     cJSON_Delete(widgets);
     
     httpd_resp_set_type(req, "application/json");
-    httpd_resp_sendstr(req, response);
+    web_metrics_sendstr(req, response);
     free(response);
     return ESP_OK;
 }
@@ -590,7 +620,7 @@ static esp_err_t widgets_active_get_handler(httpd_req_t *req)
     cJSON_Delete(json);
     
     httpd_resp_set_type(req, "application/json");
-    httpd_resp_sendstr(req, response);
+    web_metrics_sendstr(req, response);
     free(response);
     return ESP_OK;
 }
@@ -598,20 +628,20 @@ static esp_err_t widgets_active_get_handler(httpd_req_t *req)
 static esp_err_t widgets_active_post_handler(httpd_req_t *req)
 {
     if (req->content_len > MAX_POST_SIZE) {
-        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Content too large");
+        web_metrics_send_err(req, HTTPD_400_BAD_REQUEST, "Content too large");
         return ESP_FAIL;
     }
     
     char *buf = malloc(req->content_len + 1);
     if (!buf) {
-        httpd_resp_send_500(req);
+        web_metrics_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, NULL);
         return ESP_FAIL;
     }
     
-    int received = httpd_req_recv(req, buf, req->content_len);
+    int received = web_metrics_recv(req, buf, req->content_len);
     if (received <= 0) {
         free(buf);
-        httpd_resp_send_500(req);
+        web_metrics_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, NULL);
         return ESP_FAIL;
     }
     buf[received] = '\0';
@@ -620,27 +650,266 @@ static esp_err_t widgets_active_post_handler(httpd_req_t *req)
     free(buf);
     
     if (!json) {
-        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid JSON");
+        web_metrics_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid JSON");
         return ESP_FAIL;
     }
     
     cJSON *widget_id = cJSON_GetObjectItem(json, "widget_id");
     if (!widget_id || !cJSON_IsString(widget_id)) {
         cJSON_Delete(json);
-        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Missing widget_id");
+        web_metrics_send_err(req, HTTPD_400_BAD_REQUEST, "Missing widget_id");
+        return ESP_FAIL;
+    }
+    
+    if (!widget_manager_widget_exists(widget_id->valuestring)) {
+        cJSON_Delete(json);
+        web_metrics_send_err(req, HTTPD_404_NOT_FOUND, "Widget not found");
+        return ESP_FAIL;
+    }
+    
+    // Applied by the LVGL task on the next frame
+    esp_err_t ret = ui_state_post_switch(widget_id->valuestring);
+    cJSON_Delete(json);
+    
+    if (ret != ESP_OK) {
+        return send_ui_busy(req);
+    }
+    
+    httpd_resp_set_type(req, "application/json");
+    web_metrics_sendstr(req, "{\"status\":\"ok\"}");
+    return ESP_OK;
+}
+
+// Widget retain mode API handlers
+static esp_err_t widgets_retain_get_handler(httpd_req_t *req)
+{
+    cJSON *json = cJSON_CreateObject();
+    cJSON_AddNumberToObject(json, "budget_bytes", widget_manager_get_retain_budget());
+    
+    char *response = cJSON_PrintUnformatted(json);
+    cJSON_Delete(json);
+    
+    httpd_resp_set_type(req, "application/json");
+    web_metrics_sendstr(req, response);
+    free(response);
+    return ESP_OK;
+}
+
+static esp_err_t widgets_retain_post_handler(httpd_req_t *req)
+{
+    if (req->content_len > MAX_POST_SIZE) {
+        web_metrics_send_err(req, HTTPD_400_BAD_REQUEST, "Content too large");
+        return ESP_FAIL;
+    }
+    
+    char *buf = malloc(req->content_len + 1);
+    if (!buf) {
+        web_metrics_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, NULL);
+        return ESP_FAIL;
+    }
+    
+    int received = web_metrics_recv(req, buf, req->content_len);
+    if (received <= 0) {
+        free(buf);
+        web_metrics_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, NULL);
+        return ESP_FAIL;
+    }
+    buf[received] = '\0';
+    
+    cJSON *json = cJSON_Parse(buf);
+    free(buf);
+    
+    if (!json) {
+        web_metrics_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid JSON");
+        return ESP_FAIL;
+    }
+    
+    cJSON *budget_item = cJSON_GetObjectItem(json, "budget_bytes");
+    if (!budget_item || !cJSON_IsNumber(budget_item) || budget_item->valuedouble < 0) {
+        cJSON_Delete(json);
+        web_metrics_send_err(req, HTTPD_400_BAD_REQUEST, "Missing or invalid budget_bytes");
+        return ESP_FAIL;
+    }
+    
+    widget_manager_set_retain_budget((uint32_t)budget_item->valuedouble);
+    cJSON_Delete(json);
+    
+    httpd_resp_set_type(req, "application/json");
+    web_metrics_sendstr(req, "{\"status\":\"ok\"}");
+    return ESP_OK;
+}
+
+// Dashboard layout API handlers
+static esp_err_t layout_get_handler(httpd_req_t *req)
+{
+    layout_t layout;
+    layout_manager_get(&layout);
+    
+    cJSON *json = layout_manager_to_json(&layout);
+    if (!json) {
+        web_metrics_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, NULL);
+        return ESP_FAIL;
+    }
+    
+    char *response = cJSON_PrintUnformatted(json);
+    cJSON_Delete(json);
+    
+    httpd_resp_set_type(req, "application/json");
+    web_metrics_sendstr(req, response);
+    free(response);
+    return ESP_OK;
+}
+
+static esp_err_t layout_post_handler(httpd_req_t *req)
+{
+    if (req->content_len > MAX_POST_SIZE) {
+        web_metrics_send_err(req, HTTPD_400_BAD_REQUEST, "Content too large");
+        return ESP_FAIL;
+    }
+    
+    char *buf = malloc(req->content_len + 1);
+    if (!buf) {
+        web_metrics_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, NULL);
+        return ESP_FAIL;
+    }
+    
+    int received = web_metrics_recv(req, buf, req->content_len);
+    if (received <= 0) {
+        free(buf);
+        web_metrics_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, NULL);
+        return ESP_FAIL;
+    }
+    buf[received] = '\0';
+    
+    cJSON *json = cJSON_Parse(buf);
+    free(buf);
+    
+    if (!json) {
+        web_metrics_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid JSON");
         return ESP_FAIL;
     }
     
-    esp_err_t ret = widget_manager_switch(widget_id->valuestring);
+    layout_t layout;
+    esp_err_t ret = layout_manager_from_json(json, &layout);
     cJSON_Delete(json);
     
     if (ret != ESP_OK) {
-        httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, "Widget not found");
+        web_metrics_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid layout");
+        return ESP_FAIL;
+    }
+    
+    ret = layout_manager_set(&layout);
+    if (ret == ESP_ERR_NOT_FOUND) {
+        web_metrics_send_err(req, HTTPD_404_NOT_FOUND, "Widget not found");
+        return ESP_FAIL;
+    } else if (ret != ESP_OK) {
+        web_metrics_send_err(req, HTTPD_400_BAD_REQUEST, "Each region needs a different widget");
         return ESP_FAIL;
     }
     
     httpd_resp_set_type(req, "application/json");
-    httpd_resp_sendstr(req, "{\"status\":\"ok\"}");
+    web_metrics_sendstr(req, "{\"status\":\"ok\"}");
+    return ESP_OK;
+}
+
+// Timer API handlers
+static esp_err_t timers_get_handler(httpd_req_t *req)
+{
+    cJSON *json = timer_service_to_json();
+    if (!json) {
+        web_metrics_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, NULL);
+        return ESP_FAIL;
+    }
+    
+    char *response = cJSON_PrintUnformatted(json);
+    cJSON_Delete(json);
+    
+    httpd_resp_set_type(req, "application/json");
+    web_metrics_sendstr(req, response);
+    free(response);
+    return ESP_OK;
+}
+
+// {"name": "tea", "action": "create|start|pause|reset|delete", "type": "countdown", "duration_seconds": 180}
+static esp_err_t timers_post_handler(httpd_req_t *req)
+{
+    if (req->content_len > MAX_POST_SIZE) {
+        web_metrics_send_err(req, HTTPD_400_BAD_REQUEST, "Content too large");
+        return ESP_FAIL;
+    }
+    
+    char *buf = malloc(req->content_len + 1);
+    if (!buf) {
+        web_metrics_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, NULL);
+        return ESP_FAIL;
+    }
+    
+    int received = web_metrics_recv(req, buf, req->content_len);
+    if (received <= 0) {
+        free(buf);
+        web_metrics_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, NULL);
+        return ESP_FAIL;
+    }
+    buf[received] = '\0';
+    
+    cJSON *json = cJSON_Parse(buf);
+    free(buf);
+    
+    if (!json) {
+        web_metrics_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid JSON");
+        return ESP_FAIL;
+    }
+    
+    cJSON *name = cJSON_GetObjectItem(json, "name");
+    cJSON *action = cJSON_GetObjectItem(json, "action");
+    if (!cJSON_IsString(name) || !cJSON_IsString(action)) {
+        cJSON_Delete(json);
+        web_metrics_send_err(req, HTTPD_400_BAD_REQUEST, "Missing name or action");
+        return ESP_FAIL;
+    }
+    
+    esp_err_t ret;
+    if (strcmp(action->valuestring, "create") == 0) {
+        cJSON *type = cJSON_GetObjectItem(json, "type");
+        cJSON *duration = cJSON_GetObjectItem(json, "duration_seconds");
+        timer_kind_t kind = (cJSON_IsString(type) && strcmp(type->valuestring, "stopwatch") == 0) ?
+                            TIMER_KIND_STOPWATCH : TIMER_KIND_COUNTDOWN;
+        int seconds = cJSON_IsNumber(duration) ? duration->valueint : 0;
+        if (kind == TIMER_KIND_COUNTDOWN && (seconds <= 0 || seconds > 359999)) {
+            cJSON_Delete(json);
+            web_metrics_send_err(req, HTTPD_400_BAD_REQUEST, "duration_seconds must be 1-359999");
+            return ESP_FAIL;
+        }
+        ret = timer_service_configure(name->valuestring, kind, seconds);
+    } else if (strcmp(action->valuestring, "start") == 0) {
+        ret = timer_service_start(name->valuestring);
+    } else if (strcmp(action->valuestring, "pause") == 0) {
+        ret = timer_service_pause(name->valuestring);
+    } else if (strcmp(action->valuestring, "reset") == 0) {
+        ret = timer_service_reset(name->valuestring);
+    } else if (strcmp(action->valuestring, "delete") == 0) {
+        ret = timer_service_delete(name->valuestring);
+    } else {
+        ret = ESP_ERR_NOT_SUPPORTED;
+    }
+    cJSON_Delete(json);
+    
+    if (ret == ESP_ERR_NOT_FOUND) {
+        web_metrics_send_err(req, HTTPD_404_NOT_FOUND, "Timer not found");
+        return ESP_FAIL;
+    } else if (ret == ESP_ERR_NO_MEM) {
+        web_metrics_send_err(req, HTTPD_400_BAD_REQUEST, "Too many timers");
+        return ESP_FAIL;
+    } else if (ret != ESP_OK) {
+        web_metrics_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid timer request");
+        return ESP_FAIL;
+    }
+    
+    // The timer widget may be showing this one
+    ui_state_post_data_updated("timer");
+    
+    httpd_resp_set_type(req, "application/json");
+    web_metrics_sendstr(req, "{\"status\":\"ok\"}");
     return ESP_OK;
 }
 
@@ -676,13 +945,13 @@ static esp_err_t widget_config_get_handler(httpd_req_t *req)
     // Extract widget_id from URI: /api/widgets/{id}/config
     char widget_id[32];
     if (!is_widget_config_uri(req->uri, widget_id, sizeof(widget_id))) {
-        httpd_resp_send_404(req);
+        web_metrics_send_err(req, HTTPD_404_NOT_FOUND, NULL);
         return ESP_FAIL;
     }
     
     cJSON *config = widget_manager_get_config(widget_id);
     if (!config) {
-        httpd_resp_send_404(req);
+        web_metrics_send_err(req, HTTPD_404_NOT_FOUND, NULL);
         return ESP_FAIL;
     }
     
@@ -690,7 +959,7 @@ static esp_err_t widget_config_get_handler(httpd_req_t *req)
     cJSON_Delete(config);
     
     httpd_resp_set_type(req, "application/json");
-    httpd_resp_sendstr(req, response);
+    web_metrics_sendstr(req, response);
     free(response);
     return ESP_OK;
 }
@@ -700,25 +969,25 @@ static esp_err_t widget_config_post_handler(httpd_req_t *req)
     // Extract widget_id from URI
     char widget_id[32];
     if (!is_widget_config_uri(req->uri, widget_id, sizeof(widget_id))) {
-        httpd_resp_send_404(req);
+        web_metrics_send_err(req, HTTPD_404_NOT_FOUND, NULL);
         return ESP_FAIL;
     }
     
     if (req->content_len > MAX_POST_SIZE) {
-        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Content too large");
+        web_metrics_send_err(req, HTTPD_400_BAD_REQUEST, "Content too large");
         return ESP_FAIL;
     }
     
     char *buf = malloc(req->content_len + 1);
     if (!buf) {
-        httpd_resp_send_500(req);
+        web_metrics_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, NULL);
         return ESP_FAIL;
     }
     
-    int received = httpd_req_recv(req, buf, req->content_len);
+    int received = web_metrics_recv(req, buf, req->content_len);
     if (received <= 0) {
         free(buf);
-        httpd_resp_send_500(req);
+        web_metrics_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, NULL);
         return ESP_FAIL;
     }
     buf[received] = '\0';
@@ -727,20 +996,26 @@ static esp_err_t widget_config_post_handler(httpd_req_t *req)
     free(buf);
     
     if (!json) {
-        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid JSON");
+        web_metrics_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid JSON");
+        return ESP_FAIL;
+    }
+    
+    if (!widget_manager_widget_exists(widget_id)) {
+        cJSON_Delete(json);
+        web_metrics_send_err(req, HTTPD_404_NOT_FOUND, "Widget not found");
         return ESP_FAIL;
     }
     
-    esp_err_t ret = widget_manager_set_config(widget_id, json);
+    // Applied (and persisted) by the LVGL task on the next frame
+    esp_err_t ret = ui_state_post_config(widget_id, json);
     cJSON_Delete(json);
     
     if (ret != ESP_OK) {
-        httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, "Widget not found");
-        return ESP_FAIL;
+        return send_ui_busy(req);
     }
     
     httpd_resp_set_type(req, "application/json");
-    httpd_resp_sendstr(req, "{\"status\":\"ok\"}");
+    web_metrics_sendstr(req, "{\"status\":\"ok\"}");
     return ESP_OK;
 }
 
@@ -755,7 +1030,7 @@ static esp_err_t timezone_get_handler(httpd_req_t *req)
     cJSON_Delete(json);
     
     httpd_resp_set_type(req, "application/json");
-    httpd_resp_sendstr(req, response);
+    web_metrics_sendstr(req, response);
     free(response);
     return ESP_OK;
 }
@@ -763,20 +1038,20 @@ static esp_err_t timezone_get_handler(httpd_req_t *req)
 static esp_err_t timezone_post_handler(httpd_req_t *req)
 {
     if (req->content_len > MAX_POST_SIZE) {
-        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Content too large");
+        web_metrics_send_err(req, HTTPD_400_BAD_REQUEST, "Content too large");
         return ESP_FAIL;
     }
     
     char *buf = malloc(req->content_len + 1);
     if (!buf) {
-        httpd_resp_send_500(req);
+        web_metrics_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, NULL);
         return ESP_FAIL;
     }
     
-    int received = httpd_req_recv(req, buf, req->content_len);
+    int received = web_metrics_recv(req, buf, req->content_len);
     if (received <= 0) {
         free(buf);
-        httpd_resp_send_500(req);
+        web_metrics_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, NULL);
         return ESP_FAIL;
     }
     buf[received] = '\0';
@@ -785,14 +1060,14 @@ static esp_err_t timezone_post_handler(httpd_req_t *req)
     free(buf);
     
     if (!json) {
-        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid JSON");
+        web_metrics_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid JSON");
         return ESP_FAIL;
     }
     
     cJSON *tz_item = cJSON_GetObjectItem(json, "timezone");
     if (!tz_item || !cJSON_IsString(tz_item)) {
         cJSON_Delete(json);
-        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Missing or invalid timezone");
+        web_metrics_send_err(req, HTTPD_400_BAD_REQUEST, "Missing or invalid timezone");
         return ESP_FAIL;
     }
     
@@ -801,12 +1076,12 @@ static esp_err_t timezone_post_handler(httpd_req_t *req)
     cJSON_Delete(json);
     
     if (ret != ESP_OK) {
-        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Failed to set timezone");
+        web_metrics_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Failed to set timezone");
         return ESP_FAIL;
     }
     
     httpd_resp_set_type(req, "application/json");
-    httpd_resp_sendstr(req, "{\"status\":\"ok\"}");
+    web_metrics_sendstr(req, "{\"status\":\"ok\"}");
     return ESP_OK;
 }
 
@@ -821,7 +1096,7 @@ static esp_err_t font_size_get_handler(httpd_req_t *req)
     cJSON_Delete(json);
     
     httpd_resp_set_type(req, "application/json");
-    httpd_resp_sendstr(req, response);
+    web_metrics_sendstr(req, response);
     free(response);
     return ESP_OK;
 }
@@ -829,20 +1104,20 @@ static esp_err_t font_size_get_handler(httpd_req_t *req)
 static esp_err_t font_size_post_handler(httpd_req_t *req)
 {
     if (req->content_len > MAX_POST_SIZE) {
-        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Content too large");
+        web_metrics_send_err(req, HTTPD_400_BAD_REQUEST, "Content too large");
         return ESP_FAIL;
     }
     
     char *buf = malloc(req->content_len + 1);
     if (!buf) {
-        httpd_resp_send_500(req);
+        web_metrics_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, NULL);
         return ESP_FAIL;
     }
     
-    int received = httpd_req_recv(req, buf, req->content_len);
+    int received = web_metrics_recv(req, buf, req->content_len);
     if (received <= 0) {
         free(buf);
-        httpd_resp_send_500(req);
+        web_metrics_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, NULL);
         return ESP_FAIL;
     }
     buf[received] = '\0';
@@ -851,40 +1126,40 @@ static esp_err_t font_size_post_handler(httpd_req_t *req)
     free(buf);
     
     if (!json) {
-        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid JSON");
+        web_metrics_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid JSON");
         return ESP_FAIL;
     }
     
     cJSON *size_item = cJSON_GetObjectItem(json, "font_size");
     if (!size_item || !cJSON_IsNumber(size_item)) {
         cJSON_Delete(json);
-        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Missing or invalid font_size");
+        web_metrics_send_err(req, HTTPD_400_BAD_REQUEST, "Missing or invalid font_size");
         return ESP_FAIL;
     }
     
     int preset = size_item->valueint;
     if (preset < 0 || preset > 9) {
         cJSON_Delete(json);
-        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Font size out of range (0-9)");
+        web_metrics_send_err(req, HTTPD_400_BAD_REQUEST, "Font size out of range (0-9)");
         return ESP_FAIL;
     }
     
     font_size_set_preset((font_size_preset_t)preset);
     
-    // Notify UI state manager to refresh widgets
-    ui_state_refresh();
+    // Ask the UI to pick up the new fonts (non-blocking)
+    ui_state_post_font_changed();
     
     cJSON_Delete(json);
     
     httpd_resp_set_type(req, "application/json");
-    httpd_resp_sendstr(req, "{\"status\":\"ok\"}");
+    web_metrics_sendstr(req, "{\"status\":\"ok\"}");
     return ESP_OK;
 }
 
 // Weather zip code API handlers
 static esp_err_t weather_zip_get_handler(httpd_req_t *req)
 {
-    char zip_code[16] = {0};
+    char zip_code[WEATHER_LOCATION_QUERY_LEN] = {0};
     weather_service_get_zip_code(zip_code, sizeof(zip_code));
     
     cJSON *json = cJSON_CreateObject();
@@ -894,7 +1169,7 @@ static esp_err_t weather_zip_get_handler(httpd_req_t *req)
     cJSON_Delete(json);
     
     httpd_resp_set_type(req, "application/json");
-    httpd_resp_sendstr(req, response);
+    web_metrics_sendstr(req, response);
     free(response);
     return ESP_OK;
 }
@@ -902,20 +1177,20 @@ static esp_err_t weather_zip_get_handler(httpd_req_t *req)
 static esp_err_t weather_zip_post_handler(httpd_req_t *req)
 {
     if (req->content_len > MAX_POST_SIZE) {
-        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Content too large");
+        web_metrics_send_err(req, HTTPD_400_BAD_REQUEST, "Content too large");
         return ESP_FAIL;
     }
     
     char *buf = malloc(req->content_len + 1);
     if (!buf) {
-        httpd_resp_send_500(req);
+        web_metrics_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, NULL);
         return ESP_FAIL;
     }
     
-    int received = httpd_req_recv(req, buf, req->content_len);
+    int received = web_metrics_recv(req, buf, req->content_len);
     if (received <= 0) {
         free(buf);
-        httpd_resp_send_500(req);
+        web_metrics_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, NULL);
         return ESP_FAIL;
     }
     buf[received] = '\0';
@@ -924,7 +1199,7 @@ static esp_err_t weather_zip_post_handler(httpd_req_t *req)
     free(buf);
     
     if (!json) {
-        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid JSON");
+        web_metrics_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid JSON");
         return ESP_FAIL;
     }
     
@@ -935,9 +1210,9 @@ static esp_err_t weather_zip_post_handler(httpd_req_t *req)
     
     cJSON_Delete(json);
     
-    ui_state_refresh(); // Notify UI to refresh weather widget
+    ui_state_post_data_updated("weather"); // Republish weather without a rebuild
     httpd_resp_set_type(req, "application/json");
-    httpd_resp_sendstr(req, "{\"status\":\"ok\"}");
+    web_metrics_sendstr(req, "{\"status\":\"ok\"}");
     return ESP_OK;
 }
 
@@ -952,7 +1227,7 @@ static esp_err_t weather_temp_unit_get_handler(httpd_req_t *req)
     cJSON_Delete(json);
     
     httpd_resp_set_type(req, "application/json");
-    httpd_resp_sendstr(req, response);
+    web_metrics_sendstr(req, response);
     free(response);
     return ESP_OK;
 }
@@ -960,20 +1235,20 @@ static esp_err_t weather_temp_unit_get_handler(httpd_req_t *req)
 static esp_err_t weather_temp_unit_post_handler(httpd_req_t *req)
 {
     if (req->content_len > MAX_POST_SIZE) {
-        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Content too large");
+        web_metrics_send_err(req, HTTPD_400_BAD_REQUEST, "Content too large");
         return ESP_FAIL;
     }
     
     char *buf = malloc(req->content_len + 1);
     if (!buf) {
-        httpd_resp_send_500(req);
+        web_metrics_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, NULL);
         return ESP_FAIL;
     }
     
-    int received = httpd_req_recv(req, buf, req->content_len);
+    int received = web_metrics_recv(req, buf, req->content_len);
     if (received <= 0) {
         free(buf);
-        httpd_resp_send_500(req);
+        web_metrics_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, NULL);
         return ESP_FAIL;
     }
     buf[received] = '\0';
@@ -982,14 +1257,14 @@ static esp_err_t weather_temp_unit_post_handler(httpd_req_t *req)
     free(buf);
     
     if (!json) {
-        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid JSON");
+        web_metrics_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid JSON");
         return ESP_FAIL;
     }
     
     cJSON *unit_item = cJSON_GetObjectItem(json, "temp_unit");
     if (!unit_item || !cJSON_IsString(unit_item)) {
         cJSON_Delete(json);
-        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Missing or invalid temp_unit");
+        web_metrics_send_err(req, HTTPD_400_BAD_REQUEST, "Missing or invalid temp_unit");
         return ESP_FAIL;
     }
     
@@ -1001,7 +1276,7 @@ static esp_err_t weather_temp_unit_post_handler(httpd_req_t *req)
         unit = WEATHER_TEMP_CELSIUS;
     } else {
         cJSON_Delete(json);
-        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid temp_unit (must be 'celsius' or 'fahrenheit')");
+        web_metrics_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid temp_unit (must be 'celsius' or 'fahrenheit')");
         return ESP_FAIL;
     }
     
@@ -1009,24 +1284,115 @@ static esp_err_t weather_temp_unit_post_handler(httpd_req_t *req)
     cJSON_Delete(json);
     
     if (ret != ESP_OK) {
-        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Failed to set temperature unit");
+        web_metrics_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Failed to set temperature unit");
+        return ESP_FAIL;
+    }
+    
+    ui_state_post_data_updated("weather"); // Republish weather without a rebuild
+    httpd_resp_set_type(req, "application/json");
+    web_metrics_sendstr(req, "{\"status\":\"ok\"}");
+    return ESP_OK;
+}
+
+// Weather wind speed unit API handlers
+static esp_err_t weather_wind_unit_get_handler(httpd_req_t *req)
+{
+    cJSON *json = cJSON_CreateObject();
+    cJSON_AddStringToObject(json, "wind_unit", weather_service_wind_unit_name(weather_service_get_wind_unit()));
+    
+    char *response = cJSON_PrintUnformatted(json);
+    cJSON_Delete(json);
+    
+    httpd_resp_set_type(req, "application/json");
+    web_metrics_sendstr(req, response);
+    free(response);
+    return ESP_OK;
+}
+
+static esp_err_t weather_wind_unit_post_handler(httpd_req_t *req)
+{
+    if (req->content_len > MAX_POST_SIZE) {
+        web_metrics_send_err(req, HTTPD_400_BAD_REQUEST, "Content too large");
         return ESP_FAIL;
     }
     
-    ui_state_refresh(); // Notify UI to refresh weather widget
+    char *buf = malloc(req->content_len + 1);
+    if (!buf) {
+        web_metrics_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, NULL);
+        return ESP_FAIL;
+    }
+    
+    int received = web_metrics_recv(req, buf, req->content_len);
+    if (received <= 0) {
+        free(buf);
+        web_metrics_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, NULL);
+        return ESP_FAIL;
+    }
+    buf[received] = '\0';
+    
+    cJSON *json = cJSON_Parse(buf);
+    free(buf);
+    
+    if (!json) {
+        web_metrics_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid JSON");
+        return ESP_FAIL;
+    }
+    
+    weather_wind_unit_t unit;
+    cJSON *unit_item = cJSON_GetObjectItem(json, "wind_unit");
+    if (!unit_item || !cJSON_IsString(unit_item) ||
+        weather_service_parse_wind_unit(cJSON_GetStringValue(unit_item), &unit) != ESP_OK) {
+        cJSON_Delete(json);
+        web_metrics_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid wind_unit (must be 'kmh', 'mph' or 'ms')");
+        return ESP_FAIL;
+    }
+    cJSON_Delete(json);
+    
+    if (weather_service_set_wind_unit(unit) != ESP_OK) {
+        web_metrics_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Failed to set wind unit");
+        return ESP_FAIL;
+    }
+    
+    ui_state_post_data_updated("weather"); // Republish weather without a rebuild
     httpd_resp_set_type(req, "application/json");
-    httpd_resp_sendstr(req, "{\"status\":\"ok\"}");
+    web_metrics_sendstr(req, "{\"status\":\"ok\"}");
     return ESP_OK;
 }
 
+// Cached data is canonical (°C, m/s); report it in the selected units
+static void add_weather_fields(cJSON *json, const weather_data_t *weather)
+{
+    cJSON_AddNumberToObject(json, "temperature", weather_service_display_temp(weather->temperature));
+    cJSON_AddNumberToObject(json, "humidity", weather->humidity);
+    cJSON_AddNumberToObject(json, "wind_speed", weather_service_display_wind(weather->wind_speed));
+    cJSON_AddStringToObject(json, "temp_unit",
+                            weather_service_get_temp_unit() == WEATHER_TEMP_FAHRENHEIT ? "fahrenheit" : "celsius");
+    cJSON_AddStringToObject(json, "wind_unit", weather_service_wind_unit_name(weather_service_get_wind_unit()));
+    cJSON_AddNumberToObject(json, "weather_code", weather->weather_code);
+    cJSON_AddStringToObject(json, "condition", weather->condition);
+}
+
 // Weather data API handler
 static esp_err_t weather_data_get_handler(httpd_req_t *req)
 {
+    // ?location=<name> selects a named location, the zip code otherwise
+    char query[64] = {0};
+    char location[WEATHER_LOCATION_NAME_LEN] = {0};
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK) {
+        httpd_query_key_value(query, "location", location, sizeof(location));
+    }
+    
     weather_data_t weather = {0};
     esp_err_t ret = ESP_FAIL;
     
-    // Try to get cached data first
-    if (weather_service_get_cached(&weather) != ESP_OK) {
+    if (location[0] != '\0') {
+        // Returns the cache and only asks for a refresh when it is due
+        ret = weather_service_fetch_location(location, &weather);
+        if (ret == ESP_ERR_NOT_FOUND) {
+            web_metrics_send_err(req, HTTPD_404_NOT_FOUND, "Unknown location");
+            return ESP_FAIL;
+        }
+    } else if (weather_service_get_cached(&weather) != ESP_OK) {
         // Cache miss or expired, fetch new data
         ret = weather_service_fetch(&weather);
     } else {
@@ -1036,11 +1402,7 @@ static esp_err_t weather_data_get_handler(httpd_req_t *req)
     cJSON *json = cJSON_CreateObject();
     
     if (ret == ESP_OK && weather.valid) {
-        cJSON_AddNumberToObject(json, "temperature", weather.temperature);
-        cJSON_AddNumberToObject(json, "humidity", weather.humidity);
-        cJSON_AddNumberToObject(json, "wind_speed", weather.wind_speed);
-        cJSON_AddNumberToObject(json, "weather_code", weather.weather_code);
-        cJSON_AddStringToObject(json, "condition", weather.condition);
+        add_weather_fields(json, &weather);
         cJSON_AddBoolToObject(json, "valid", true);
     } else {
         cJSON_AddBoolToObject(json, "valid", false);
@@ -1051,11 +1413,276 @@ static esp_err_t weather_data_get_handler(httpd_req_t *req)
     cJSON_Delete(json);
     
     httpd_resp_set_type(req, "application/json");
-    httpd_resp_sendstr(req, response);
+    web_metrics_sendstr(req, response);
+    free(response);
+    return ESP_OK;
+}
+
+// Weather locations API handlers - every location with its cached data
+static esp_err_t weather_locations_get_handler(httpd_req_t *req)
+{
+    cJSON *json = cJSON_CreateObject();
+    cJSON_AddNumberToObject(json, "max", WEATHER_MAX_LOCATIONS);
+    cJSON *list = cJSON_AddArrayToObject(json, "locations");
+    
+    for (int i = 0; i < WEATHER_MAX_LOCATIONS; i++) {
+        char name[WEATHER_LOCATION_NAME_LEN];
+        char zip_code[WEATHER_LOCATION_QUERY_LEN];
+        weather_data_t weather;
+        if (weather_service_get_location(i, name, zip_code, sizeof(zip_code), &weather) != ESP_OK) {
+            continue;
+        }
+        
+        cJSON *item = cJSON_CreateObject();
+        cJSON_AddStringToObject(item, "name", name);
+        cJSON_AddStringToObject(item, "zip_code", zip_code);
+        cJSON_AddBoolToObject(item, "primary", i == 0);
+        if (weather.valid) {
+            add_weather_fields(item, &weather);
+        }
+        cJSON_AddBoolToObject(item, "valid", weather.valid);
+        cJSON_AddItemToArray(list, item);
+    }
+    
+    char *response = cJSON_PrintUnformatted(json);
+    cJSON_Delete(json);
+    
+    httpd_resp_set_type(req, "application/json");
+    web_metrics_sendstr(req, response);
+    free(response);
+    return ESP_OK;
+}
+
+// {"name": "office", "zip_code": "10001"} adds or changes a location,
+// {"name": "office", "remove": true} removes it
+static esp_err_t weather_locations_post_handler(httpd_req_t *req)
+{
+    if (req->content_len > MAX_POST_SIZE) {
+        web_metrics_send_err(req, HTTPD_400_BAD_REQUEST, "Content too large");
+        return ESP_FAIL;
+    }
+    
+    char *buf = malloc(req->content_len + 1);
+    if (!buf) {
+        web_metrics_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, NULL);
+        return ESP_FAIL;
+    }
+    
+    int received = web_metrics_recv(req, buf, req->content_len);
+    if (received <= 0) {
+        free(buf);
+        web_metrics_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, NULL);
+        return ESP_FAIL;
+    }
+    buf[received] = '\0';
+    
+    cJSON *json = cJSON_Parse(buf);
+    free(buf);
+    
+    if (!json) {
+        web_metrics_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid JSON");
+        return ESP_FAIL;
+    }
+    
+    const char *name = cJSON_GetStringValue(cJSON_GetObjectItem(json, "name"));
+    const char *zip_code = cJSON_GetStringValue(cJSON_GetObjectItem(json, "zip_code"));
+    bool remove_location = cJSON_IsTrue(cJSON_GetObjectItem(json, "remove"));
+    
+    esp_err_t ret = ESP_ERR_INVALID_ARG;
+    if (name && remove_location) {
+        ret = weather_service_remove_location(name);
+    } else if (name && zip_code) {
+        ret = weather_service_set_location(name, zip_code);
+    }
+    cJSON_Delete(json);
+    
+    if (ret == ESP_ERR_NOT_FOUND) {
+        web_metrics_send_err(req, HTTPD_404_NOT_FOUND, "Unknown location");
+        return ESP_FAIL;
+    }
+    if (ret == ESP_ERR_NO_MEM) {
+        web_metrics_send_err(req, HTTPD_400_BAD_REQUEST, "All locations are in use");
+        return ESP_FAIL;
+    }
+    if (ret != ESP_OK) {
+        web_metrics_send_err(req, HTTPD_400_BAD_REQUEST,
+                            "Invalid location (name: letters, digits, '-' or '_'; the primary location cannot be removed)");
+        return ESP_FAIL;
+    }
+    
+    ui_state_post_data_updated("weather"); // Republish weather without a rebuild
+    httpd_resp_set_type(req, "application/json");
+    web_metrics_sendstr(req, "{\"status\":\"ok\"}");
+    return ESP_OK;
+}
+
+// Forecast API handler - served from the stored forecast, never fetches
+static esp_err_t weather_forecast_get_handler(httpd_req_t *req)
+{
+    cJSON *json = weather_forecast_to_json(time(NULL));
+    char *response = cJSON_PrintUnformatted(json);
+    cJSON_Delete(json);
+    
+    if (!response) {
+        web_metrics_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, NULL);
+        return ESP_FAIL;
+    }
+    
+    httpd_resp_set_type(req, "application/json");
+    web_metrics_sendstr(req, response);
+    free(response);
+    return ESP_OK;
+}
+
+// Metrics API handler
+static esp_err_t metrics_get_handler(httpd_req_t *req)
+{
+    // JSON by default, Prometheus text with ?format=prometheus
+    char query[64] = {0};
+    char format[16] = {0};
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK) {
+        httpd_query_key_value(query, "format", format, sizeof(format));
+    }
+    
+    if (strcmp(format, "prometheus") == 0) {
+        return web_metrics_send_prometheus(req);
+    }
+    
+    cJSON *json = web_metrics_to_json();
+    cJSON_AddItemToObject(json, "widget_switch", widget_manager_get_switch_stats());
+    cJSON_AddItemToObject(json, "redraw", redraw_stats_to_json());
+    cJSON_AddItemToObject(json, "weather_http", weather_service_get_http_stats());
+    char *response = cJSON_PrintUnformatted(json);
+    cJSON_Delete(json);
+    
+    if (!response) {
+        web_metrics_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, NULL);
+        return ESP_FAIL;
+    }
+    
+    httpd_resp_set_type(req, "application/json");
+    web_metrics_sendstr(req, response);
     free(response);
     return ESP_OK;
 }
 
+static esp_err_t metrics_reset_post_handler(httpd_req_t *req)
+{
+    web_metrics_reset();
+    redraw_stats_reset();
+    httpd_resp_set_type(req, "application/json");
+    web_metrics_sendstr(req, "{\"status\":\"ok\"}");
+    return ESP_OK;
+}
+
+// Route table - slow routes touch storage, the display lock or the radio
+// and are handed to the worker pool so the httpd task stays responsive
+static web_route_t web_routes[] = {
+    // Root page (shell HTML)
+    { "/",                        HTTP_GET,  root_get_handler,               false },
+    
+    // Section HTML files - specific routes
+    { "/sections/setup.html",     HTTP_GET,  section_handler,                false },
+    { "/sections/widgets.html",   HTTP_GET,  section_handler,                false },
+    { "/sections/settings.html",  HTTP_GET,  section_handler,                false },
+    
+    // CSS and JS files - specific routes (ESP-IDF doesn't support wildcards)
+    { "/css/styles.css",          HTTP_GET,  css_handler,                    false },
+    { "/js/app.js",               HTTP_GET,  js_handler,                     false },
+    { "/js/api.js",               HTTP_GET,  js_handler,                     false },
+    
+    // Config, scan, status and reset API
+    { "/api/config",              HTTP_POST, config_post_handler,            true  },
+    { "/api/config",              HTTP_GET,  config_get_handler,             false },
+    { "/api/scan",                HTTP_GET,  scan_get_handler,               true  },
+    { "/api/status",              HTTP_GET,  status_get_handler,             false },
+    { "/api/reset",               HTTP_POST, reset_post_handler,             true  },
+    
+    // Timezone and font size API
+    { "/api/timezone",            HTTP_GET,  timezone_get_handler,           false },
+    { "/api/timezone",            HTTP_POST, timezone_post_handler,          true  },
+    { "/api/font-size",           HTTP_GET,  font_size_get_handler,          false },
+    { "/api/font-size",           HTTP_POST, font_size_post_handler,         true  },
+    
+    // Weather API
+    { "/api/weather/zip-code",    HTTP_GET,  weather_zip_get_handler,        false },
+    { "/api/weather/zip-code",    HTTP_POST, weather_zip_post_handler,       true  },
+    { "/api/weather/data",        HTTP_GET,  weather_data_get_handler,       false },
+    { "/api/weather/locations",   HTTP_GET,  weather_locations_get_handler,  false },
+    { "/api/weather/locations",   HTTP_POST, weather_locations_post_handler, true  },
+    { "/api/weather/forecast",    HTTP_GET,  weather_forecast_get_handler,   false },
+    { "/api/weather/temp-unit",   HTTP_GET,  weather_temp_unit_get_handler,  false },
+    { "/api/weather/temp-unit",   HTTP_POST, weather_temp_unit_post_handler, true  },
+    { "/api/weather/wind-unit",   HTTP_GET,  weather_wind_unit_get_handler,  false },
+    { "/api/weather/wind-unit",   HTTP_POST, weather_wind_unit_post_handler, true  },
+    
+    // Widget API
+    { "/api/widgets",             HTTP_GET,  widgets_get_handler,            false },
+    { "/api/widgets/active",      HTTP_GET,  widgets_active_get_handler,     false },
+    { "/api/widgets/active",      HTTP_POST, widgets_active_post_handler,    false },
+    { "/api/widgets/retain",      HTTP_GET,  widgets_retain_get_handler,     false },
+    { "/api/widgets/retain",      HTTP_POST, widgets_retain_post_handler,    true  },
+    { "/api/layout",              HTTP_GET,  layout_get_handler,             false },
+    { "/api/layout",              HTTP_POST, layout_post_handler,            true  },
+    
+    // Timer API
+    { "/api/timers",              HTTP_GET,  timers_get_handler,             false },
+    { "/api/timers",              HTTP_POST, timers_post_handler,            true  },
+    
+    // Metrics API
+    { "/api/metrics",             HTTP_GET,  metrics_get_handler,            false },
+    { "/api/metrics/reset",       HTTP_POST, metrics_reset_post_handler,     false },
+};
+
+// Widget config routes - registered per known widget, the URI here is the metrics label
+static web_route_t widget_config_get_route = { "/api/widgets/{id}/config", HTTP_GET, widget_config_get_handler, false };
+static web_route_t widget_config_post_route = { "/api/widgets/{id}/config", HTTP_POST, widget_config_post_handler, false };
+
+// Run the route's handler (on the httpd task or a worker)
+static esp_err_t route_run(httpd_req_t *req)
+{
+    const web_route_t *route = (const web_route_t *)req->user_ctx;
+    
+    web_metrics_req_t metrics;
+    web_metrics_request_begin(&metrics, route->metrics_id);
+    esp_err_t ret = route->handler(req);
+    web_metrics_request_end(&metrics, ret);
+    
+    return ret;
+}
+
+// Entry point for every registered URI
+static esp_err_t route_dispatch(httpd_req_t *req)
+{
+    const web_route_t *route = (const web_route_t *)req->user_ctx;
+    if (route->slow) {
+        esp_err_t ret = http_worker_submit(req, route_run);
+        if (ret == ESP_ERR_TIMEOUT) {
+            // Pool was busy and a 503 has already been sent
+            web_metrics_record_rejected(route->metrics_id);
+            return ESP_OK;
+        }
+        return ret;
+    }
+    return route_run(req);
+}
+
+static void register_route(httpd_handle_t server, const char *uri, web_route_t *route)
+{
+    route->metrics_id = web_metrics_register_route(route->uri, route->method,
+                                                   route->slow ? WEB_P99_BUDGET_SLOW_MS : WEB_P99_BUDGET_FAST_MS);
+    
+    httpd_uri_t uri_handler = {
+        .uri       = uri,
+        .method    = route->method,
+        .handler   = route_dispatch,
+        .user_ctx  = (void *)route
+    };
+    if (httpd_register_uri_handler(server, &uri_handler) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to register %s", uri);
+    }
+}
+
 void web_server_init(const char *ssid)
 {
     ap_ssid = ssid;
@@ -1066,247 +1693,29 @@ httpd_handle_t web_server_start(void)
 {
     httpd_config_t config = HTTPD_DEFAULT_CONFIG();
     config.server_port = WEB_SERVER_PORT;
-    config.max_uri_handlers = 40;  // Increased for all routes (sections, static files, API endpoints, widget configs, weather)
+    config.max_uri_handlers = 48;  // Increased for all routes (sections, static files, API endpoints, widget configs, weather)
+    config.lru_purge_enable = true;  // Detached slow requests hold sockets; recycle idle ones
+    
+    // Slow handlers run on the worker pool; fall back to inline if it can't start
+    if (http_worker_start() != ESP_OK) {
+        ESP_LOGW(TAG, "HTTP workers unavailable, slow handlers will run inline");
+    }
     
     httpd_handle_t server = NULL;
     
     if (httpd_start(&server, &config) == ESP_OK) {
-        // Root page (shell HTML)
-        httpd_uri_t root_uri = {
-            .uri       = "/",
-            .method    = HTTP_GET,
-            .handler   = root_get_handler,
-            .user_ctx  = NULL
-        };
-        httpd_register_uri_handler(server, &root_uri);
-        
-        // Section HTML files - specific routes
-        httpd_uri_t setup_section_uri = {
-            .uri       = "/sections/setup.html",
-            .method    = HTTP_GET,
-            .handler   = section_handler,
-            .user_ctx  = NULL
-        };
-        httpd_register_uri_handler(server, &setup_section_uri);
-        
-        httpd_uri_t widgets_section_uri = {
-            .uri       = "/sections/widgets.html",
-            .method    = HTTP_GET,
-            .handler   = section_handler,
-            .user_ctx  = NULL
-        };
-        httpd_register_uri_handler(server, &widgets_section_uri);
-        
-        httpd_uri_t settings_section_uri = {
-            .uri       = "/sections/settings.html",
-            .method    = HTTP_GET,
-            .handler   = section_handler,
-            .user_ctx  = NULL
-        };
-        httpd_register_uri_handler(server, &settings_section_uri);
-        
-        // CSS files - specific routes (ESP-IDF doesn't support wildcards)
-        httpd_uri_t css_uri = {
-            .uri       = "/css/styles.css",
-            .method    = HTTP_GET,
-            .handler   = css_handler,
-            .user_ctx  = NULL
-        };
-        httpd_register_uri_handler(server, &css_uri);
-        
-        // JS files - specific routes
-        httpd_uri_t app_js_uri = {
-            .uri       = "/js/app.js",
-            .method    = HTTP_GET,
-            .handler   = js_handler,
-            .user_ctx  = NULL
-        };
-        httpd_register_uri_handler(server, &app_js_uri);
-        
-        httpd_uri_t api_js_uri = {
-            .uri       = "/js/api.js",
-            .method    = HTTP_GET,
-            .handler   = js_handler,
-            .user_ctx  = NULL
-        };
-        httpd_register_uri_handler(server, &api_js_uri);
-        
-        // Config API - POST
-        httpd_uri_t config_post_uri = {
-            .uri       = "/api/config",
-            .method    = HTTP_POST,
-            .handler   = config_post_handler,
-            .user_ctx  = NULL
-        };
-        httpd_register_uri_handler(server, &config_post_uri);
-        
-        // Config API - GET
-        httpd_uri_t config_get_uri = {
-            .uri       = "/api/config",
-            .method    = HTTP_GET,
-            .handler   = config_get_handler,
-            .user_ctx  = NULL
-        };
-        httpd_register_uri_handler(server, &config_get_uri);
-        
-        // Scan API - GET
-        httpd_uri_t scan_uri = {
-            .uri       = "/api/scan",
-            .method    = HTTP_GET,
-            .handler   = scan_get_handler,
-            .user_ctx  = NULL
-        };
-        httpd_register_uri_handler(server, &scan_uri);
-        
-        // Status API - GET
-        httpd_uri_t status_uri = {
-            .uri       = "/api/status",
-            .method    = HTTP_GET,
-            .handler   = status_get_handler,
-            .user_ctx  = NULL
-        };
-        httpd_register_uri_handler(server, &status_uri);
-        
-        // Reset API - POST
-        httpd_uri_t reset_uri = {
-            .uri       = "/api/reset",
-            .method    = HTTP_POST,
-            .handler   = reset_post_handler,
-            .user_ctx  = NULL
-        };
-        httpd_register_uri_handler(server, &reset_uri);
-        
-        // Timezone API - GET
-        httpd_uri_t timezone_get_uri = {
-            .uri       = "/api/timezone",
-            .method    = HTTP_GET,
-            .handler   = timezone_get_handler,
-            .user_ctx  = NULL
-        };
-        httpd_register_uri_handler(server, &timezone_get_uri);
-        
-        // Timezone API - POST
-        httpd_uri_t timezone_post_uri = {
-            .uri       = "/api/timezone",
-            .method    = HTTP_POST,
-            .handler   = timezone_post_handler,
-            .user_ctx  = NULL
-        };
-        httpd_register_uri_handler(server, &timezone_post_uri);
-        
-        // Font size API - GET
-        httpd_uri_t font_size_get_uri = {
-            .uri       = "/api/font-size",
-            .method    = HTTP_GET,
-            .handler   = font_size_get_handler,
-            .user_ctx  = NULL
-        };
-        httpd_register_uri_handler(server, &font_size_get_uri);
-        
-        // Font size API - POST
-        httpd_uri_t font_size_post_uri = {
-            .uri       = "/api/font-size",
-            .method    = HTTP_POST,
-            .handler   = font_size_post_handler,
-            .user_ctx  = NULL
-        };
-        httpd_register_uri_handler(server, &font_size_post_uri);
-        
-        // Weather zip code API - GET
-        httpd_uri_t weather_zip_get_uri = {
-            .uri       = "/api/weather/zip-code",
-            .method    = HTTP_GET,
-            .handler   = weather_zip_get_handler,
-            .user_ctx  = NULL
-        };
-        httpd_register_uri_handler(server, &weather_zip_get_uri);
-        
-        // Weather zip code API - POST
-        httpd_uri_t weather_zip_post_uri = {
-            .uri       = "/api/weather/zip-code",
-            .method    = HTTP_POST,
-            .handler   = weather_zip_post_handler,
-            .user_ctx  = NULL
-        };
-        httpd_register_uri_handler(server, &weather_zip_post_uri);
-        
-        // Weather data API - GET
-        httpd_uri_t weather_data_get_uri = {
-            .uri       = "/api/weather/data",
-            .method    = HTTP_GET,
-            .handler   = weather_data_get_handler,
-            .user_ctx  = NULL
-        };
-        httpd_register_uri_handler(server, &weather_data_get_uri);
-
-        // Weather temperature unit API
-        httpd_uri_t weather_temp_unit_get_uri = {
-            .uri       = "/api/weather/temp-unit",
-            .method    = HTTP_GET,
-            .handler   = weather_temp_unit_get_handler,
-            .user_ctx  = NULL
-        };
-        httpd_register_uri_handler(server, &weather_temp_unit_get_uri);
-
-        httpd_uri_t weather_temp_unit_post_uri = {
-            .uri       = "/api/weather/temp-unit",
-            .method    = HTTP_POST,
-            .handler   = weather_temp_unit_post_handler,
-            .user_ctx  = NULL
-        };
-        httpd_register_uri_handler(server, &weather_temp_unit_post_uri);
-        
-        // Widget API - GET list
-        httpd_uri_t widgets_get_uri = {
-            .uri       = "/api/widgets",
-            .method    = HTTP_GET,
-            .handler   = widgets_get_handler,
-            .user_ctx  = NULL
-        };
-        httpd_register_uri_handler(server, &widgets_get_uri);
-        
-        // Widget API - GET active
-        httpd_uri_t widgets_active_get_uri = {
-            .uri       = "/api/widgets/active",
-            .method    = HTTP_GET,
-            .handler   = widgets_active_get_handler,
-            .user_ctx  = NULL
-        };
-        httpd_register_uri_handler(server, &widgets_active_get_uri);
-        
-        // Widget API - POST active
-        httpd_uri_t widgets_active_post_uri = {
-            .uri       = "/api/widgets/active",
-            .method    = HTTP_POST,
-            .handler   = widgets_active_post_handler,
-            .user_ctx  = NULL
-        };
-        httpd_register_uri_handler(server, &widgets_active_post_uri);
+        for (int i = 0; i < sizeof(web_routes) / sizeof(web_routes[0]); i++) {
+            register_route(server, web_routes[i].uri, &web_routes[i]);
+        }
         
         // Widget config routes - register for known widgets
         // ESP-IDF doesn't support wildcards, so we register specific routes
         const char *known_widgets[] = {"clock", "timer", "weather", "calendar"};
         for (int i = 0; i < sizeof(known_widgets) / sizeof(known_widgets[0]); i++) {
             char uri_buf[64];
-            
-            // GET handler
             snprintf(uri_buf, sizeof(uri_buf), "/api/widgets/%s/config", known_widgets[i]);
-            httpd_uri_t widget_config_get_uri = {
-                .uri       = uri_buf,
-                .method    = HTTP_GET,
-                .handler   = widget_config_get_handler,
-                .user_ctx  = NULL
-            };
-            httpd_register_uri_handler(server, &widget_config_get_uri);
-            
-            // POST handler
-            httpd_uri_t widget_config_post_uri = {
-                .uri       = uri_buf,
-                .method    = HTTP_POST,
-                .handler   = widget_config_post_handler,
-                .user_ctx  = NULL
-            };
-            httpd_register_uri_handler(server, &widget_config_post_uri);
+            register_route(server, uri_buf, &widget_config_get_route);
+            register_route(server, uri_buf, &widget_config_post_route);
         }
         
         ESP_LOGI(TAG, "HTTP server started on port %d", WEB_SERVER_PORT);
@@ -1,24 +1,364 @@
 #include "widget_manager.h"
 #include "ui_state.h"
+#include "layout_manager.h"
 #include "sd_database.h"
+#include "storage_writer.h"
 #include "esp_log.h"
+#include "font_size.h"
+#include "bsp/esp-bsp.h"
+#include "lvgl.h"
+#include "ui/widgets/widget_common.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "freertos/FreeRTOS.h"
 #include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
 
 static const char *TAG = "widget_manager";
 
 #define MAX_WIDGETS 16
+#define CONFIG_SAVE_DEBOUNCE_MS  1000   // Quiet time before a changed config is written
+#define RETAIN_BUDGET_DEFAULT    (64 * 1024)  // Bytes of hidden widget trees kept alive (0 = retain off)
+#define TRANSITION_TIME_MS       200    // Screen fade between widgets
+#define PREBUILD_CHECK_MS        1000   // How often to look for idle time to prebuild
+#define PREBUILD_MIN_IDLE_PCT    60     // LVGL idle percentage required to prebuild
 
 static const widget_t *registered_widgets[MAX_WIDGETS];
 static int widget_count = 0;
 static const widget_t *active_widget = NULL;
 
+// Retain mode: widgets with suspend/resume hooks keep their object tree
+// when switched away from, until evicted (LRU) to stay under the budget
+static uint32_t retain_budget = RETAIN_BUDGET_DEFAULT;
+static bool retained[MAX_WIDGETS];          // Built but suspended
+static size_t retained_cost[MAX_WIDGETS];   // Heap used by the tree, measured at show()
+static uint32_t last_used_tick[MAX_WIDGETS];
+
+// Each widget draws on its own screen, created on first use
+static lv_obj_t *widget_screens[MAX_WIDGETS];
+static bool leaving[MAX_WIDGETS];           // Still on the screen fading out
+
+// Dashboard layouts: several widgets in regions of one shared screen.
+// Regions clip their children, so a widget's redraws stay inside it.
+static lv_obj_t *dashboard_screen = NULL;
+static lv_obj_t *region_parents[MAX_WIDGETS];   // Region a widget is shown in
+static bool dashboard_active = false;
+
+// Switch history used to predict (and prebuild) the next widget
+static uint16_t transitions[MAX_WIDGETS][MAX_WIDGETS];
+static int previous_index = -1;
+static lv_timer_t *prebuild_timer = NULL;
+
+// Switch latency, split by whether the widget was resumed or built
+typedef struct {
+    uint32_t count;
+    int64_t total_us;
+    int64_t max_us;
+    int64_t last_us;
+} switch_stats_t;
+
+static switch_stats_t switch_stats_resumed;
+static switch_stats_t switch_stats_built;
+static portMUX_TYPE switch_stats_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static int widget_index(const widget_t *widget)
+{
+    for (int i = 0; i < widget_count; i++) {
+        if (registered_widgets[i] == widget) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// Shown full screen or in a dashboard region
+static bool is_shown(int index)
+{
+    return registered_widgets[index] == active_widget || region_parents[index] != NULL;
+}
+
+static bool can_retain(const widget_t *widget)
+{
+    return retain_budget > 0 && widget->suspend && widget->resume;
+}
+
+static void widget_screen_unloaded_cb(lv_event_t *e);
+
+// Get a widget's screen, creating it on first use
+static lv_obj_t* widget_screen(int index)
+{
+    if (!widget_screens[index]) {
+        lv_obj_t *scr = lv_obj_create(NULL);
+        lv_obj_set_style_bg_color(scr, WIDGET_COLOR_BG, 0);
+        lv_obj_set_style_bg_opa(scr, LV_OPA_COVER, 0);
+        lv_obj_clear_flag(scr, LV_OBJ_FLAG_SCROLLABLE);
+        lv_obj_add_event_cb(scr, widget_screen_unloaded_cb, LV_EVENT_SCREEN_UNLOADED, (void *)(intptr_t)index);
+        widget_screens[index] = scr;
+    }
+    return widget_screens[index];
+}
+
+// Where a widget builds its objects: its dashboard region or its own screen
+static lv_obj_t* widget_parent(int index)
+{
+    return region_parents[index] ? region_parents[index] : widget_screen(index);
+}
+
+// Load a screen with the widget transition (no-op if already shown)
+static void load_screen(lv_obj_t *scr)
+{
+    if (lv_screen_active() != scr) {
+        lv_screen_load_anim(scr, LV_SCR_LOAD_ANIM_FADE_IN, TRANSITION_TIME_MS, 0, false);
+    }
+}
+
+// Build a widget in its parent, recording how much heap its object tree took
+static void show_measured(int index)
+{
+    const widget_t *widget = registered_widgets[index];
+    lv_obj_t *parent = widget_parent(index);
+    size_t cache_before = widget->cache_size ? widget->cache_size() : 0;
+    size_t free_before = heap_caps_get_free_size(MALLOC_CAP_DEFAULT);
+    
+    if (widget->show) {
+        widget->show(parent);
+    }
+    
+    size_t free_after = heap_caps_get_free_size(MALLOC_CAP_DEFAULT);
+    size_t cache_after = widget->cache_size ? widget->cache_size() : 0;
+    size_t used = (free_before > free_after) ? (free_before - free_after) : 0;
+    
+    // A cache filled by this show stays allocated after hide(), so it isn't part of the tree
+    size_t cache_growth = (cache_after > cache_before) ? (cache_after - cache_before) : 0;
+    retained_cost[index] = (used > cache_growth) ? (used - cache_growth) : 0;
+}
+
+// Destroy a suspended widget's tree
+static void drop_retained(int index)
+{
+    if (!retained[index]) {
+        return;
+    }
+    
+    retained[index] = false;
+    if (registered_widgets[index]->hide) {
+        registered_widgets[index]->hide();
+    }
+    ESP_LOGI(TAG, "Dropped retained widget '%s' (%u bytes)",
+             registered_widgets[index]->id, (unsigned)retained_cost[index]);
+}
+
+// Evict least recently used retained widgets until under budget
+static void evict_retained(void)
+{
+    while (true) {
+        size_t total = 0;
+        int oldest = -1;
+        for (int i = 0; i < widget_count; i++) {
+            if (!retained[i]) {
+                continue;
+            }
+            total += retained_cost[i];
+            if (oldest < 0 || (int32_t)(last_used_tick[i] - last_used_tick[oldest]) < 0) {
+                oldest = i;
+            }
+        }
+        
+        if (oldest < 0 || total <= retain_budget) {
+            return;
+        }
+        drop_retained(oldest);
+    }
+}
+
+// Keep a retained tree in sync with a config change, or drop it
+static void patch_or_drop_retained(int index, const cJSON *changed)
+{
+    const widget_t *widget = registered_widgets[index];
+    if (!retained[index] && !leaving[index]) {
+        return;
+    }
+    if (widget->apply_delta && changed && widget->apply_delta(changed)) {
+        return;
+    }
+    
+    if (leaving[index]) {
+        // Still fading out: destroy it now instead of keeping a stale tree
+        leaving[index] = false;
+        if (widget->hide) {
+            widget->hide();
+        }
+        return;
+    }
+    drop_retained(index);
+}
+
+// A widget's screen finished fading out: suspend or destroy its tree
+static void widget_screen_unloaded_cb(lv_event_t *e)
+{
+    int index = (int)(intptr_t)lv_event_get_user_data(e);
+    if (!leaving[index]) {
+        return;
+    }
+    leaving[index] = false;
+    
+    // Switched back before the fade finished
+    const widget_t *widget = registered_widgets[index];
+    if (widget == active_widget) {
+        return;
+    }
+    
+    if (can_retain(widget)) {
+        widget->suspend();
+        retained[index] = true;
+        evict_retained();
+    } else if (widget->hide) {
+        widget->hide();
+    }
+}
+
+// Most likely next widget after the active one, from switch history
+static int predict_next(void)
+{
+    int active_index = widget_index(active_widget);
+    if (active_index < 0) {
+        return -1;
+    }
+    
+    int best = -1;
+    for (int i = 0; i < widget_count; i++) {
+        if (i != active_index && transitions[active_index][i] > 0 &&
+            (best < 0 || transitions[active_index][i] > transitions[active_index][best])) {
+            best = i;
+        }
+    }
+    
+    // No history yet - going back is the best guess
+    return (best >= 0) ? best : previous_index;
+}
+
+// Build the predicted next widget while LVGL is idle, so the switch only resumes it
+static void prebuild_timer_cb(lv_timer_t *timer)
+{
+    (void)timer;
+    
+    if (lv_timer_get_idle() < PREBUILD_MIN_IDLE_PCT) {
+        return;
+    }
+    
+    int next = predict_next();
+    if (next < 0 || registered_widgets[next] == active_widget ||
+        retained[next] || leaving[next] || !can_retain(registered_widgets[next])) {
+        return;
+    }
+    
+    // Only if it fits in the budget next to what's already retained
+    size_t total = retained_cost[next];
+    for (int i = 0; i < widget_count; i++) {
+        if (retained[i]) {
+            total += retained_cost[i];
+        }
+    }
+    if (total > retain_budget) {
+        return;
+    }
+    
+    show_measured(next);
+    registered_widgets[next]->suspend();
+    retained[next] = true;
+    last_used_tick[next] = lv_tick_get();
+    ESP_LOGI(TAG, "Prebuilt widget '%s' (%u bytes)", registered_widgets[next]->id, (unsigned)retained_cost[next]);
+}
+
+// Destroy the dashboard widgets and their regions
+static void clear_dashboard(void)
+{
+    for (int i = 0; i < widget_count; i++) {
+        if (region_parents[i]) {
+            if (registered_widgets[i]->hide) {
+                registered_widgets[i]->hide();
+            }
+            region_parents[i] = NULL;
+        }
+    }
+    
+    if (dashboard_screen) {
+        lv_obj_clean(dashboard_screen);
+    }
+    dashboard_active = false;
+}
+
+static void record_switch(switch_stats_t *stats, int64_t us)
+{
+    portENTER_CRITICAL(&switch_stats_lock);
+    stats->count++;
+    stats->total_us += us;
+    stats->last_us = us;
+    if (us > stats->max_us) {
+        stats->max_us = us;
+    }
+    portEXIT_CRITICAL(&switch_stats_lock);
+}
+
+static cJSON* switch_stats_to_json(const switch_stats_t *stats)
+{
+    switch_stats_t copy;
+    portENTER_CRITICAL(&switch_stats_lock);
+    copy = *stats;
+    portEXIT_CRITICAL(&switch_stats_lock);
+    
+    cJSON *json = cJSON_CreateObject();
+    cJSON_AddNumberToObject(json, "count", copy.count);
+    cJSON_AddNumberToObject(json, "avg_ms", copy.count ? copy.total_us / 1000.0 / copy.count : 0.0);
+    cJSON_AddNumberToObject(json, "max_ms", copy.max_us / 1000.0);
+    cJSON_AddNumberToObject(json, "last_ms", copy.last_us / 1000.0);
+    return json;
+}
+
+// Queue a widget's current config for the storage task; a burst of
+// changes is written once, after CONFIG_SAVE_DEBOUNCE_MS of quiet
+static void widget_manager_save_config(const widget_t *widget)
+{
+    if (!sd_db_is_ready() || !widget->get_config) {
+        return;
+    }
+    
+    cJSON *config = widget->get_config();
+    if (!config) {
+        return;
+    }
+    
+    char *json_str = cJSON_PrintUnformatted(config);
+    cJSON_Delete(config);
+    if (!json_str) {
+        return;
+    }
+    
+    char key[64];
+    snprintf(key, sizeof(key), "widget_%s_config", widget->id);
+    
+    storage_writer_set_string(key, json_str, CONFIG_SAVE_DEBOUNCE_MS);
+    free(json_str);
+}
+
 void widget_manager_init(void)
 {
     widget_count = 0;
     active_widget = NULL;
     memset(registered_widgets, 0, sizeof(registered_widgets));
+    memset(retained, 0, sizeof(retained));
+    memset(leaving, 0, sizeof(leaving));
+    memset(widget_screens, 0, sizeof(widget_screens));
+    memset(region_parents, 0, sizeof(region_parents));
+    memset(transitions, 0, sizeof(transitions));
     
-    ESP_LOGI(TAG, "Widget manager initialized");
+    int budget = 0;
+    if (sd_db_is_ready() && sd_db_get_int("widget_retain_budget", &budget) == ESP_OK && budget >= 0) {
+        retain_budget = (uint32_t)budget;
+    }
+    
+    ESP_LOGI(TAG, "Widget manager initialized (retain budget %lu bytes)", (unsigned long)retain_budget);
 }
 
 void widget_manager_register(const widget_t *widget)
@@ -57,36 +397,87 @@ esp_err_t widget_manager_switch(const char *widget_id)
     }
     
     // Find widget
-    const widget_t *new_widget = NULL;
+    int new_index = -1;
     for (int i = 0; i < widget_count; i++) {
         if (strcmp(registered_widgets[i]->id, widget_id) == 0) {
-            new_widget = registered_widgets[i];
+            new_index = i;
             break;
         }
     }
     
-    if (!new_widget) {
+    if (new_index < 0) {
         ESP_LOGE(TAG, "Widget '%s' not found", widget_id);
         return ESP_ERR_NOT_FOUND;
     }
     
-    // Hide current widget
-    if (active_widget && active_widget->hide) {
-        active_widget->hide();
+    const widget_t *new_widget = registered_widgets[new_index];
+    int64_t start_us = esp_timer_get_time();
+    
+    // Hold the display lock across hide/show so concurrent HTTP workers
+    // can't interleave widget transitions (the lock is recursive)
+    bsp_display_lock(0);
+    
+    // Selecting a single widget leaves the dashboard
+    if (dashboard_active) {
+        clear_dashboard();
+        layout_manager_set_single(widget_id);
     }
     
-    // Show new widget
-    if (new_widget->show) {
-        new_widget->show();
+    int old_index = widget_index(active_widget);
+    bool resumed;
+    
+    if (old_index == new_index) {
+        // Same widget: rebuild in place
+        if (new_widget->hide) {
+            new_widget->hide();
+        }
+        show_measured(new_index);
+        resumed = false;
+    } else {
+        // Bring up the new widget on its own screen: a tree still fading
+        // out or retained is reused, otherwise it is built now
+        resumed = leaving[new_index] || retained[new_index];
+        if (leaving[new_index]) {
+            leaving[new_index] = false;
+        } else if (retained[new_index]) {
+            retained[new_index] = false;
+            new_widget->resume();
+        } else {
+            show_measured(new_index);
+        }
+        
+        // The old widget is suspended or hidden once its screen has faded out
+        if (old_index >= 0) {
+            leaving[old_index] = true;
+            last_used_tick[old_index] = lv_tick_get();
+            if (transitions[old_index][new_index] < UINT16_MAX) {
+                transitions[old_index][new_index]++;
+            }
+            previous_index = old_index;
+        }
+        
+        load_screen(widget_screen(new_index));
     }
     
     active_widget = new_widget;
+    last_used_tick[new_index] = lv_tick_get();
+    evict_retained();
     
-    // Persist to database (survives reboot)
+    if (!prebuild_timer) {
+        prebuild_timer = lv_timer_create(prebuild_timer_cb, PREBUILD_CHECK_MS, NULL);
+    }
+    
+    bsp_display_unlock();
+    
+    int64_t elapsed_us = esp_timer_get_time() - start_us;
+    record_switch(resumed ? &switch_stats_resumed : &switch_stats_built, elapsed_us);
+    ESP_LOGI(TAG, "Switch to '%s' took %lld us (%s)", widget_id, (long long)elapsed_us,
+             resumed ? "resumed" : "built");
+    
+    // Persist to database (survives reboot); written by the storage task,
+    // since switches run on the LVGL task
     if (sd_db_is_ready()) {
-        sd_db_set_string("active_widget", widget_id);
-        sd_db_save();
-        ESP_LOGI(TAG, "Saved active widget '%s' to database", widget_id);
+        storage_writer_set_string("active_widget", widget_id, 0);
     }
     
     // Notify UI state manager
@@ -142,6 +533,40 @@ cJSON* widget_manager_get_config(const char *widget_id)
     return widget->get_config();
 }
 
+// Build an object with the fields of 'after' that differ from 'before'
+static cJSON* config_diff(const cJSON *before, const cJSON *after)
+{
+    cJSON *changed = cJSON_CreateObject();
+    if (!changed || !after) {
+        return changed;
+    }
+    
+    const cJSON *item = NULL;
+    cJSON_ArrayForEach(item, after) {
+        const cJSON *old_item = before ? cJSON_GetObjectItem(before, item->string) : NULL;
+        if (!old_item || !cJSON_Compare(old_item, item, true)) {
+            cJSON_AddItemToObject(changed, item->string, cJSON_Duplicate(item, true));
+        }
+    }
+    
+    return changed;
+}
+
+// Rebuild the active widget, or let it patch itself if it can
+static void apply_to_active(const widget_t *widget, const cJSON *changed)
+{
+    if (widget->apply_delta && changed && widget->apply_delta(changed)) {
+        return;
+    }
+    
+    if (widget->hide) {
+        widget->hide();
+    }
+    if (widget->show) {
+        widget->show(widget_parent(widget_index(widget)));
+    }
+}
+
 esp_err_t widget_manager_set_config(const char *widget_id, cJSON *cfg)
 {
     if (!widget_id || !cfg) {
@@ -149,66 +574,253 @@ esp_err_t widget_manager_set_config(const char *widget_id, cJSON *cfg)
     }
     
     // Find widget
-    const widget_t *widget = NULL;
+    int index = -1;
     for (int i = 0; i < widget_count; i++) {
         if (strcmp(registered_widgets[i]->id, widget_id) == 0) {
-            widget = registered_widgets[i];
+            index = i;
             break;
         }
     }
     
+    const widget_t *widget = (index >= 0) ? registered_widgets[index] : NULL;
     if (!widget || !widget->set_config) {
         return ESP_ERR_NOT_FOUND;
     }
     
-    // Check if this widget is currently active
-    bool is_active = (active_widget == widget);
+    bsp_display_lock(0);
     
-    // Apply config (widget's set_config should handle refresh internally if widget is shown)
-    // The clock widget and other widgets should refresh themselves in set_config
+    // Widgets only update their state in set_config; work out what
+    // actually changed so the shown widget can be patched instead of rebuilt
+    cJSON *before = widget->get_config ? widget->get_config() : NULL;
     widget->set_config(cfg);
+    cJSON *after = widget->get_config ? widget->get_config() : NULL;
+    cJSON *changed = (before && after) ? config_diff(before, after) : NULL;
     
-    // Save config to database
-    if (sd_db_is_ready()) {
-        char *json_str = cJSON_PrintUnformatted(cfg);
-        if (json_str) {
-            char key[64];
-            snprintf(key, sizeof(key), "widget_%s_config", widget_id);
-            sd_db_set_string(key, json_str);
-            sd_db_save();
-            free(json_str);
-        }
+    bool has_changes = !changed || cJSON_GetArraySize(changed) > 0;
+    bool is_active = is_shown(index);
+    if (is_active && has_changes) {
+        apply_to_active(widget, changed);
+    } else if (has_changes) {
+        patch_or_drop_retained(index, changed);
+    }
+    
+    bsp_display_unlock();
+    
+    cJSON_Delete(before);
+    cJSON_Delete(after);
+    cJSON_Delete(changed);
+    
+    if (has_changes) {
+        widget_manager_save_config(widget);
     }
     
-    // Notify UI state manager of config change
     ui_state_notify_config_changed(widget_id);
     
-    ESP_LOGI(TAG, "Config updated for widget: %s (active: %s)", widget_id, is_active ? "yes" : "no");
+    ESP_LOGI(TAG, "Config updated for widget: %s (active: %s, changed: %s)",
+             widget_id, is_active ? "yes" : "no", has_changes ? "yes" : "no");
+    return ESP_OK;
+}
+
+void widget_manager_apply_font_change(void)
+{
+    if (!active_widget && !dashboard_active) {
+        return;
+    }
+    
+    cJSON *changed = cJSON_CreateObject();
+    if (changed) {
+        cJSON_AddNumberToObject(changed, "font_size", font_size_get_preset());
+    }
+    
+    bsp_display_lock(0);
+    for (int i = 0; i < widget_count; i++) {
+        if (is_shown(i)) {
+            apply_to_active(registered_widgets[i], changed);
+        } else {
+            patch_or_drop_retained(i, changed);
+        }
+    }
+    bsp_display_unlock();
+    
+    cJSON_Delete(changed);
+}
+
+esp_err_t widget_manager_set_retain_budget(uint32_t budget_bytes)
+{
+    // Takes effect (including eviction) on the next switch
+    retain_budget = budget_bytes;
+    
+    if (sd_db_is_ready()) {
+        sd_db_set_int("widget_retain_budget", (int)budget_bytes);
+        sd_db_save();
+    }
+    
+    ESP_LOGI(TAG, "Retain budget set to %lu bytes", (unsigned long)budget_bytes);
     return ESP_OK;
 }
 
+uint32_t widget_manager_get_retain_budget(void)
+{
+    return retain_budget;
+}
+
+cJSON* widget_manager_get_switch_stats(void)
+{
+    cJSON *json = cJSON_CreateObject();
+    cJSON_AddItemToObject(json, "resumed", switch_stats_to_json(&switch_stats_resumed));
+    cJSON_AddItemToObject(json, "built", switch_stats_to_json(&switch_stats_built));
+    cJSON_AddNumberToObject(json, "retain_budget", retain_budget);
+    
+    // Snapshot of retained trees (written by the LVGL task, read racily here)
+    cJSON *list = cJSON_AddArrayToObject(json, "retained");
+    for (int i = 0; i < widget_count; i++) {
+        if (retained[i]) {
+            cJSON *entry = cJSON_CreateObject();
+            cJSON_AddStringToObject(entry, "id", registered_widgets[i]->id);
+            cJSON_AddNumberToObject(entry, "bytes", retained_cost[i]);
+            cJSON_AddItemToArray(list, entry);
+        }
+    }
+    
+    return json;
+}
+
 esp_err_t widget_manager_refresh(void)
 {
-    if (!active_widget) {
+    if (!active_widget && !dashboard_active) {
         ESP_LOGW(TAG, "No active widget to refresh");
         return ESP_ERR_INVALID_STATE;
     }
     
-    ESP_LOGI(TAG, "Refreshing active widget: %s", active_widget->id);
+    // Hide and show every shown widget to force refresh
+    bsp_display_lock(0);
     
-    // Hide and show to force refresh
-    if (active_widget->hide) {
-        active_widget->hide();
+    for (int i = 0; i < widget_count; i++) {
+        if (!is_shown(i)) {
+            continue;
+        }
+        
+        const widget_t *widget = registered_widgets[i];
+        if (widget->hide) {
+            widget->hide();
+        }
+        if (widget->show) {
+            widget->show(widget_parent(i));
+        }
+        ESP_LOGI(TAG, "Widget refreshed: %s", widget->id);
     }
     
-    if (active_widget->show) {
-        active_widget->show();
+    bsp_display_unlock();
+    
+    return ESP_OK;
+}
+
+esp_err_t widget_manager_show_layout(const layout_t *layout)
+{
+    if (!layout) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    if (layout->type == LAYOUT_SINGLE) {
+        const char *active = widget_manager_get_active();
+        if (!dashboard_active && active && strcmp(active, layout->widgets[0]) == 0) {
+            return ESP_OK;
+        }
+        return widget_manager_switch(layout->widgets[0]);
     }
     
-    ESP_LOGI(TAG, "Widget refreshed: %s", active_widget->id);
+    int count = layout_manager_region_count(layout->type);
+    int indices[LAYOUT_MAX_REGIONS];
+    for (int i = 0; i < count; i++) {
+        indices[i] = -1;
+        for (int j = 0; j < widget_count; j++) {
+            if (strcmp(registered_widgets[j]->id, layout->widgets[i]) == 0) {
+                indices[i] = j;
+                break;
+            }
+        }
+        if (indices[i] < 0) {
+            ESP_LOGE(TAG, "Layout widget '%s' not found", layout->widgets[i]);
+            return ESP_ERR_NOT_FOUND;
+        }
+    }
+    
+    bsp_display_lock(0);
+    
+    clear_dashboard();
+    if (!dashboard_screen) {
+        dashboard_screen = lv_obj_create(NULL);
+        lv_obj_set_style_bg_color(dashboard_screen, WIDGET_COLOR_BG, 0);
+        lv_obj_set_style_bg_opa(dashboard_screen, LV_OPA_COVER, 0);
+        lv_obj_clear_flag(dashboard_screen, LV_OBJ_FLAG_SCROLLABLE);
+    }
+    
+    // The full screen widget is suspended or hidden once it has faded out
+    int old_index = widget_index(active_widget);
+    if (old_index >= 0) {
+        leaving[old_index] = true;
+        last_used_tick[old_index] = lv_tick_get();
+    }
+    active_widget = NULL;
+    
+    int32_t width = lv_display_get_horizontal_resolution(NULL);
+    int32_t height = lv_display_get_vertical_resolution(NULL);
+    
+    for (int i = 0; i < count; i++) {
+        int index = indices[i];
+        
+        // Widgets keep their objects in static state, so a widget can only
+        // be built in one place: drop any tree it still has elsewhere
+        if (retained[index]) {
+            drop_retained(index);
+        } else if (leaving[index]) {
+            leaving[index] = false;
+            if (registered_widgets[index]->hide) {
+                registered_widgets[index]->hide();
+            }
+        }
+        
+        layout_region_t area;
+        layout_manager_region_area(layout->type, i, width, height, &area);
+        
+        lv_obj_t *region = lv_obj_create(dashboard_screen);
+        lv_obj_remove_style_all(region);
+        lv_obj_set_pos(region, area.x, area.y);
+        lv_obj_set_size(region, area.w, area.h);
+        lv_obj_clear_flag(region, LV_OBJ_FLAG_SCROLLABLE);
+        
+        // Resolve the region size now so widgets can fit themselves to it
+        lv_obj_update_layout(region);
+        
+        region_parents[index] = region;
+        show_measured(index);
+    }
+    
+    dashboard_active = true;
+    evict_retained();
+    load_screen(dashboard_screen);
+    
+    bsp_display_unlock();
+    
+    ESP_LOGI(TAG, "Dashboard shown with %d widgets", count);
     return ESP_OK;
 }
 
+bool widget_manager_is_shown(const char *widget_id)
+{
+    if (!widget_id) {
+        return false;
+    }
+    
+    for (int i = 0; i < widget_count; i++) {
+        if (strcmp(registered_widgets[i]->id, widget_id) == 0) {
+            return is_shown(i);
+        }
+    }
+    
+    return false;
+}
+
 bool widget_manager_widget_exists(const char *widget_id)
 {
     if (!widget_id) {
@@ -2,7 +2,10 @@
 
 #include "esp_err.h"
 #include "cJSON.h"
+#include "lvgl.h"
+#include "layout_manager.h"
 #include <stdbool.h>
+#include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -21,13 +24,29 @@ struct widget {
     
     // Lifecycle functions
     void (*init)(void);          // One-time initialization
-    void (*show)(void);          // Create LVGL objects, start timers
+    void (*show)(lv_obj_t *parent);  // Create LVGL objects in the widget's screen, start timers
     void (*hide)(void);          // Cleanup LVGL objects, stop timers
     void (*update)(void);        // Periodic refresh (called by timer)
     
     // Configuration functions
     cJSON* (*get_config)(void);  // Get current config as JSON
-    void (*set_config)(cJSON *cfg);  // Apply config from JSON
+    void (*set_config)(cJSON *cfg);  // Update config state from JSON (manager persists and rebuilds)
+    
+    // Optional: adjust the shown widget for the config fields in 'changed'
+    // (only fields whose value changed, plus "font_size" on preset changes).
+    // Return false to fall back to a full hide/show rebuild.
+    bool (*apply_delta)(const cJSON *changed);
+    
+    // Optional retain mode: keep the object tree when switched away.
+    // suspend hides the tree and pauses timers, resume undoes that and
+    // refreshes. hide() must also work on a suspended widget.
+    void (*suspend)(void);
+    void (*resume)(void);
+    
+    // Optional: bytes held by caches that survive hide() and are reused by
+    // the next show(). Not charged to the retain budget, since dropping
+    // the tree doesn't free them.
+    size_t (*cache_size)(void);
 };
 
 /**
@@ -44,6 +63,9 @@ void widget_manager_register(const widget_t *widget);
 
 /**
  * @brief Switch to a different widget
+ * Loads the widget's screen with a fade; the previous widget is suspended
+ * or hidden once its screen is unloaded. The likely next widget is
+ * prebuilt in LVGL idle time when it fits in the retain budget.
  * @param widget_id Widget ID to switch to
  * @return ESP_OK on success, ESP_ERR_NOT_FOUND if widget doesn't exist
  */
@@ -70,12 +92,43 @@ cJSON* widget_manager_get_config(const char *widget_id);
 
 /**
  * @brief Set configuration for a specific widget
+ * A changed config is saved by the storage task once it has been stable
+ * for a second, so a burst of changes results in a single write.
  * @param widget_id Widget ID
  * @param cfg JSON object with config
  * @return ESP_OK on success
  */
 esp_err_t widget_manager_set_config(const char *widget_id, cJSON *cfg);
 
+/**
+ * @brief Apply a font size preset change to the active widget
+ * Uses the widget's apply_delta hook if it has one, otherwise rebuilds.
+ * Must be called from the LVGL task.
+ */
+void widget_manager_apply_font_change(void);
+
+/**
+ * @brief Set the memory budget for retained (hidden) widget trees
+ * Least recently used trees are destroyed once over budget; 0 disables
+ * retain mode. Persisted; takes effect on the next switch.
+ * @param budget_bytes Budget in bytes
+ * @return ESP_OK on success
+ */
+esp_err_t widget_manager_set_retain_budget(uint32_t budget_bytes);
+
+/**
+ * @brief Get the memory budget for retained widget trees
+ * @return Budget in bytes
+ */
+uint32_t widget_manager_get_retain_budget(void);
+
+/**
+ * @brief Get widget switch latency statistics
+ * @return JSON object (resumed/built latency, retained trees),
+ *         caller must free with cJSON_Delete
+ */
+cJSON* widget_manager_get_switch_stats(void);
+
 /**
  * @brief Check if a widget is registered
  * @param widget_id Widget ID to check
@@ -84,12 +137,29 @@ esp_err_t widget_manager_set_config(const char *widget_id, cJSON *cfg);
 bool widget_manager_widget_exists(const char *widget_id);
 
 /**
- * @brief Refresh the currently active widget
+ * @brief Check if a widget is on screen (full screen or in a dashboard region)
+ * @param widget_id Widget ID to check
+ * @return true if the widget is shown
+ */
+bool widget_manager_is_shown(const char *widget_id);
+
+/**
+ * @brief Refresh the shown widgets
  * Forces a hide/show cycle to update the display
- * @return ESP_OK on success, ESP_ERR_INVALID_STATE if no widget is active
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE if no widget is shown
  */
 esp_err_t widget_manager_refresh(void);
 
+/**
+ * @brief Show a layout (LVGL task)
+ * A single layout switches to its widget. Other layouts build each widget
+ * in its own region of a shared dashboard screen, sized to the region;
+ * widget_manager_get_active() returns NULL while the dashboard is shown.
+ * @param layout Layout to show
+ * @return ESP_OK on success, ESP_ERR_NOT_FOUND if a widget doesn't exist
+ */
+esp_err_t widget_manager_show_layout(const layout_t *layout);
+
 #ifdef __cplusplus
 }
 #endif
@@ -9,10 +9,15 @@
 #include "core/wifi_ap.h"
 #include "core/web_server.h"
 #include "core/widget_manager.h"
+#include "core/layout_manager.h"
 #include "core/time_sync.h"
 #include "core/ui_state.h"
+#include "core/redraw_stats.h"
 #include "core/font_size.h"
 #include "core/weather_service.h"
+#include "core/timer_service.h"
+#include "core/weather_binding.h"
+#include "core/storage_writer.h"
 #include "sd_database.h"
 #include "ui/screens/sd_format_ui.h"
 #include "ui/screens/splash_ui.h"
@@ -31,6 +36,28 @@ static sd_db_status_t saved_db_status = SD_DB_NOT_PRESENT;
 // Whether device setup is complete
 static bool setup_complete = false;
 
+// Show the saved dashboard, or else the saved widget (clock by default).
+// Only one of them is built, so boot loads a single screen.
+static void show_saved_widgets(void)
+{
+    if (layout_manager_restore() == ESP_OK) {
+        ESP_LOGI(TAG, "Restored saved dashboard");
+        return;
+    }
+    
+    char saved_widget[32] = {0};
+    if (sd_db_get_string("active_widget", saved_widget, sizeof(saved_widget)) == ESP_OK && saved_widget[0] != '\0') {
+        ESP_LOGI(TAG, "Restoring saved widget: %s", saved_widget);
+        if (widget_manager_switch(saved_widget) == ESP_OK) {
+            return;
+        }
+        ESP_LOGW(TAG, "Failed to restore widget '%s', defaulting to clock", saved_widget);
+    } else {
+        ESP_LOGI(TAG, "No saved widget found, defaulting to clock");
+    }
+    widget_manager_switch("clock");
+}
+
 // Callback when WiFi connection state changes
 static void on_sta_connection_change(bool connected, const char *ip_addr)
 {
@@ -50,13 +77,7 @@ static void on_sta_connection_change(bool connected, const char *ip_addr)
         // Initialize time sync
         time_sync_init();
         
-        // Switch to saved widget (or default to clock)
-        char saved_widget[32] = {0};
-        if (sd_db_get_string("active_widget", saved_widget, sizeof(saved_widget)) == ESP_OK && saved_widget[0] != '\0') {
-            widget_manager_switch(saved_widget);
-        } else {
-            widget_manager_switch("clock");
-        }
+        show_saved_widgets();
     }
     // Update status UI if already active (before widget system takes over)
     else if (status_ui_is_active()) {
@@ -135,22 +156,9 @@ static void show_status_ui(void)
         time_sync_init();
     }
     
-    // Restore saved widget from database
-    char saved_widget[32] = {0};
-    if (sd_db_get_string("active_widget", saved_widget, sizeof(saved_widget)) == ESP_OK && saved_widget[0] != '\0') {
-        ESP_LOGI(TAG, "Restoring saved widget: %s", saved_widget);
-        if (widget_manager_switch(saved_widget) == ESP_OK) {
-            status_ui_cleanup(); // Hide status UI, widget is now showing
-        } else {
-            ESP_LOGW(TAG, "Failed to restore widget '%s', defaulting to clock", saved_widget);
-            widget_manager_switch("clock");
-            status_ui_cleanup();
-        }
-    } else {
-        ESP_LOGI(TAG, "No saved widget found, defaulting to clock");
-        widget_manager_switch("clock");
-        status_ui_cleanup();
-    }
+    // Restore the saved dashboard or widget, then hide the status UI
+    show_saved_widgets();
+    status_ui_cleanup();
     
     bsp_display_unlock();
 }
@@ -214,6 +222,9 @@ void app_main(void)
             break;
     }
     
+    // Settings changed from the UI are written by this task
+    storage_writer_init();
+    
     // Initialize WiFi AP (always start AP for web access)
     wifi_ap_init(on_station_connect, on_station_disconnect);
     wifi_ap_start();
@@ -235,6 +246,9 @@ void app_main(void)
     // Start display
     bsp_display_start();
     
+    // Count invalidated area and rendered frames for /api/metrics
+    redraw_stats_init();
+    
     // Initialize UI state manager
     ui_state_init();
     
@@ -244,12 +258,19 @@ void app_main(void)
     // Initialize weather service
     weather_service_init();
     
+    // Restore timers before the timer widget attaches to them
+    timer_service_init();
+    
+    // Weather subjects, published from ui_state when the service has new data
+    weather_binding_init();
+    
     // Initialize widget manager and register widgets
     widget_manager_init();
     widget_manager_register(&clock_widget);
     widget_manager_register(&timer_widget);
     widget_manager_register(&weather_widget);
     widget_manager_register(&calendar_widget);
+    layout_manager_init();
     
     // Initialize UI components
     splash_ui_init(after_splash_complete);
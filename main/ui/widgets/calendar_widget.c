@@ -16,7 +16,7 @@ static void calendar_widget_init(void)
     ESP_LOGI(TAG, "Calendar widget initialized");
 }
 
-static void calendar_widget_show(void)
+static void calendar_widget_show(lv_obj_t *parent)
 {
     if (calendar_container) {
         return;
@@ -24,10 +24,7 @@ static void calendar_widget_show(void)
     
     bsp_display_lock(0);
     
-    lv_obj_t *scr = lv_screen_active();
-    lv_obj_set_style_bg_color(scr, WIDGET_COLOR_BG, 0);
-    
-    calendar_container = lv_obj_create(scr);
+    calendar_container = lv_obj_create(parent);
     lv_obj_set_size(calendar_container, LV_PCT(100), LV_PCT(100));
     lv_obj_set_style_bg_opa(calendar_container, LV_OPA_TRANSP, 0);
     lv_obj_set_style_border_width(calendar_container, 0, 0);
@@ -1,22 +1,21 @@
 #include "clock_widget.h"
 #include "widget_common.h"
+#include "digit_display.h"
 #include "core/widget_manager.h"
 #include "core/time_sync.h"
 #include "core/font_size.h"
+#include "core/tick_scheduler.h"
 #include "sd_database.h"
 #include "esp_log.h"
 #include "bsp/esp-bsp.h"
 #include "bsp/display.h"
+#include "esp_timer.h"
 #include <string.h>
 #include <stdio.h>
-#include <math.h>
 #include <time.h>
+#include <sys/time.h>
 #include "cJSON.h"
 
-#ifndef M_PI
-#define M_PI 3.14159265358979323846
-#endif
-
 static const char *TAG = "clock_widget";
 
 typedef enum {
@@ -44,22 +43,254 @@ static clock_config_t clock_config = {
 
 // LVGL objects
 static lv_obj_t *clock_container = NULL;
-static lv_obj_t *time_label = NULL;
+static lv_obj_t *time_label = NULL;      // Fallback if the digit glyphs can't be allocated
+static lv_obj_t *time_digits = NULL;
 static lv_obj_t *date_label = NULL;
-static lv_obj_t *analog_face = NULL;
-static lv_obj_t *hour_hand = NULL;
-static lv_obj_t *minute_hand = NULL;
-static lv_obj_t *second_hand = NULL;
-static lv_timer_t *clock_timer = NULL;
+static lv_obj_t *analog_face = NULL;     // Canvas showing the cached face
+static lv_draw_buf_t *face_buf = NULL;   // Face cache, kept across hide/show
+static int32_t face_buf_size = 0;        // Width and height of face_buf
+static int32_t face_size = 0;
+static int clock_tick = -1;     // tick_scheduler subscription
+
+// Smooth second hand: swept once per display refresh, falling back to
+// 1 Hz steps when frames get slow so the LVGL task doesn't hog the CPU
+#define SWEEP_SLOW_FRAME_MS     25      // Average frame interval that triggers the fallback
+#define SWEEP_RETRY_S           60      // Seconds of stepping before trying to sweep again
+
+static lv_timer_t *sweep_timer = NULL;
+static int64_t sweep_anchor_us = 0;     // esp_timer time of the last whole second
+static int32_t sweep_anchor_sec = 0;    // tm_sec at that point
+static int64_t sweep_last_frame_us = 0;
+static int32_t sweep_avg_frame_us = 0;
+static bool sweep_fallback = false;
+static int sweep_fallback_s = 0;
+
+// Analog hands are drawn on top of the face in its DRAW_MAIN event
+typedef enum {
+    HAND_HOUR,
+    HAND_MINUTE,
+    HAND_SECOND,
+    HAND_COUNT
+} clock_hand_id_t;
+
+typedef struct {
+    int32_t angle;      // Tenths of a degree clockwise from 12, -1 until set
+    int32_t length;     // Tip distance from the center
+    int32_t tail;       // Length behind the center
+    int32_t width;
+} clock_hand_t;
+
+static clock_hand_t hands[HAND_COUNT];
+
+// sin(0..90 degrees) in Q14
+static const int16_t sin_q14[91] = {
+        0,   286,   572,   857,  1143,  1428,  1713,  1997,  2280,  2563,
+     2845,  3126,  3406,  3686,  3964,  4240,  4516,  4790,  5063,  5334,
+     5604,  5872,  6138,  6402,  6664,  6924,  7182,  7438,  7692,  7943,
+     8192,  8438,  8682,  8923,  9162,  9397,  9630,  9860, 10087, 10311,
+    10531, 10749, 10963, 11174, 11381, 11585, 11786, 11982, 12176, 12365,
+    12551, 12733, 12911, 13085, 13255, 13421, 13583, 13741, 13894, 14044,
+    14189, 14330, 14466, 14598, 14726, 14849, 14968, 15082, 15191, 15296,
+    15396, 15491, 15582, 15668, 15749, 15826, 15897, 15964, 16026, 16083,
+    16135, 16182, 16225, 16262, 16294, 16322, 16344, 16362, 16374, 16382,
+    16384
+};
 
 // Forward declarations
-static void clock_update_cb(lv_timer_t *timer);
+static void clock_update_cb(void);
 static void create_digital_clock(void);
 static void create_analog_clock(void);
 static void update_digital_display(void);
 static void update_analog_display(void);
 static void load_config(void);
-static void save_config(void);
+
+// Update on every second or only on the minute, depending on the config
+static tick_interest_t clock_tick_interest(void)
+{
+    return (clock_config.mode == CLOCK_MODE_ANALOG || clock_config.show_seconds) ? TICK_ON_SECOND : TICK_ON_MINUTE;
+}
+
+static void clock_tick_cb(time_t now, void *user_data)
+{
+    (void)now;
+    (void)user_data;
+    clock_update_cb();
+}
+
+// sin of an angle in tenths of a degree, Q14 (interpolated between whole degrees)
+static int32_t lut_sin(int32_t decideg)
+{
+    decideg %= 3600;
+    if (decideg < 0) {
+        decideg += 3600;
+    }
+    
+    // Fold into the first quadrant
+    int32_t sign = 1;
+    if (decideg >= 1800) {
+        decideg -= 1800;
+        sign = -1;
+    }
+    if (decideg > 900) {
+        decideg = 1800 - decideg;
+    }
+    
+    int32_t deg = decideg / 10;
+    int32_t frac = decideg % 10;
+    int32_t value = sin_q14[deg];
+    if (frac) {
+        value += (sin_q14[deg + 1] - value) * frac / 10;
+    }
+    return sign * value;
+}
+
+static int32_t lut_cos(int32_t decideg)
+{
+    return lut_sin(decideg + 900);
+}
+
+// Point at 'radius' from the face center along 'decideg' (face-local coordinates)
+static void face_point(int32_t decideg, int32_t radius, int32_t *x, int32_t *y)
+{
+    *x = face_size / 2 + ((radius * lut_sin(decideg)) >> 14);
+    *y = face_size / 2 - ((radius * lut_cos(decideg)) >> 14);
+}
+
+// Screen area covered by a hand at the given angle
+static void hand_area(const clock_hand_t *hand, int32_t decideg, lv_area_t *area)
+{
+    int32_t tip_x, tip_y, tail_x, tail_y;
+    face_point(decideg, hand->length, &tip_x, &tip_y);
+    face_point(decideg + 1800, hand->tail, &tail_x, &tail_y);
+    
+    lv_area_t coords;
+    lv_obj_get_coords(analog_face, &coords);
+    
+    // Round caps and anti-aliasing reach a little past the line
+    int32_t pad = hand->width / 2 + 2;
+    area->x1 = coords.x1 + LV_MIN(tip_x, tail_x) - pad;
+    area->y1 = coords.y1 + LV_MIN(tip_y, tail_y) - pad;
+    area->x2 = coords.x1 + LV_MAX(tip_x, tail_x) + pad;
+    area->y2 = coords.y1 + LV_MAX(tip_y, tail_y) + pad;
+}
+
+static void invalidate_hand(clock_hand_id_t id)
+{
+    if (!analog_face || hands[id].angle < 0) {
+        return;
+    }
+    
+    lv_area_t area;
+    hand_area(&hands[id], hands[id].angle, &area);
+    lv_obj_invalidate_area(analog_face, &area);
+}
+
+// Move a hand, invalidating only its old and new position
+static void set_hand_angle(clock_hand_id_t id, int32_t decideg)
+{
+    if (hands[id].angle == decideg) {
+        return;
+    }
+    
+    if (!analog_face || hands[id].angle < 0) {
+        hands[id].angle = decideg;
+        invalidate_hand(id);
+        return;
+    }
+    
+    lv_area_t old_area, new_area;
+    hand_area(&hands[id], hands[id].angle, &old_area);
+    hand_area(&hands[id], decideg, &new_area);
+    hands[id].angle = decideg;
+    
+    // Small moves (a sweeping second hand) overlap, so one swept box is enough
+    if (old_area.x1 <= new_area.x2 && new_area.x1 <= old_area.x2 &&
+        old_area.y1 <= new_area.y2 && new_area.y1 <= old_area.y2) {
+        lv_area_t swept = {
+            .x1 = LV_MIN(old_area.x1, new_area.x1),
+            .y1 = LV_MIN(old_area.y1, new_area.y1),
+            .x2 = LV_MAX(old_area.x2, new_area.x2),
+            .y2 = LV_MAX(old_area.y2, new_area.y2)
+        };
+        lv_obj_invalidate_area(analog_face, &swept);
+    } else {
+        lv_obj_invalidate_area(analog_face, &old_area);
+        lv_obj_invalidate_area(analog_face, &new_area);
+    }
+}
+
+static bool sweep_wanted(void)
+{
+    return analog_face && !lv_obj_has_flag(clock_container, LV_OBJ_FLAG_HIDDEN) &&
+           clock_config.show_seconds && clock_config.smooth_seconds && !sweep_fallback;
+}
+
+// Tie the sub-second esp_timer clock to the wall clock's current second
+static void sweep_anchor(const struct tm *timeinfo)
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    sweep_anchor_us = esp_timer_get_time() - tv.tv_usec;
+    sweep_anchor_sec = timeinfo->tm_sec;
+}
+
+// Position the second hand for the current sub-second time
+static void sweep_update(void)
+{
+    int64_t elapsed_us = esp_timer_get_time() - sweep_anchor_us;
+    
+    // Never run ahead into the next second before the tick re-anchors
+    int32_t frac = (int32_t)LV_CLAMP(0, elapsed_us * 60 / 1000000, 59);
+    set_hand_angle(HAND_SECOND, sweep_anchor_sec * 60 + frac);
+}
+
+static void sweep_timer_cb(lv_timer_t *timer)
+{
+    (void)timer;
+    
+    // Track how often we actually get to run; a slow render or a busy
+    // CPU shows up as a longer interval between frames
+    int64_t now_us = esp_timer_get_time();
+    if (sweep_last_frame_us) {
+        int32_t frame_us = (int32_t)(now_us - sweep_last_frame_us);
+        sweep_avg_frame_us += (frame_us - sweep_avg_frame_us) / 8;
+    }
+    sweep_last_frame_us = now_us;
+    
+    if (sweep_avg_frame_us > SWEEP_SLOW_FRAME_MS * 1000) {
+        ESP_LOGW(TAG, "Frames too slow for a smooth second hand (%ld us), stepping instead",
+                 (long)sweep_avg_frame_us);
+        sweep_fallback = true;
+        sweep_fallback_s = 0;
+        lv_timer_delete(sweep_timer);
+        sweep_timer = NULL;
+        return;
+    }
+    
+    sweep_update();
+}
+
+// Start or stop the sweep timer to match the config and fallback state
+static void sweep_sync(void)
+{
+    if (sweep_wanted() && !sweep_timer) {
+        sweep_timer = lv_timer_create(sweep_timer_cb, LV_DEF_REFR_PERIOD, NULL);
+        sweep_last_frame_us = 0;
+        sweep_avg_frame_us = LV_DEF_REFR_PERIOD * 1000;
+    } else if (!sweep_wanted() && sweep_timer) {
+        lv_timer_delete(sweep_timer);
+        sweep_timer = NULL;
+    }
+}
+
+// Show or hide the optional parts according to the current config
+static void apply_visibility(void)
+{
+    widget_obj_set_visible(date_label, clock_config.show_date || clock_config.show_weekday);
+    
+    // The second hand is only drawn when enabled
+    invalidate_hand(HAND_SECOND);
+}
 
 static void clock_widget_init(void)
 {
@@ -67,7 +298,7 @@ static void clock_widget_init(void)
     ESP_LOGI(TAG, "Clock widget initialized");
 }
 
-static void clock_widget_show(void)
+static void clock_widget_show(lv_obj_t *parent)
 {
     if (clock_container) {
         return; // Already shown
@@ -75,10 +306,7 @@ static void clock_widget_show(void)
     
     bsp_display_lock(0);
     
-    lv_obj_t *scr = lv_screen_active();
-    lv_obj_set_style_bg_color(scr, WIDGET_COLOR_BG, 0);
-    
-    clock_container = lv_obj_create(scr);
+    clock_container = lv_obj_create(parent);
     lv_obj_set_size(clock_container, LV_PCT(100), LV_PCT(100));
     lv_obj_set_style_bg_opa(clock_container, LV_OPA_TRANSP, 0);
     lv_obj_set_style_border_width(clock_container, 0, 0);
@@ -91,12 +319,16 @@ static void clock_widget_show(void)
         create_analog_clock();
     }
     
-    // Create update timer
-    int interval = (clock_config.mode == CLOCK_MODE_ANALOG || clock_config.show_seconds) ? 1000 : 60000;
-    clock_timer = lv_timer_create(clock_update_cb, interval, NULL);
+    // Optional parts are always created and hidden when disabled,
+    // so toggling them later doesn't need a rebuild
+    apply_visibility();
+    
+    // Updates come from the shared scheduler, aligned to the wall clock
+    clock_tick = tick_scheduler_subscribe(clock_tick_interest(), 0, clock_tick_cb, NULL);
     
     // Initial update
-    clock_update_cb(NULL);
+    clock_update_cb();
+    sweep_sync();
     
     bsp_display_unlock();
     
@@ -107,21 +339,21 @@ static void clock_widget_hide(void)
 {
     bsp_display_lock(0);
     
-    // Stop timer first
-    if (clock_timer) {
-        lv_timer_delete(clock_timer);
-        clock_timer = NULL;
+    // Stop updates first
+    tick_scheduler_unsubscribe(clock_tick);
+    clock_tick = -1;
+    if (sweep_timer) {
+        lv_timer_delete(sweep_timer);
+        sweep_timer = NULL;
     }
     
     // Clear pointers before deletion to prevent callback from accessing deleted objects
     lv_obj_t *container_to_delete = clock_container;
     clock_container = NULL;
     time_label = NULL;
+    time_digits = NULL;
     date_label = NULL;
     analog_face = NULL;
-    hour_hand = NULL;
-    minute_hand = NULL;
-    second_hand = NULL;
     
     // Delete container after clearing pointers
     if (container_to_delete) {
@@ -135,7 +367,9 @@ static void clock_widget_hide(void)
 
 static void clock_widget_update(void)
 {
-    clock_update_cb(NULL);
+    bsp_display_lock(0);
+    clock_update_cb();
+    bsp_display_unlock();
 }
 
 static void create_digital_clock(void)
@@ -149,113 +383,187 @@ static void create_digital_clock(void)
     lv_obj_set_flex_align(container, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER);
     lv_obj_clear_flag(container, LV_OBJ_FLAG_SCROLLABLE);
     
-    // Time label
-    time_label = lv_label_create(container);
-    lv_label_set_text(time_label, "00:00");
-    lv_obj_set_style_text_font(time_label, font_size_get_huge(), 0);
-    lv_obj_set_style_text_color(time_label, WIDGET_COLOR_TEXT, 0);
-    lv_obj_set_style_margin_bottom(time_label, 20, 0);
+    // Time digits: pre-rendered glyphs as large as the widest time allows,
+    // leaving room for the date below
+    const char *sample = clock_config.show_seconds ?
+        (clock_config.is_24h ? "88:88:88" : "88:88:88 AM") :
+        (clock_config.is_24h ? "88:88" : "88:88 AM");
+    lv_obj_update_layout(clock_container);
+    time_digits = digit_display_create(container, sample,
+                                       lv_obj_get_content_width(clock_container),
+                                       lv_obj_get_content_height(clock_container) - 60);
+    if (time_digits) {
+        lv_obj_set_style_text_color(time_digits, WIDGET_COLOR_TEXT, 0);
+        lv_obj_set_style_margin_bottom(time_digits, 20, 0);
+    } else {
+        time_label = lv_label_create(container);
+        lv_label_set_text(time_label, "00:00");
+        lv_obj_set_style_text_font(time_label, font_size_get_huge(), 0);
+        lv_obj_set_style_text_color(time_label, WIDGET_COLOR_TEXT, 0);
+        lv_obj_set_style_margin_bottom(time_label, 20, 0);
+    }
     
     // Date label
-    if (clock_config.show_date || clock_config.show_weekday) {
-        date_label = lv_label_create(container);
-        lv_label_set_text(date_label, "");
-        lv_obj_set_style_text_font(date_label, &lv_font_montserrat_18, 0);
-        lv_obj_set_style_text_color(date_label, WIDGET_COLOR_MUTED, 0);
-    }
+    date_label = lv_label_create(container);
+    lv_label_set_text(date_label, "");
+    lv_obj_set_style_text_font(date_label, &lv_font_montserrat_18, 0);
+    lv_obj_set_style_text_color(date_label, WIDGET_COLOR_MUTED, 0);
 }
 
-static void create_analog_clock(void)
+// Draw the hands and center dot over the cached face
+static void analog_face_draw_cb(lv_event_t *e)
 {
-    // Analog clock face container
-    analog_face = lv_obj_create(clock_container);
-    lv_obj_set_size(analog_face, 360, 360);
-    lv_obj_center(analog_face);
-    lv_obj_set_style_bg_color(analog_face, lv_color_hex(0x2a2a4e), 0);
-    lv_obj_set_style_bg_opa(analog_face, LV_OPA_COVER, 0);
-    lv_obj_set_style_radius(analog_face, LV_RADIUS_CIRCLE, 0);
-    lv_obj_set_style_border_width(analog_face, 4, 0);
-    lv_obj_set_style_border_color(analog_face, WIDGET_COLOR_TEXT, 0);
-    lv_obj_clear_flag(analog_face, LV_OBJ_FLAG_SCROLLABLE);
-    
-    // Draw hour markers
-    for (int i = 0; i < 12; i++) {
-        lv_obj_t *marker = lv_obj_create(analog_face);
-        lv_obj_set_size(marker, 4, 20);
-        lv_obj_set_style_bg_color(marker, WIDGET_COLOR_TEXT, 0);
-        lv_obj_set_style_bg_opa(marker, LV_OPA_COVER, 0);
-        lv_obj_set_style_border_width(marker, 0, 0);
-        lv_obj_set_style_radius(marker, 2, 0);
+    lv_layer_t *layer = lv_event_get_layer(e);
+    lv_area_t coords;
+    lv_obj_get_coords(analog_face, &coords);
+    
+    for (int i = 0; i < HAND_COUNT; i++) {
+        const clock_hand_t *hand = &hands[i];
+        if (hand->angle < 0 || (i == HAND_SECOND && !clock_config.show_seconds)) {
+            continue;
+        }
         
-        float angle = (i * 30.0f - 90.0f) * M_PI / 180.0f;
-        int x = 180 + (int)(150 * cosf(angle));
-        int y = 180 + (int)(150 * sinf(angle));
-        lv_obj_set_pos(marker, x - 2, y - 10);
-    }
-    
-    // Hour hand
-    hour_hand = lv_obj_create(analog_face);
-    lv_obj_set_size(hour_hand, 6, 80);
-    lv_obj_set_style_bg_color(hour_hand, WIDGET_COLOR_TEXT, 0);
-    lv_obj_set_style_bg_opa(hour_hand, LV_OPA_COVER, 0);
-    lv_obj_set_style_border_width(hour_hand, 0, 0);
-    lv_obj_set_style_radius(hour_hand, 3, 0);
-    lv_obj_set_pos(hour_hand, 177, 100);
-    lv_obj_set_style_transform_pivot_x(hour_hand, 3, 0);
-    lv_obj_set_style_transform_pivot_y(hour_hand, 80, 0);
-    
-    // Minute hand
-    minute_hand = lv_obj_create(analog_face);
-    lv_obj_set_size(minute_hand, 4, 120);
-    lv_obj_set_style_bg_color(minute_hand, WIDGET_COLOR_TEXT, 0);
-    lv_obj_set_style_bg_opa(minute_hand, LV_OPA_COVER, 0);
-    lv_obj_set_style_border_width(minute_hand, 0, 0);
-    lv_obj_set_style_radius(minute_hand, 2, 0);
-    lv_obj_set_pos(minute_hand, 178, 60);
-    lv_obj_set_style_transform_pivot_x(minute_hand, 2, 0);
-    lv_obj_set_style_transform_pivot_y(minute_hand, 120, 0);
-    
-    // Second hand
-    if (clock_config.show_seconds) {
-        second_hand = lv_obj_create(analog_face);
-        lv_obj_set_size(second_hand, 2, 130);
-        lv_obj_set_style_bg_color(second_hand, WIDGET_COLOR_ACCENT, 0);
-        lv_obj_set_style_bg_opa(second_hand, LV_OPA_COVER, 0);
-        lv_obj_set_style_border_width(second_hand, 0, 0);
-        lv_obj_set_style_radius(second_hand, 1, 0);
-        lv_obj_set_pos(second_hand, 179, 50);
-        lv_obj_set_style_transform_pivot_x(second_hand, 1, 0);
-        lv_obj_set_style_transform_pivot_y(second_hand, 130, 0);
+        int32_t tip_x, tip_y, tail_x, tail_y;
+        face_point(hand->angle, hand->length, &tip_x, &tip_y);
+        face_point(hand->angle + 1800, hand->tail, &tail_x, &tail_y);
+        
+        lv_draw_line_dsc_t line;
+        lv_draw_line_dsc_init(&line);
+        line.color = (i == HAND_SECOND) ? WIDGET_COLOR_ACCENT : WIDGET_COLOR_TEXT;
+        line.width = hand->width;
+        line.round_start = 1;
+        line.round_end = 1;
+        line.p1.x = coords.x1 + tail_x;
+        line.p1.y = coords.y1 + tail_y;
+        line.p2.x = coords.x1 + tip_x;
+        line.p2.y = coords.y1 + tip_y;
+        lv_draw_line(layer, &line);
     }
     
     // Center dot
-    lv_obj_t *center = lv_obj_create(analog_face);
-    lv_obj_set_size(center, 12, 12);
-    lv_obj_set_style_bg_color(center, WIDGET_COLOR_TEXT, 0);
-    lv_obj_set_style_bg_opa(center, LV_OPA_COVER, 0);
-    lv_obj_set_style_border_width(center, 0, 0);
-    lv_obj_set_style_radius(center, LV_RADIUS_CIRCLE, 0);
-    lv_obj_center(center);
+    lv_draw_rect_dsc_t dot;
+    lv_draw_rect_dsc_init(&dot);
+    dot.bg_color = WIDGET_COLOR_TEXT;
+    dot.bg_opa = LV_OPA_COVER;
+    dot.radius = LV_RADIUS_CIRCLE;
+    lv_area_t dot_area = {
+        .x1 = coords.x1 + face_size / 2 - 6,
+        .y1 = coords.y1 + face_size / 2 - 6,
+        .x2 = coords.x1 + face_size / 2 + 5,
+        .y2 = coords.y1 + face_size / 2 + 5
+    };
+    lv_draw_rect(layer, &dot, &dot_area);
+}
+
+// Render the static face (dial, border, hour markers) once into a buffer.
+// The buffer outlives the canvas, so a rebuild at the same size reuses it.
+static bool render_face(void)
+{
+    if (face_buf && face_buf_size == face_size) {
+        lv_canvas_set_draw_buf(analog_face, face_buf);
+        return true;
+    }
+    if (face_buf) {
+        lv_draw_buf_destroy(face_buf);
+        face_buf = NULL;
+    }
+    
+    face_buf = lv_draw_buf_create(face_size, face_size, LV_COLOR_FORMAT_RGB565, 0);
+    if (!face_buf) {
+        ESP_LOGE(TAG, "Failed to allocate clock face buffer");
+        return false;
+    }
+    face_buf_size = face_size;
+    
+    lv_canvas_set_draw_buf(analog_face, face_buf);
+    lv_canvas_fill_bg(analog_face, WIDGET_COLOR_BG, LV_OPA_COVER);
+    
+    lv_layer_t layer;
+    lv_canvas_init_layer(analog_face, &layer);
+    
+    lv_draw_rect_dsc_t dial;
+    lv_draw_rect_dsc_init(&dial);
+    dial.bg_color = lv_color_hex(0x2a2a4e);
+    dial.bg_opa = LV_OPA_COVER;
+    dial.radius = LV_RADIUS_CIRCLE;
+    dial.border_width = 4;
+    dial.border_color = WIDGET_COLOR_TEXT;
+    dial.border_opa = LV_OPA_COVER;
+    lv_area_t dial_area = { 0, 0, face_size - 1, face_size - 1 };
+    lv_draw_rect(&layer, &dial, &dial_area);
+    
+    // Hour markers
+    lv_draw_line_dsc_t marker;
+    lv_draw_line_dsc_init(&marker);
+    marker.color = WIDGET_COLOR_TEXT;
+    marker.width = 4;
+    marker.round_start = 1;
+    marker.round_end = 1;
+    for (int i = 0; i < 12; i++) {
+        int32_t x1, y1, x2, y2;
+        face_point(i * 300, face_size * 140 / 360, &x1, &y1);
+        face_point(i * 300, face_size * 160 / 360, &x2, &y2);
+        marker.p1.x = x1;
+        marker.p1.y = y1;
+        marker.p2.x = x2;
+        marker.p2.y = y2;
+        lv_draw_line(&layer, &marker);
+    }
+    
+    lv_canvas_finish_layer(analog_face, &layer);
+    return true;
+}
+
+static void create_analog_clock(void)
+{
+    // Fit the face to the container, leaving room for the date below it.
+    // Everything is laid out for a 360 px face and scaled to the actual size.
+    lv_obj_update_layout(clock_container);
+    int32_t face = LV_MIN(lv_obj_get_content_width(clock_container),
+                          lv_obj_get_content_height(clock_container) - 60);
+    face_size = LV_CLAMP(120, face, 360);
+    
+    // The face is a canvas holding a pre-rendered image; the hands are
+    // drawn over it, so a tick only redraws the area the hands sweep
+    analog_face = lv_canvas_create(clock_container);
+    lv_obj_align(analog_face, LV_ALIGN_CENTER, 0, (face_size < 360) ? -20 : 0);
+    if (!render_face()) {
+        lv_obj_delete(analog_face);
+        analog_face = NULL;
+        return;
+    }
+    lv_obj_add_event_cb(analog_face, analog_face_draw_cb, LV_EVENT_DRAW_MAIN, NULL);
+    
+    hands[HAND_HOUR] = (clock_hand_t) { .angle = -1, .length = face_size * 80 / 360, .tail = 0, .width = 6 };
+    hands[HAND_MINUTE] = (clock_hand_t) { .angle = -1, .length = face_size * 120 / 360, .tail = 0, .width = 4 };
+    hands[HAND_SECOND] = (clock_hand_t) { .angle = -1, .length = face_size * 130 / 360, .tail = face_size * 20 / 360, .width = 2 };
     
     // Date label below clock
-    if (clock_config.show_date || clock_config.show_weekday) {
-        date_label = lv_label_create(clock_container);
-        lv_label_set_text(date_label, "");
-        lv_obj_set_style_text_font(date_label, font_size_get_medium(), 0);
-        lv_obj_set_style_text_color(date_label, WIDGET_COLOR_MUTED, 0);
-        lv_obj_align(date_label, LV_ALIGN_BOTTOM_MID, 0, -20);
+    date_label = lv_label_create(clock_container);
+    lv_label_set_text(date_label, "");
+    lv_obj_set_style_text_font(date_label, font_size_get_medium(), 0);
+    lv_obj_set_style_text_color(date_label, WIDGET_COLOR_MUTED, 0);
+    lv_obj_align(date_label, LV_ALIGN_BOTTOM_MID, 0, (face_size < 360) ? 0 : -20);
+}
+
+static void set_time_text(const char *text)
+{
+    if (time_digits) {
+        digit_display_set_text(time_digits, text);
+    } else {
+        widget_label_set_text(time_label, text);
     }
 }
 
 static void update_digital_display(void)
 {
-    if (!time_label) return;
+    if (!time_label && !time_digits) return;
     
     time_t now;
     struct tm timeinfo;
     
     if (time_sync_get_time(&now) != ESP_OK) {
-        lv_label_set_text(time_label, "--:--");
+        set_time_text("--:--");
         return;
     }
     
@@ -292,7 +600,7 @@ static void update_digital_display(void)
         }
     }
     
-    lv_label_set_text(time_label, time_str);
+    set_time_text(time_str);
     
     // Update date label
     if (date_label && (clock_config.show_date || clock_config.show_weekday)) {
@@ -304,7 +612,7 @@ static void update_digital_display(void)
         } else {
             strftime(date_str, sizeof(date_str), "%b %d", &timeinfo);
         }
-        lv_label_set_text(date_label, date_str);
+        widget_label_set_text(date_label, date_str);
     }
 }
 
@@ -321,24 +629,24 @@ static void update_analog_display(void)
     
     localtime_r(&now, &timeinfo);
     
-    // Calculate angles (0 degrees = 12 o'clock, clockwise)
-    float hour_angle = ((timeinfo.tm_hour % 12) * 30.0f + timeinfo.tm_min * 0.5f - 90.0f) * M_PI / 180.0f;
-    float minute_angle = (timeinfo.tm_min * 6.0f - 90.0f) * M_PI / 180.0f;
-    float second_angle = (timeinfo.tm_sec * 6.0f - 90.0f) * M_PI / 180.0f;
-    
-    // Update hour hand
-    if (hour_hand) {
-        lv_obj_set_style_transform_angle(hour_hand, (int32_t)(hour_angle * 1800.0f / M_PI), 0);
-    }
-    
-    // Update minute hand
-    if (minute_hand) {
-        lv_obj_set_style_transform_angle(minute_hand, (int32_t)(minute_angle * 1800.0f / M_PI), 0);
+    // Angles in tenths of a degree, clockwise from 12 o'clock. Unchanged
+    // hands (usually hour and minute) invalidate nothing.
+    set_hand_angle(HAND_HOUR, (timeinfo.tm_hour % 12) * 300 + timeinfo.tm_min * 5);
+    set_hand_angle(HAND_MINUTE, timeinfo.tm_min * 60);
+    if (clock_config.show_seconds) {
+        if (sweep_timer) {
+            // The sweep timer moves the hand; just keep it on the wall clock
+            sweep_anchor(&timeinfo);
+            sweep_update();
+        } else {
+            set_hand_angle(HAND_SECOND, timeinfo.tm_sec * 60);
+        }
     }
     
-    // Update second hand
-    if (second_hand && clock_config.show_seconds) {
-        lv_obj_set_style_transform_angle(second_hand, (int32_t)(second_angle * 1800.0f / M_PI), 0);
+    // After a while of stepping, give the smooth hand another chance
+    if (sweep_fallback && ++sweep_fallback_s >= SWEEP_RETRY_S) {
+        sweep_fallback = false;
+        sweep_sync();
     }
     
     // Update date label
@@ -351,34 +659,23 @@ static void update_analog_display(void)
         } else {
             strftime(date_str, sizeof(date_str), "%b %d", &timeinfo);
         }
-        lv_label_set_text(date_label, date_str);
+        widget_label_set_text(date_label, date_str);
     }
 }
 
-static void clock_update_cb(lv_timer_t *timer)
+// Redraw the time (display lock held: scheduler tick, show or config change)
+static void clock_update_cb(void)
 {
-    (void)timer;
-    
     // Check if widget is still active
     if (!clock_container) {
         return;
     }
     
-    bsp_display_lock(0);
-    
-    // Double-check after acquiring lock (widget might have been hidden)
-    if (!clock_container) {
-        bsp_display_unlock();
-        return;
-    }
-    
     if (clock_config.mode == CLOCK_MODE_DIGITAL) {
         update_digital_display();
     } else {
         update_analog_display();
     }
-    
-    bsp_display_unlock();
 }
 
 static void load_config(void)
@@ -432,30 +729,6 @@ static void load_config(void)
     ESP_LOGI(TAG, "Clock config loaded");
 }
 
-static void save_config(void)
-{
-    if (!sd_db_is_ready()) {
-        return;
-    }
-    
-    cJSON *json = cJSON_CreateObject();
-    cJSON_AddStringToObject(json, "mode", clock_config.mode == CLOCK_MODE_ANALOG ? "analog" : "digital");
-    cJSON_AddBoolToObject(json, "show_seconds", clock_config.show_seconds);
-    cJSON_AddBoolToObject(json, "is_24h", clock_config.is_24h);
-    cJSON_AddBoolToObject(json, "show_date", clock_config.show_date);
-    cJSON_AddBoolToObject(json, "show_weekday", clock_config.show_weekday);
-    cJSON_AddBoolToObject(json, "smooth_seconds", clock_config.smooth_seconds);
-    
-    char *json_str = cJSON_PrintUnformatted(json);
-    if (json_str) {
-        sd_db_set_string("widget_clock_config", json_str);
-        sd_db_save();
-        free(json_str);
-    }
-    
-    cJSON_Delete(json);
-}
-
 static cJSON* clock_widget_get_config(void)
 {
     cJSON *json = cJSON_CreateObject();
@@ -503,13 +776,86 @@ static void clock_widget_set_config(cJSON *cfg)
         clock_config.smooth_seconds = cJSON_IsTrue(item);
     }
     
-    save_config();
+    // Persistence and the rebuild (if shown) are done once by widget_manager
+}
+
+// Patch the shown clock for changed config fields (called with the display lock held)
+static bool clock_widget_apply_delta(const cJSON *changed)
+{
+    if (!clock_container) {
+        return true;  // Not shown, next show() uses the new config
+    }
+    
+    // Digital and analog have different object trees
+    if (cJSON_GetObjectItem(changed, "mode")) {
+        return false;
+    }
     
-    // If widget is currently shown, recreate it with new config
-    if (clock_container) {
-        clock_widget_hide();
-        clock_widget_show();
+    // The digits are sized for the widest time, which these change
+    if (clock_config.mode == CLOCK_MODE_DIGITAL &&
+        (cJSON_GetObjectItem(changed, "show_seconds") || cJSON_GetObjectItem(changed, "is_24h"))) {
+        return false;
+    }
+    
+    if (cJSON_GetObjectItem(changed, "font_size")) {
+        if (time_label) {
+            lv_obj_set_style_text_font(time_label, font_size_get_huge(), 0);
+        }
+        if (date_label && clock_config.mode == CLOCK_MODE_ANALOG) {
+            lv_obj_set_style_text_font(date_label, font_size_get_medium(), 0);
+        }
+    }
+    
+    apply_visibility();
+    
+    if (cJSON_GetObjectItem(changed, "show_seconds")) {
+        tick_scheduler_set_interest(clock_tick, clock_tick_interest(), 0);
+    }
+    if (cJSON_GetObjectItem(changed, "smooth_seconds")) {
+        sweep_fallback = false;
     }
+    sweep_sync();
+    
+    // Re-render text (12/24h, seconds and date formats)
+    clock_update_cb();
+    return true;
+}
+
+// Retain mode: keep the object tree, just hide it and pause updates
+static void clock_widget_suspend(void)
+{
+    if (!clock_container) {
+        return;
+    }
+    
+    tick_scheduler_set_paused(clock_tick, true);
+    if (sweep_timer) {
+        lv_timer_pause(sweep_timer);
+    }
+    lv_obj_add_flag(clock_container, LV_OBJ_FLAG_HIDDEN);
+}
+
+static void clock_widget_resume(void)
+{
+    if (!clock_container) {
+        return;
+    }
+    
+    lv_obj_clear_flag(clock_container, LV_OBJ_FLAG_HIDDEN);
+    lv_obj_move_foreground(clock_container);
+    
+    tick_scheduler_set_paused(clock_tick, false);
+    if (sweep_timer) {
+        sweep_last_frame_us = 0;    // The pause isn't a slow frame
+        lv_timer_resume(sweep_timer);
+    }
+    clock_update_cb();  // Catch up on time missed while hidden
+}
+
+// The face cache isn't freed by hide(), so it isn't charged to the retain budget
+static size_t clock_widget_cache_size(void)
+{
+    return face_buf ? (size_t)face_buf_size * face_buf_size * 2 : 0;  // RGB565
 }
 
 // Widget structure
@@ -522,6 +868,10 @@ const struct widget clock_widget = {
     .hide = clock_widget_hide,
     .update = clock_widget_update,
     .get_config = clock_widget_get_config,
-    .set_config = clock_widget_set_config
+    .set_config = clock_widget_set_config,
+    .apply_delta = clock_widget_apply_delta,
+    .suspend = clock_widget_suspend,
+    .resume = clock_widget_resume,
+    .cache_size = clock_widget_cache_size
 };
 
@@ -0,0 +1,408 @@
+#include "digit_display.h"
+#include "core/redraw_stats.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "esp_err.h"
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+
+static const char *TAG = "digit_display";
+
+// Glyphs are designed in a box 100 units high and scaled to the pixel size
+#define DIGIT_UNITS             100
+#define DIGIT_STROKE_RADIUS     6       // Units
+#define DIGIT_SPACING           8       // Units between cells
+#define DIGIT_LETTER_SCALE      45      // AM/PM height, percent of the digits
+#define DIGIT_MIN_HEIGHT        24
+#define DIGIT_MAX_HEIGHT        200
+#define DIGIT_MAX_CELLS         12
+#define DIGIT_CACHE_SIZES       3       // Glyph sets kept for different sizes
+
+#define GLYPH_CHARS             "0123456789:- APM"
+#define GLYPH_COUNT             (sizeof(GLYPH_CHARS) - 1)
+
+// Round-capped line from (x1, y1) to (x2, y2), in units
+typedef struct {
+    int8_t x1, y1, x2, y2;
+} stroke_t;
+
+// Seven-segment strokes: a (top), b, c, d (bottom), e, f, g (middle)
+static const stroke_t segments[7] = {
+    { 12,  8, 44,  8 },
+    { 48, 12, 48, 46 },
+    { 48, 54, 48, 88 },
+    { 12, 92, 44, 92 },
+    {  8, 54,  8, 88 },
+    {  8, 12,  8, 46 },
+    { 12, 50, 44, 50 }
+};
+
+// Segment bits (a = bit 0) for 0-9
+static const uint8_t digit_segments[10] = {
+    0x3f, 0x06, 0x5b, 0x4f, 0x66, 0x6d, 0x7d, 0x07, 0x7f, 0x6f
+};
+
+static const stroke_t colon_strokes[] = {
+    { 10, 32, 10, 32 },
+    { 10, 68, 10, 68 }
+};
+
+static const stroke_t letter_a[] = {
+    {  8, 92, 28,  8 }, { 28,  8, 48, 92 }, { 16, 62, 40, 62 }
+};
+
+static const stroke_t letter_p[] = {
+    {  8, 92,  8,  8 }, {  8,  8, 36,  8 }, { 36,  8, 46, 18 },
+    { 46, 18, 46, 40 }, { 46, 40, 36, 50 }, { 36, 50,  8, 50 }
+};
+
+static const stroke_t letter_m[] = {
+    {  8, 92,  8,  8 }, {  8,  8, 32, 56 }, { 32, 56, 56,  8 }, { 56,  8, 56, 92 }
+};
+
+// A set of glyphs rasterized at one height, shared by displays of that size
+typedef struct {
+    int32_t height;         // 0 if the slot is empty
+    int refs;
+    lv_image_dsc_t glyphs[GLYPH_COUNT];
+} glyph_set_t;
+
+static glyph_set_t glyph_sets[DIGIT_CACHE_SIZES];
+
+typedef struct {
+    glyph_set_t *set;
+    char text[DIGIT_MAX_CELLS + 1];
+    int32_t cell_x[DIGIT_MAX_CELLS];    // Relative to the text's left edge
+    int32_t text_w;
+} digit_display_t;
+
+static int glyph_index(char c)
+{
+    const char *p = strchr(GLYPH_CHARS, c);
+    return (p && c) ? (int)(p - GLYPH_CHARS) : -1;
+}
+
+// Glyph outline: strokes, width in units and whether it is a small letter
+static int glyph_strokes(char c, stroke_t *out, int32_t *width, bool *letter)
+{
+    const stroke_t *src = NULL;
+    int count = 0;
+    *width = 56;
+    *letter = false;
+    
+    if (c >= '0' && c <= '9') {
+        for (int i = 0; i < 7; i++) {
+            if (digit_segments[c - '0'] & (1 << i)) {
+                out[count++] = segments[i];
+            }
+        }
+        return count;
+    }
+    
+    switch (c) {
+        case ':':
+            src = colon_strokes;
+            count = 2;
+            *width = 20;
+            break;
+        case '-':
+            out[0] = segments[6];
+            return 1;
+        case ' ':
+            *width = 20;
+            return 0;
+        case 'A':
+            src = letter_a;
+            count = 3;
+            *letter = true;
+            break;
+        case 'P':
+            src = letter_p;
+            count = 6;
+            *letter = true;
+            break;
+        case 'M':
+            src = letter_m;
+            count = 4;
+            *width = 64;
+            *letter = true;
+            break;
+        default:
+            return 0;
+    }
+    
+    memcpy(out, src, count * sizeof(stroke_t));
+    return count;
+}
+
+static float stroke_distance(float x, float y, const stroke_t *s)
+{
+    float dx = s->x2 - s->x1;
+    float dy = s->y2 - s->y1;
+    float px = x - s->x1;
+    float py = y - s->y1;
+    float len2 = dx * dx + dy * dy;
+    
+    float t = (len2 > 0.0f) ? (px * dx + py * dy) / len2 : 0.0f;
+    t = (t < 0.0f) ? 0.0f : (t > 1.0f) ? 1.0f : t;
+    
+    float ex = px - t * dx;
+    float ey = py - t * dy;
+    return sqrtf(ex * ex + ey * ey);
+}
+
+// Anti-aliased coverage of the strokes, one byte per pixel
+static esp_err_t rasterize_glyph(char c, int32_t digit_h, lv_image_dsc_t *img)
+{
+    stroke_t strokes[7];
+    int32_t width_units;
+    bool letter;
+    int count = glyph_strokes(c, strokes, &width_units, &letter);
+    
+    int32_t h = letter ? digit_h * DIGIT_LETTER_SCALE / 100 : digit_h;
+    int32_t w = (width_units * h + DIGIT_UNITS - 1) / DIGIT_UNITS;
+    
+    uint8_t *buf = heap_caps_calloc(1, w * h, MALLOC_CAP_SPIRAM);
+    if (!buf) {
+        return ESP_ERR_NO_MEM;
+    }
+    
+    float scale = (float)h / DIGIT_UNITS;
+    for (int32_t y = 0; y < h; y++) {
+        float uy = (y + 0.5f) / scale;
+        for (int32_t x = 0; x < w; x++) {
+            float ux = (x + 0.5f) / scale;
+            
+            float d = 1e9f;
+            for (int i = 0; i < count; i++) {
+                float sd = stroke_distance(ux, uy, &strokes[i]);
+                if (sd < d) {
+                    d = sd;
+                }
+            }
+            
+            // Signed distance to the edge in pixels -> coverage
+            float cover = 0.5f - (d - DIGIT_STROKE_RADIUS) * scale;
+            cover = (cover < 0.0f) ? 0.0f : (cover > 1.0f) ? 1.0f : cover;
+            buf[y * w + x] = (uint8_t)(cover * 255.0f);
+        }
+    }
+    
+    memset(img, 0, sizeof(*img));
+    img->header.magic = LV_IMAGE_HEADER_MAGIC;
+    img->header.cf = LV_COLOR_FORMAT_A8;
+    img->header.w = w;
+    img->header.h = h;
+    img->header.stride = w;
+    img->data_size = w * h;
+    img->data = buf;
+    return ESP_OK;
+}
+
+static void free_glyph_set(glyph_set_t *set)
+{
+    for (size_t i = 0; i < GLYPH_COUNT; i++) {
+        heap_caps_free((void *)set->glyphs[i].data);
+    }
+    memset(set, 0, sizeof(*set));
+}
+
+// Get the glyphs for a height, rasterizing them if they aren't cached
+static glyph_set_t* acquire_glyph_set(int32_t height)
+{
+    glyph_set_t *slot = NULL;
+    for (int i = 0; i < DIGIT_CACHE_SIZES; i++) {
+        if (glyph_sets[i].height == height) {
+            glyph_sets[i].refs++;
+            return &glyph_sets[i];
+        }
+        // Prefer an empty slot over evicting an unused size
+        if (glyph_sets[i].refs == 0 && (!slot || glyph_sets[i].height == 0)) {
+            slot = &glyph_sets[i];
+        }
+    }
+    
+    if (!slot) {
+        ESP_LOGW(TAG, "No free glyph cache slot for %ld px", (long)height);
+        return NULL;
+    }
+    
+    free_glyph_set(slot);
+    for (size_t i = 0; i < GLYPH_COUNT; i++) {
+        if (rasterize_glyph(GLYPH_CHARS[i], height, &slot->glyphs[i]) != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to allocate %ld px glyphs", (long)height);
+            free_glyph_set(slot);
+            return NULL;
+        }
+    }
+    
+    slot->height = height;
+    slot->refs = 1;
+    ESP_LOGI(TAG, "Rasterized glyphs at %ld px", (long)height);
+    return slot;
+}
+
+static int32_t glyph_width(const glyph_set_t *set, char c)
+{
+    int index = glyph_index(c);
+    return (index >= 0) ? set->glyphs[index].header.w : set->glyphs[glyph_index(' ')].header.w;
+}
+
+// Lay out the cells of the current text and return its width
+static int32_t layout_text(digit_display_t *dd)
+{
+    int32_t spacing = DIGIT_SPACING * dd->set->height / DIGIT_UNITS;
+    int32_t x = 0;
+    
+    for (int i = 0; dd->text[i]; i++) {
+        dd->cell_x[i] = x;
+        x += glyph_width(dd->set, dd->text[i]) + spacing;
+    }
+    return (x > 0) ? x - spacing : 0;
+}
+
+// Screen area of a cell (full digit height, so a taller glyph fits too)
+static void cell_area(lv_obj_t *obj, const digit_display_t *dd, int cell, lv_area_t *area)
+{
+    lv_area_t coords;
+    lv_obj_get_coords(obj, &coords);
+    
+    int32_t offset = (lv_area_get_width(&coords) - dd->text_w) / 2;
+    area->x1 = coords.x1 + offset + dd->cell_x[cell];
+    area->y1 = coords.y1;
+    area->x2 = area->x1 + glyph_width(dd->set, dd->text[cell]) - 1;
+    area->y2 = coords.y1 + dd->set->height - 1;
+}
+
+static void digit_display_draw_cb(lv_event_t *e)
+{
+    lv_obj_t *obj = lv_event_get_target_obj(e);
+    digit_display_t *dd = lv_obj_get_user_data(obj);
+    lv_layer_t *layer = lv_event_get_layer(e);
+    
+    lv_draw_image_dsc_t dsc;
+    lv_draw_image_dsc_init(&dsc);
+    dsc.recolor = lv_obj_get_style_text_color(obj, LV_PART_MAIN);
+    dsc.recolor_opa = LV_OPA_COVER;
+    
+    for (int i = 0; dd->text[i]; i++) {
+        int index = glyph_index(dd->text[i]);
+        if (index < 0 || dd->text[i] == ' ') {
+            continue;
+        }
+        
+        const lv_image_dsc_t *glyph = &dd->set->glyphs[index];
+        lv_area_t area;
+        cell_area(obj, dd, i, &area);
+        area.y2 = area.y1 + glyph->header.h - 1;    // Letters sit at the top
+        
+        dsc.src = glyph;
+        lv_draw_image(layer, &dsc, &area);
+    }
+}
+
+static void digit_display_delete_cb(lv_event_t *e)
+{
+    digit_display_t *dd = lv_obj_get_user_data(lv_event_get_target_obj(e));
+    if (dd) {
+        dd->set->refs--;    // Glyphs stay cached for the next display
+        free(dd);
+    }
+}
+
+static int32_t sample_units(const char *sample)
+{
+    int32_t units = 0;
+    for (const char *p = sample; *p; p++) {
+        stroke_t strokes[7];
+        int32_t width;
+        bool letter;
+        glyph_strokes(*p, strokes, &width, &letter);
+        units += (letter ? width * DIGIT_LETTER_SCALE / 100 : width) + DIGIT_SPACING;
+    }
+    return (units > DIGIT_SPACING) ? units - DIGIT_SPACING : DIGIT_UNITS;
+}
+
+lv_obj_t* digit_display_create(lv_obj_t *parent, const char *sample, int32_t max_w, int32_t max_h)
+{
+    if (!parent || !sample || strlen(sample) > DIGIT_MAX_CELLS) {
+        return NULL;
+    }
+    
+    // Largest height at which the sample fits, in whole pixels
+    int32_t height = LV_MIN(max_h, max_w * DIGIT_UNITS / sample_units(sample));
+    height = LV_CLAMP(DIGIT_MIN_HEIGHT, height, DIGIT_MAX_HEIGHT);
+    
+    digit_display_t *dd = calloc(1, sizeof(digit_display_t));
+    if (!dd) {
+        return NULL;
+    }
+    
+    dd->set = acquire_glyph_set(height);
+    if (!dd->set) {
+        free(dd);
+        return NULL;
+    }
+    
+    // Size the object for the sample, then start out empty
+    strcpy(dd->text, sample);
+    int32_t width = layout_text(dd);
+    dd->text[0] = '\0';
+    dd->text_w = 0;
+    
+    lv_obj_t *obj = lv_obj_create(parent);
+    lv_obj_remove_style_all(obj);
+    lv_obj_set_size(obj, width, height);
+    lv_obj_clear_flag(obj, LV_OBJ_FLAG_CLICKABLE | LV_OBJ_FLAG_SCROLLABLE);
+    lv_obj_set_user_data(obj, dd);
+    lv_obj_add_event_cb(obj, digit_display_draw_cb, LV_EVENT_DRAW_MAIN, NULL);
+    lv_obj_add_event_cb(obj, digit_display_delete_cb, LV_EVENT_DELETE, NULL);
+    
+    return obj;
+}
+
+bool digit_display_set_text(lv_obj_t *obj, const char *text)
+{
+    digit_display_t *dd = obj ? lv_obj_get_user_data(obj) : NULL;
+    if (!dd || !text) {
+        return false;
+    }
+    
+    if (strcmp(dd->text, text) == 0) {
+        redraw_stats_count_label(false);
+        return false;
+    }
+    redraw_stats_count_label(true);
+    
+    size_t old_len = strlen(dd->text);
+    size_t new_len = strlen(text);
+    if (new_len > DIGIT_MAX_CELLS) {
+        new_len = DIGIT_MAX_CELLS;
+    }
+    
+    // Same cell structure (e.g. 12:59 -> 12:58): only redraw changed cells
+    bool same_layout = (old_len == new_len);
+    for (size_t i = 0; i < new_len && same_layout; i++) {
+        same_layout = (glyph_width(dd->set, dd->text[i]) == glyph_width(dd->set, text[i]));
+    }
+    
+    if (same_layout) {
+        for (size_t i = 0; i < new_len; i++) {
+            if (dd->text[i] != text[i]) {
+                lv_area_t area;
+                cell_area(obj, dd, (int)i, &area);
+                lv_obj_invalidate_area(obj, &area);
+                dd->text[i] = text[i];
+            }
+        }
+        return true;
+    }
+    
+    // The text moved (e.g. 9:59 -> 10:00), so the whole display changes
+    memcpy(dd->text, text, new_len);
+    dd->text[new_len] = '\0';
+    dd->text_w = layout_text(dd);
+    lv_obj_invalidate(obj);
+    return true;
+}
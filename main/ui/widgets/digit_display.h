@@ -0,0 +1,41 @@
+#pragma once
+
+#include "lvgl.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Large sprite-based digit display
+ * Renders "0-9", ':', '-', ' ' and AM/PM letters from glyphs that are
+ * rasterized once per size into an A8 cache in PSRAM. Setting new text
+ * only invalidates the cells whose character changed. The color is the
+ * object's text color style.
+ */
+
+/**
+ * @brief Create a digit display sized to fit a sample text
+ * The glyph height is the largest at which the sample fits in the given
+ * box; the object is as wide as the sample.
+ * @param parent Parent object
+ * @param sample Widest text that will be shown (e.g. "88:88:88 AM")
+ * @param max_w Available width
+ * @param max_h Available height
+ * @return Display object, or NULL if the glyphs couldn't be allocated
+ */
+lv_obj_t* digit_display_create(lv_obj_t *parent, const char *sample, int32_t max_w, int32_t max_h);
+
+/**
+ * @brief Set the shown text, invalidating only the changed cells
+ * @param obj Display object
+ * @param text New text (unsupported characters show as blanks)
+ * @return true if the text changed
+ */
+bool digit_display_set_text(lv_obj_t *obj, const char *text);
+
+#ifdef __cplusplus
+}
+#endif
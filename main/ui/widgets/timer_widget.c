@@ -2,6 +2,10 @@
 #include "widget_common.h"
 #include "core/widget_manager.h"
 #include "core/font_size.h"
+#include "core/tick_scheduler.h"
+#include "core/timer_service.h"
+#include "core/ui_state.h"
+#include "core/storage_writer.h"
 #include "sd_database.h"
 #include "esp_log.h"
 #include "bsp/esp-bsp.h"
@@ -18,22 +22,17 @@ typedef enum {
     TIMER_MODE_STOPWATCH
 } timer_mode_t;
 
+// The widget shows one timer from timer_service, which keeps the time
+#define TIMER_WIDGET_NAME    "timer"
+
 typedef struct {
     timer_mode_t mode;
-    int duration_seconds;  // For countdown (current value)
-    int initial_duration_seconds;  // For countdown (saved/initial value to restore on reset)
-    int elapsed_seconds;   // For stopwatch
-    bool running;
-    bool paused;
+    int initial_duration_seconds;  // For countdown (value to restore on reset)
 } timer_config_t;
 
 static timer_config_t timer_config = {
     .mode = TIMER_MODE_COUNTDOWN,
-    .duration_seconds = 300,  // 5 minutes default
-    .initial_duration_seconds = 300,  // 5 minutes default
-    .elapsed_seconds = 0,
-    .running = false,
-    .paused = false
+    .initial_duration_seconds = 300  // 5 minutes default
 };
 
 static lv_obj_t *timer_container = NULL;
@@ -43,9 +42,11 @@ static lv_obj_t *status_label = NULL;
 static lv_obj_t *start_pause_btn = NULL;
 static lv_obj_t *reset_btn = NULL;
 static lv_obj_t *time_adjust_container = NULL;  // For countdown time adjustment
-static lv_timer_t *timer_timer = NULL;
+static int timer_tick = -1;     // tick_scheduler subscription
+static bool timer_suspended = false;
 
-static void timer_update_cb(lv_timer_t *timer);
+static void timer_update_cb(void);
+static void timer_tick_cb(time_t now, void *user_data);
 static void load_config(void);
 static void save_config(void);
 static void format_time(int seconds, char *buf, size_t len);
@@ -53,14 +54,66 @@ static void start_pause_btn_event_cb(lv_event_t *e);
 static void reset_btn_event_cb(lv_event_t *e);
 static void time_adjust_btn_event_cb(lv_event_t *e);
 static void update_control_buttons(void);
+static void render_timer(void);
+
+// Countdown finished (esp_timer task) - redraw if shown
+static void timer_finished_cb(const char *name)
+{
+    if (strcmp(name, TIMER_WIDGET_NAME) == 0) {
+        ui_state_post_data_updated("timer");
+    }
+}
+
+// Make the service timer match the widget config (resets it if changed)
+static void configure_service_timer(void)
+{
+    timer_service_configure(TIMER_WIDGET_NAME,
+                            timer_config.mode == TIMER_MODE_STOPWATCH ? TIMER_KIND_STOPWATCH : TIMER_KIND_COUNTDOWN,
+                            timer_config.initial_duration_seconds);
+}
+
+static void get_timer(timer_info_t *info)
+{
+    if (timer_service_get(TIMER_WIDGET_NAME, info) != ESP_OK) {
+        memset(info, 0, sizeof(*info));
+        info->duration_s = timer_config.initial_duration_seconds;
+        info->value_ms = (int64_t)info->duration_s * 1000;
+    }
+}
+
+// Seconds to show: countdowns round up so 00:00 means done
+static int display_seconds(const timer_info_t *info)
+{
+    if (info->kind == TIMER_KIND_COUNTDOWN) {
+        return (int)((info->value_ms + 999) / 1000);
+    }
+    return (int)(info->value_ms / 1000);
+}
+
+static const char* state_text(timer_state_t state)
+{
+    switch (state) {
+        case TIMER_STATE_RUNNING:
+            return "Running";
+        case TIMER_STATE_PAUSED:
+            return "Paused";
+        case TIMER_STATE_FINISHED:
+            return "Finished";
+        case TIMER_STATE_STOPPED:
+        default:
+            return "Stopped";
+    }
+}
 
 static void timer_widget_init(void)
 {
     load_config();
+    configure_service_timer();
+    timer_service_set_finished_cb(timer_finished_cb);
     ESP_LOGI(TAG, "Timer widget initialized");
 }
 
-static void timer_widget_show(void)
+static void timer_widget_show(lv_obj_t *parent)
 {
     if (timer_container) {
         return;
@@ -68,10 +121,7 @@ static void timer_widget_show(void)
     
     bsp_display_lock(0);
     
-    lv_obj_t *scr = lv_screen_active();
-    lv_obj_set_style_bg_color(scr, WIDGET_COLOR_BG, 0);
-    
-    timer_container = lv_obj_create(scr);
+    timer_container = lv_obj_create(parent);
     lv_obj_set_size(timer_container, LV_PCT(100), LV_PCT(100));
     lv_obj_set_style_bg_opa(timer_container, LV_OPA_TRANSP, 0);
     lv_obj_set_style_border_width(timer_container, 0, 0);
@@ -79,51 +129,44 @@ static void timer_widget_show(void)
     lv_obj_set_flex_align(timer_container, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER);
     lv_obj_clear_flag(timer_container, LV_OBJ_FLAG_SCROLLABLE);
     
+    // In a small dashboard region only the time, progress and main buttons fit
+    bool compact = widget_is_compact(timer_container);
+    
+    timer_info_t info;
+    get_timer(&info);
+    bool active = (info.state == TIMER_STATE_RUNNING || info.state == TIMER_STATE_PAUSED);
+    
     // Time display
     time_label = lv_label_create(timer_container);
     char time_str[32];
-    if (timer_config.mode == TIMER_MODE_COUNTDOWN) {
-        // If timer is stopped/paused, show initial duration; if running, show current duration
-        int display_seconds = (timer_config.running || timer_config.paused) ? 
-                              timer_config.duration_seconds : timer_config.initial_duration_seconds;
-        format_time(display_seconds, time_str, sizeof(time_str));
-        // Also update current duration if stopped
-        if (!timer_config.running && !timer_config.paused) {
-            timer_config.duration_seconds = timer_config.initial_duration_seconds;
-        }
-    } else {
-        format_time(timer_config.elapsed_seconds, time_str, sizeof(time_str));
-    }
+    format_time(display_seconds(&info), time_str, sizeof(time_str));
     lv_label_set_text(time_label, time_str);
     lv_obj_set_style_text_font(time_label, font_size_get_huge(), 0);
     lv_obj_set_style_text_color(time_label, WIDGET_COLOR_TEXT, 0);
-    lv_obj_set_style_margin_bottom(time_label, 30, 0);
+    lv_obj_set_style_margin_bottom(time_label, compact ? 10 : 30, 0);
     
     // Progress bar (for countdown)
     if (timer_config.mode == TIMER_MODE_COUNTDOWN) {
         progress_bar = lv_bar_create(timer_container);
-        lv_obj_set_size(progress_bar, 300, 20);
-        int max_duration = timer_config.initial_duration_seconds;
-        lv_bar_set_range(progress_bar, 0, max_duration);
-        int current_value = (timer_config.running || timer_config.paused) ? 
-                           timer_config.duration_seconds : timer_config.initial_duration_seconds;
-        lv_bar_set_value(progress_bar, current_value, LV_ANIM_OFF);
+        lv_obj_set_size(progress_bar, compact ? LV_PCT(80) : 300, 20);
+        lv_bar_set_range(progress_bar, 0, info.duration_s);
+        lv_bar_set_value(progress_bar, display_seconds(&info), LV_ANIM_OFF);
         lv_obj_set_style_bg_color(progress_bar, lv_color_hex(0x2a2a4e), LV_PART_MAIN);
         lv_obj_set_style_bg_color(progress_bar, WIDGET_COLOR_ACCENT, LV_PART_INDICATOR);
-        lv_obj_set_style_margin_bottom(progress_bar, 20, 0);
+        lv_obj_set_style_margin_bottom(progress_bar, compact ? 5 : 20, 0);
     }
     
     // Status label
     status_label = lv_label_create(timer_container);
-    lv_label_set_text(status_label, timer_config.running ? "Running" : (timer_config.paused ? "Paused" : "Stopped"));
+    lv_label_set_text(status_label, state_text(info.state));
     lv_obj_set_style_text_font(status_label, font_size_get_normal(), 0);
     lv_obj_set_style_text_color(status_label, WIDGET_COLOR_MUTED, 0);
-    lv_obj_set_style_margin_top(status_label, 20, 0);
-    lv_obj_set_style_margin_bottom(status_label, 30, 0);
+    lv_obj_set_style_margin_top(status_label, compact ? 5 : 20, 0);
+    lv_obj_set_style_margin_bottom(status_label, compact ? 10 : 30, 0);
     
     // Control buttons container
     lv_obj_t *btn_container = lv_obj_create(timer_container);
-    lv_obj_set_size(btn_container, 400, 80);
+    lv_obj_set_size(btn_container, compact ? LV_PCT(100) : 400, compact ? 50 : 80);
     lv_obj_set_style_bg_opa(btn_container, LV_OPA_TRANSP, 0);
     lv_obj_set_style_border_width(btn_container, 0, 0);
     lv_obj_set_flex_flow(btn_container, LV_FLEX_FLOW_ROW);
@@ -133,22 +176,22 @@ static void timer_widget_show(void)
     
     // Start/Pause button
     start_pause_btn = lv_btn_create(btn_container);
-    lv_obj_set_size(start_pause_btn, 150, 60);
+    lv_obj_set_size(start_pause_btn, compact ? LV_PCT(45) : 150, compact ? 44 : 60);
     lv_obj_set_style_bg_color(start_pause_btn, WIDGET_COLOR_ACCENT, 0);
     lv_obj_set_style_bg_opa(start_pause_btn, LV_OPA_COVER, 0);
     lv_obj_set_style_radius(start_pause_btn, 12, 0);
-    lv_obj_set_style_margin_right(start_pause_btn, 20, 0); // Gap between buttons
+    lv_obj_set_style_margin_right(start_pause_btn, compact ? 8 : 20, 0); // Gap between buttons
     lv_obj_add_event_cb(start_pause_btn, start_pause_btn_event_cb, LV_EVENT_CLICKED, NULL);
     
     lv_obj_t *start_pause_label = lv_label_create(start_pause_btn);
-    lv_label_set_text(start_pause_label, timer_config.running ? "Pause" : "Start");
+    lv_label_set_text(start_pause_label, info.state == TIMER_STATE_RUNNING ? "Pause" : "Start");
     lv_obj_set_style_text_font(start_pause_label, &lv_font_montserrat_20, 0); // Fixed font for buttons
     lv_obj_set_style_text_color(start_pause_label, lv_color_white(), 0);
     lv_obj_center(start_pause_label);
     
     // Reset button
     reset_btn = lv_btn_create(btn_container);
-    lv_obj_set_size(reset_btn, 150, 60);
+    lv_obj_set_size(reset_btn, compact ? LV_PCT(45) : 150, compact ? 44 : 60);
     lv_obj_set_style_bg_color(reset_btn, lv_color_hex(0x444444), 0);
     lv_obj_set_style_bg_opa(reset_btn, LV_OPA_COVER, 0);
     lv_obj_set_style_radius(reset_btn, 12, 0);
@@ -161,7 +204,7 @@ static void timer_widget_show(void)
     lv_obj_center(reset_label);
     
     // Time adjustment buttons (for countdown mode when stopped)
-    if (timer_config.mode == TIMER_MODE_COUNTDOWN) {
+    if (timer_config.mode == TIMER_MODE_COUNTDOWN && !compact) {
         time_adjust_container = lv_obj_create(timer_container);
         lv_obj_set_size(time_adjust_container, 400, 60);
         lv_obj_set_style_bg_opa(time_adjust_container, LV_OPA_TRANSP, 0);
@@ -220,16 +263,16 @@ static void timer_widget_show(void)
         lv_obj_center(label_plus1);
         
         // Show/hide adjustment buttons based on timer state
-        if (timer_config.running || timer_config.paused) {
+        if (active) {
             lv_obj_add_flag(time_adjust_container, LV_OBJ_FLAG_HIDDEN);
         }
     }
     
+    // Redraw every second while running; the service keeps the time
+    timer_suspended = false;
+    timer_tick = tick_scheduler_subscribe(TICK_ON_SECOND, 0, timer_tick_cb, NULL);
     update_control_buttons();
     
-    // Create update timer (1 second interval)
-    timer_timer = lv_timer_create(timer_update_cb, 1000, NULL);
-    
     bsp_display_unlock();
     
     ESP_LOGI(TAG, "Timer widget shown");
@@ -239,11 +282,9 @@ static void timer_widget_hide(void)
 {
     bsp_display_lock(0);
     
-    // Stop timer first
-    if (timer_timer) {
-        lv_timer_delete(timer_timer);
-        timer_timer = NULL;
-    }
+    // Stop updates first
+    tick_scheduler_unsubscribe(timer_tick);
+    timer_tick = -1;
     
     // Clear pointers before deletion to prevent callback from accessing deleted objects
     lv_obj_t *container_to_delete = timer_container;
@@ -267,7 +308,9 @@ static void timer_widget_hide(void)
 
 static void timer_widget_update(void)
 {
-    timer_update_cb(NULL);
+    bsp_display_lock(0);
+    timer_update_cb();
+    bsp_display_unlock();
 }
 
 static void format_time(int seconds, char *buf, size_t len)
@@ -283,57 +326,43 @@ static void format_time(int seconds, char *buf, size_t len)
     }
 }
 
-static void timer_update_cb(lv_timer_t *timer)
+static void timer_tick_cb(time_t now, void *user_data)
+{
+    (void)now;
+    (void)user_data;
+    timer_update_cb();
+}
+
+// Show the time left (or elapsed) - nothing is counted here
+static void render_timer(void)
 {
-    (void)timer;
-    
-    // Check if widget is still active
     if (!timer_container || !time_label) {
         return;
     }
     
-    if (!timer_config.running) {
-        return;
-    }
+    timer_info_t info;
+    get_timer(&info);
     
-    bsp_display_lock(0);
+    char time_str[32];
+    format_time(display_seconds(&info), time_str, sizeof(time_str));
+    widget_label_set_text(time_label, time_str);
     
-    // Double-check after acquiring lock (widget might have been hidden)
+    if (progress_bar) {
+        lv_bar_set_range(progress_bar, 0, info.duration_s);
+        lv_bar_set_value(progress_bar, display_seconds(&info), LV_ANIM_ON);
+    }
+}
+
+// Redraw from the timer service (display lock held)
+static void timer_update_cb(void)
+{
+    // Check if widget is still active
     if (!timer_container || !time_label) {
-        bsp_display_unlock();
         return;
     }
     
-    if (timer_config.mode == TIMER_MODE_COUNTDOWN) {
-        timer_config.duration_seconds--;
-        if (timer_config.duration_seconds < 0) {
-            timer_config.duration_seconds = 0;
-            timer_config.running = false;
-            timer_config.paused = false;
-            // Update buttons when timer completes
-            update_control_buttons();
-            // TODO: Add alert/notification
-        }
-        
-        char time_str[32];
-        format_time(timer_config.duration_seconds, time_str, sizeof(time_str));
-        if (time_label) {
-            lv_label_set_text(time_label, time_str);
-        }
-        
-        if (progress_bar) {
-            lv_bar_set_value(progress_bar, timer_config.duration_seconds, LV_ANIM_ON);
-        }
-    } else {
-        timer_config.elapsed_seconds++;
-        char time_str[32];
-        format_time(timer_config.elapsed_seconds, time_str, sizeof(time_str));
-        if (time_label) {
-            lv_label_set_text(time_label, time_str);
-        }
-    }
-    
-    bsp_display_unlock();
+    render_timer();
+    update_control_buttons();  // Picks up a countdown that just finished
 }
 
 static void load_config(void)
@@ -361,7 +390,6 @@ static void load_config(void)
     item = cJSON_GetObjectItem(json, "duration_seconds");
     if (item && cJSON_IsNumber(item)) {
         timer_config.initial_duration_seconds = item->valueint;
-        timer_config.duration_seconds = item->valueint;  // Restore current duration from saved
     }
     
     cJSON_Delete(json);
@@ -381,8 +409,7 @@ static void save_config(void)
     
     char *json_str = cJSON_PrintUnformatted(json);
     if (json_str) {
-        sd_db_set_string("widget_timer_config", json_str);
-        sd_db_save();
+        storage_writer_set_string("widget_timer_config", json_str, 0);
         free(json_str);
     }
     
@@ -395,8 +422,11 @@ static cJSON* timer_widget_get_config(void)
     cJSON *json = cJSON_CreateObject();
     cJSON_AddStringToObject(json, "mode", timer_config.mode == TIMER_MODE_STOPWATCH ? "stopwatch" : "countdown");
     cJSON_AddNumberToObject(json, "duration_seconds", timer_config.initial_duration_seconds);  // Return saved duration
-    cJSON_AddBoolToObject(json, "running", timer_config.running);
-    cJSON_AddBoolToObject(json, "paused", timer_config.paused);
+    
+    timer_info_t info;
+    get_timer(&info);
+    cJSON_AddBoolToObject(json, "running", info.state == TIMER_STATE_RUNNING);
+    cJSON_AddBoolToObject(json, "paused", info.state == TIMER_STATE_PAUSED);
     return json;
 }
 
@@ -406,32 +436,35 @@ static void update_control_buttons(void)
     
     bsp_display_lock(0);
     
+    timer_info_t info;
+    get_timer(&info);
+    bool running = (info.state == TIMER_STATE_RUNNING);
+    
     // Update start/pause button text
     lv_obj_t *btn_label = lv_obj_get_child(start_pause_btn, 0);
     if (btn_label) {
-        if (timer_config.running) {
-            lv_label_set_text(btn_label, "Pause");
-        } else if (timer_config.paused) {
-            lv_label_set_text(btn_label, "Resume");
+        if (running) {
+            widget_label_set_text(btn_label, "Pause");
+        } else if (info.state == TIMER_STATE_PAUSED) {
+            widget_label_set_text(btn_label, "Resume");
         } else {
-            lv_label_set_text(btn_label, "Start");
+            widget_label_set_text(btn_label, "Start");
         }
     }
     
     // Update status label
     if (status_label) {
-        lv_label_set_text(status_label, timer_config.running ? "Running" : (timer_config.paused ? "Paused" : "Stopped"));
+        widget_label_set_text(status_label, state_text(info.state));
     }
     
     // Show/hide time adjustment buttons (only for countdown when stopped)
     if (time_adjust_container) {
-        if (timer_config.running || timer_config.paused) {
-            lv_obj_add_flag(time_adjust_container, LV_OBJ_FLAG_HIDDEN);
-        } else {
-            lv_obj_clear_flag(time_adjust_container, LV_OBJ_FLAG_HIDDEN);
-        }
+        widget_obj_set_visible(time_adjust_container, !running && info.state != TIMER_STATE_PAUSED);
     }
     
+    // Only tick while there is something counting on screen
+    tick_scheduler_set_paused(timer_tick, timer_suspended || !running);
+    
     bsp_display_unlock();
 }
 
@@ -443,25 +476,18 @@ static void start_pause_btn_event_cb(lv_event_t *e)
     
     bsp_display_lock(0);
     
-    if (timer_config.running) {
-        // Pause
-        timer_config.running = false;
-        timer_config.paused = true;
+    timer_info_t info;
+    get_timer(&info);
+    if (info.state == TIMER_STATE_RUNNING) {
+        timer_service_pause(TIMER_WIDGET_NAME);
         ESP_LOGI(TAG, "Timer paused");
     } else {
-        // Start or Resume
-        timer_config.running = true;
-        timer_config.paused = false;
-        
-        // For countdown, ensure we don't go below 0
-        if (timer_config.mode == TIMER_MODE_COUNTDOWN && timer_config.duration_seconds <= 0) {
-            timer_config.duration_seconds = timer_config.initial_duration_seconds; // Reset to saved duration if at 0
-        }
-        
-        ESP_LOGI(TAG, "Timer %s", timer_config.paused ? "resumed" : "started");
+        // A finished countdown starts over from the full duration
+        timer_service_start(TIMER_WIDGET_NAME);
+        ESP_LOGI(TAG, "Timer %s", info.state == TIMER_STATE_PAUSED ? "resumed" : "started");
     }
     
-    save_config();
+    render_timer();
     update_control_buttons();
     
     bsp_display_unlock();
@@ -475,32 +501,9 @@ static void reset_btn_event_cb(lv_event_t *e)
     
     bsp_display_lock(0);
     
-    timer_config.running = false;
-    timer_config.paused = false;
-    
-    if (timer_config.mode == TIMER_MODE_COUNTDOWN) {
-        // Reset to saved initial duration
-        timer_config.duration_seconds = timer_config.initial_duration_seconds;
-        if (time_label) {
-            char time_str[32];
-            format_time(timer_config.duration_seconds, time_str, sizeof(time_str));
-            lv_label_set_text(time_label, time_str);
-        }
-        if (progress_bar) {
-            lv_bar_set_range(progress_bar, 0, timer_config.initial_duration_seconds);
-            lv_bar_set_value(progress_bar, timer_config.duration_seconds, LV_ANIM_OFF);
-        }
-    } else {
-        // Stopwatch: reset to 0
-        timer_config.elapsed_seconds = 0;
-        if (time_label) {
-            char time_str[32];
-            format_time(0, time_str, sizeof(time_str));
-            lv_label_set_text(time_label, time_str);
-        }
-    }
-    
-    save_config();
+    // Countdown back to the saved duration, stopwatch back to 0
+    timer_service_reset(TIMER_WIDGET_NAME);
+    render_timer();
     update_control_buttons();
     
     bsp_display_unlock();
@@ -510,7 +513,10 @@ static void time_adjust_btn_event_cb(lv_event_t *e)
 {
     int32_t seconds = (int32_t)(intptr_t)lv_event_get_user_data(e);
     
-    if (timer_config.mode != TIMER_MODE_COUNTDOWN || timer_config.running || timer_config.paused) {
+    timer_info_t info;
+    get_timer(&info);
+    if (timer_config.mode != TIMER_MODE_COUNTDOWN ||
+        info.state == TIMER_STATE_RUNNING || info.state == TIMER_STATE_PAUSED) {
         return; // Only allow adjustment when stopped
     }
     
@@ -519,29 +525,17 @@ static void time_adjust_btn_event_cb(lv_event_t *e)
     bsp_display_lock(0);
     
     timer_config.initial_duration_seconds += seconds;
-    timer_config.duration_seconds = timer_config.initial_duration_seconds;  // Update current duration too
     
     // Clamp to reasonable values (0 to 99:59:59)
     if (timer_config.initial_duration_seconds < 0) {
         timer_config.initial_duration_seconds = 0;
-        timer_config.duration_seconds = 0;
     } else if (timer_config.initial_duration_seconds > 359999) {
         timer_config.initial_duration_seconds = 359999; // 99:59:59
-        timer_config.duration_seconds = 359999;
-    }
-    
-    // Update display
-    if (time_label) {
-        char time_str[32];
-        format_time(timer_config.duration_seconds, time_str, sizeof(time_str));
-        lv_label_set_text(time_label, time_str);
-    }
-    
-    if (progress_bar) {
-        lv_bar_set_range(progress_bar, 0, timer_config.initial_duration_seconds);
-        lv_bar_set_value(progress_bar, timer_config.duration_seconds, LV_ANIM_OFF);
     }
     
+    configure_service_timer();
+    render_timer();
+    update_control_buttons();
     save_config();
     
     bsp_display_unlock();
@@ -560,26 +554,79 @@ static void timer_widget_set_config(cJSON *cfg)
     item = cJSON_GetObjectItem(cfg, "duration_seconds");
     if (item && cJSON_IsNumber(item)) {
         timer_config.initial_duration_seconds = item->valueint;
-        timer_config.duration_seconds = item->valueint;  // Update current duration too
     }
     
-    item = cJSON_GetObjectItem(cfg, "running");
-    if (item && cJSON_IsBool(item)) {
-        timer_config.running = cJSON_IsTrue(item);
+    // A changed mode or duration resets the timer
+    configure_service_timer();
+    
+    cJSON *running = cJSON_GetObjectItem(cfg, "running");
+    cJSON *paused = cJSON_GetObjectItem(cfg, "paused");
+    if (cJSON_IsTrue(running)) {
+        timer_service_start(TIMER_WIDGET_NAME);
+    } else if (cJSON_IsTrue(paused)) {
+        timer_service_pause(TIMER_WIDGET_NAME);
+    } else if (cJSON_IsFalse(running)) {
+        if (cJSON_IsFalse(paused)) {
+            timer_service_reset(TIMER_WIDGET_NAME);
+        } else {
+            timer_service_pause(TIMER_WIDGET_NAME);
+        }
     }
     
-    item = cJSON_GetObjectItem(cfg, "paused");
-    if (item && cJSON_IsBool(item)) {
-        timer_config.paused = cJSON_IsTrue(item);
+    // Persistence and the rebuild (if shown) are done once by widget_manager
+}
+
+// Patch the shown timer for changed config fields (called with the display lock held)
+static bool timer_widget_apply_delta(const cJSON *changed)
+{
+    if (!timer_container) {
+        return true;  // Not shown, next show() uses the new config
     }
     
-    save_config();
+    // Countdown and stopwatch have different controls
+    if (cJSON_GetObjectItem(changed, "mode")) {
+        return false;
+    }
     
-    // If widget is currently shown, recreate it with new config
-    if (timer_container) {
-        timer_widget_hide();
-        timer_widget_show();
+    if (cJSON_GetObjectItem(changed, "font_size")) {
+        if (time_label) {
+            lv_obj_set_style_text_font(time_label, font_size_get_huge(), 0);
+        }
+        if (status_label) {
+            lv_obj_set_style_text_font(status_label, font_size_get_normal(), 0);
+        }
+    }
+    
+    render_timer();
+    update_control_buttons();
+    return true;
+}
+
+// Retain mode: keep the object tree, just hide it and pause updates
+static void timer_widget_suspend(void)
+{
+    if (!timer_container) {
+        return;
+    }
+    
+    // The service keeps counting; only the redraws stop
+    timer_suspended = true;
+    tick_scheduler_set_paused(timer_tick, true);
+    lv_obj_add_flag(timer_container, LV_OBJ_FLAG_HIDDEN);
+}
+
+static void timer_widget_resume(void)
+{
+    if (!timer_container) {
+        return;
     }
+    
+    lv_obj_clear_flag(timer_container, LV_OBJ_FLAG_HIDDEN);
+    lv_obj_move_foreground(timer_container);
+    
+    timer_suspended = false;
+    render_timer();
+    update_control_buttons();
 }
 
 const struct widget timer_widget = {
@@ -591,6 +638,9 @@ const struct widget timer_widget = {
     .hide = timer_widget_hide,
     .update = timer_widget_update,
     .get_config = timer_widget_get_config,
-    .set_config = timer_widget_set_config
+    .set_config = timer_widget_set_config,
+    .apply_delta = timer_widget_apply_delta,
+    .suspend = timer_widget_suspend,
+    .resume = timer_widget_resume
 };
 
@@ -0,0 +1,33 @@
+#include "widget_common.h"
+#include "core/redraw_stats.h"
+#include <string.h>
+
+bool widget_label_set_text(lv_obj_t *label, const char *text)
+{
+    if (!label || !text) {
+        return false;
+    }
+    
+    const char *current = lv_label_get_text(label);
+    if (current && strcmp(current, text) == 0) {
+        redraw_stats_count_label(false);
+        return false;
+    }
+    
+    lv_label_set_text(label, text);
+    redraw_stats_count_label(true);
+    return true;
+}
+
+void widget_obj_set_visible(lv_obj_t *obj, bool visible)
+{
+    if (!obj || lv_obj_has_flag(obj, LV_OBJ_FLAG_HIDDEN) == !visible) {
+        return;
+    }
+    
+    if (visible) {
+        lv_obj_clear_flag(obj, LV_OBJ_FLAG_HIDDEN);
+    } else {
+        lv_obj_add_flag(obj, LV_OBJ_FLAG_HIDDEN);
+    }
+}
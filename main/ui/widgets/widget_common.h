@@ -1,6 +1,7 @@
 #pragma once
 
 #include "lvgl.h"
+#include <stdbool.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -13,6 +14,34 @@ extern "C" {
 #define WIDGET_COLOR_ACCENT    lv_color_hex(0xe94560)
 #define WIDGET_COLOR_SUCCESS   lv_color_hex(0x4caf50)
 
+// Containers smaller than this (e.g. a dashboard region) get a compact layout
+#define WIDGET_COMPACT_SIZE    400
+
+// Resolve a widget container's size and check if it needs the compact layout
+static inline bool widget_is_compact(lv_obj_t *container)
+{
+    lv_obj_update_layout(container);
+    return lv_obj_get_content_width(container) < WIDGET_COMPACT_SIZE ||
+           lv_obj_get_content_height(container) < WIDGET_COMPACT_SIZE;
+}
+
+/**
+ * @brief Set a label's text only if it differs from what is shown
+ * Unchanged text causes no relayout or invalidation. The label's own
+ * text is the copy compared against.
+ * @param label Label object
+ * @param text New text
+ * @return true if the text changed
+ */
+bool widget_label_set_text(lv_obj_t *label, const char *text);
+
+/**
+ * @brief Show or hide an object, skipping the redraw if nothing changes
+ * @param obj Object
+ * @param visible true to show, false to hide
+ */
+void widget_obj_set_visible(lv_obj_t *obj, bool visible);
+
 #ifdef __cplusplus
 }
 #endif